@@ -1,4 +1,5 @@
 using System;
+using System.Collections.Generic;
 using System.Diagnostics;
 using System.Threading;
 using System.Threading.Tasks;
@@ -67,6 +68,31 @@ namespace Rl.Net.Cli.Test
         }
     }
 
+    internal class MockLeasingSender : LeasingSender
+    {
+        public MockLeasingSender(ErrorCallback callback) : base(callback)
+        {
+        }
+
+        public Action<BufferLease> OnSend
+        {
+            get;
+            set;
+        }
+
+        protected override void Send(BufferLease lease)
+        {
+            if (this.OnSend != null)
+            {
+                this.OnSend(lease);
+            }
+            else
+            {
+                lease.Dispose();
+            }
+        }
+    }
+
     [TestClass]
     public class SenderExtensibilityTest : TestBase
     {
@@ -457,6 +483,64 @@ namespace Rl.Net.Cli.Test
             Assert.IsTrue(sendCalled);
         }
 
+        [TestMethod]
+        public void Test_LeasingSender_LeaseOutlivesSend()
+        {
+            ManualResetEventSlim senderCalledWaiter = new ManualResetEventSlim(initialState: false);
+
+            List<BufferLease> leases = new List<BufferLease>();
+            void LeasingSenderSend(BufferLease lease)
+            {
+                lock (leases)
+                {
+                    leases.Add(lease);
+                }
+
+                senderCalledWaiter.Set();
+            }
+
+            FactoryContext factoryContext = CreateFactoryContext(
+                (config, callback) =>
+                {
+                    return new MockLeasingSender(callback)
+                    {
+                        OnSend = LeasingSenderSend
+                    };
+                });
+
+            LiveModel liveModel = CreateLiveModel(factoryContext);
+            liveModel.Init();
+            RankingResponse response = liveModel.ChooseRank(EventId, ContextJsonWithPdf);
+
+            Assert.IsTrue(senderCalledWaiter.Wait(TimeSpan.FromSeconds(1)));
+
+            List<BufferLease> received;
+            lock (leases)
+            {
+                received = new List<BufferLease>(leases);
+            }
+
+            // The bytes are still readable after Send returned, until the leases are completed
+            foreach (BufferLease lease in received)
+            {
+                Assert.IsTrue(lease.Length > 0);
+                Assert.AreEqual(lease.Length, lease.Memory.Length);
+                Assert.AreEqual(lease.Span[0], lease.Memory.Span[0]);
+            }
+
+            BufferLease.CompleteAll(received);
+
+            foreach (BufferLease lease in received)
+            {
+                Assert.IsTrue(lease.IsCompleted);
+                Assert.ThrowsException<ObjectDisposedException>(() => lease.Memory);
+            }
+
+            // Completing twice is harmless
+            BufferLease.CompleteAll(received);
+            received[0].Dispose();
+        }
+
         private void Run_TestAsyncSender_SendFailure(Func<SharedBuffer, BackgroundErrorCallback, Task> asyncSenderSend, string expectedString, bool expectPrefix = false)
         {
             FactoryContext factoryContext = CreateFactoryContext(asyncSendFunc: asyncSenderSend);
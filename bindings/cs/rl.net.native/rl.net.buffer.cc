@@ -12,6 +12,14 @@ API void ReleaseBufferSharedPointer(const buffer* buffer)
     delete buffer;
 }
 
+API void ReleaseBufferSharedPointers(const buffer* const* buffers, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        delete buffers[i];
+    }
+}
+
 API const unsigned char* GetSharedBufferBegin(const buffer* buffer)
 {
     return (*buffer)->preamble_begin();
@@ -14,6 +14,9 @@ extern "C"
 {
   API void ReleaseBufferSharedPointer(const rl_net_native::buffer* buffer);
 
+  // Releases count buffers in a single call, so managed senders can acknowledge a whole batch per transition
+  API void ReleaseBufferSharedPointers(const rl_net_native::buffer* const* buffers, int count);
+
   API const rl_net_native::buffer* CloneBufferSharedPointer(const rl_net_native::buffer* original);
 
   API const unsigned char* GetSharedBufferBegin(const rl_net_native::buffer* buffer);
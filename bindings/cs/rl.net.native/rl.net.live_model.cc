@@ -220,6 +220,11 @@ API int LiveModelRefreshModel(livemodel_context_t* context, reinforcement_learni
   return context->livemodel->refresh_model(status);
 }
 
+API int LiveModelGetMetrics(livemodel_context_t* context, reinforcement_learning::metrics_snapshot* metrics, reinforcement_learning::api_status* status)
+{
+  return context->livemodel->get_metrics(*metrics, status);
+}
+
 API void LiveModelSetCallback(livemodel_context_t* livemodel, rl_net_native::background_error_callback_t callback)
 {
   livemodel->background_error_callback = callback;
@@ -59,6 +59,8 @@ extern "C" {
 
   API int LiveModelRefreshModel(livemodel_context_t* context, reinforcement_learning::api_status* status = nullptr);
 
+  API int LiveModelGetMetrics(livemodel_context_t* context, reinforcement_learning::metrics_snapshot* metrics, reinforcement_learning::api_status* status = nullptr);
+
   API void LiveModelSetCallback(livemodel_context_t* livemodel, rl_net_native::background_error_callback_t callback = nullptr);
   API void LiveModelSetTrace(livemodel_context_t* livemodel, rl_net_native::trace_logger_callback_t trace_logger_callback = nullptr);
 }
@@ -0,0 +1,64 @@
+#include "rl.net.metrics.h"
+
+API reinforcement_learning::metrics_snapshot* CreateMetricsSnapshot()
+{
+    return new reinforcement_learning::metrics_snapshot();
+}
+
+API void DeleteMetricsSnapshot(reinforcement_learning::metrics_snapshot* metrics)
+{
+    delete metrics;
+}
+
+API size_t GetMetricsCounterCount(reinforcement_learning::metrics_snapshot* metrics)
+{
+    return metrics->counters.size();
+}
+
+API const char* GetMetricsCounterName(reinforcement_learning::metrics_snapshot* metrics, size_t index)
+{
+    return metrics->counters[index].name.c_str();
+}
+
+API uint64_t GetMetricsCounterValue(reinforcement_learning::metrics_snapshot* metrics, size_t index)
+{
+    return metrics->counters[index].value;
+}
+
+API size_t GetMetricsGaugeCount(reinforcement_learning::metrics_snapshot* metrics)
+{
+    return metrics->gauges.size();
+}
+
+API const char* GetMetricsGaugeName(reinforcement_learning::metrics_snapshot* metrics, size_t index)
+{
+    return metrics->gauges[index].name.c_str();
+}
+
+API int64_t GetMetricsGaugeValue(reinforcement_learning::metrics_snapshot* metrics, size_t index)
+{
+    return metrics->gauges[index].value;
+}
+
+API size_t GetMetricsHistogramCount(reinforcement_learning::metrics_snapshot* metrics)
+{
+    return metrics->histograms.size();
+}
+
+API const char* GetMetricsHistogramName(reinforcement_learning::metrics_snapshot* metrics, size_t index)
+{
+    return metrics->histograms[index].name.c_str();
+}
+
+API void GetMetricsHistogramValues(reinforcement_learning::metrics_snapshot* metrics, size_t index, uint64_t* values)
+{
+    const auto& histogram = metrics->histograms[index];
+    values[0] = histogram.count;
+    values[1] = histogram.sum;
+    values[2] = histogram.min;
+    values[3] = histogram.max;
+    values[4] = histogram.p50;
+    values[5] = histogram.p90;
+    values[6] = histogram.p99;
+    values[7] = histogram.p999;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "rl.net.native.h"
+#include "metrics.h"
+
+// Global exports
+extern "C" {
+    API reinforcement_learning::metrics_snapshot* CreateMetricsSnapshot();
+    API void DeleteMetricsSnapshot(reinforcement_learning::metrics_snapshot* metrics);
+
+    API size_t GetMetricsCounterCount(reinforcement_learning::metrics_snapshot* metrics);
+    API const char* GetMetricsCounterName(reinforcement_learning::metrics_snapshot* metrics, size_t index);
+    API uint64_t GetMetricsCounterValue(reinforcement_learning::metrics_snapshot* metrics, size_t index);
+
+    API size_t GetMetricsGaugeCount(reinforcement_learning::metrics_snapshot* metrics);
+    API const char* GetMetricsGaugeName(reinforcement_learning::metrics_snapshot* metrics, size_t index);
+    API int64_t GetMetricsGaugeValue(reinforcement_learning::metrics_snapshot* metrics, size_t index);
+
+    API size_t GetMetricsHistogramCount(reinforcement_learning::metrics_snapshot* metrics);
+    API const char* GetMetricsHistogramName(reinforcement_learning::metrics_snapshot* metrics, size_t index);
+    // Writes count, sum, min, max, p50, p90, p99 and p999 to values, which must hold 8 elements
+    API void GetMetricsHistogramValues(reinforcement_learning::metrics_snapshot* metrics, size_t index, uint64_t* values);
+}
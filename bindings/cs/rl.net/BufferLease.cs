@@ -0,0 +1,153 @@
+using System;
+using System.Buffers;
+using System.Collections.Generic;
+using System.Runtime.InteropServices;
+using System.Threading;
+
+namespace Rl.Net {
+    /// <summary>
+    /// A reference to a native send buffer that keeps it alive until it is completed. The bytes are read in place
+    /// through <see cref="Memory"/> or <see cref="Span"/>, without copying them into a managed array.
+    /// The lease must be completed once the transport is done with the bytes, either with <see cref="Dispose"/> or,
+    /// for many leases at once, with <see cref="CompleteAll"/>. Reading the bytes after completion is not allowed.
+    /// </summary>
+    public sealed class BufferLease : IDisposable
+    {
+        [DllImport("rl.net.native.dll")]
+        private static extern IntPtr CloneBufferSharedPointer(IntPtr original);
+
+        [DllImport("rl.net.native.dll")]
+        private static extern void ReleaseBufferSharedPointer(IntPtr shared_buffer);
+
+        [DllImport("rl.net.native.dll")]
+        private static extern void ReleaseBufferSharedPointers(IntPtr[] shared_buffers, int count);
+
+        [DllImport("rl.net.native.dll")]
+        private static extern IntPtr GetSharedBufferBegin(IntPtr shared_buffer);
+
+        [DllImport("rl.net.native.dll")]
+        private static extern UIntPtr GetSharedBufferLength(IntPtr shared_buffer);
+
+        // Exposes the native bytes as Memory<byte>. Native memory does not move, so pinning is free.
+        private sealed unsafe class NativeMemoryManager : MemoryManager<byte>
+        {
+            private readonly byte* pointer;
+            private readonly int length;
+
+            public NativeMemoryManager(byte* pointer, int length)
+            {
+                this.pointer = pointer;
+                this.length = length;
+            }
+
+            public override Span<byte> GetSpan()
+            {
+                return new Span<byte>(this.pointer, this.length);
+            }
+
+            public override MemoryHandle Pin(int elementIndex = 0)
+            {
+                return new MemoryHandle(this.pointer + elementIndex);
+            }
+
+            public override void Unpin()
+            {
+            }
+
+            protected override void Dispose(bool disposing)
+            {
+            }
+        }
+
+        private IntPtr sharedBuffer;
+        private readonly NativeMemoryManager memoryManager;
+
+        internal BufferLease(IntPtr originalSharedBuffer)
+        {
+            this.sharedBuffer = CloneBufferSharedPointer(originalSharedBuffer);
+
+            unsafe
+            {
+                byte* begin = (byte*)GetSharedBufferBegin(this.sharedBuffer).ToPointer();
+                int length = (int)GetSharedBufferLength(this.sharedBuffer).ToUInt32();
+                this.memoryManager = new NativeMemoryManager(begin, length);
+            }
+        }
+
+        ~BufferLease()
+        {
+            this.Release();
+        }
+
+        /// <summary>The leased bytes</summary>
+        public ReadOnlyMemory<byte> Memory
+        {
+            get
+            {
+                this.ThrowIfCompleted();
+                return this.memoryManager.Memory;
+            }
+        }
+
+        /// <summary>The leased bytes</summary>
+        public ReadOnlySpan<byte> Span
+        {
+            get
+            {
+                this.ThrowIfCompleted();
+                return this.memoryManager.GetSpan();
+            }
+        }
+
+        public int Length => this.memoryManager.Memory.Length;
+
+        public bool IsCompleted => this.sharedBuffer == IntPtr.Zero;
+
+        /// <summary>Complete the lease and let the native side reuse the buffer</summary>
+        public void Dispose()
+        {
+            this.Release();
+            GC.SuppressFinalize(this);
+        }
+
+        /// <summary>
+        /// Complete many leases with a single transition into native code. Leases that are already completed are skipped.
+        /// </summary>
+        public static void CompleteAll(IReadOnlyList<BufferLease> leases)
+        {
+            IntPtr[] sharedBuffers = new IntPtr[leases.Count];
+            int count = 0;
+            foreach (BufferLease lease in leases)
+            {
+                IntPtr sharedBuffer = Interlocked.Exchange(ref lease.sharedBuffer, IntPtr.Zero);
+                if (sharedBuffer != IntPtr.Zero)
+                {
+                    sharedBuffers[count++] = sharedBuffer;
+                    GC.SuppressFinalize(lease);
+                }
+            }
+
+            if (count > 0)
+            {
+                ReleaseBufferSharedPointers(sharedBuffers, count);
+            }
+        }
+
+        private void Release()
+        {
+            IntPtr localSharedBuffer = Interlocked.Exchange(ref this.sharedBuffer, IntPtr.Zero);
+            if (localSharedBuffer != IntPtr.Zero)
+            {
+                ReleaseBufferSharedPointer(localSharedBuffer);
+            }
+        }
+
+        private void ThrowIfCompleted()
+        {
+            if (this.IsCompleted)
+            {
+                throw new ObjectDisposedException(nameof(BufferLease));
+            }
+        }
+    }
+}
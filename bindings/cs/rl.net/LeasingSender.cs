@@ -0,0 +1,53 @@
+using System;
+using Rl.Net.Native;
+
+namespace Rl.Net
+{
+    /// <summary>
+    /// Base class for an ISender that hands each native buffer to its transport without copying it.
+    /// Every buffer arrives as a <see cref="BufferLease"/> owned by the implementation, which completes it once the bytes
+    /// have been sent. Transports that send several buffers per request can complete them together with
+    /// <see cref="BufferLease.CompleteAll"/>.
+    /// </summary>
+    public abstract class LeasingSender : ISender
+    {
+        private ErrorCallback errorCallback;
+
+        public LeasingSender(ErrorCallback callback)
+        {
+            this.errorCallback = callback;
+        }
+
+        public virtual void Init(ApiStatus status)
+        {
+        }
+
+        public void Send(SharedBuffer buffer, ApiStatus status)
+        {
+            BufferLease lease = buffer.Lease();
+            GC.KeepAlive(buffer);
+
+            try
+            {
+                this.Send(lease);
+            }
+            catch
+            {
+                // Ownership was not taken
+                lease.Dispose();
+                throw;
+            }
+        }
+
+        protected void RaiseBackgroundError(ApiStatus status)
+        {
+            this.errorCallback.Invoke(status);
+        }
+
+        /// <summary>
+        /// Queue the leased bytes on the transport and return. The implementation owns the lease and must complete it.
+        /// Throwing means the lease was not taken, and it is completed by the caller.
+        /// </summary>
+        protected abstract void Send(BufferLease lease);
+    }
+}
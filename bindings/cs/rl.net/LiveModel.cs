@@ -307,6 +307,9 @@ namespace Rl.Net
             [DllImport("rl.net.native.dll")]
             public static extern int LiveModelRefreshModel(IntPtr liveModel, IntPtr apiStatus);
 
+            [DllImport("rl.net.native.dll")]
+            public static extern int LiveModelGetMetrics(IntPtr liveModel, IntPtr metrics, IntPtr apiStatus);
+
             public delegate void managed_background_error_callback_t(IntPtr apiStatus);
 
             [DllImport("rl.net.native.dll")]
@@ -1239,6 +1242,28 @@ namespace Rl.Net
             return result == NativeMethods.SuccessStatus;
         }
 
+        public Metrics GetMetrics()
+        {
+            Metrics metrics = new Metrics();
+            using (ApiStatus apiStatus = new ApiStatus())
+            if (!this.TryGetMetrics(metrics, apiStatus))
+            {
+                throw new RLException(apiStatus);
+            }
+
+            return metrics;
+        }
+
+        public bool TryGetMetrics(Metrics metrics, ApiStatus apiStatus = null)
+        {
+            int result = NativeMethods.LiveModelGetMetrics(this.DangerousGetHandle(), metrics.DangerousGetHandle(), apiStatus.ToNativeHandleOrNullptrDangerous());
+
+            GC.KeepAlive(metrics);
+            GC.KeepAlive(apiStatus);
+            GC.KeepAlive(this);
+            return result == NativeMethods.SuccessStatus;
+        }
+
         private event EventHandler<ApiStatus> BackgroundErrorInternal;
 
         // This event is thread-safe, because we do not hook/unhook the event in user-scheduleable code anymore.
@@ -95,6 +95,11 @@ namespace Rl.Net
             InvokeDangerous(this.liveModel.RefreshModel);
         }
 
+        public Metrics GetMetrics()
+        {
+            return InvokeDangerous(this.liveModel.GetMetrics);
+        }
+
         public event EventHandler<ApiStatus> BackgroundError
         {
             add
@@ -0,0 +1,137 @@
+using System;
+using System.Collections.Generic;
+using System.Runtime.InteropServices;
+
+using Rl.Net.Native;
+
+namespace Rl.Net {
+    namespace Native
+    {
+        internal partial class NativeMethods
+        {
+            [DllImport("rl.net.native.dll")]
+            public static extern IntPtr CreateMetricsSnapshot();
+
+            [DllImport("rl.net.native.dll")]
+            public static extern void DeleteMetricsSnapshot(IntPtr metrics);
+
+            [DllImport("rl.net.native.dll")]
+            public static extern UIntPtr GetMetricsCounterCount(IntPtr metrics);
+
+            [DllImport("rl.net.native.dll")]
+            public static extern IntPtr GetMetricsCounterName(IntPtr metrics, UIntPtr index);
+
+            [DllImport("rl.net.native.dll")]
+            public static extern ulong GetMetricsCounterValue(IntPtr metrics, UIntPtr index);
+
+            [DllImport("rl.net.native.dll")]
+            public static extern UIntPtr GetMetricsGaugeCount(IntPtr metrics);
+
+            [DllImport("rl.net.native.dll")]
+            public static extern IntPtr GetMetricsGaugeName(IntPtr metrics, UIntPtr index);
+
+            [DllImport("rl.net.native.dll")]
+            public static extern long GetMetricsGaugeValue(IntPtr metrics, UIntPtr index);
+
+            [DllImport("rl.net.native.dll")]
+            public static extern UIntPtr GetMetricsHistogramCount(IntPtr metrics);
+
+            [DllImport("rl.net.native.dll")]
+            public static extern IntPtr GetMetricsHistogramName(IntPtr metrics, UIntPtr index);
+
+            [DllImport("rl.net.native.dll")]
+            public static extern void GetMetricsHistogramValues(IntPtr metrics, UIntPtr index, [Out] ulong[] values);
+        }
+    }
+
+    // Distribution of the values recorded in a histogram. Percentiles are upper bounds within 1/16 of the exact value.
+    public struct HistogramSummary
+    {
+        public ulong Count;
+        public ulong Sum;
+        public ulong Min;
+        public ulong Max;
+        public ulong P50;
+        public ulong P90;
+        public ulong P99;
+        public ulong P999;
+    }
+
+    // Snapshot of the performance metrics of the client library, filled by LiveModel.TryGetMetrics.
+    // Metrics are process wide: counters and gauges sum the contributions of every LiveModel.
+    public sealed class Metrics : NativeObject<Metrics>
+    {
+        public Metrics() : base(new New<Metrics>(NativeMethods.CreateMetricsSnapshot), new Delete<Metrics>(NativeMethods.DeleteMetricsSnapshot))
+        {
+        }
+
+        public IReadOnlyDictionary<string, ulong> Counters
+        {
+            get
+            {
+                IntPtr metrics = this.DangerousGetHandle();
+                ulong count = NativeMethods.GetMetricsCounterCount(metrics).ToUInt64();
+
+                Dictionary<string, ulong> result = new Dictionary<string, ulong>();
+                for (ulong i = 0; i < count; i++)
+                {
+                    UIntPtr index = new UIntPtr(i);
+                    result[NativeMethods.StringMarshallingFunc(NativeMethods.GetMetricsCounterName(metrics, index))] = NativeMethods.GetMetricsCounterValue(metrics, index);
+                }
+
+                GC.KeepAlive(this);
+                return result;
+            }
+        }
+
+        public IReadOnlyDictionary<string, long> Gauges
+        {
+            get
+            {
+                IntPtr metrics = this.DangerousGetHandle();
+                ulong count = NativeMethods.GetMetricsGaugeCount(metrics).ToUInt64();
+
+                Dictionary<string, long> result = new Dictionary<string, long>();
+                for (ulong i = 0; i < count; i++)
+                {
+                    UIntPtr index = new UIntPtr(i);
+                    result[NativeMethods.StringMarshallingFunc(NativeMethods.GetMetricsGaugeName(metrics, index))] = NativeMethods.GetMetricsGaugeValue(metrics, index);
+                }
+
+                GC.KeepAlive(this);
+                return result;
+            }
+        }
+
+        public IReadOnlyDictionary<string, HistogramSummary> Histograms
+        {
+            get
+            {
+                IntPtr metrics = this.DangerousGetHandle();
+                ulong count = NativeMethods.GetMetricsHistogramCount(metrics).ToUInt64();
+
+                Dictionary<string, HistogramSummary> result = new Dictionary<string, HistogramSummary>();
+                ulong[] values = new ulong[8];
+                for (ulong i = 0; i < count; i++)
+                {
+                    UIntPtr index = new UIntPtr(i);
+                    NativeMethods.GetMetricsHistogramValues(metrics, index, values);
+                    result[NativeMethods.StringMarshallingFunc(NativeMethods.GetMetricsHistogramName(metrics, index))] = new HistogramSummary
+                    {
+                        Count = values[0],
+                        Sum = values[1],
+                        Min = values[2],
+                        Max = values[3],
+                        P50 = values[4],
+                        P90 = values[5],
+                        P99 = values[6],
+                        P999 = values[7]
+                    };
+                }
+
+                GC.KeepAlive(this);
+                return result;
+            }
+        }
+    }
+}
@@ -35,6 +35,18 @@ namespace Rl.Net {
         public SharedBuffer(SharedBuffer original) : base(BindConstructorArguments(original), new Delete<SharedBuffer>(ReleaseBufferSharedPointer))
         { }
 
+        /// <summary>
+        /// Take a reference to the buffer that outlives this call. The bytes stay valid, without being copied, until
+        /// the returned lease is completed.
+        /// </summary>
+        public BufferLease Lease()
+        {
+            BufferLease lease = new BufferLease(this.DangerousGetHandle());
+            GC.KeepAlive(this);
+
+            return lease;
+        }
+
         public ReadOnlySpan<byte> AsSpanDangerous()
         {
             unsafe {
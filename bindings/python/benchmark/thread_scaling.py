@@ -0,0 +1,80 @@
+"""Measure how choose_rank throughput scales with Python threads.
+
+The native calls release the GIL, so throughput should grow with the thread count until the
+cores are saturated. Run from a directory where rl_client is importable:
+
+    python thread_scaling.py --actions 100 --requests 20000
+"""
+import argparse
+import json
+import tempfile
+import time
+from concurrent.futures import ThreadPoolExecutor
+
+import rl_client
+
+
+def create_model(output_dir):
+    config = {
+        "appid": "thread_scaling",
+        "interaction.sender.implementation": "INTERACTION_FILE_SENDER",
+        "observation.sender.implementation": "OBSERVATION_FILE_SENDER",
+        "interaction.file.name": output_dir + "/interaction.fb",
+        "observation.file.name": output_dir + "/observation.fb",
+        "model.source": "FILE_MODEL_DATA",
+        "model_file_loader.file_must_exist": False,
+        "model.backgroundrefresh": False,
+        "InitialExplorationEpsilon": 0.2,
+    }
+    return rl_client.LiveModel(rl_client.create_config_from_json(json.dumps(config)))
+
+
+def make_context(actions):
+    shared = {"User": {"id": "a", "major": "eng", "hobby": "hiking"}}
+    shared["_multi"] = [{"A": {"id": str(i), "f": i % 7}} for i in range(actions)]
+    return json.dumps(shared)
+
+
+def run(threads, requests, work):
+    per_thread = requests // threads
+    start = time.perf_counter()
+    with ThreadPoolExecutor(max_workers=threads) as executor:
+        futures = [executor.submit(work, per_thread) for _ in range(threads)]
+        completed = sum(future.result() for future in futures)
+    return completed / (time.perf_counter() - start)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--actions", type=int, default=100)
+    parser.add_argument("--requests", type=int, default=20000)
+    parser.add_argument("--batch_size", type=int, default=64)
+    parser.add_argument("--threads", type=int, nargs="+", default=[1, 2, 4, 8])
+    args = parser.parse_args()
+
+    context = make_context(args.actions)
+
+    with tempfile.TemporaryDirectory() as output_dir:
+        model = create_model(output_dir)
+
+        def single(count):
+            for _ in range(count):
+                model.choose_rank(context)
+            return count
+
+        def batched(count):
+            contexts = [context] * args.batch_size
+            batches = count // args.batch_size
+            for _ in range(batches):
+                model.choose_rank_batch(contexts)
+            return batches * args.batch_size
+
+        print("{:>8} {:>16} {:>16}".format("threads", "choose_rank/s", "batch/s"))
+        for threads in args.threads:
+            single_rate = run(threads, args.requests, single)
+            batch_rate = run(threads, args.requests, batched)
+            print("{:>8} {:>16.0f} {:>16.0f}".format(threads, single_rate, batch_rate))
+
+
+if __name__ == "__main__":
+    main()
@@ -1,4 +1,5 @@
 #include <pybind11/functional.h>
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 
 #include "config_utility.h"
@@ -7,6 +8,7 @@
 
 #include <exception>
 #include <memory>
+#include <vector>
 
 #define STRINGIFY(x) #x
 #define MACRO_STRINGIFY(x) STRINGIFY(x)
@@ -104,6 +106,56 @@ struct constants {
   constants() = delete;
 };
 
+// Results of choose_rank_batch. The actions of context i are
+// action_ids[offsets[i]:offsets[i + 1]] and the same slice of probabilities.
+struct ranking_batch {
+  py::list event_ids;
+  py::list model_ids;
+  py::array_t<uint32_t> chosen_action_ids;
+  py::array_t<uint32_t> action_ids;
+  py::array_t<float> probabilities;
+  py::array_t<uint64_t> offsets;
+};
+
+// Hand a vector over to NumPy without copying. The array owns the vector.
+template <typename T> py::array_t<T> to_numpy(std::vector<T> &&values) {
+  auto *owned = new std::vector<T>(std::move(values));
+  py::capsule owner(owned, [](void *p) {
+    delete reinterpret_cast<std::vector<T> *>(p);
+  });
+  return py::array_t<T>(owned->size(), owned->data(), owner);
+}
+
+// Borrow the UTF-8 text of each str or bytes item. items keeps the objects
+// alive so the pointers stay valid while the GIL is released.
+void collect_strings(const py::sequence &sequence, const char *what,
+                     std::vector<py::object> &items,
+                     std::vector<const char *> &values) {
+  // A single str or bytes is a sequence too, of characters or ints
+  if (PyUnicode_Check(sequence.ptr()) || PyBytes_Check(sequence.ptr())) {
+    throw py::type_error(std::string(what) +
+                         " must be a sequence of str or bytes, not a single " +
+                         Py_TYPE(sequence.ptr())->tp_name);
+  }
+  items.reserve(items.size() + sequence.size());
+  values.reserve(values.size() + sequence.size());
+  for (auto item : sequence) {
+    const char *value = nullptr;
+    if (PyBytes_Check(item.ptr())) {
+      value = PyBytes_AS_STRING(item.ptr());
+    } else if (PyUnicode_Check(item.ptr())) {
+      value = PyUnicode_AsUTF8(item.ptr());
+      if (value == nullptr) {
+        throw py::error_already_set();
+      }
+    } else {
+      throw py::type_error(std::string(what) + " must be str or bytes");
+    }
+    items.push_back(py::reinterpret_borrow<py::object>(item));
+    values.push_back(value);
+  }
+}
+
 PYBIND11_MODULE(rl_client, m) {
   PyRLException = PyErr_NewException("rl_client.RLException", NULL, NULL);
   if (PyRLException) {
@@ -149,6 +201,7 @@ PYBIND11_MODULE(rl_client, m) {
              auto live_model =
                  std::unique_ptr<rl::live_model>(new rl::live_model(config));
              rl::api_status status;
+             py::gil_scoped_release release;
              THROW_IF_FAIL(live_model->init(&status));
              return live_model;
            }),
@@ -158,6 +211,7 @@ PYBIND11_MODULE(rl_client, m) {
              auto live_model = std::unique_ptr<live_model_with_callback>(
                  new live_model_with_callback(config, callback));
              rl::api_status status;
+             py::gil_scoped_release release;
              THROW_IF_FAIL(live_model->init(&status));
              return live_model;
            }),
@@ -170,6 +224,7 @@ PYBIND11_MODULE(rl_client, m) {
             rl::api_status status;
             unsigned int flags = deferred ? rl::action_flags::DEFERRED
                                           : rl::action_flags::DEFAULT;
+            py::gil_scoped_release release;
             THROW_IF_FAIL(
                 lm.choose_rank(event_id, context, flags, response, &status));
             return response;
@@ -187,6 +242,7 @@ PYBIND11_MODULE(rl_client, m) {
             unsigned int flags = deferred ? rl::action_flags::DEFERRED
                                           : rl::action_flags::DEFAULT;
             rl::api_status status;
+            py::gil_scoped_release release;
             THROW_IF_FAIL(lm.choose_rank(context, flags, response, &status));
             return response;
           },
@@ -199,6 +255,7 @@ PYBIND11_MODULE(rl_client, m) {
           "report_action_taken",
           [](rl::live_model &lm, const char *event_id) {
             rl::api_status status;
+            py::gil_scoped_release release;
             THROW_IF_FAIL(lm.report_action_taken(event_id, &status));
           },
           py::arg("event_id"))
@@ -206,6 +263,7 @@ PYBIND11_MODULE(rl_client, m) {
           "report_outcome",
           [](rl::live_model &lm, const char *event_id, const char *outcome) {
             rl::api_status status;
+            py::gil_scoped_release release;
             THROW_IF_FAIL(lm.report_outcome(event_id, outcome, &status));
           },
           py::arg("event_id"), py::arg("outcome"))
@@ -213,13 +271,212 @@ PYBIND11_MODULE(rl_client, m) {
           "report_outcome",
           [](rl::live_model &lm, const char *event_id, float outcome) {
             rl::api_status status;
+            py::gil_scoped_release release;
             THROW_IF_FAIL(lm.report_outcome(event_id, outcome, &status));
           },
           py::arg("event_id"), py::arg("outcome"))
+      .def(
+          "choose_rank_batch",
+          [](rl::live_model &lm, const py::sequence &contexts,
+             const py::object &event_ids, bool deferred) {
+            std::vector<py::object> items;
+            std::vector<const char *> context_values;
+            collect_strings(contexts, "contexts", items, context_values);
+            std::vector<const char *> event_id_values;
+            if (!event_ids.is_none()) {
+              collect_strings(event_ids.cast<py::sequence>(), "event_ids",
+                              items, event_id_values);
+              if (event_id_values.size() != context_values.size()) {
+                throw py::value_error(
+                    "event_ids must have one entry per context");
+              }
+            }
+
+            const unsigned int flags = deferred ? rl::action_flags::DEFERRED
+                                                : rl::action_flags::DEFAULT;
+            const size_t count = context_values.size();
+            std::vector<std::string> response_event_ids(count);
+            std::vector<std::string> response_model_ids(count);
+            std::vector<uint32_t> chosen_action_ids(count);
+            std::vector<uint32_t> action_ids;
+            std::vector<float> probabilities;
+            std::vector<uint64_t> offsets(1, 0);
+            offsets.reserve(count + 1);
+            {
+              py::gil_scoped_release release;
+              rl::ranking_response response;
+              rl::api_status status;
+              for (size_t i = 0; i < count; ++i) {
+                response.clear();
+                if (event_id_values.empty()) {
+                  THROW_IF_FAIL(lm.choose_rank(context_values[i], flags,
+                                               response, &status));
+                } else {
+                  THROW_IF_FAIL(lm.choose_rank(event_id_values[i],
+                                               context_values[i], flags,
+                                               response, &status));
+                }
+                size_t chosen_action_id = 0;
+                response.get_chosen_action_id(chosen_action_id);
+                chosen_action_ids[i] = static_cast<uint32_t>(chosen_action_id);
+                response_event_ids[i] = response.get_event_id();
+                response_model_ids[i] = response.get_model_id();
+                for (const auto &action_prob : response) {
+                  action_ids.push_back(action_prob.action_id);
+                  probabilities.push_back(action_prob.probability);
+                }
+                offsets.push_back(action_ids.size());
+              }
+            }
+
+            ranking_batch batch;
+            for (size_t i = 0; i < count; ++i) {
+              batch.event_ids.append(py::str(response_event_ids[i]));
+              batch.model_ids.append(py::str(response_model_ids[i]));
+            }
+            batch.chosen_action_ids = to_numpy(std::move(chosen_action_ids));
+            batch.action_ids = to_numpy(std::move(action_ids));
+            batch.probabilities = to_numpy(std::move(probabilities));
+            batch.offsets = to_numpy(std::move(offsets));
+            return batch;
+          },
+          py::arg("contexts"), py::arg("event_ids") = py::none(),
+          py::arg("deferred") = false, R"pbdoc(
+        Request predictions for a sequence of contexts in a single call. The GIL is released for the whole batch.
+
+        :param contexts: Sequence of str or bytes contexts
+        :param event_ids: Optional sequence of str or bytes event ids, one per context. Generated when omitted.
+        :param deferred: Whether the actions are deferred
+        :rtype: :class:`rl_client.RankingBatch`
+    )pbdoc")
+      .def(
+          "report_outcome_batch",
+          [](rl::live_model &lm, const py::sequence &event_ids,
+             py::array_t<float, py::array::c_style | py::array::forcecast>
+                 outcomes) {
+            std::vector<py::object> items;
+            std::vector<const char *> event_id_values;
+            collect_strings(event_ids, "event_ids", items, event_id_values);
+            if (outcomes.ndim() != 1 ||
+                static_cast<size_t>(outcomes.shape(0)) !=
+                    event_id_values.size()) {
+              throw py::value_error(
+                  "outcomes must be one dimensional with one entry per event id");
+            }
+
+            const float *outcome_values = outcomes.data();
+            py::gil_scoped_release release;
+            rl::api_status status;
+            for (size_t i = 0; i < event_id_values.size(); ++i) {
+              THROW_IF_FAIL(lm.report_outcome(event_id_values[i],
+                                              outcome_values[i], &status));
+            }
+          },
+          py::arg("event_ids"), py::arg("outcomes"), R"pbdoc(
+        Report numeric outcomes for a sequence of event ids in a single call. The GIL is released for the whole batch.
+
+        :param event_ids: Sequence of str or bytes event ids
+        :param outcomes: Array-like of float outcomes, one per event id
+    )pbdoc")
       .def("refresh_model", [](rl::live_model &lm) {
         rl::api_status status;
+        py::gil_scoped_release release;
         THROW_IF_FAIL(lm.refresh_model(&status));
-      });
+      })
+      .def(
+          "update_configuration",
+          [](rl::live_model &lm, const rl::utility::configuration &changes) {
+            rl::api_status status;
+            py::gil_scoped_release release;
+            THROW_IF_FAIL(lm.update_configuration(changes, &status));
+          },
+          py::arg("changes"), R"pbdoc(
+        Change initial_exploration.epsilon, queue.mode or send.batchintervalms without recreating the live model.
+
+        :param changes: Configuration holding the settings to change
+    )pbdoc")
+      .def(
+          "get_metrics",
+          [](const rl::live_model &lm) {
+            rl::metrics_snapshot metrics;
+            {
+              rl::api_status status;
+              py::gil_scoped_release release;
+              THROW_IF_FAIL(lm.get_metrics(metrics, &status));
+            }
+
+            py::dict counters;
+            for (const auto &counter : metrics.counters) {
+              counters[py::str(counter.name)] = counter.value;
+            }
+            py::dict gauges;
+            for (const auto &gauge : metrics.gauges) {
+              gauges[py::str(gauge.name)] = gauge.value;
+            }
+            py::dict histograms;
+            for (const auto &h : metrics.histograms) {
+              py::dict value;
+              value["count"] = h.count;
+              value["sum"] = h.sum;
+              value["min"] = h.min;
+              value["max"] = h.max;
+              value["p50"] = h.p50;
+              value["p90"] = h.p90;
+              value["p99"] = h.p99;
+              value["p999"] = h.p999;
+              histograms[py::str(h.name)] = value;
+            }
+
+            py::dict result;
+            result["counters"] = counters;
+            result["gauges"] = gauges;
+            result["histograms"] = histograms;
+            return result;
+          },
+          R"pbdoc(
+        Performance metrics of the client library, shared by every LiveModel of the process.
+
+        :returns: dict with ``counters`` and ``gauges`` mapping names to integers, and ``histograms`` mapping names
+            to dicts of ``count``, ``sum``, ``min``, ``max``, ``p50``, ``p90``, ``p99`` and ``p999``
+    )pbdoc");
+
+  py::class_<ranking_batch>(m, "RankingBatch", R"pbdoc(
+        Results of :meth:`rl_client.LiveModel.choose_rank_batch`. The actions of context i are
+        ``action_ids[offsets[i]:offsets[i + 1]]`` with probabilities in the same slice of ``probabilities``.
+    )pbdoc")
+      .def_readonly("event_ids", &ranking_batch::event_ids, R"pbdoc(
+        Event id of each context
+
+        :rtype: list[str]
+    )pbdoc")
+      .def_readonly("model_ids", &ranking_batch::model_ids, R"pbdoc(
+        ID of the model used for each context
+
+        :rtype: list[str]
+    )pbdoc")
+      .def_readonly("chosen_action_ids", &ranking_batch::chosen_action_ids,
+                    R"pbdoc(
+        Action chosen for each context
+
+        :rtype: numpy.ndarray[uint32]
+    )pbdoc")
+      .def_readonly("action_ids", &ranking_batch::action_ids, R"pbdoc(
+        Ranked action ids of all contexts, concatenated
+
+        :rtype: numpy.ndarray[uint32]
+    )pbdoc")
+      .def_readonly("probabilities", &ranking_batch::probabilities, R"pbdoc(
+        Probabilities matching action_ids
+
+        :rtype: numpy.ndarray[float32]
+    )pbdoc")
+      .def_readonly("offsets", &ranking_batch::offsets, R"pbdoc(
+        Start of the actions of each context in action_ids, followed by the total count
+
+        :rtype: numpy.ndarray[uint64]
+    )pbdoc")
+      .def("__len__",
+           [](const ranking_batch &b) { return b.chosen_action_ids.size(); });
 
   py::class_<rl::ranking_response>(m, "RankingResponse")
       .def_property_readonly(
@@ -327,8 +584,19 @@ PYBIND11_MODULE(rl_client, m) {
     .def_property_readonly_static("USE_COMPRESSION", [](py::object /*self*/) { return rl::name::USE_COMPRESSION; })
     .def_property_readonly_static("USE_DEDUP", [](py::object /*self*/) { return rl::name::USE_DEDUP; })
     .def_property_readonly_static("QUEUE_MODE", [](py::object /*self*/) { return rl::name::QUEUE_MODE; })
+    .def_property_readonly_static("QUEUE_BLOCK_TIMEOUT_MS", [](py::object /*self*/) { return rl::name::QUEUE_BLOCK_TIMEOUT_MS; })
+    .def_property_readonly_static("QUEUE_ADAPTIVE_LOW_WATER_MARK", [](py::object /*self*/) { return rl::name::QUEUE_ADAPTIVE_LOW_WATER_MARK; })
+    .def_property_readonly_static("QUEUE_ADAPTIVE_MIN_PASS_PROB", [](py::object /*self*/) { return rl::name::QUEUE_ADAPTIVE_MIN_PASS_PROB; })
     .def_property_readonly_static("EH_TEST", [](py::object /*self*/) { return rl::name::EH_TEST; })
     .def_property_readonly_static("TRACE_LOG_IMPLEMENTATION", [](py::object /*self*/) { return rl::name::TRACE_LOG_IMPLEMENTATION; })
+    .def_property_readonly_static("TRACE_LOG_LEVEL", [](py::object /*self*/) { return rl::name::TRACE_LOG_LEVEL; })
+    .def_property_readonly_static("TRACE_LOG_ASYNC", [](py::object /*self*/) { return rl::name::TRACE_LOG_ASYNC; })
+    .def_property_readonly_static("METRICS_DUMP_INTERVAL_MS", [](py::object /*self*/) { return rl::name::METRICS_DUMP_INTERVAL_MS; })
+    .def_property_readonly_static("METRICS_DUMP_FILE_NAME", [](py::object /*self*/) { return rl::name::METRICS_DUMP_FILE_NAME; })
+    .def_property_readonly_static("TRACE_SPANS_SAMPLE_RATE", [](py::object /*self*/) { return rl::name::TRACE_SPANS_SAMPLE_RATE; })
+    .def_property_readonly_static("TRACE_SPANS_THRESHOLD_US", [](py::object /*self*/) { return rl::name::TRACE_SPANS_THRESHOLD_US; })
+    .def_property_readonly_static("TRACE_SPANS_FILE_NAME", [](py::object /*self*/) { return rl::name::TRACE_SPANS_FILE_NAME; })
+    .def_property_readonly_static("BACKGROUND_EXECUTOR_THREADS", [](py::object /*self*/) { return rl::name::BACKGROUND_EXECUTOR_THREADS; })
     .def_property_readonly_static("INTERACTION_FILE_NAME", [](py::object /*self*/) { return rl::name::INTERACTION_FILE_NAME; })
     .def_property_readonly_static("OBSERVATION_FILE_NAME", [](py::object /*self*/) { return rl::name::OBSERVATION_FILE_NAME; })
     .def_property_readonly_static("TIME_PROVIDER_IMPLEMENTATION", [](py::object /*self*/) { return rl::name::TIME_PROVIDER_IMPLEMENTATION; })
@@ -356,5 +624,6 @@ PYBIND11_MODULE(rl_client, m) {
     .def_property_readonly_static("CONTENT_ENCODING_IDENTITY", [](py::object /*self*/) { return rl::value::CONTENT_ENCODING_IDENTITY; })
     .def_property_readonly_static("CONTENT_ENCODING_DEDUP", [](py::object /*self*/) { return rl::value::CONTENT_ENCODING_DEDUP; })
     .def_property_readonly_static("QUEUE_MODE_DROP", [](py::object /*self*/) { return rl::value::QUEUE_MODE_DROP; })
-    .def_property_readonly_static("QUEUE_MODE_BLOCK", [](py::object /*self*/) { return rl::value::QUEUE_MODE_BLOCK; });
+    .def_property_readonly_static("QUEUE_MODE_BLOCK", [](py::object /*self*/) { return rl::value::QUEUE_MODE_BLOCK; })
+    .def_property_readonly_static("QUEUE_MODE_ADAPTIVE", [](py::object /*self*/) { return rl::value::QUEUE_MODE_ADAPTIVE; });
 }
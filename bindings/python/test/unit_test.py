@@ -78,6 +78,50 @@ class LiveModelTests(unittest.TestCase):
         model.report_outcome(event_id, 1.0)
         model.report_outcome(event_id,"{'result':'res'}")
 
+    def test_choose_rank_batch(self):
+        model = rl_client.LiveModel(self.config)
+
+        contexts = ['{"_multi":[{},{}]}', b'{"_multi":[{},{},{}]}']
+        batch = model.choose_rank_batch(contexts, event_ids=["event_1", b"event_2"])
+        self.assertEqual(len(batch), 2)
+        self.assertEqual(batch.event_ids, ["event_1", "event_2"])
+        self.assertEqual(list(batch.offsets), [0, 2, 5])
+        self.assertEqual(len(batch.action_ids), 5)
+        self.assertEqual(batch.probabilities.dtype.name, "float32")
+        self.assertAlmostEqual(float(batch.probabilities[0:2].sum()), 1.0, places=5)
+        self.assertAlmostEqual(float(batch.probabilities[2:5].sum()), 1.0, places=5)
+        for i in range(len(batch)):
+            begin = batch.offsets[i]
+            self.assertEqual(batch.chosen_action_ids[i], batch.action_ids[begin])
+
+    def test_choose_rank_batch_matches_choose_rank(self):
+        model = rl_client.LiveModel(self.config)
+
+        context = '{"_multi":[{},{},{},{}]}'
+        batch = model.choose_rank_batch([context], event_ids=["event_id"])
+        response = model.choose_rank(context, event_id="event_id")
+        self.assertEqual(batch.chosen_action_ids[0], response.chosen_action_id)
+        self.assertEqual(list(zip(batch.action_ids, batch.probabilities)), response.actions_probabilities)
+
+    def test_choose_rank_batch_invalid_input(self):
+        model = rl_client.LiveModel(self.config)
+
+        self.assertRaises(TypeError, model.choose_rank_batch, [1])
+        self.assertRaises(TypeError, model.choose_rank_batch, '{"_multi":[{},{}]}')
+        self.assertRaises(TypeError, model.choose_rank_batch, b'{"_multi":[{},{}]}')
+        self.assertRaises(TypeError, model.choose_rank_batch, ['{"_multi":[{},{}]}'], event_ids="event_id")
+        self.assertRaises(ValueError, model.choose_rank_batch, ['{"_multi":[{},{}]}'], event_ids=[])
+        self.assertRaises(rl_client.RLException, model.choose_rank_batch, [""])
+
+    def test_report_outcome_batch(self):
+        model = rl_client.LiveModel(self.config)
+
+        event_ids = ["event_1", "event_2"]
+        model.choose_rank_batch(['{"_multi":[{},{}]}'] * 2, event_ids=event_ids)
+        model.report_outcome_batch(event_ids, [1.0, 0.5])
+        self.assertRaises(ValueError, model.report_outcome_batch, event_ids, [1.0])
+        self.assertRaises(TypeError, model.report_outcome_batch, "event_1", [1.0])
+
     def test_report_outcome_no_connection(self):
         # Requires dependency injection for network.
         return
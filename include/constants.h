@@ -4,12 +4,18 @@ namespace reinforcement_learning {  namespace name {
       const char *const  APP_ID                  = "appid";
       const char *const  MODEL_SRC               = "model.source";
       const char *const  MODEL_BLOB_URI          = "model.blob.uri";
+      const char *const  MODEL_DELTA_BLOB_URI    = "model.delta.blob.uri";   // Optional blob of weight patches against the current model
       const char *const  MODEL_REFRESH_INTERVAL_MS = "model.refreshintervalms";
+      const char *const  MODEL_DOWNLOAD_CHUNK_SIZE = "model.download.chunk_size";   // Bytes per ranged GET, 0 downloads the model in one GET
+      const char *const  MODEL_DOWNLOAD_PARALLEL_CHUNKS = "model.download.parallel_chunks";
+      const char *const  MODEL_DOWNLOAD_MAX_RETRIES = "model.download.max_retries"; // Failed requests in a row before a model download is given up
       const char *const  MODEL_IMPLEMENTATION    = "model.implementation";       // VW vs other ML
       const char *const  MODEL_BACKGROUND_REFRESH = "model.backgroundrefresh";
       const char *const  MODEL_VW_INITIAL_COMMAND_LINE = "model.vw.initial_command_line";
       const char *const  VW_CMDLINE              = "vw.commandline";
       const char *const  VW_POOL_INIT_SIZE       = "vw.pool.init.size";
+      const char *const  MODEL_CACHE_MAX_ENTRIES = "model.cache.max_entries"; // Predictions cached by context, 0 disables the cache
+      const char *const  MODEL_CACHE_TTL_MS      = "model.cache.ttlms";        // 0 keeps entries until evicted or the model is updated
       const char *const  INITIAL_EPSILON         = "initial_exploration.epsilon";
       const char *const  LEARNING_MODE           = "rank.learning.mode";
       const char* const  PROTOCOL_VERSION             = "protocol.version";
@@ -48,12 +54,28 @@ namespace reinforcement_learning {  namespace name {
       const char *const SEND_HIGH_WATER_MARK        = "send.highwatermark";
       const char *const SEND_QUEUE_MAX_CAPACITY_KB  = "send.queue.maxcapacity.kb";
       const char *const SEND_BATCH_INTERVAL_MS      = "send.batchintervalms";
+      const char *const SEND_FLUSH_ON_HIGH_WATER_MARK = "send.flush_on_highwatermark"; // Also send as soon as a full batch is queued
+      const char *const SEND_BUFFER_POOL_MAX_KB     = "send.bufferpool.maxsize.kb";   // Capacity of the batch buffers kept for reuse, 0 keeps none
       const char *const USE_COMPRESSION             = "send.use_compression";
       const char *const USE_DEDUP                   = "send.use_dedup";
       const char *const QUEUE_MODE                  = "queue.mode";
+      const char *const QUEUE_BLOCK_TIMEOUT_MS      = "queue.block.timeoutms";        // Negative waits forever (default for BLOCK), 0 never waits (default for ADAPTIVE)
+      const char *const QUEUE_ADAPTIVE_LOW_WATER_MARK = "queue.adaptive.lowwatermark"; // Fraction of the queue capacity at which ADAPTIVE subsampling starts
+      const char *const QUEUE_ADAPTIVE_MIN_PASS_PROB = "queue.adaptive.minpassprob";
 
       const char *const  EH_TEST                 = "eventhub.mock";
       const char *const  TRACE_LOG_IMPLEMENTATION = "trace.logger.implementation";
+      const char *const  TRACE_LOG_LEVEL          = "trace.logger.level";       // DEBUG, INFO, WARN or ERROR. Lower levels are not formatted.
+      const char *const  TRACE_LOG_ASYNC          = "trace.logger.async";       // Trace from a background thread, dropping messages when it falls behind
+      const char *const  TRACE_LOG_ASYNC_QUEUE_SIZE = "trace.logger.async.queue.size";
+      const char *const  METRICS_DUMP_INTERVAL_MS = "metrics.dump.intervalms"; // 0 disables the periodic dump of live_model::get_metrics
+      const char *const  METRICS_DUMP_FILE_NAME   = "metrics.dump.file.name";  // JSON lines are appended to this file, or traced at info level when unset
+      const char *const  TRACE_SPANS_SAMPLE_RATE  = "trace.spans.sample.rate";  // Record the stages of 1 in N requests, 0 disables sampling
+      const char *const  TRACE_SPANS_THRESHOLD_US = "trace.spans.threshold.us"; // Record the stages of every request slower than this, 0 disables
+      const char *const  TRACE_SPANS_FILE_NAME    = "trace.spans.file.name";    // Chrome trace file, for chrome://tracing or Perfetto
+      const char *const  TRACE_SPANS_FLUSH_INTERVAL_MS = "trace.spans.flush.intervalms";
+      const char *const  TRACE_SPANS_MAX_PENDING  = "trace.spans.max.pending";  // Recorded requests waiting to be written, more are dropped
+      const char *const  BACKGROUND_EXECUTOR_THREADS = "background.executor.threads"; // Workers shared by the background procs of every live_model, 0 gives each proc its own thread
       const char *const  INTERACTION_FILE_NAME = "interaction.file.name";
       const char *const  OBSERVATION_FILE_NAME = "observation.file.name";
       const char *const  TIME_PROVIDER_IMPLEMENTATION = "time_provider.implementation";
@@ -87,10 +109,37 @@ namespace reinforcement_learning {  namespace value {
 
       const char *const QUEUE_MODE_DROP = "DROP";
       const char *const QUEUE_MODE_BLOCK = "BLOCK";
+      const char *const QUEUE_MODE_ADAPTIVE = "ADAPTIVE";
 
       const bool DEFAULT_MODEL_BACKGROUND_REFRESH = true;
       const int DEFAULT_VW_POOL_INIT_SIZE = 4;
+      const int DEFAULT_MODEL_CACHE_MAX_ENTRIES = 0;
+      const int DEFAULT_MODEL_CACHE_TTL_MS = 0;
+      const int DEFAULT_MODEL_DOWNLOAD_CHUNK_SIZE = 0;
+      const int DEFAULT_MODEL_DOWNLOAD_PARALLEL_CHUNKS = 1;
+      const int DEFAULT_MODEL_DOWNLOAD_MAX_RETRIES = 3;
+      const bool DEFAULT_TRACE_LOG_ASYNC = false;
+      const int DEFAULT_TRACE_LOG_ASYNC_QUEUE_SIZE = 4096;
+      const int DEFAULT_METRICS_DUMP_INTERVAL_MS = 0;
+      const int DEFAULT_TRACE_SPANS_SAMPLE_RATE = 0;
+      const int DEFAULT_TRACE_SPANS_THRESHOLD_US = 0;
+      const char *const DEFAULT_TRACE_SPANS_FILE_NAME = "rl_spans.json";
+      const int DEFAULT_TRACE_SPANS_FLUSH_INTERVAL_MS = 1000;
+      const int DEFAULT_TRACE_SPANS_MAX_PENDING = 1024;
+      const int DEFAULT_BACKGROUND_EXECUTOR_THREADS = 0;
+      const int DEFAULT_HOST_BACKGROUND_EXECUTOR_THREADS = 2;  // Executor of a live_model_host
       const int DEFAULT_PROTOCOL_VERSION = 1;
+      const float DEFAULT_INITIAL_EPSILON = 0.2f;
+
+      // Batchers of the interaction and observation senders
+      const int DEFAULT_SEND_HIGH_WATER_MARK = 198 * 1024;
+      const int DEFAULT_SEND_BATCH_INTERVAL_MS = 1000;
+      const bool DEFAULT_SEND_FLUSH_ON_HIGH_WATER_MARK = false;
+      const int DEFAULT_SEND_QUEUE_MAX_CAPACITY_KB = 16 * 1024;
+      const float DEFAULT_QUEUE_ADAPTIVE_LOW_WATER_MARK = 0.5f;
+      const float DEFAULT_QUEUE_ADAPTIVE_MIN_PASS_PROB = 0.1f;
+      const int DEFAULT_SEND_BUFFER_POOL_MAX_KB = 2 * 1024;
+      const bool DEFAULT_USE_DEDUP = false;
 
       const char *get_default_observation_sender();
       const char *get_default_interaction_sender();
@@ -51,7 +51,7 @@ public:
   // Will resize entire buffer
   void resize_body_region(size_t size);
 
-  // Clear the contents of the buffer
+  // Clear the contents of the buffer, keeping its capacity
   void reset();
 
   // Get the beginning of the raw buffer
@@ -48,4 +48,11 @@ ERROR_CODE_DEFINITION(46, inference_configuration_error, "Unable to configure mo
 ERROR_CODE_DEFINITION(47, serialize_error, "Unknown error while serializing.")
 ERROR_CODE_DEFINITION(48, extension_error, "Error from extension: ")
 ERROR_CODE_DEFINITION(49, baseline_actions_not_defined, "Baseline Actions must be defined in apprentice mode")
+ERROR_CODE_DEFINITION(50, shared_context_not_found, "Shared context is not registered: ")
+ERROR_CODE_DEFINITION(51, model_delta_base_mismatch, "Model delta does not apply to the current model: ")
+ERROR_CODE_DEFINITION(52, model_delta_format_error, "Invalid model delta: ")
+ERROR_CODE_DEFINITION(53, model_changed_during_download, "Model changed while it was downloaded: ")
+ERROR_CODE_DEFINITION(54, model_checksum_mismatch, "Downloaded model does not match its Content-MD5: ")
+ERROR_CODE_DEFINITION(55, invalid_configuration, "Invalid configuration value: ")
+ERROR_CODE_DEFINITION(56, configuration_not_reloadable, "Configuration value cannot change without recreating the live_model: ")
 //! [Error Definitions]
@@ -16,7 +16,11 @@
 #include "factory_resolver.h"
 #include "sender.h"
 #include "future_compat.h"
+#include "metrics.h"
+#include "prediction_cache_stats.h"
+#include "queue_stats.h"
 
+#include <cstdint>
 #include <memory>
 
 namespace reinforcement_learning {
@@ -142,6 +146,50 @@ namespace reinforcement_learning {
     */
     int choose_rank(const char * context_json, unsigned int flags, ranking_response& resp, api_status* status = nullptr); //event_id is auto-generated
 
+    /**
+     * @brief Register context features shared by many requests, such as the features of a user during a session.
+     * Requests then pass the returned handle with only their actions, and the shared features are not parsed again
+     * by models able to reuse them. The interaction is logged with the shared features and the actions joined.
+     * @param shared_json JSON object holding the shared features. It must not hold _multi or _slots.
+     * @param shared_context Handle of the shared features, valid until unregister_shared_context() is called
+     * @param status  Optional field with detailed string description if there is an error
+     * @return int Return error code.  This will also be returned in the api_status object
+     */
+    int register_shared_context(const char * shared_json, uint64_t& shared_context, api_status* status = nullptr);
+
+    /**
+     * @brief Release shared features registered with register_shared_context().
+     * @param shared_context Handle returned by register_shared_context()
+     * @param status  Optional field with detailed string description if there is an error
+     * @return int Return error code.  This will also be returned in the api_status object
+     */
+    int unregister_shared_context(uint64_t shared_context, api_status* status = nullptr);
+
+    /**
+    * @brief Choose an action, given registered shared features and the actions of this request.
+    * @param event_id  The unique identifier for this interaction.  The same event_id should be used when
+    *                  reporting the outcome for this action.
+    * @param shared_context Handle returned by register_shared_context()
+    * @param actions_json JSON object holding the _multi array of actions, and any other features of this request
+    * @param resp Ranking response contains the chosen action, probability distribution used for sampling actions and ranked actions
+    * @param status  Optional field with detailed string description if there is an error
+    * @return int Return error code.  This will also be returned in the api_status object
+    */
+    int choose_rank(const char * event_id, uint64_t shared_context, const char * actions_json, ranking_response& resp, api_status* status = nullptr);
+
+    /**
+    * @brief Choose an action, given registered shared features and the actions of this request.
+    * @param event_id  The unique identifier for this interaction.  The same event_id should be used when
+    *                  reporting the outcome for this action.
+    * @param shared_context Handle returned by register_shared_context()
+    * @param actions_json JSON object holding the _multi array of actions, and any other features of this request
+    * @param flags Action flags (see action_flags.h)
+    * @param resp Ranking response contains the chosen action, probability distribution used for sampling actions and ranked actions
+    * @param status  Optional field with detailed string description if there is an error
+    * @return int Return error code.  This will also be returned in the api_status object
+    */
+    int choose_rank(const char * event_id, uint64_t shared_context, const char * actions_json, unsigned int flags, ranking_response& resp, api_status* status = nullptr);
+
   /**
     * @brief (DEPRECATED) Choose an action from a continuous range, given a list of context features
     * The inference library chooses an action by sampling the probability density function produced per continuous action range.
@@ -358,6 +406,52 @@ namespace reinforcement_learning {
      */
     int refresh_model(api_status* status = nullptr);
 
+    /**
+     * @brief Get live statistics of the queue batching interaction events.
+     * @param stats Queue depth, drain rate and drop counts of the interaction queue
+     * @param status  Optional field with detailed string description if there is an error
+     * @return int Return error code.  This will also be returned in the api_status object
+     */
+    int get_interaction_queue_stats(queue_stats& stats, api_status* status = nullptr) const;
+
+    /**
+     * @brief Get live statistics of the queue batching observation events.
+     * @param stats Queue depth, drain rate and drop counts of the observation queue
+     * @param status  Optional field with detailed string description if there is an error
+     * @return int Return error code.  This will also be returned in the api_status object
+     */
+    int get_observation_queue_stats(queue_stats& stats, api_status* status = nullptr) const;
+
+    /**
+     * @brief Get the counters of the cache of model predictions (see model.cache.max_entries).
+     * @param stats Hits, misses and size of the prediction cache. All zero when the model does not cache predictions.
+     * @param status  Optional field with detailed string description if there is an error
+     * @return int Return error code.  This will also be returned in the api_status object
+     */
+    int get_prediction_cache_stats(prediction_cache_stats& stats, api_status* status = nullptr) const;
+
+    /**
+     * @brief Get the performance metrics of the client library: queue levels and drops, batch sizes and send latency,
+     * model pool usage, HTTP retries and compression ratios. Metrics are process wide (see metrics_snapshot).
+     * Set metrics.dump.intervalms to also write them periodically to metrics.dump.file.name or the trace logger.
+     * @param metrics Snapshot of every counter, gauge and histogram
+     * @param status  Optional field with detailed string description if there is an error
+     * @return int Return error code.  This will also be returned in the api_status object
+     */
+    int get_metrics(metrics_snapshot& metrics, api_status* status = nullptr) const;
+
+    /**
+     * @brief Change settings without recreating the live_model.
+     * initial_exploration.epsilon, queue.mode and send.batchintervalms can change, globally or for the interaction and
+     * observation sections. Exploration uses the new epsilon right away, batchers apply their new settings with an
+     * early flush when the next event is logged. Changing another batcher setting fails with
+     * configuration_not_reloadable and changes nothing.
+     * @param changes Settings to change, with values as in the configuration given to the constructor
+     * @param status  Optional field with detailed string description if there is an error
+     * @return int Return error code.  This will also be returned in the api_status object
+     */
+    int update_configuration(const utility::configuration& changes, api_status* status = nullptr);
+
     /**
      * @brief Error callback function.
      * When live_model is constructed, a background error callback and a
@@ -411,6 +505,9 @@ namespace reinforcement_learning {
 
     ~live_model();
   private:
+    friend class live_model_host;
+    explicit live_model(live_model_impl* impl);  //! Takes ownership of the implementation
+
     std::unique_ptr<live_model_impl> _pimpl;  //! The actual implementation details are forwarded to this object (PIMPL pattern)
     bool _initialized = false;                //! Guard to ensure that live_model is properly initialized. i.e. init() was called and successfully initialized.
     const std::vector<int> default_baseline_vector = std::vector<int>();
@@ -0,0 +1,88 @@
+/**
+ * @brief Host of many live_model instances sharing their infrastructure.
+ *
+ * @file live_model_host.h
+ */
+#pragma once
+#include "factory_resolver.h"
+#include "live_model.h"
+
+#include <memory>
+
+namespace reinforcement_learning {
+
+  //// Forward declarations ////////
+  class live_model_host_impl;     //
+  class api_status;               //
+                                  //
+  namespace utility {             //
+    class configuration;          //
+  }                               //
+  //////////////////////////////////
+
+  /**
+   * @brief Runs the live_model instances of many apps in one process without duplicating their infrastructure.
+   *
+   * - Apps which get their model from the same source and load it the same way share one model. Model data is
+   *   identified by its content, so it is downloaded and loaded once for all of them.
+   * - Apps which log to the same Event Hub share one sender and its connections. Each app keeps its own batches.
+   * - Background work of every app runs on one pool of background.executor.threads threads.
+   *
+   * Each app keeps its own configuration, seed shift, error callback and event stream.
+   */
+  class live_model_host {
+  public:
+    using error_fn = live_model::error_fn;
+
+    /**
+     * @brief Construct a host.
+     *
+     * @param config Settings of the host: trace logger and background.executor.threads
+     * @param fn Error callback for the errors of the shared senders
+     * @param err_context Context passed back during Error callback
+     * The factories create the shared objects and the objects of each app.
+     */
+    explicit live_model_host(
+      const utility::configuration& config,
+      error_fn fn = nullptr,
+      void* err_context = nullptr,
+      trace_logger_factory_t* trace_factory = &trace_logger_factory,
+      data_transport_factory_t* t_factory = &data_transport_factory,
+      model_factory_t* m_factory = &model_factory,
+      sender_factory_t* s_factory = &sender_factory,
+      time_provider_factory_t* time_prov_factory = &time_provider_factory);
+
+    ~live_model_host();
+
+    /**
+     * @brief Initialize the host. Starts the shared background threads.
+     *
+     * @param status  Optional field with detailed string description if there is an error
+     * @return int Return error code.  This will also be returned in the api_status object
+     */
+    int init(api_status* status = nullptr);
+
+    /**
+     * @brief Create and initialize the live_model of one app.
+     *
+     * Models may outlive the host, the objects they share are released with the last of them.
+     *
+     * @param config Configuration of the app, as for a live_model of its own
+     * @param fn Error callback for handling errors of the app in background thread
+     * @param err_context Context passed back during Error callback
+     * @param model The initialized live_model
+     * @param status  Optional field with detailed string description if there is an error
+     * @return int Return error code.  This will also be returned in the api_status object
+     */
+    int create_live_model(const utility::configuration& config, error_fn fn, void* err_context, std::unique_ptr<live_model>& model, api_status* status = nullptr);
+
+    live_model_host(const live_model_host&) = delete;
+    live_model_host(live_model_host&&) = delete;
+    live_model_host& operator=(const live_model_host&) = delete;
+    live_model_host& operator=(live_model_host&&) = delete;
+
+  private:
+    std::shared_ptr<live_model_host_impl> _pimpl;  //! Shared with the models created by the host
+    bool _initialized = false;
+  };
+}
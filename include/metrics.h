@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace reinforcement_learning {
+  //! Total counted since the process started
+  struct counter_value {
+    std::string name;
+    uint64_t value = 0;
+  };
+
+  //! Current level, such as a queue depth
+  struct gauge_value {
+    std::string name;
+    int64_t value = 0;
+  };
+
+  //! Distribution of recorded values. Percentiles are upper bounds within 1/16 of the exact value.
+  struct histogram_value {
+    std::string name;
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t min = 0;
+    uint64_t max = 0;
+    uint64_t p50 = 0;
+    uint64_t p90 = 0;
+    uint64_t p99 = 0;
+    uint64_t p999 = 0;
+  };
+
+  /**
+   * @brief Snapshot of the performance metrics of the client library, sorted by name.
+   *
+   * Metrics are process wide: when several live_model instances run in the same process, counters and gauges are the
+   * sum of their contributions. Names end with their unit when they have one, such as _us or _bytes.
+   */
+  struct metrics_snapshot {
+    std::vector<counter_value> counters;
+    std::vector<gauge_value> gauges;
+    std::vector<histogram_value> histograms;
+  };
+}
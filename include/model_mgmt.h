@@ -2,6 +2,7 @@
 #include <cstddef>
 #include <stdint.h>
 
+#include <memory>
 #include <utility>
 #include <vector>
 #include <string>
@@ -9,6 +10,8 @@
 // Declare const pointer for internal linkage
 namespace reinforcement_learning {
   class ranking_response;
+  class ranking_buffer;
+  struct prediction_cache_stats;
   class api_status;
 }
 
@@ -36,7 +39,10 @@ namespace reinforcement_learning { namespace model_management {
         model_data(model_data&& other) noexcept
           : _data(other._data),
             _data_sz(other._data_sz),
-            _refresh_count(other._refresh_count) {}
+            _refresh_count(other._refresh_count) {
+          other._data = nullptr;
+          other._data_sz = 0;
+        }
 
         model_data& operator=(model_data&& other) noexcept {
           if (this != &other) {
@@ -58,6 +64,9 @@ namespace reinforcement_learning { namespace model_management {
     class i_data_transport {
     public:
       virtual int get_data(model_data& data, api_status* status = nullptr) = 0;
+      //! Called when the data returned last was a model delta which does not apply to the current model. The next call
+      //! to get_data() should return the full model if it is newer than the one returned before. Does nothing by default.
+      virtual void request_full_model() {}
       virtual ~i_data_transport() = default;
     };
 
@@ -69,15 +78,30 @@ namespace reinforcement_learning { namespace model_management {
       CA
     };
 
+    //! Shared features registered once with live_model::register_shared_context() and ranked with many action lists
+    struct shared_context {
+      //! Identifies the features while they are registered. Identifiers are never reused.
+      uint64_t id = 0;
+      //! JSON object holding the shared features
+      std::shared_ptr<const std::string> features;
+    };
+
     //! The i_model interfaces provides the resolution from the raw model_data to a consumable object.
     class i_model {
     public:
       virtual int update(const model_data& data, bool& model_ready, api_status* status = nullptr) = 0;
       virtual int choose_rank(uint64_t rnd_seed, const char* features, std::vector<int>& action_ids, std::vector<float>& action_pdf, std::string& model_version, api_status* status = nullptr) = 0;
-      virtual int choose_continuous_action(const char* features, float& action, float& pdf_value, std::string& model_version, api_status* status = nullptr) = 0;
+      //! Rank into a reusable flat buffer as a single slot. The default implementation copies the result of choose_rank().
+      virtual int choose_rank_flat(uint64_t rnd_seed, const char* features, ranking_buffer& ranking, std::string& model_version, api_status* status = nullptr);
+      //! Rank the registered shared features together with the actions of one request. context holds both joined into one
+      //! document. The default implementation ranks context, models able to reuse parsed shared features override it.
+      virtual int choose_rank_shared(uint64_t rnd_seed, const shared_context& shared, const char* actions, const char* context, ranking_buffer& ranking, std::string& model_version, api_status* status = nullptr);
+      virtual int choose_continuous_action(uint64_t rnd_seed, const char* features, float& action, float& pdf_value, std::string& model_version, api_status* status = nullptr) = 0;
       virtual int request_decision(const std::vector<const char*>& event_ids, const char* features, std::vector<std::vector<uint32_t>>& actions_ids, std::vector<std::vector<float>>& action_pdfs, std::string& model_version, api_status* status = nullptr) = 0;
       virtual int request_multi_slot_decision(const char* event_id, const std::vector<std::string>& slot_ids, const char* features, std::vector<std::vector<uint32_t>>& actions_ids, std::vector<std::vector<float>>& action_pdfs, std::string& model_version, api_status* status = nullptr) = 0;
       virtual model_type_t model_type() const = 0;
+      //! Counters of the cache of predictions by context. The default implementation reports a disabled cache.
+      virtual int get_prediction_cache_stats(prediction_cache_stats& stats, api_status* status = nullptr) const;
       virtual ~i_model() = default;
     };
 }}
@@ -17,6 +17,8 @@ namespace reinforcement_learning {
     std::string _event_id;
     std::string _model_id;
     coll_t _decision;
+    // Number of slots in use. Slots past _size are kept so their storage can be reused.
+    size_t _size = 0;
 
   public:
     using iterator_t = container_iterator<slot_ranking, coll_t>;
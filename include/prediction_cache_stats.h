@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace reinforcement_learning {
+  /**
+   * @brief Counters of the cache of model predictions (see model.cache.max_entries).
+   */
+  struct prediction_cache_stats {
+    //! Number of cached predictions
+    size_t entries = 0;
+    //! Maximum number of cached predictions. Zero when the cache is disabled.
+    size_t capacity = 0;
+    //! Predictions served from the cache
+    uint64_t hits = 0;
+    //! Predictions which had to run the model, including the ones whose cached entry had expired
+    uint64_t misses = 0;
+    //! Entries removed to make room for new ones
+    uint64_t evictions = 0;
+    //! Entries removed because they outlived model.cache.ttlms
+    uint64_t expirations = 0;
+    //! Number of times the cache was emptied by a model update
+    uint64_t invalidations = 0;
+  };
+}
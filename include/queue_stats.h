@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace reinforcement_learning {
+  /**
+   * @brief Live statistics of the queue used to batch events before they are sent.
+   */
+  struct queue_stats {
+    //! Number of events waiting to be sent
+    size_t queue_depth = 0;
+    //! Estimated size in bytes of the events waiting to be sent
+    size_t queue_bytes = 0;
+    //! Events per second shipped by the background batcher, smoothed over recent flushes
+    float drain_rate = 0.f;
+    //! Probability with which new events are currently admitted (ADAPTIVE queue mode only)
+    float admission_pass_prob = 1.f;
+    //! Total number of events dropped since the queue was created
+    uint64_t dropped_events = 0;
+    //! Total number of appends which gave up waiting for room in the queue
+    uint64_t block_timeouts = 0;
+    //! Batch buffers kept for reuse, and their capacity in bytes
+    size_t pooled_buffers = 0;
+    size_t pooled_buffer_bytes = 0;
+    //! Total number of batch buffers allocated, reused from the pool, and freed because the pool was full
+    uint64_t buffers_allocated = 0;
+    uint64_t buffers_reused = 0;
+    uint64_t buffers_discarded = 0;
+  };
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace reinforcement_learning {
+  /**
+   * @brief Flat storage for the ranked actions and probabilities of one or more slots.
+   * The action ids and the probabilities of every slot are kept in two contiguous arrays, and slots are delimited by offsets.
+   * clear() keeps the allocated capacity. A buffer reused across calls therefore stops allocating once it has grown to the
+   * largest decision it has seen.
+   */
+  class ranking_buffer {
+  public:
+    //! Remove all slots and actions. Allocated capacity is kept.
+    void clear();
+
+    //! Reserve room for slot_count slots holding action_count actions in total
+    void reserve(size_t slot_count, size_t action_count);
+
+    //! Start a new slot. Subsequent calls to push_back() append to it.
+    void add_slot();
+
+    //! Append an (action id, probability) pair to the last slot. The first slot is started implicitly.
+    void push_back(uint32_t action_id, float probability);
+
+    //! Number of slots
+    size_t slot_count() const;
+
+    //! Number of actions across all slots
+    size_t size() const;
+
+    //! Number of actions in the slot
+    size_t slot_size(size_t slot) const;
+
+    //! Action ids of the slot, slot_size(slot) entries
+    const uint32_t* action_ids(size_t slot) const;
+    uint32_t* action_ids(size_t slot);
+
+    //! Probabilities of the slot, slot_size(slot) entries
+    const float* probabilities(size_t slot) const;
+    float* probabilities(size_t slot);
+
+  private:
+    size_t slot_begin(size_t slot) const;
+    size_t slot_end(size_t slot) const;
+
+    std::vector<uint32_t> _action_ids;
+    std::vector<float> _probabilities;
+    // Offset of the first action of each slot
+    std::vector<size_t> _slot_offsets;
+  };
+}
@@ -14,9 +14,12 @@ namespace reinforcement_learning {
 }
 
 const char* get_log_level_string(int log_level);
+//! Parses one of the STR_LEVEL_ strings, returns false when it is not one of them
+bool get_log_level(const char* log_level_string, int& log_level);
 
+// msg is only evaluated when the level is enabled, so filtered messages are never formatted
 #define TRACE_LOG( logger, level, msg ) do{  \
-    if(logger != nullptr) {           \
+    if(logger != nullptr && logger->is_enabled(level)) { \
       logger->log(level, msg);               \
     }                                 \
   } while(0)                          \
@@ -31,5 +34,8 @@ namespace reinforcement_learning {
   public:
     virtual void log(int log_level, const std::string& msg) = 0;
     virtual ~i_trace() {} ;
+
+    //! Checked by TRACE_LOG before formatting the message. Every level is enabled by default.
+    virtual bool is_enabled(int /*log_level*/) const { return true; }
   };
 }
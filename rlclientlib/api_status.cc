@@ -30,7 +30,7 @@ namespace reinforcement_learning {
   }
 
   status_builder::status_builder(i_trace* trace, api_status* status, const int code)
-    : _code { code }, _status { status }, _trace {trace} {
+    : _code { code }, _status { status }, _trace { trace != nullptr && trace->is_enabled(LEVEL_ERROR) ? trace : nullptr } {
     if ( enable_logging() )
       _os << "(ERR:" << _code << ")";
   }
@@ -40,7 +40,7 @@ namespace reinforcement_learning {
       api_status::try_update(_status, _code, _os.str().c_str());
     }
     if (_trace != nullptr ) {
-      _trace->log(0, _os.str());
+      _trace->log(LEVEL_ERROR, _os.str());
     }
   }
 
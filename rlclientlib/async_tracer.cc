@@ -0,0 +1,109 @@
+#include "async_tracer.h"
+#include "api_status.h"
+#include "err_constants.h"
+#include "str_util.h"
+#include "utility/metrics_registry.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace reinforcement_learning {
+  namespace {
+    // The writer polls instead of being signalled, so that logging never takes a lock
+    const std::chrono::milliseconds WRITER_POLL_INTERVAL(10);
+
+    size_t round_up_to_power_of_two(size_t value) {
+      size_t result = 2;
+      while (result < value) {
+        result <<= 1;
+      }
+      return result;
+    }
+  }
+
+  async_tracer::async_tracer(i_trace* inner, size_t capacity)
+    : _inner(inner)
+    , _capacity(round_up_to_power_of_two(capacity))
+    , _slots(new slot[_capacity])
+    , _dropped_metric(utility::metrics_registry::instance().counter("trace.logger.dropped_messages")) {
+    for (size_t i = 0; i < _capacity; ++i) {
+      _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  async_tracer::~async_tracer() {
+    if (_writer.joinable()) {
+      _sleeper.interrupt();
+      _writer.join();
+    }
+    // Messages logged while the writer was stopping
+    drain();
+  }
+
+  int async_tracer::init(api_status* status) {
+    try {
+      _writer = std::thread(&async_tracer::write_loop, this);
+    }
+    catch (const std::exception& e) {
+      RETURN_ERROR_LS(nullptr, status, background_thread_start) << " (async trace logger)" << e.what();
+    }
+    return error_code::success;
+  }
+
+  // Bounded multi-producer queue: a slot whose sequence equals the claimed position is free, and it holds a message
+  // once its sequence is one past that position.
+  void async_tracer::log(int log_level, const std::string& msg) {
+    auto pos = _tail.load(std::memory_order_relaxed);
+    for (;;) {
+      auto& s = _slots[pos & (_capacity - 1)];
+      const auto sequence = s.sequence.load(std::memory_order_acquire);
+      if (sequence == pos) {
+        if (_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          s.level = log_level;
+          s.msg = msg;
+          s.sequence.store(pos + 1, std::memory_order_release);
+          return;
+        }
+      }
+      else if (sequence < pos) {
+        // The writer has not released this slot yet: the ring is full
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        _dropped_metric.add();
+        return;
+      }
+      else {
+        pos = _tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  size_t async_tracer::drain() {
+    size_t written = 0;
+    for (;;) {
+      auto& s = _slots[_head & (_capacity - 1)];
+      if (s.sequence.load(std::memory_order_acquire) != _head + 1) {
+        break;
+      }
+      // Free the slot before the possibly slow write. Swapping keeps the capacity of both strings.
+      const auto level = s.level;
+      _message.swap(s.msg);
+      s.sequence.store(_head + _capacity, std::memory_order_release);
+      ++_head;
+
+      _inner->log(level, _message);
+      ++written;
+    }
+
+    const auto dropped = _dropped.exchange(0, std::memory_order_relaxed);
+    if (dropped > 0) {
+      _inner->log(LEVEL_WARN, utility::concat(dropped, " trace messages were dropped because the trace logger could not keep up"));
+    }
+    return written;
+  }
+
+  void async_tracer::write_loop() {
+    do {
+      while (drain() > 0) {}
+    } while (_sleeper.sleep(WRITER_POLL_INTERVAL));
+  }
+}
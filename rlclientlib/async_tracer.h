@@ -0,0 +1,60 @@
+#pragma once
+#include "trace_logger.h"
+#include "utility/interruptable_sleeper.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace reinforcement_learning {
+  class api_status;
+  namespace utility {
+    class metrics_counter;
+  }
+
+  /**
+   * Trace logger which hands messages to a background thread, so that tracing never blocks the caller.
+   *
+   * Messages go through a bounded lock-free ring. When it is full the message is dropped, and the number of dropped
+   * messages is traced once the writer catches up. The wrapped logger is only called from the background thread.
+   */
+  class async_tracer : public i_trace {
+  public:
+    //! capacity is rounded up to a power of two
+    async_tracer(i_trace* inner, size_t capacity);
+    ~async_tracer();
+
+    async_tracer(const async_tracer&) = delete;
+    async_tracer& operator=(const async_tracer&) = delete;
+
+    int init(api_status* status);
+
+    void log(int log_level, const std::string& msg) override;
+
+  private:
+    struct slot {
+      std::atomic<size_t> sequence;
+      int level;
+      std::string msg;
+    };
+
+    //! Writes the queued messages, returns the number written
+    size_t drain();
+    void write_loop();
+
+    std::unique_ptr<i_trace> _inner;
+    const size_t _capacity;
+    std::unique_ptr<slot[]> _slots;
+    std::atomic<size_t> _tail{ 0 };  // Next slot claimed by a producer
+    size_t _head = 0;                // Next slot read by the writer thread
+    std::string _message;            // Message being written by the writer thread
+    std::atomic<uint64_t> _dropped{ 0 };
+    utility::metrics_counter& _dropped_metric;
+
+    std::thread _writer;
+    utility::interruptable_sleeper _sleeper;
+  };
+}
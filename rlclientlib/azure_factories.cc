@@ -27,9 +27,30 @@ namespace reinforcement_learning {
     if (uri == nullptr) {
       RETURN_ERROR(trace_logger, status, http_uri_not_provided);
     }
+
+    m::download_options options;
+    const int chunk_size = config.get_int(name::MODEL_DOWNLOAD_CHUNK_SIZE, value::DEFAULT_MODEL_DOWNLOAD_CHUNK_SIZE);
+    options.parallel_chunks = config.get_int(name::MODEL_DOWNLOAD_PARALLEL_CHUNKS, value::DEFAULT_MODEL_DOWNLOAD_PARALLEL_CHUNKS);
+    options.max_retries = config.get_int(name::MODEL_DOWNLOAD_MAX_RETRIES, value::DEFAULT_MODEL_DOWNLOAD_MAX_RETRIES);
+    if (chunk_size < 0 || options.parallel_chunks < 1 || options.max_retries < 0) {
+      RETURN_ERROR_LS(trace_logger, status, invalid_argument) << "Model download chunk size and retries must not be negative, parallel chunks must be positive";
+    }
+    options.chunk_size = static_cast<uint64_t>(chunk_size);
+
     i_http_client* client;
     RETURN_IF_FAIL(create_http_client(uri, config, &client, status));
-    *retval = new m::restapi_data_transport(client, trace_logger);
+
+    i_http_client* delta_client = nullptr;
+    const auto delta_uri = config.get(name::MODEL_DELTA_BLOB_URI, nullptr);
+    if (delta_uri != nullptr) {
+      const int scode = create_http_client(delta_uri, config, &delta_client, status);
+      if (scode != error_code::success) {
+        delete client;
+        return scode;
+      }
+    }
+
+    *retval = new m::restapi_data_transport(client, delta_client, options, trace_logger);
     return error_code::success;
   }
 
@@ -0,0 +1,26 @@
+#include "context_buffer.h"
+
+namespace reinforcement_learning {
+  context_buffer::context_buffer(const char* context)
+    : context_buffer(context, context != nullptr ? strlen(context) : 0) {}
+
+  context_buffer::context_buffer(const char* context, size_t length)
+    : _buffer(std::make_shared<const buffer_t>(context, context + length)) {}
+
+  const context_buffer::buffer_t& context_buffer::get() const {
+    static const buffer_t empty_buffer;
+    return _buffer ? *_buffer : empty_buffer;
+  }
+
+  const char* context_buffer::data() const {
+    return reinterpret_cast<const char*>(get().data());
+  }
+
+  size_t context_buffer::size() const {
+    return get().size();
+  }
+
+  bool context_buffer::empty() const {
+    return get().empty();
+  }
+}
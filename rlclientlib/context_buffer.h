@@ -0,0 +1,26 @@
+#pragma once
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace reinforcement_learning {
+  // Immutable, reference counted copy of a context.
+  // The context is copied exactly once when the buffer is created. Copies of a context_buffer
+  // share that copy, so the same context can be handed to several events and serializers.
+  class context_buffer {
+  public:
+    using buffer_t = std::vector<unsigned char>;
+
+    context_buffer() = default;
+    explicit context_buffer(const char* context);
+    context_buffer(const char* context, size_t length);
+
+    const buffer_t& get() const;
+    const char* data() const;
+    size_t size() const;
+    bool empty() const;
+
+  private:
+    std::shared_ptr<const buffer_t> _buffer;
+  };
+}
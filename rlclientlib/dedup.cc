@@ -3,6 +3,7 @@
 #include "serialization/payload_serializer.h"
 #include "utility/context_helper.h"
 #include "utility/config_helper.h"
+#include "utility/metrics_registry.h"
 
 #include "zstd.h"
 #include <sstream>
@@ -154,6 +155,10 @@ void dedup_state::update_ewma(float value)
 {
   //This is racy, but update only reads and modifies a single value, so it won't lead to data corruption 
   _ewma.update(value);
+
+  //Process wide distribution of the compression ratio, in thousandths of the uncompressed size
+  static u::metrics_histogram& compressed_permille = u::metrics_registry::instance().histogram("dedup.compressed_permille");
+  compressed_permille.record(static_cast<uint64_t>(value * 1000));
 }
 
 int dedup_state::compress(generic_event::payload_buffer_t& input, event_content_type& content_type, api_status* status) const {
@@ -282,7 +287,7 @@ public:
 
 	logger::i_async_batcher<generic_event>* create_batcher(logger::i_message_sender* sender, utility::watchdog& watchdog,
 																									error_callback_fn* perror_cb, const char* section) override {
-		auto config = utility::get_batcher_config(_config, section);
+		auto config = get_batcher_config(section);
 
     if(_use_dedup) {
       return new logger::async_batcher<generic_event, dedup_collection_serializer>(
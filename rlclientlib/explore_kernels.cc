@@ -0,0 +1,345 @@
+#include "explore_kernels.h"
+#include "explore.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  define RL_EXPLORE_AVX2
+#  include <immintrin.h>
+#  if defined(_MSC_VER)
+#    include <intrin.h>
+#    define RL_TARGET_AVX2
+#  else
+#    define RL_TARGET_AVX2 __attribute__((target("avx2")))
+#  endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define RL_EXPLORE_NEON
+#  include <arm_neon.h>
+#endif
+
+namespace reinforcement_learning { namespace explore_kernels {
+  namespace {
+    // Running sums are recorded every block_size actions so that the sampling search can skip whole blocks
+    const size_t block_size = 64;
+
+    struct scalar_ops {
+      static const size_t width = 1;
+
+      static void fill(float* pdf, size_t n, float value) {
+        std::fill(pdf, pdf + n, value);
+      }
+
+      static void clamp_negative(float* pdf, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+          if (pdf[i] < 0) pdf[i] = 0;
+        }
+      }
+
+      static void divide(float* pdf, size_t n, float total) {
+        for (size_t i = 0; i < n; ++i) {
+          pdf[i] /= total;
+        }
+      }
+
+      static uint32_t greater_mask(const float* pdf, float threshold) {
+        return pdf[0] > threshold ? 1u : 0u;
+      }
+    };
+
+#if defined(RL_EXPLORE_AVX2)
+    struct avx2_ops {
+      static const size_t width = 8;
+
+      RL_TARGET_AVX2 static void fill(float* pdf, size_t n, float value) {
+        const __m256 v = _mm256_set1_ps(value);
+        size_t i = 0;
+        for (; i + width <= n; i += width) {
+          _mm256_storeu_ps(pdf + i, v);
+        }
+        for (; i < n; ++i) pdf[i] = value;
+      }
+
+      // Same result as "if (p < 0) p = 0": NaN and -0.f are left untouched
+      RL_TARGET_AVX2 static void clamp_negative(float* pdf, size_t n) {
+        const __m256 zero = _mm256_setzero_ps();
+        size_t i = 0;
+        for (; i + width <= n; i += width) {
+          const __m256 v = _mm256_loadu_ps(pdf + i);
+          const __m256 negative = _mm256_cmp_ps(v, zero, _CMP_LT_OQ);
+          _mm256_storeu_ps(pdf + i, _mm256_andnot_ps(negative, v));
+        }
+        for (; i < n; ++i) {
+          if (pdf[i] < 0) pdf[i] = 0;
+        }
+      }
+
+      // A true division rather than a multiplication by the reciprocal, to round exactly like the reference
+      RL_TARGET_AVX2 static void divide(float* pdf, size_t n, float total) {
+        const __m256 t = _mm256_set1_ps(total);
+        size_t i = 0;
+        for (; i + width <= n; i += width) {
+          _mm256_storeu_ps(pdf + i, _mm256_div_ps(_mm256_loadu_ps(pdf + i), t));
+        }
+        for (; i < n; ++i) pdf[i] /= total;
+      }
+
+      RL_TARGET_AVX2 static uint32_t greater_mask(const float* pdf, float threshold) {
+        const __m256 gt = _mm256_cmp_ps(_mm256_loadu_ps(pdf), _mm256_set1_ps(threshold), _CMP_GT_OQ);
+        return static_cast<uint32_t>(_mm256_movemask_ps(gt));
+      }
+    };
+#endif
+
+#if defined(RL_EXPLORE_NEON)
+    struct neon_ops {
+      static const size_t width = 4;
+
+      static void fill(float* pdf, size_t n, float value) {
+        const float32x4_t v = vdupq_n_f32(value);
+        size_t i = 0;
+        for (; i + width <= n; i += width) {
+          vst1q_f32(pdf + i, v);
+        }
+        for (; i < n; ++i) pdf[i] = value;
+      }
+
+      static void clamp_negative(float* pdf, size_t n) {
+        const float32x4_t zero = vdupq_n_f32(0.f);
+        size_t i = 0;
+        for (; i + width <= n; i += width) {
+          const float32x4_t v = vld1q_f32(pdf + i);
+          vst1q_f32(pdf + i, vbslq_f32(vcltq_f32(v, zero), zero, v));
+        }
+        for (; i < n; ++i) {
+          if (pdf[i] < 0) pdf[i] = 0;
+        }
+      }
+
+      static void divide(float* pdf, size_t n, float total) {
+        const float32x4_t t = vdupq_n_f32(total);
+        size_t i = 0;
+        for (; i + width <= n; i += width) {
+          vst1q_f32(pdf + i, vdivq_f32(vld1q_f32(pdf + i), t));
+        }
+        for (; i < n; ++i) pdf[i] /= total;
+      }
+
+      static uint32_t greater_mask(const float* pdf, float threshold) {
+        const uint32x4_t gt = vcgtq_f32(vld1q_f32(pdf), vdupq_n_f32(threshold));
+        return (vgetq_lane_u32(gt, 0) & 1u) | (vgetq_lane_u32(gt, 1) & 2u) |
+          (vgetq_lane_u32(gt, 2) & 4u) | (vgetq_lane_u32(gt, 3) & 8u);
+      }
+    };
+#endif
+
+    enum class level { scalar, avx2, neon };
+
+    level detect_level() {
+#if defined(RL_EXPLORE_AVX2)
+#  if defined(_MSC_VER)
+      int info[4];
+      __cpuid(info, 0);
+      if (info[0] < 7) return level::scalar;
+      __cpuid(info, 1);
+      const bool osxsave = (info[2] & (1 << 27)) != 0;
+      const bool avx = (info[2] & (1 << 28)) != 0;
+      if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return level::scalar;
+      __cpuidex(info, 7, 0);
+      return (info[1] & (1 << 5)) != 0 ? level::avx2 : level::scalar;
+#  else
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2") ? level::avx2 : level::scalar;
+#  endif
+#elif defined(RL_EXPLORE_NEON)
+      return level::neon;
+#else
+      return level::scalar;
+#endif
+    }
+
+    level active_level() {
+      static const level detected = detect_level();
+      return detected;
+    }
+
+    template <typename Ops>
+    int generate_epsilon_greedy_impl(float epsilon, uint32_t top_action, float* pdf_first, float* pdf_last) {
+      if (pdf_last < pdf_first) return E_EXPLORATION_BAD_RANGE;
+      const auto num_actions = static_cast<uint32_t>(pdf_last - pdf_first);
+      if (num_actions == 0) return E_EXPLORATION_BAD_RANGE;
+      if (top_action >= num_actions) top_action = num_actions - 1;
+
+      Ops::fill(pdf_first, num_actions, epsilon / static_cast<float>(num_actions));
+      pdf_first[top_action] += 1.f - epsilon;
+      return S_EXPLORATION_OK;
+    }
+
+    template <typename Ops>
+    int sample_after_normalizing_impl(uint64_t seed, float* pdf_first, float* pdf_last, uint32_t& chosen_index) {
+      if (pdf_first == pdf_last || pdf_last < pdf_first) return E_EXPLORATION_BAD_RANGE;
+      const size_t n = pdf_last - pdf_first;
+
+      Ops::clamp_negative(pdf_first, n);
+
+      // The total must be accumulated serially in index order to round exactly like the reference.
+      // Its running values are the prefix sums the reference recomputes while searching for the chosen action,
+      // so they are kept at block boundaries and the search only re-adds a single block.
+      static thread_local std::vector<float> block_sums;
+      block_sums.clear();
+      float total = 0.f;
+      size_t i = 0;
+      for (; i + block_size <= n; i += block_size) {
+        for (size_t j = i; j < i + block_size; ++j) {
+          total += pdf_first[j];
+        }
+        block_sums.push_back(total);
+      }
+      for (; i < n; ++i) {
+        total += pdf_first[i];
+      }
+
+      // assume the first is the best
+      if (total == 0) {
+        chosen_index = 0;
+        *pdf_first = 1;
+        return S_EXPLORATION_OK;
+      }
+
+      float draw = total * exploration::uniform_random_merand48(seed);
+      if (draw > total) draw = total;
+
+      // Chosen action is the first one whose prefix sum exceeds draw. Prefix sums of non-negative values never
+      // decrease, so it lies in the first block whose running sum exceeds draw.
+      size_t block = 0;
+      while (block < block_sums.size() && !(block_sums[block] > draw)) {
+        ++block;
+      }
+      chosen_index = static_cast<uint32_t>(n - 1);
+      float sum = block == 0 ? 0.f : block_sums[block - 1];
+      for (size_t j = block * block_size; j < n; ++j) {
+        sum += pdf_first[j];
+        if (sum > draw) {
+          chosen_index = static_cast<uint32_t>(j);
+          break;
+        }
+      }
+
+      Ops::divide(pdf_first, n, total);
+      return S_EXPLORATION_OK;
+    }
+
+    using ranked_action = std::pair<float, uint32_t>;
+
+    // Higher probability first, lower index first on ties
+    bool ranks_before(const ranked_action& a, const ranked_action& b) {
+      return a.first > b.first || (a.first == b.first && a.second < b.second);
+    }
+
+    float rank_key(float probability) {
+      return std::isnan(probability) ? -std::numeric_limits<float>::infinity() : probability;
+    }
+
+    // Actions are offered in index order, so a later action only displaces the weakest one on a strictly higher probability
+    void offer(std::vector<ranked_action>& heap, float probability, size_t index) {
+      const float key = rank_key(probability);
+      if (key > heap.front().first) {
+        std::pop_heap(heap.begin(), heap.end(), ranks_before);
+        heap.back() = ranked_action(key, static_cast<uint32_t>(index));
+        std::push_heap(heap.begin(), heap.end(), ranks_before);
+      }
+    }
+
+    template <typename Ops>
+    int top_k_impl(const float* pdf_first, const float* pdf_last, size_t k, uint32_t* indices) {
+      if (pdf_last < pdf_first) return E_EXPLORATION_BAD_RANGE;
+      const size_t n = pdf_last - pdf_first;
+      k = std::min(k, n);
+      if (k == 0) return S_EXPLORATION_OK;
+
+      // Heap of the best k actions seen so far, weakest on top
+      static thread_local std::vector<ranked_action> heap;
+      heap.clear();
+      for (size_t i = 0; i < k; ++i) {
+        heap.emplace_back(rank_key(pdf_first[i]), static_cast<uint32_t>(i));
+      }
+      std::make_heap(heap.begin(), heap.end(), ranks_before);
+
+      size_t i = k;
+      for (; i + Ops::width <= n; i += Ops::width) {
+        // Most actions cannot enter the top k and are rejected a whole vector at a time
+        uint32_t mask = Ops::greater_mask(pdf_first + i, heap.front().first);
+        for (size_t j = 0; mask != 0; ++j, mask >>= 1) {
+          if ((mask & 1u) != 0) offer(heap, pdf_first[i + j], i + j);
+        }
+      }
+      for (; i < n; ++i) {
+        offer(heap, pdf_first[i], i);
+      }
+
+      std::sort_heap(heap.begin(), heap.end(), ranks_before);
+      for (size_t j = 0; j < k; ++j) {
+        indices[j] = heap[j].second;
+      }
+      return S_EXPLORATION_OK;
+    }
+  }
+
+  namespace scalar {
+    int generate_epsilon_greedy(float epsilon, uint32_t top_action, float* pdf_first, float* pdf_last) {
+      return generate_epsilon_greedy_impl<scalar_ops>(epsilon, top_action, pdf_first, pdf_last);
+    }
+
+    int sample_after_normalizing(uint64_t seed, float* pdf_first, float* pdf_last, uint32_t& chosen_index) {
+      return sample_after_normalizing_impl<scalar_ops>(seed, pdf_first, pdf_last, chosen_index);
+    }
+
+    int top_k(const float* pdf_first, const float* pdf_last, size_t k, uint32_t* indices) {
+      return top_k_impl<scalar_ops>(pdf_first, pdf_last, k, indices);
+    }
+  }
+
+  int generate_epsilon_greedy(float epsilon, uint32_t top_action, float* pdf_first, float* pdf_last) {
+    switch (active_level()) {
+#if defined(RL_EXPLORE_AVX2)
+    case level::avx2: return generate_epsilon_greedy_impl<avx2_ops>(epsilon, top_action, pdf_first, pdf_last);
+#elif defined(RL_EXPLORE_NEON)
+    case level::neon: return generate_epsilon_greedy_impl<neon_ops>(epsilon, top_action, pdf_first, pdf_last);
+#endif
+    default: return generate_epsilon_greedy_impl<scalar_ops>(epsilon, top_action, pdf_first, pdf_last);
+    }
+  }
+
+  int sample_after_normalizing(uint64_t seed, float* pdf_first, float* pdf_last, uint32_t& chosen_index) {
+    switch (active_level()) {
+#if defined(RL_EXPLORE_AVX2)
+    case level::avx2: return sample_after_normalizing_impl<avx2_ops>(seed, pdf_first, pdf_last, chosen_index);
+#elif defined(RL_EXPLORE_NEON)
+    case level::neon: return sample_after_normalizing_impl<neon_ops>(seed, pdf_first, pdf_last, chosen_index);
+#endif
+    default: return sample_after_normalizing_impl<scalar_ops>(seed, pdf_first, pdf_last, chosen_index);
+    }
+  }
+
+  int top_k(const float* pdf_first, const float* pdf_last, size_t k, uint32_t* indices) {
+    switch (active_level()) {
+#if defined(RL_EXPLORE_AVX2)
+    case level::avx2: return top_k_impl<avx2_ops>(pdf_first, pdf_last, k, indices);
+#elif defined(RL_EXPLORE_NEON)
+    case level::neon: return top_k_impl<neon_ops>(pdf_first, pdf_last, k, indices);
+#endif
+    default: return top_k_impl<scalar_ops>(pdf_first, pdf_last, k, indices);
+    }
+  }
+
+  const char* simd_level() {
+    switch (active_level()) {
+    case level::avx2: return "avx2";
+    case level::neon: return "neon";
+    default: return "scalar";
+    }
+  }
+}}
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace reinforcement_learning { namespace explore_kernels {
+  // Vectorized replacements for the exploration library calls on the ranking path.
+  // The vector unit is picked at runtime: AVX2 on x86 when the CPU supports it, NEON on ARM64, else scalar code.
+  // Results are bit-identical to exploration::generate_epsilon_greedy and exploration::sample_after_normalizing,
+  // including the action chosen for a given seed. Return values are the exploration status codes.
+
+  int generate_epsilon_greedy(float epsilon, uint32_t top_action, float* pdf_first, float* pdf_last);
+
+  int sample_after_normalizing(uint64_t seed, float* pdf_first, float* pdf_last, uint32_t& chosen_index);
+
+  // Write the indices of the min(k, size) highest probabilities to indices, highest first.
+  // Ties keep the lower index first and NaN ranks as -infinity.
+  int top_k(const float* pdf_first, const float* pdf_last, size_t k, uint32_t* indices);
+
+  // Vector unit used by the kernels: "avx2", "neon" or "scalar"
+  const char* simd_level();
+
+  // Portable implementations used when no vector unit is available
+  namespace scalar {
+    int generate_epsilon_greedy(float epsilon, uint32_t top_action, float* pdf_first, float* pdf_last);
+    int sample_after_normalizing(uint64_t seed, float* pdf_first, float* pdf_last, uint32_t& chosen_index);
+    int top_k(const float* pdf_first, const float* pdf_last, size_t k, uint32_t* indices);
+  }
+}}
@@ -10,8 +10,20 @@ namespace reinforcement_learning { namespace name {
   //TODO: Explore and expose useful configuration settings here
   const char *const ONNX_USE_UNSTRUCTURED_INPUT = "onnx.use_unstructured_input";
   const char *const ONNX_OUTPUT_NAME          = "onnx.output_name";
+  const char *const ONNX_USE_IO_BINDING       = "onnx.use_io_binding";
+  const char *const ONNX_INTRA_OP_THREADS     = "onnx.intra_op_threads";
+  const char *const ONNX_INTER_OP_THREADS     = "onnx.inter_op_threads";
+  const char *const ONNX_BATCH_MAX_SIZE       = "onnx.batch_max_size";
+  const char *const ONNX_BATCH_MAX_DELAY_US   = "onnx.batch_max_delay_us";
+  const char *const ONNX_MODEL_TYPE           = "onnx.model_type";
 }}
 
 namespace reinforcement_learning { namespace value {
   const char *const ONNXRUNTIME_MODEL = "ONNXRUNTIME";
+
+  // Decision types served by an ONNX model, see onnx_model.cc for the expected outputs
+  const char *const ONNX_MODEL_TYPE_CB     = "CB";
+  const char *const ONNX_MODEL_TYPE_CCB    = "CCB";
+  const char *const ONNX_MODEL_TYPE_SLATES = "SLATES";
+  const char *const ONNX_MODEL_TYPE_CA     = "CA";
 }}
\ No newline at end of file
@@ -0,0 +1,289 @@
+#include "base64.h"
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  define RL_BASE64_X86
+#  include <immintrin.h>
+#  if defined(_MSC_VER)
+#    include <intrin.h>
+#    define RL_TARGET_SSSE3
+#    define RL_TARGET_AVX2
+#  else
+#    define RL_TARGET_SSSE3 __attribute__((target("ssse3")))
+#    define RL_TARGET_AVX2 __attribute__((target("avx2")))
+#  endif
+#endif
+
+namespace reinforcement_learning { namespace onnx { namespace base64 {
+  namespace {
+    // Any value with one of the two high bits set is outside of the alphabet
+    const uint8_t INVALID = 0xFF;
+
+    struct decode_table {
+      uint8_t values[256];
+
+      decode_table() {
+        for (auto& value : values) {
+          value = INVALID;
+        }
+
+        const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        for (uint8_t i = 0; i < 64; ++i) {
+          values[static_cast<uint8_t>(alphabet[i])] = i;
+        }
+      }
+    };
+
+    const decode_table DecodeTable;
+
+    inline uint8_t lookup(char c) {
+      return DecodeTable.values[static_cast<uint8_t>(c)];
+    }
+
+    // Decode the groups of [first, last), which holds a whole number of groups. Only the last one may be padded.
+    bool decode_groups(const char* first, const char* last, unsigned char* out) {
+      if (first == last) {
+        return true;
+      }
+
+      // All groups but the last one are complete
+      const char* last_group = last - 4;
+      for (; first != last_group; first += 4) {
+        const uint8_t a = lookup(first[0]);
+        const uint8_t b = lookup(first[1]);
+        const uint8_t c = lookup(first[2]);
+        const uint8_t d = lookup(first[3]);
+        if (((a | b | c | d) & 0xC0) != 0) {
+          return false;
+        }
+
+        const uint32_t group = (a << 18) | (b << 12) | (c << 6) | d;
+        *out++ = static_cast<unsigned char>(group >> 16);
+        *out++ = static_cast<unsigned char>(group >> 8);
+        *out++ = static_cast<unsigned char>(group);
+      }
+
+      // The last group may be padded with one or two '='
+      const uint8_t a = lookup(first[0]);
+      const uint8_t b = lookup(first[1]);
+      const uint8_t c = first[2] == '=' && first[3] == '=' ? 0 : lookup(first[2]);
+      const uint8_t d = first[3] == '=' ? 0 : lookup(first[3]);
+      if (((a | b | c | d) & 0xC0) != 0) {
+        return false;
+      }
+
+      const uint32_t group = (a << 18) | (b << 12) | (c << 6) | d;
+      *out++ = static_cast<unsigned char>(group >> 16);
+      if (first[2] != '=') {
+        *out++ = static_cast<unsigned char>(group >> 8);
+      }
+      if (first[3] != '=') {
+        *out++ = static_cast<unsigned char>(group);
+      }
+
+      return true;
+    }
+
+#if defined(RL_BASE64_X86)
+    // The vector decoders follow Wojciech Mula's lookup scheme: two nibble lookups flag the characters outside of the
+    // alphabet, and a third one, indexed by the high nibble, gives the offset from each character to its 6 bit value.
+    // The 6 bit values are then packed by multiply-adds and a byte shuffle.
+    struct ssse3_ops {
+      static const size_t input_width = 16;
+      static const size_t output_width = 12;
+      static const size_t store_width = 16;
+
+      RL_TARGET_SSSE3 static bool decode_block(const char* in, unsigned char* out) {
+        const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+
+        const __m128i lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+        const __m128i lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+        const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m128i mask_2f = _mm_set1_epi8(0x2F);
+
+        const __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(input, 4), mask_2f);
+        const __m128i lo_nibbles = _mm_and_si128(input, mask_2f);
+        const __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+        const __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+        if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0) {
+          return false;
+        }
+
+        // '/' shares its high nibble with '+', so it is moved to the next entry of the offset table
+        const __m128i eq_2f = _mm_cmpeq_epi8(input, mask_2f);
+        const __m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2f, hi_nibbles));
+        const __m128i values = _mm_add_epi8(input, roll);
+
+        const __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+        const __m128i groups = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+        const __m128i bytes = _mm_shuffle_epi8(groups, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), bytes);
+        return true;
+      }
+    };
+
+    struct avx2_ops {
+      static const size_t input_width = 32;
+      static const size_t output_width = 24;
+      static const size_t store_width = 32;
+
+      RL_TARGET_AVX2 static bool decode_block(const char* in, unsigned char* out) {
+        const __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+
+        // Byte shuffles stay within each 128 bit lane, so the tables are repeated in both lanes
+        const __m256i lut_lo = _mm256_setr_epi8(
+          0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+          0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+        const __m256i lut_hi = _mm256_setr_epi8(
+          0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+          0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+        const __m256i lut_roll = _mm256_setr_epi8(
+          0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m256i mask_2f = _mm256_set1_epi8(0x2F);
+
+        const __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(input, 4), mask_2f);
+        const __m256i lo_nibbles = _mm256_and_si256(input, mask_2f);
+        const __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+        const __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+        if (_mm256_movemask_epi8(_mm256_cmpgt_epi8(_mm256_and_si256(lo, hi), _mm256_setzero_si256())) != 0) {
+          return false;
+        }
+
+        const __m256i eq_2f = _mm256_cmpeq_epi8(input, mask_2f);
+        const __m256i roll = _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_2f, hi_nibbles));
+        const __m256i values = _mm256_add_epi8(input, roll);
+
+        const __m256i pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+        const __m256i groups = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+        const __m256i lanes = _mm256_shuffle_epi8(groups, _mm256_setr_epi8(
+          2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+          2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+
+        // Join the 12 bytes of each lane
+        const __m256i bytes = _mm256_permutevar8x32_epi32(lanes, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), bytes);
+        return true;
+      }
+    };
+
+    template <typename Ops>
+    bool decode_impl(const char* first, const char* last, unsigned char* out) {
+      // Blocks write store_width bytes for output_width decoded ones. They stop while the groups left over still decode
+      // to enough bytes to cover the extra ones, and always before the last group, which may be padded.
+      const size_t slack = (Ops::store_width - Ops::output_width + 2) / 3 * 4 + 4;
+      while (static_cast<size_t>(last - first) >= Ops::input_width + slack) {
+        if (!Ops::decode_block(first, out)) {
+          return false;
+        }
+        first += Ops::input_width;
+        out += Ops::output_width;
+      }
+
+      return decode_groups(first, last, out);
+    }
+#endif
+
+    enum class level { scalar, ssse3, avx2 };
+
+    level detect_level() {
+#if defined(RL_BASE64_X86)
+#  if defined(_MSC_VER)
+      int info[4];
+      __cpuid(info, 0);
+      const int max_leaf = info[0];
+      if (max_leaf < 1) return level::scalar;
+      __cpuid(info, 1);
+      const bool ssse3 = (info[2] & (1 << 9)) != 0;
+      const bool osxsave = (info[2] & (1 << 27)) != 0;
+      const bool avx = (info[2] & (1 << 28)) != 0;
+      if (max_leaf >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6) {
+        __cpuidex(info, 7, 0);
+        if ((info[1] & (1 << 5)) != 0) return level::avx2;
+      }
+      return ssse3 ? level::ssse3 : level::scalar;
+#  else
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx2")) return level::avx2;
+      return __builtin_cpu_supports("ssse3") ? level::ssse3 : level::scalar;
+#  endif
+#else
+      return level::scalar;
+#endif
+    }
+
+    level active_level() {
+      static const level detected = detect_level();
+      return detected;
+    }
+
+    bool decode_with(level unit, const char* first, const char* last, unsigned char* out) {
+      size_t size;
+      if (!decoded_size(first, last, size)) {
+        return false;
+      }
+
+      switch (unit) {
+#if defined(RL_BASE64_X86)
+      case level::avx2: return decode_impl<avx2_ops>(first, last, out);
+      case level::ssse3: return decode_impl<ssse3_ops>(first, last, out);
+#endif
+      default: return decode_groups(first, last, out);
+      }
+    }
+  }
+
+  bool decoded_size(const char* first, const char* last, size_t& size) {
+    const size_t length = last - first;
+    if (length % 4 != 0) {
+      return false;
+    }
+
+    size_t padding = 0;
+    if (length > 0 && last[-1] == '=') {
+      padding = (last[-2] == '=') ? 2 : 1;
+    }
+
+    size = (length / 4) * 3 - padding;
+    return true;
+  }
+
+  bool decode(const char* first, const char* last, unsigned char* out) {
+    return decode_with(active_level(), first, last, out);
+  }
+
+  const char* simd_level() {
+    switch (active_level()) {
+    case level::avx2: return "avx2";
+    case level::ssse3: return "ssse3";
+    default: return "scalar";
+    }
+  }
+
+  namespace scalar {
+    bool decode(const char* first, const char* last, unsigned char* out) {
+      return decode_with(level::scalar, first, last, out);
+    }
+  }
+
+  namespace ssse3 {
+    bool supported() {
+      return active_level() >= level::ssse3;
+    }
+
+    bool decode(const char* first, const char* last, unsigned char* out) {
+      return decode_with(level::ssse3, first, last, out);
+    }
+  }
+
+  namespace avx2 {
+    bool supported() {
+      return active_level() >= level::avx2;
+    }
+
+    bool decode(const char* first, const char* last, unsigned char* out) {
+      return decode_with(level::avx2, first, last, out);
+    }
+  }
+}}}
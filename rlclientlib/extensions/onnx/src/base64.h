@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+
+namespace reinforcement_learning { namespace onnx { namespace base64 {
+  // Number of bytes encoded by the base64 text [first, last).
+  // Returns false when the length is not a multiple of 4 or the padding is invalid.
+  bool decoded_size(const char* first, const char* last, size_t& size);
+
+  // Decode the base64 text [first, last) into out, which must have room for decoded_size() bytes.
+  // Returns false on characters outside of the base64 alphabet.
+  // The vector unit is picked at runtime: AVX2 or SSSE3 on x86 when the CPU supports them, else scalar code.
+  bool decode(const char* first, const char* last, unsigned char* out);
+
+  // Vector unit used by decode(): "avx2", "ssse3" or "scalar"
+  const char* simd_level();
+
+  // Portable implementation used when no vector unit is available
+  namespace scalar {
+    bool decode(const char* first, const char* last, unsigned char* out);
+  }
+
+  // Each vector decoder, so that tests cover the ones decode() does not pick. decode() must only be called when
+  // supported() is true.
+  namespace ssse3 {
+    bool supported();
+    bool decode(const char* first, const char* last, unsigned char* out);
+  }
+
+  namespace avx2 {
+    bool supported();
+    bool decode(const char* first, const char* last, unsigned char* out);
+  }
+}}}
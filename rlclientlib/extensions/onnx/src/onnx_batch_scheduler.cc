@@ -0,0 +1,303 @@
+#include "onnx_batch_scheduler.h"
+
+#include <algorithm>
+
+#include "api_status.h"
+#include "err_constants.h"
+#include "scope_exit.h"
+#include "trace_logger.h"
+
+namespace reinforcement_learning { namespace onnx {
+
+  static Ort::AllocatorWithDefaultOptions DefaultOnnxAllocator;
+  static const OrtApi& OnnxRuntimeCApi = Ort::GetApi();
+
+  namespace {
+    size_t element_count(const std::vector<int64_t>& dims) {
+      size_t count = 1;
+      for (const auto dim : dims) {
+        count *= static_cast<size_t>(dim);
+      }
+      return count;
+    }
+
+    bool has_batch_dimension(const Ort::TypeInfo& type_info) {
+      const std::vector<int64_t> shape = type_info.GetTensorTypeAndShapeInfo().GetShape();
+      return !shape.empty() && shape[0] < 0;
+    }
+  }
+
+  onnx_batch_scheduler::onnx_batch_scheduler(std::shared_ptr<Ort::Session> session, const std::string& output_name, size_t max_batch_size, std::chrono::microseconds max_delay, i_trace* trace_logger)
+    : _session(std::move(session))
+    , _output_name(output_name)
+    , _max_batch_size(max_batch_size)
+    , _max_delay(max_delay)
+    , _trace_logger(trace_logger)
+    , _memory_info(Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault))
+  {
+    const size_t input_count = _session->GetInputCount();
+    for (size_t i = 0; i < input_count; ++i) {
+      char* input_name = _session->GetInputName(i, DefaultOnnxAllocator);
+      _input_names.emplace_back(input_name);
+      DefaultOnnxAllocator.Free(input_name);
+    }
+
+    for (const auto& input_name : _input_names) {
+      _input_name_ptrs.push_back(input_name.c_str());
+    }
+
+    _batch_dims.resize(input_count);
+    _batch_values.resize(input_count);
+    _batch.reserve(_max_batch_size);
+
+    _thread = std::thread(&onnx_batch_scheduler::run, this);
+  }
+
+  onnx_batch_scheduler::~onnx_batch_scheduler() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stopping = true;
+    }
+    _queued.notify_one();
+
+    // Queued requests are still scored before the thread exits
+    _thread.join();
+  }
+
+  bool onnx_batch_scheduler::supports_batching(Ort::Session& session, const std::string& output_name) {
+    const size_t input_count = session.GetInputCount();
+    for (size_t i = 0; i < input_count; ++i) {
+      if (!has_batch_dimension(session.GetInputTypeInfo(i))) {
+        return false;
+      }
+    }
+
+    const size_t output_count = session.GetOutputCount();
+    for (size_t i = 0; i < output_count; ++i) {
+      char* name = session.GetOutputName(i, DefaultOnnxAllocator);
+      const bool found = output_name == name;
+      DefaultOnnxAllocator.Free(name);
+
+      if (found) {
+        return has_batch_dimension(session.GetOutputTypeInfo(i));
+      }
+    }
+
+    return false;
+  }
+
+  int onnx_batch_scheduler::score(const char* features, ranking_buffer& ranking, api_status* status) {
+    request req(_trace_logger);
+    RETURN_IF_FAIL(prepare(features, req, status));
+    req.ranking = &ranking;
+
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      req.enqueued = std::chrono::steady_clock::now();
+      _queue.push_back(&req);
+      _queued_rows += static_cast<size_t>(req.rows);
+      _queued.notify_one();
+
+      _completed.wait(lock, [&req] { return req.done; });
+    }
+
+    if (req.result != error_code::success) {
+      RETURN_ERROR_LS(_trace_logger, status, extension_error) << req.error;
+    }
+
+    return error_code::success;
+  }
+
+  // Parse the features and arrange them in the order of the session inputs
+  int onnx_batch_scheduler::prepare(const char* features, request& req, api_status* status) const {
+    RETURN_IF_FAIL(read_tensor_notation(features, req.inputs, status));
+
+    const size_t input_count = _input_names.size();
+    req.dims.resize(input_count);
+    req.values.resize(input_count);
+
+    for (size_t i = 0; i < req.inputs.input_count(); ++i) {
+      const std::string& name = req.inputs.input_name(i);
+      const auto position = std::find(_input_names.begin(), _input_names.end(), name);
+      if (position == _input_names.end()) {
+        RETURN_ERROR_LS(_trace_logger, status, extension_error) << "OnnxExtension: Unknown input '" << name << "'.";
+      }
+
+      const size_t index = position - _input_names.begin();
+      if (!req.dims[index].empty()) {
+        RETURN_ERROR_LS(_trace_logger, status, extension_error) << "OnnxExtension: Input '" << name << "' is provided more than once.";
+      }
+
+      const tensor_data_t& tensor = req.inputs.input(i);
+      size_t rank = 0;
+      if (!check_array_packing<int64_t>(tensor.first, rank) || rank == 0) {
+        RETURN_ERROR_LS(_trace_logger, status, extension_error)
+          << "Invalid tensor dimensions for input '" << name << "'. Batched inputs need a leading batch dimension.";
+      }
+
+      const int64_t* dims = reinterpret_cast<const int64_t*>(tensor.first.data());
+      req.dims[index].assign(dims, dims + rank);
+      if (std::any_of(dims, dims + rank, [](int64_t dim) { return dim < 0; }) || dims[0] == 0) {
+        RETURN_ERROR_LS(_trace_logger, status, extension_error) << "Invalid tensor dimensions for input '" << name << "'.";
+      }
+
+      if (req.rows != 0 && req.rows != dims[0]) {
+        RETURN_ERROR_LS(_trace_logger, status, extension_error)
+          << "Input '" << name << "' has " << dims[0] << " rows. Other inputs have " << req.rows << ".";
+      }
+      req.rows = dims[0];
+
+      const size_t expected_values_count = element_count(req.dims[index]);
+      size_t values_count = 0;
+      if (!check_array_size<value_t>(tensor.second, expected_values_count, values_count)) {
+        RETURN_ERROR_LS(_trace_logger, status, extension_error)
+          << "Invalid tensor value packing/data for input '" << name << "'. Expecting " << expected_values_count
+          << " elements. Got " << values_count << ".";
+      }
+      req.values[index] = reinterpret_cast<const value_t*>(tensor.second.data());
+    }
+
+    for (size_t index = 0; index < input_count; ++index) {
+      if (req.dims[index].empty()) {
+        RETURN_ERROR_LS(_trace_logger, status, extension_error) << "OnnxExtension: Missing input '" << _input_names[index] << "'.";
+      }
+    }
+
+    return error_code::success;
+  }
+
+  // Requests can be stacked when all their dimensions but the first one agree
+  bool onnx_batch_scheduler::is_compatible(const request& first, const request& candidate) const {
+    for (size_t index = 0; index < first.dims.size(); ++index) {
+      const auto& a = first.dims[index];
+      const auto& b = candidate.dims[index];
+      if (a.size() != b.size() || !std::equal(a.begin() + 1, a.end(), b.begin() + 1)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void onnx_batch_scheduler::run() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+      _queued.wait(lock, [this] { return _stopping || !_queue.empty(); });
+      if (_queue.empty()) {
+        return;
+      }
+
+      // Give concurrent callers until the oldest request has waited max_delay to join the batch
+      const auto deadline = _queue.front()->enqueued + _max_delay;
+      _queued.wait_until(lock, deadline, [this] { return _stopping || _queued_rows >= _max_batch_size; });
+
+      _batch.clear();
+      size_t rows = 0;
+      while (!_queue.empty()) {
+        request* next = _queue.front();
+        if (!_batch.empty() && (rows + next->rows > _max_batch_size || !is_compatible(*_batch.front(), *next))) {
+          break;
+        }
+
+        _batch.push_back(next);
+        rows += static_cast<size_t>(next->rows);
+        _queued_rows -= static_cast<size_t>(next->rows);
+        _queue.pop_front();
+      }
+
+      lock.unlock();
+      run_batch();
+      lock.lock();
+
+      for (auto req : _batch) {
+        req->done = true;
+      }
+      _completed.notify_all();
+    }
+  }
+
+  void onnx_batch_scheduler::run_batch() {
+    try {
+      int64_t total_rows = 0;
+      for (const auto req : _batch) {
+        total_rows += req->rows;
+      }
+
+      std::vector<Ort::Value> inputs;
+      inputs.reserve(_input_names.size());
+      for (size_t index = 0; index < _input_names.size(); ++index) {
+        auto& dims = _batch_dims[index];
+        dims = _batch.front()->dims[index];
+        dims[0] = total_rows;
+
+        auto& values = _batch_values[index];
+        values.clear();
+        for (const auto req : _batch) {
+          values.insert(values.end(), req->values[index], req->values[index] + element_count(req->dims[index]));
+        }
+
+        inputs.push_back(Ort::Value::CreateTensor<value_t>(_memory_info, values.data(), values.size(), dims.data(), dims.size()));
+      }
+
+      // Use the C API to avoid an unneeded throw in the error case
+      OrtValue* onnx_output = nullptr;
+
+      // This cast-chain is taken from the OnnxRuntime code implementation of the C++ API of Ort::Session::Run().
+      auto ort_input_values = reinterpret_cast<const OrtValue**>(const_cast<Ort::Value*>(inputs.data()));
+
+      const char* output_node_name = _output_name.c_str();
+
+      OrtStatus* run_status = OnnxRuntimeCApi.Run(
+        _session->operator OrtSession *(), // Unwrap the underlying C reference to pass to the C API
+        Ort::RunOptions{nullptr},
+        _input_name_ptrs.data(), ort_input_values, inputs.size(), // Inputs: Names, Values, Count
+        &output_node_name, 1, &onnx_output); // Outputs: Names, Count, Values; note the inconsistency
+
+      if (run_status)
+      {
+        auto release_guard = VW::scope_exit([&run_status] { OnnxRuntimeCApi.ReleaseStatus(run_status); });
+        complete_batch(error_code::extension_error, OnnxRuntimeCApi.GetErrorMessage(run_status));
+        return;
+      }
+
+      // Re-wrap in Ort::Value to ensure proper destruction
+      Ort::Value target_output = Ort::Value(onnx_output);
+
+      const Ort::TensorTypeAndShapeInfo output_info = target_output.GetTensorTypeAndShapeInfo();
+      const std::vector<int64_t> output_shape = output_info.GetShape();
+      if (output_shape.empty() || output_shape[0] != total_rows) {
+        complete_batch(error_code::extension_error, "OnnxExtension: The batched output does not have one row per input row.");
+        return;
+      }
+
+      const size_t row_size = output_info.GetElementCount() / static_cast<size_t>(total_rows);
+      const float* floatarr = target_output.GetTensorMutableData<float>();
+
+      // Hand each caller its own rows, numbered from zero as if it had been scored alone
+      for (const auto req : _batch) {
+        const size_t count = static_cast<size_t>(req->rows) * row_size;
+
+        req->ranking->clear();
+        req->ranking->add_slot();
+        for (size_t i = 0; i < count; ++i) {
+          req->ranking->push_back(static_cast<uint32_t>(i), floatarr[i]);
+        }
+        req->result = error_code::success;
+
+        floatarr += count;
+      }
+    }
+    catch (const std::exception& e) {
+      complete_batch(error_code::extension_error, e.what());
+    }
+    catch (...) {
+      complete_batch(error_code::extension_error, "Unknown error");
+    }
+  }
+
+  void onnx_batch_scheduler::complete_batch(int result, const char* error) {
+    for (auto req : _batch) {
+      req->result = result;
+      req->error = error;
+    }
+  }
+}}
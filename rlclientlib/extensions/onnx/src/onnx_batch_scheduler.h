@@ -0,0 +1,96 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <core/session/onnxruntime_cxx_api.h>
+
+#include "onnx_input.h"
+#include "ranking_buffer.h"
+
+namespace reinforcement_learning {
+  class api_status;
+  class i_trace;
+}
+
+namespace reinforcement_learning { namespace onnx {
+  /**
+   * Gathers concurrent scoring requests into one session run.
+   *
+   * Callers block in score() while a background thread waits for up to max_batch_size rows, or max_delay after the
+   * oldest queued request, whichever comes first. The inputs of the gathered requests are stacked along their first
+   * dimension, the session is run once, and each caller receives its own rows of the output.
+   *
+   * Only models whose inputs and output all have a dynamic first dimension can be batched (see supports_batching()).
+   * Requests are batched together when their dimensions agree past the first one. A request whose shape differs from
+   * the batch being gathered waits for the next batch.
+   */
+  class onnx_batch_scheduler {
+  public:
+    onnx_batch_scheduler(std::shared_ptr<Ort::Session> session, const std::string& output_name, size_t max_batch_size, std::chrono::microseconds max_delay, i_trace* trace_logger);
+    ~onnx_batch_scheduler();
+
+    onnx_batch_scheduler(const onnx_batch_scheduler&) = delete;
+    onnx_batch_scheduler& operator=(const onnx_batch_scheduler&) = delete;
+
+    //! Score the tensor notation features as part of a batch. The rows of the output for these features are stored as a single slot of ranking.
+    int score(const char* features, ranking_buffer& ranking, api_status* status = nullptr);
+
+    //! Whether every input and the named output of the session have a dynamic first dimension
+    static bool supports_batching(Ort::Session& session, const std::string& output_name);
+
+  private:
+    struct request {
+      explicit request(i_trace* trace_logger) : inputs(trace_logger) {}
+
+      onnx_input_builder inputs;
+      // Dimensions and values of each model input, in the order of the session inputs
+      std::vector<std::vector<int64_t>> dims;
+      std::vector<const value_t*> values;
+      int64_t rows = 0;
+
+      ranking_buffer* ranking = nullptr;
+      std::chrono::steady_clock::time_point enqueued;
+      int result = 0;
+      std::string error;
+      bool done = false;
+    };
+
+    int prepare(const char* features, request& req, api_status* status) const;
+    bool is_compatible(const request& first, const request& candidate) const;
+    void run();
+    void run_batch();
+    void complete_batch(int result, const char* error);
+
+    std::shared_ptr<Ort::Session> _session;
+    const std::string _output_name;
+    const size_t _max_batch_size;
+    const std::chrono::microseconds _max_delay;
+    i_trace* _trace_logger;
+
+    std::vector<std::string> _input_names;
+    std::vector<const char*> _input_name_ptrs;
+    Ort::MemoryInfo _memory_info;
+
+    std::mutex _mutex;
+    // Signals the background thread that requests are queued
+    std::condition_variable _queued;
+    // Signals callers that their request is done
+    std::condition_variable _completed;
+    std::deque<request*> _queue;
+    size_t _queued_rows = 0;
+    bool _stopping = false;
+
+    // Only used by the background thread
+    std::vector<request*> _batch;
+    std::vector<std::vector<int64_t>> _batch_dims;
+    std::vector<std::vector<value_t>> _batch_values;
+
+    std::thread _thread;
+  };
+}}
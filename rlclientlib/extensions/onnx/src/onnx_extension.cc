@@ -1,5 +1,7 @@
 #include "onnx_extension.h"
 
+#include <cstring>
+
 #include "api_status.h"
 #include "configuration.h"
 #include "constants.h"
@@ -11,8 +13,34 @@
 namespace m = reinforcement_learning::model_management;
 namespace u = reinforcement_learning::utility;
 
+// portability fun
+#ifndef _WIN32
+#define _stricmp strcasecmp
+#endif
+
 namespace reinforcement_learning { namespace onnx {
 
+  bool to_model_type(const char* model_type, m::model_type_t& result)
+  {
+    const std::pair<const char*, m::model_type_t> model_types[] = {
+      { value::ONNX_MODEL_TYPE_CB, m::model_type_t::CB },
+      { value::ONNX_MODEL_TYPE_CCB, m::model_type_t::CCB },
+      { value::ONNX_MODEL_TYPE_SLATES, m::model_type_t::SLATES },
+      { value::ONNX_MODEL_TYPE_CA, m::model_type_t::CA }
+    };
+
+    for (const auto& entry : model_types)
+    {
+      if (_stricmp(model_type, entry.first) == 0)
+      {
+        result = entry.second;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
   int create_onnx_model(m::i_model** retval, const u::configuration& config, i_trace* trace_logger, api_status* status)
   {
     const char* app_id = config.get(name::APP_ID, "");
@@ -23,8 +51,38 @@ namespace reinforcement_learning { namespace onnx {
     }
 
     bool use_unstructured_input = config.get_bool(name::ONNX_USE_UNSTRUCTURED_INPUT, false);
+    // Session::Run stays the default until I/O binding has been checked against more ONNX Runtime releases
+    bool use_io_binding = config.get_bool(name::ONNX_USE_IO_BINDING, false);
+    int intra_op_threads = config.get_int(name::ONNX_INTRA_OP_THREADS, 0);
+    int inter_op_threads = config.get_int(name::ONNX_INTER_OP_THREADS, 0);
+
+    // Batching is off unless more than one row may be batched
+    int batch_max_size = config.get_int(name::ONNX_BATCH_MAX_SIZE, 1);
+    int batch_max_delay_us = config.get_int(name::ONNX_BATCH_MAX_DELAY_US, 1000);
+    if (batch_max_size < 1 || batch_max_delay_us < 0)
+    {
+      RETURN_ERROR_LS(trace_logger, status, inference_configuration_error)
+        << name::ONNX_BATCH_MAX_SIZE << " must be positive and " << name::ONNX_BATCH_MAX_DELAY_US << " must not be negative.";
+    }
   
-    *retval = new onnx_model(trace_logger, app_id, output_name, use_unstructured_input);
+    const char* model_type_name = config.get(name::ONNX_MODEL_TYPE, value::ONNX_MODEL_TYPE_CB);
+    m::model_type_t model_type;
+    if (!to_model_type(model_type_name, model_type))
+    {
+      RETURN_ERROR_LS(trace_logger, status, inference_configuration_error) << "Unknown ONNX model type '" << model_type_name << "'.";
+    }
+  
+    int cache_max_entries = config.get_int(name::MODEL_CACHE_MAX_ENTRIES, value::DEFAULT_MODEL_CACHE_MAX_ENTRIES);
+    int cache_ttl_ms = config.get_int(name::MODEL_CACHE_TTL_MS, value::DEFAULT_MODEL_CACHE_TTL_MS);
+    if (cache_max_entries < 0 || cache_ttl_ms < 0)
+    {
+      RETURN_ERROR_LS(trace_logger, status, inference_configuration_error)
+        << name::MODEL_CACHE_MAX_ENTRIES << " and " << name::MODEL_CACHE_TTL_MS << " must not be negative.";
+    }
+
+    *retval = new onnx_model(trace_logger, app_id, output_name, use_unstructured_input, use_io_binding,
+      intra_op_threads, inter_op_threads, static_cast<size_t>(batch_max_size), std::chrono::microseconds(batch_max_delay_us),
+      model_type, static_cast<size_t>(cache_max_entries), std::chrono::milliseconds(cache_ttl_ms));
 
     return error_code::success;
   };
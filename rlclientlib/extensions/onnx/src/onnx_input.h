@@ -60,6 +60,16 @@ namespace reinforcement_learning { namespace onnx {
       return _inputs.size();
     }
 
+    inline const std::string& input_name(size_t index) const
+    {
+      return _input_names[index];
+    }
+
+    inline const tensor_data_t& input(size_t index) const
+    {
+      return _inputs[index];
+    }
+
   public:
     inline void push_input(const std::string& input_name, const tensor_data_t& input)
     {
@@ -1,13 +1,15 @@
 #include "onnx_model.h"
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
 #include <sstream>
 
 #include "api_status.h"
 #include "err_constants.h"
+#include "explore.h"
 #include "factory_resolver.h"
-#include "onnx_input.h"
-#include "scope_exit.h"
+#include "hash.h"
 #include "str_util.h"
 #include "trace_logger.h"
 
@@ -16,7 +18,6 @@ namespace reinforcement_learning { namespace onnx {
   // This is used for statically introspecting the model. It will be used regardless of whether the actual
   // inference is done on CPU/GPU/Accelerator.
   static Ort::AllocatorWithDefaultOptions DefaultOnnxAllocator;
-  static const OrtApi& OnnxRuntimeCApi = Ort::GetApi();
 
   inline void OrtLogCallback(
     void* param, OrtLoggingLevel severity, const char* category, const char* logid, const char* code_location,
@@ -55,13 +56,29 @@ namespace reinforcement_learning { namespace onnx {
     TRACE_LOG(trace_logger, loglevel, buf.str());
   }
 
-  onnx_model::onnx_model(i_trace* trace_logger, const char* app_id, const char* output_name, bool use_unstructured_input) :
+  onnx_model::onnx_model(i_trace* trace_logger, const char* app_id, const char* output_name, bool use_unstructured_input, bool use_io_binding,
+    int intra_op_threads, int inter_op_threads, size_t batch_max_size, std::chrono::microseconds batch_max_delay,
+    model_management::model_type_t model_type, size_t cache_max_entries, std::chrono::milliseconds cache_ttl) :
     _trace_logger(trace_logger),
     _output_name(output_name),
     _use_unstructured_input(use_unstructured_input),
-    _env(Ort::Env(ORT_LOGGING_LEVEL_VERBOSE, app_id, OrtLogCallback, trace_logger))
+    _use_io_binding(use_io_binding),
+    _batch_max_size(batch_max_size),
+    _batch_max_delay(batch_max_delay),
+    _model_type(model_type),
+    _env(Ort::Env(ORT_LOGGING_LEVEL_VERBOSE, app_id, OrtLogCallback, trace_logger)),
+    _prediction_cache(cache_max_entries, cache_ttl)
   {
-    //_session_options.SetThreadPoolSize(thread_pool_size);
+    // Zero keeps the onnxruntime defaults
+    if (intra_op_threads > 0)
+    {
+      _session_options.SetIntraOpNumThreads(intra_op_threads);
+    }
+
+    if (inter_op_threads > 0)
+    {
+      _session_options.SetInterOpNumThreads(inter_op_threads);
+    }
 
     // ORT_DISABLE_ALL -> To disable all optimizations
     // ORT_ENABLE_BASIC -> To enable basic optimizations (Such as redundant node removals)
@@ -131,10 +148,26 @@ namespace reinforcement_learning { namespace onnx {
         RETURN_ERROR_LS(_trace_logger, status, model_update_error) << "Invalid output type. Expected: tensor<float>.";
       }
 
-      // TODO: Should we add additional checks to make sure the next two sets are atomic?
-      _output_index = output_index;
+      // Creating a context binds the inputs and the output, which fails early on a model that cannot be scored
+      std::unique_ptr<onnx_scoring_context_factory> factory(new onnx_scoring_context_factory(new_session, _output_name, _use_io_binding, _trace_logger));
+      std::unique_ptr<onnx_scoring_context> test_context((*factory)());
+
+      std::shared_ptr<onnx_batch_scheduler> batch_scheduler;
+      if (_batch_max_size > 1)
+      {
+        if (onnx_batch_scheduler::supports_batching(*new_session, _output_name))
+        {
+          batch_scheduler = std::make_shared<onnx_batch_scheduler>(new_session, _output_name, _batch_max_size, _batch_max_delay, _trace_logger);
+        }
+        else
+        {
+          TRACE_WARN(_trace_logger, "Batching is disabled for this model. It needs a dynamic first dimension on every input and on the output.");
+        }
+      }
 
-      _master_session = std::move(new_session);
+      // Scoring threads keep the model they loaded alive until they are done with it
+      std::atomic_store(&_loaded_model, std::make_shared<loaded_model>(factory.release(), std::move(batch_scheduler)));
+      _prediction_cache.clear();
     }
     catch(const std::exception& e) {
       RETURN_ERROR_LS(_trace_logger, status, model_update_error) << e.what();
@@ -154,71 +187,237 @@ namespace reinforcement_learning { namespace onnx {
     std::string& model_version,
     api_status* status)
   {
-    std::shared_ptr<Ort::Session> local_session = _master_session;
-    if (!local_session)
+    ranking_buffer ranking;
+    RETURN_IF_FAIL(choose_rank_flat(rnd_seed, features, ranking, model_version, status));
+
+    for (size_t i = 0; i < ranking.size(); i++)
     {
-      // Model is not ready
-      RETURN_ERROR_LS(_trace_logger, status, model_rank_error) << "No model loaded.";
+      action_ids.push_back(ranking.action_ids(0)[i]);
+      action_pdf.push_back(ranking.probabilities(0)[i]);
     }
 
-    // TODO: Support GPU scoring - it is unfortunate that we cannot simply grab the appropriate allocator
-    // based on what version of onnxruntime we are loading.
-    Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
+    return error_code::success;
+  }
 
-    onnx_input_builder input_context(_trace_logger);
-    if (_use_unstructured_input)
+  int onnx_model::choose_rank_flat(uint64_t rnd_seed,
+    const char* features,
+    ranking_buffer& ranking,
+    std::string& model_version,
+    api_status* status)
+  {
+    const auto model = std::atomic_load(&_loaded_model);
+    if (!model)
     {
-      RETURN_IF_FAIL(read_tensor_notation(features, input_context, status));
+      // Model is not ready
+      RETURN_ERROR_LS(_trace_logger, status, model_rank_error) << "No model loaded.";
     }
-    else
+
+    if (!_use_unstructured_input)
     {
       // TODO: This is a placeholder for implementing ExampleBuilder APIs. We put this here to ensure that we can make a
       // non-breaking-change in the future that makes structured input the default.
       RETURN_ERROR_LS(_trace_logger, status, model_rank_error) << "Structured input is not yet implemented. See onnx_model.cc.";
     }
 
-    Ort::RunOptions run_options{nullptr};
+    try
+    {
+      // The output does not depend on rnd_seed: exploration samples from it afterwards
+      model_management::prediction_cache::ticket ticket;
+      if (_prediction_cache.lookup(features, ranking, model_version, ticket))
+      {
+        return error_code::success;
+      }
+
+      if (model->batch_scheduler)
+      {
+        RETURN_IF_FAIL(model->batch_scheduler->score(features, ranking, status));
+      }
+      else
+      {
+        // Contexts keep their tensors bound between calls, so each one is used by a single caller at a time
+        pooled_context context(model->context_pool, model->context_pool.get_or_create());
+        RETURN_IF_FAIL(context->score(features, ranking, status));
+      }
+
+      _prediction_cache.store(ticket, ranking, model_version);
+      return error_code::success;
+    }
+    catch (const std::exception& e)
+    {
+      RETURN_ERROR_LS(_trace_logger, status, model_rank_error) << e.what();
+    }
+    catch ( ... )
+    {
+      RETURN_ERROR_LS(_trace_logger, status, model_rank_error) << "Unknown error";
+    }
+  }
+
+  int onnx_model::get_prediction_cache_stats(prediction_cache_stats& stats, api_status* status) const
+  {
+    _prediction_cache.get_stats(stats);
+    return error_code::success;
+  }
+
+  // All slots are scored by one session run. The output holds one row of action scores per slot.
+  int onnx_model::rank_slots(const char* features,
+    const std::vector<uint64_t>& seeds,
+    bool exclude_chosen_actions,
+    std::vector<std::vector<uint32_t>>& actions_ids,
+    std::vector<std::vector<float>>& action_pdfs,
+    std::string& model_version,
+    api_status* status)
+  {
+    ranking_buffer output;
+    RETURN_IF_FAIL(choose_rank_flat(0, features, output, model_version, status));
+
+    const size_t slot_count = seeds.size();
+    if (slot_count == 0 || output.size() % slot_count != 0)
+    {
+      RETURN_ERROR_LS(_trace_logger, status, model_rank_error)
+        << "The model output has " << output.size() << " values, which cannot be split across " << slot_count << " slots.";
+    }
+
+    const size_t action_count = output.size() / slot_count;
+    const float* scores = output.probabilities(0);
+
+    actions_ids.assign(slot_count, std::vector<uint32_t>());
+    action_pdfs.assign(slot_count, std::vector<float>());
 
-    std::vector<const char*> input_names = input_context.input_names();
-    std::vector<Ort::Value> inputs;
+    std::vector<bool> chosen(action_count, false);
+    for (size_t slot = 0; slot < slot_count; slot++)
+    {
+      auto& ids = actions_ids[slot];
+      auto& pdf = action_pdfs[slot];
+      ids.reserve(action_count);
+      pdf.reserve(action_count);
 
-    RETURN_IF_FAIL(input_context.allocate_inputs(inputs, memory_info, status));
+      const float* slot_scores = scores + slot * action_count;
+      for (uint32_t action = 0; action < action_count; action++)
+      {
+        if (!chosen[action])
+        {
+          ids.push_back(action);
+          pdf.push_back(slot_scores[action]);
+        }
+      }
 
-    // Use the C API to avoid an unneeded throw in the error case
-    OrtValue* onnx_output = nullptr;
+      // Like VW, slots past the number of actions are left empty
+      if (ids.empty())
+      {
+        continue;
+      }
 
-    // This cast-chain is taken from the OnnxRuntime code implementation of the C++ API of Ort::Session::Run().
-    auto ort_input_values = reinterpret_cast<const OrtValue**>(const_cast<Ort::Value*>(inputs.data()));
+      uint32_t chosen_index = 0;
+      if (exploration::sample_after_normalizing(seeds[slot], std::begin(pdf), std::end(pdf), chosen_index) != S_EXPLORATION_OK ||
+          exploration::swap_chosen(std::begin(ids), std::end(ids), chosen_index) != S_EXPLORATION_OK ||
+          exploration::swap_chosen(std::begin(pdf), std::end(pdf), chosen_index) != S_EXPLORATION_OK)
+      {
+        RETURN_ERROR_LS(_trace_logger, status, exploration_error) << "Failed to sample slot " << slot << ".";
+      }
 
-    std::vector<const char*> output_node_names;
-    output_node_names.push_back(_output_name.c_str());
+      if (exclude_chosen_actions)
+      {
+        chosen[ids[0]] = true;
+      }
+    }
 
-    OrtStatus* run_status = OnnxRuntimeCApi.Run(
-      local_session->operator OrtSession *(), // Unwrap the underlying C reference to pass to the C API
-      Ort::RunOptions{nullptr},
-      input_names.data(), ort_input_values, input_context.input_count(),     // Inputs: Names, Values, Count
-    output_node_names.data(), 1, &onnx_output); // Outputs: Names, Count, Values; note the inconsistency
+    return error_code::success;
+  }
 
-    if (run_status)
+  int onnx_model::request_decision(const std::vector<const char*>& event_ids,
+    const char* features,
+    std::vector<std::vector<uint32_t>>& actions_ids,
+    std::vector<std::vector<float>>& action_pdfs,
+    std::string& model_version,
+    api_status* status)
+  {
+    // VW seeds the sampling of each slot with the hash of its event id, and does not offer a chosen action to later slots
+    std::vector<uint64_t> seeds;
+    seeds.reserve(event_ids.size());
+    for (const auto event_id : event_ids)
     {
-      auto release_guard = VW::scope_exit([&run_status] { OnnxRuntimeCApi.ReleaseStatus(run_status); });
-      RETURN_ERROR_LS(_trace_logger, status, extension_error) << OnnxRuntimeCApi.GetErrorMessage(run_status);
+      seeds.push_back(uniform_hash(event_id, strlen(event_id), 0));
     }
 
-    // Re-wrap in Ort::Value to ensure proper destruction (no point in using VW::scope_exit, since we allocate either way)
-    Ort::Value target_output = Ort::Value(onnx_output);
+    return rank_slots(features, seeds, true, actions_ids, action_pdfs, model_version, status);
+  }
 
-    size_t num_elements = target_output.GetTensorTypeAndShapeInfo().GetElementCount();
+  int onnx_model::request_multi_slot_decision(const char* event_id,
+    const std::vector<std::string>& slot_ids,
+    const char* features,
+    std::vector<std::vector<uint32_t>>& actions_ids,
+    std::vector<std::vector<float>>& action_pdfs,
+    std::string& model_version,
+    api_status* status)
+  {
+    // VW seeds each slot with the hash of the event id followed by the slot id. Slates have a separate set of actions per
+    // slot, so only CCB excludes the actions chosen by earlier slots.
+    std::vector<uint64_t> seeds;
+    seeds.reserve(slot_ids.size());
+    std::string seed_text;
+    for (const auto& slot_id : slot_ids)
+    {
+      seed_text.assign(event_id);
+      seed_text.append(slot_id);
+      seeds.push_back(uniform_hash(seed_text.c_str(), seed_text.size(), 0));
+    }
 
-    // TODO: Once we update to OnnxRuntime v1.5.1, we can change this to grab immutable data via GetTensorData<float>()
-    float* floatarr = target_output.GetTensorMutableData<float>();
+    const bool exclude_chosen_actions = _model_type != model_management::model_type_t::SLATES;
+    return rank_slots(features, seeds, exclude_chosen_actions, actions_ids, action_pdfs, model_version, status);
+  }
+
+  // The output describes a piecewise constant pdf as rows of (left, right, density), like the pdf of a VW CATS model
+  int onnx_model::choose_continuous_action(uint64_t rnd_seed, const char* features, float& action, float& pdf_value, std::string& model_version, api_status* status)
+  {
+    ranking_buffer output;
+    RETURN_IF_FAIL(choose_rank_flat(0, features, output, model_version, status));
 
-    for (size_t i = 0; i < num_elements; i++)
+    const size_t segment_count = output.size() / 3;
+    if (segment_count == 0 || output.size() % 3 != 0)
     {
-      action_ids.push_back(i);
-      action_pdf.push_back(floatarr[i]);
+      RETURN_ERROR_LS(_trace_logger, status, model_rank_error)
+        << "The model output has " << output.size() << " values. Expected rows of (left, right, density).";
     }
 
+    const float* segments = output.probabilities(0);
+    float total_mass = 0.f;
+    for (size_t i = 0; i < segment_count; i++)
+    {
+      const float* segment = segments + i * 3;
+      if (!(segment[1] >= segment[0]) || !(segment[2] >= 0.f))
+      {
+        RETURN_ERROR_LS(_trace_logger, status, model_rank_error) << "Invalid pdf segment " << i << " in the model output.";
+      }
+      total_mass += (segment[1] - segment[0]) * segment[2];
+    }
+
+    if (!(total_mass > 0.f))
+    {
+      RETURN_ERROR_LS(_trace_logger, status, model_rank_error) << "The pdf in the model output has no mass.";
+    }
+
+    // A single draw picks the segment by its mass and the action within it, as VW's sample_pdf does
+    const float draw = total_mass * exploration::uniform_random_merand48(rnd_seed);
+    float cumulative_mass = 0.f;
+    float segment_start_mass = 0.f;
+    const float* segment = nullptr;
+    for (size_t i = 0; i < segment_count && draw >= cumulative_mass; i++)
+    {
+      const float* candidate = segments + i * 3;
+      const float mass = (candidate[1] - candidate[0]) * candidate[2];
+      if (mass > 0.f)
+      {
+        segment = candidate;
+        segment_start_mass = cumulative_mass;
+        cumulative_mass += mass;
+      }
+    }
+
+    // Clamping keeps rounding errors from moving the action out of the last segment with mass
+    action = segment[0] + (draw - segment_start_mass) / segment[2];
+    action = (std::max)(segment[0], (std::min)(action, segment[1]));
+    pdf_value = segment[2] / total_mass;
+
     return error_code::success;
   }
-}}
\ No newline at end of file
+}}
@@ -1,10 +1,16 @@
 #pragma once
+#include <chrono>
+#include <memory>
 #include <string>
 
 #include <core/session/onnxruntime_cxx_api.h>
 
 #include "err_constants.h"
 #include "model_mgmt.h"
+#include "onnx_batch_scheduler.h"
+#include "onnx_scoring_context.h"
+#include "../../../model_mgmt/prediction_cache.h"
+#include "../../../utility/versioned_object_pool.h"
 
 namespace reinforcement_learning {
   class i_trace;
@@ -13,36 +19,52 @@ namespace reinforcement_learning {
 namespace reinforcement_learning { namespace onnx {
   class onnx_model : public model_management::i_model {
   public:
-    onnx_model(i_trace* trace_logger, const char* app_id, const char* output_name, bool use_unstructured_input);
+    onnx_model(i_trace* trace_logger, const char* app_id, const char* output_name, bool use_unstructured_input, bool use_io_binding,
+      int intra_op_threads, int inter_op_threads, size_t batch_max_size, std::chrono::microseconds batch_max_delay,
+      model_management::model_type_t model_type, size_t cache_max_entries, std::chrono::milliseconds cache_ttl);
     int update(const model_management::model_data& data, bool& model_ready, api_status* status = nullptr) override;
     int choose_rank(uint64_t rnd_seed, const char* features, std::vector<int>& action_ids, std::vector<float>& action_pdf, std::string& model_version, api_status* status = nullptr) override;
+    int choose_rank_flat(uint64_t rnd_seed, const char* features, ranking_buffer& ranking, std::string& model_version, api_status* status = nullptr) override;
 
-    int choose_continuous_action(const char* features, float& action, float& pdf_value, std::string& model_version, api_status* status = nullptr) override
-    {
-      return error_code::not_supported;
-    }
+    int choose_continuous_action(uint64_t rnd_seed, const char* features, float& action, float& pdf_value, std::string& model_version, api_status* status = nullptr) override;
+    int request_decision(const std::vector<const char*>& event_ids, const char* features, std::vector<std::vector<uint32_t>>& actions_ids, std::vector<std::vector<float>>& action_pdfs, std::string& model_version, api_status* status = nullptr) override;
+    int request_multi_slot_decision(const char* event_id, const std::vector<std::string>& slot_ids, const char* features, std::vector<std::vector<uint32_t>>& actions_ids, std::vector<std::vector<float>>& action_pdfs, std::string& model_version, api_status* status = nullptr) override;
 
-    int request_decision(const std::vector<const char*>& event_ids, const char* features, std::vector<std::vector<uint32_t>>& actions_ids, std::vector<std::vector<float>>& action_pdfs, std::string& model_version, api_status* status = nullptr) override
-    {
-      return error_code::not_supported;
-    }
-
-    int request_multi_slot_decision(const char* event_id, const std::vector<std::string>& slot_ids, const char* features, std::vector<std::vector<uint32_t>>& actions_ids, std::vector<std::vector<float>>& action_pdfs, std::string& model_version, api_status* status = nullptr) override
-    {
-      return error_code::not_supported;
-    }
-
-    model_management::model_type_t model_type() const { return model_management::model_type_t::CB; }
+    model_management::model_type_t model_type() const override { return _model_type; }
+    int get_prediction_cache_stats(prediction_cache_stats& stats, api_status* status = nullptr) const override;
       
   private:
+    int rank_slots(const char* features, const std::vector<uint64_t>& seeds, bool exclude_chosen_actions, std::vector<std::vector<uint32_t>>& actions_ids, std::vector<std::vector<float>>& action_pdfs, std::string& model_version, api_status* status);
+
     i_trace* _trace_logger;
     std::string _output_name;
-    size_t _output_index;
     const bool _use_unstructured_input;
+    const bool _use_io_binding;
+    const size_t _batch_max_size;
+    const std::chrono::microseconds _batch_max_delay;
+    const model_management::model_type_t _model_type;
 
     Ort::Env _env;
     Ort::SessionOptions _session_options;
 
-    std::shared_ptr<Ort::Session> _master_session;
+    using pooled_context = utility::pooled_object_guard<onnx_scoring_context, onnx_scoring_context_factory>;
+
+    // What a request scores with. update() builds a new one for each model, so a request never mixes two models.
+    struct loaded_model {
+      // Takes ownership of factory
+      loaded_model(onnx_scoring_context_factory* factory, std::shared_ptr<onnx_batch_scheduler> scheduler)
+        : context_pool(factory, 0, "model.onnx_context_pool"), batch_scheduler(std::move(scheduler))
+      { }
+
+      utility::versioned_object_pool<onnx_scoring_context, onnx_scoring_context_factory> context_pool;
+      // Only set when batching is enabled and the model supports it
+      const std::shared_ptr<onnx_batch_scheduler> batch_scheduler;
+    };
+
+    //! Replaced by update() while other threads score, only accessed through std::atomic_load and std::atomic_store
+    std::shared_ptr<loaded_model> _loaded_model;
+
+    // Holds the raw model output, so multi-slot and continuous decisions still sample from it on every call
+    model_management::prediction_cache _prediction_cache;
   };
 }}
@@ -0,0 +1,342 @@
+#include "onnx_scoring_context.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "api_status.h"
+#include "base64.h"
+#include "err_constants.h"
+#include "onnx_input.h"
+#include "scope_exit.h"
+#include "tensor_parser.h"
+#include "trace_logger.h"
+
+namespace reinforcement_learning { namespace onnx {
+
+  static Ort::AllocatorWithDefaultOptions DefaultOnnxAllocator;
+  static const OrtApi& OnnxRuntimeCApi = Ort::GetApi();
+
+  namespace {
+    bool is_static_shape(const std::vector<int64_t>& shape) {
+      return std::all_of(shape.begin(), shape.end(), [](int64_t dim) { return dim >= 0; });
+    }
+
+    // Matches onnx_input_builder::allocate_inputs(): a tensor without dimensions has no elements
+    size_t element_count(const std::vector<int64_t>& dims) {
+      if (dims.empty()) {
+        return 0;
+      }
+
+      size_t count = 1;
+      for (const auto dim : dims) {
+        count *= static_cast<size_t>(dim);
+      }
+      return count;
+    }
+
+    std::string take_name(char* name) {
+      std::string result(name);
+      DefaultOnnxAllocator.Free(name);
+      return result;
+    }
+  }
+
+  onnx_scoring_context::onnx_scoring_context(std::shared_ptr<Ort::Session> session, const std::string& output_name, bool use_io_binding, i_trace* trace_logger)
+    : _session(std::move(session))
+    , _output_name(output_name)
+    , _trace_logger(trace_logger)
+    // TODO: Support GPU scoring - it is unfortunate that we cannot simply grab the appropriate allocator
+    // based on what version of onnxruntime we are loading.
+    , _memory_info(Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault))
+    , _static_output(false)
+  {
+    if (!use_io_binding) {
+      return;
+    }
+
+    _binding.reset(new Ort::IoBinding(*_session));
+
+    size_t max_rank = 0;
+    const size_t input_count = _session->GetInputCount();
+    _inputs.resize(input_count);
+    for (size_t i = 0; i < input_count; ++i) {
+      bound_input& input = _inputs[i];
+      input.name = take_name(_session->GetInputName(i, DefaultOnnxAllocator));
+      input.provided = false;
+
+      const std::vector<int64_t> shape = _session->GetInputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape();
+      max_rank = (std::max)(max_rank, shape.size());
+
+      // Inputs with dynamic dimensions are bound on first use
+      if (is_static_shape(shape)) {
+        input.dims = shape;
+        input.values.resize(element_count(shape));
+        _binding->BindInput(input.name.c_str(), Ort::Value::CreateTensor<float>(_memory_info, input.values.data(), input.values.size(), input.dims.data(), input.dims.size()));
+      }
+    }
+    _dims_scratch.reserve(max_rank);
+
+    const size_t output_count = _session->GetOutputCount();
+    for (size_t i = 0; i < output_count; ++i) {
+      if (take_name(_session->GetOutputName(i, DefaultOnnxAllocator)) != _output_name) {
+        continue;
+      }
+
+      const std::vector<int64_t> shape = _session->GetOutputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape();
+      _static_output = is_static_shape(shape);
+      if (_static_output) {
+        _output_values.resize(element_count(shape));
+        _binding->BindOutput(_output_name.c_str(), Ort::Value::CreateTensor<float>(_memory_info, _output_values.data(), _output_values.size(), shape.data(), shape.size()));
+      }
+      else {
+        _binding->BindOutput(_output_name.c_str(), _memory_info);
+      }
+      break;
+    }
+  }
+
+  bool onnx_scoring_context::uses_io_binding() const {
+    return _binding != nullptr;
+  }
+
+  int onnx_scoring_context::score(const char* features, ranking_buffer& ranking, api_status* status) {
+    if (_binding) {
+      return score_bound(features, ranking, status);
+    }
+    return score_unbound(features, ranking, status);
+  }
+
+  int onnx_scoring_context::score_bound(const char* features, ranking_buffer& ranking, api_status* status) {
+    RETURN_IF_FAIL(bind_tensor_notation(features, status));
+
+    OrtStatus* run_status = OnnxRuntimeCApi.RunWithBinding(
+      _session->operator OrtSession *(), // Unwrap the underlying C references to pass to the C API
+      _run_options,
+      *_binding);
+
+    if (run_status)
+    {
+      auto release_guard = VW::scope_exit([&run_status] { OnnxRuntimeCApi.ReleaseStatus(run_status); });
+      RETURN_ERROR_LS(_trace_logger, status, extension_error) << OnnxRuntimeCApi.GetErrorMessage(run_status);
+    }
+
+    ranking.clear();
+    ranking.add_slot();
+
+    if (_static_output) {
+      for (size_t i = 0; i < _output_values.size(); ++i) {
+        ranking.push_back(static_cast<uint32_t>(i), _output_values[i]);
+      }
+      return error_code::success;
+    }
+
+    std::vector<Ort::Value> outputs = _binding->GetOutputValues();
+    const size_t num_elements = outputs[0].GetTensorTypeAndShapeInfo().GetElementCount();
+    const float* floatarr = outputs[0].GetTensorMutableData<float>();
+    for (size_t i = 0; i < num_elements; ++i) {
+      ranking.push_back(static_cast<uint32_t>(i), floatarr[i]);
+    }
+
+    return error_code::success;
+  }
+
+  // Reads the tensor notation described in tensor_parser.h without building intermediate byte arrays
+  int onnx_scoring_context::bind_tensor_notation(const char* features, api_status* status) {
+    for (auto& input : _inputs) {
+      input.provided = false;
+    }
+
+    const char* p = features;
+
+    // Treat empty lines as empty examples, similar to VW
+    if (p != nullptr && *p != '\0') {
+      const char* const end = p + strlen(p);
+      if (*p++ != '{') {
+        RETURN_ERROR_LS(_trace_logger, status, extension_error) << "OnnxExtension: Failed to deserialize input: Expected '{'.";
+      }
+
+      // Empty objects are valid, empty examples (match VWJSON parser behaviour)
+      bool more = *p != '}';
+      while (more) {
+        if (*p++ != '"') {
+          RETURN_ERROR_LS(_trace_logger, status, extension_error)
+            << "OnnxExtension: Failed to deserialize input: Expected '\"' at position " << (p - features - 1) << ".";
+        }
+
+        _name_scratch.clear();
+        bool in_escape = false;
+        for (; *p != '\0' && *p != '"'; ++p) {
+          if (*p != '\\' || in_escape) {
+            _name_scratch.push_back(*p);
+            in_escape = false;
+          }
+          else {
+            in_escape = true;
+          }
+        }
+
+        if (p[0] != '"' || p[1] != ':') {
+          RETURN_ERROR_LS(_trace_logger, status, extension_error)
+            << "OnnxExtension: Failed to deserialize input: Malformed tensor name at position " << (p - features) << ".";
+        }
+        p += 2;
+
+        if (tensor_parser::is_skipped_field(_name_scratch.c_str())) {
+          if (!tensor_parser::skip_json_value(p)) {
+            RETURN_ERROR_LS(_trace_logger, status, extension_error)
+              << "OnnxExtension: Failed to deserialize input: Malformed value of field '" << _name_scratch << "'.";
+          }
+
+          more = *p == ',';
+          if (more) ++p;
+          continue;
+        }
+
+        if (*p++ != '"') {
+          RETURN_ERROR_LS(_trace_logger, status, extension_error)
+            << "OnnxExtension: Failed to deserialize input: Expected '\"' at position " << (p - features - 1) << ".";
+        }
+
+        const char* dims_first = p;
+        p = tensor_parser::find_value_delimiter(p, end);
+        const char* dims_last = p;
+        if (*p++ != ';') {
+          RETURN_ERROR_LS(_trace_logger, status, extension_error)
+            << "OnnxExtension: Failed to deserialize input: Expected ';' in the value of input '" << _name_scratch << "'.";
+        }
+
+        const char* values_first = p;
+        p = tensor_parser::find_value_delimiter(p, end);
+        const char* values_last = p;
+        if (*p++ != '"') {
+          RETURN_ERROR_LS(_trace_logger, status, extension_error)
+            << "OnnxExtension: Failed to deserialize input: Expected '\"' after the value of input '" << _name_scratch << "'.";
+        }
+
+        auto input = std::find_if(_inputs.begin(), _inputs.end(), [this](const bound_input& candidate) { return candidate.name == _name_scratch; });
+        if (input == _inputs.end()) {
+          RETURN_ERROR_LS(_trace_logger, status, extension_error) << "OnnxExtension: Unknown input '" << _name_scratch << "'.";
+        }
+
+        if (input->provided) {
+          RETURN_ERROR_LS(_trace_logger, status, extension_error) << "OnnxExtension: Input '" << _name_scratch << "' is provided more than once.";
+        }
+
+        RETURN_IF_FAIL(bind_tensor(*input, dims_first, dims_last, values_first, values_last, status));
+
+        more = *p == ',';
+        if (more) ++p;
+      }
+
+      if (*p != '}') {
+        RETURN_ERROR_LS(_trace_logger, status, extension_error)
+          << "OnnxExtension: Failed to deserialize input: Expected '}' at position " << (p - features) << ".";
+      }
+    }
+
+    // Bound buffers still hold the previous values, so every input has to be provided
+    for (const auto& input : _inputs) {
+      if (!input.provided) {
+        RETURN_ERROR_LS(_trace_logger, status, extension_error) << "OnnxExtension: Missing input '" << input.name << "'.";
+      }
+    }
+
+    return error_code::success;
+  }
+
+  int onnx_scoring_context::bind_tensor(bound_input& input, const char* dims_first, const char* dims_last, const char* values_first, const char* values_last, api_status* status) {
+    size_t dims_size = 0;
+    if (!base64::decoded_size(dims_first, dims_last, dims_size) || dims_size % sizeof(int64_t) != 0) {
+      RETURN_ERROR_LS(_trace_logger, status, extension_error)
+        << "Invalid tensor dimension data packing for input '" << input.name << "'. Expecting multiple of " << sizeof(int64_t) << ".";
+    }
+
+    _dims_scratch.resize(dims_size / sizeof(int64_t));
+    if (!base64::decode(dims_first, dims_last, reinterpret_cast<unsigned char*>(_dims_scratch.data()))) {
+      RETURN_ERROR_LS(_trace_logger, status, extension_error) << "Invalid base64 dimensions for input '" << input.name << "'.";
+    }
+
+    if (!is_static_shape(_dims_scratch)) {
+      RETURN_ERROR_LS(_trace_logger, status, extension_error) << "Negative tensor dimension for input '" << input.name << "'.";
+    }
+
+    const size_t expected_values_count = element_count(_dims_scratch);
+    size_t values_size = 0;
+    if (!base64::decoded_size(values_first, values_last, values_size) || values_size != expected_values_count * sizeof(value_t)) {
+      RETURN_ERROR_LS(_trace_logger, status, extension_error)
+        << "Invalid tensor value packing/data for input '" << input.name << "'. Expecting " << expected_values_count << " elements.";
+    }
+
+    // The bound tensor only has to be replaced when the shape changes
+    if (_dims_scratch != input.dims) {
+      input.dims = _dims_scratch;
+      input.values.resize(expected_values_count);
+      _binding->BindInput(input.name.c_str(), Ort::Value::CreateTensor<float>(_memory_info, input.values.data(), input.values.size(), input.dims.data(), input.dims.size()));
+    }
+
+    if (!base64::decode(values_first, values_last, reinterpret_cast<unsigned char*>(input.values.data()))) {
+      RETURN_ERROR_LS(_trace_logger, status, extension_error) << "Invalid base64 values for input '" << input.name << "'.";
+    }
+
+    input.provided = true;
+    return error_code::success;
+  }
+
+  int onnx_scoring_context::score_unbound(const char* features, ranking_buffer& ranking, api_status* status) {
+    onnx_input_builder input_context(_trace_logger);
+    RETURN_IF_FAIL(read_tensor_notation(features, input_context, status));
+
+    std::vector<const char*> input_names = input_context.input_names();
+    std::vector<Ort::Value> inputs;
+
+    RETURN_IF_FAIL(input_context.allocate_inputs(inputs, _memory_info, status));
+
+    // Use the C API to avoid an unneeded throw in the error case
+    OrtValue* onnx_output = nullptr;
+
+    // This cast-chain is taken from the OnnxRuntime code implementation of the C++ API of Ort::Session::Run().
+    auto ort_input_values = reinterpret_cast<const OrtValue**>(const_cast<Ort::Value*>(inputs.data()));
+
+    const char* output_node_name = _output_name.c_str();
+
+    OrtStatus* run_status = OnnxRuntimeCApi.Run(
+      _session->operator OrtSession *(), // Unwrap the underlying C reference to pass to the C API
+      _run_options,
+      input_names.data(), ort_input_values, input_context.input_count(), // Inputs: Names, Values, Count
+      &output_node_name, 1, &onnx_output); // Outputs: Names, Count, Values; note the inconsistency
+
+    if (run_status)
+    {
+      auto release_guard = VW::scope_exit([&run_status] { OnnxRuntimeCApi.ReleaseStatus(run_status); });
+      RETURN_ERROR_LS(_trace_logger, status, extension_error) << OnnxRuntimeCApi.GetErrorMessage(run_status);
+    }
+
+    // Re-wrap in Ort::Value to ensure proper destruction (no point in using VW::scope_exit, since we allocate either way)
+    Ort::Value target_output = Ort::Value(onnx_output);
+
+    size_t num_elements = target_output.GetTensorTypeAndShapeInfo().GetElementCount();
+
+    // TODO: Once we update to OnnxRuntime v1.5.1, we can change this to grab immutable data via GetTensorData<float>()
+    float* floatarr = target_output.GetTensorMutableData<float>();
+
+    ranking.clear();
+    ranking.add_slot();
+    for (size_t i = 0; i < num_elements; i++)
+    {
+      ranking.push_back(static_cast<uint32_t>(i), floatarr[i]);
+    }
+
+    return error_code::success;
+  }
+
+  onnx_scoring_context_factory::onnx_scoring_context_factory(std::shared_ptr<Ort::Session> session, const std::string& output_name, bool use_io_binding, i_trace* trace_logger)
+    : _session(std::move(session))
+    , _output_name(output_name)
+    , _use_io_binding(use_io_binding)
+    , _trace_logger(trace_logger)
+  {}
+
+  onnx_scoring_context* onnx_scoring_context_factory::operator()() {
+    return new onnx_scoring_context(_session, _output_name, _use_io_binding, _trace_logger);
+  }
+}}
@@ -0,0 +1,80 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <core/session/onnxruntime_cxx_api.h>
+
+#include "ranking_buffer.h"
+
+namespace reinforcement_learning {
+  class api_status;
+  class i_trace;
+}
+
+namespace reinforcement_learning { namespace onnx {
+  /**
+   * Per-caller state for scoring a session. A context is used by one thread at a time; onnx_model keeps a pool of them.
+   *
+   * With IoBinding enabled, every input keeps a float buffer that is bound to the session once, and tensor notation is
+   * base64-decoded straight into it. An input is only rebound when the shape of the incoming tensor changes. If the
+   * model output has a static shape, the output tensor is preallocated and bound as well, so steady-state scoring does
+   * not allocate. Otherwise onnxruntime allocates the output on every run.
+   *
+   * With IoBinding disabled, inputs are parsed and passed to Session::Run on every call.
+   */
+  class onnx_scoring_context {
+  public:
+    onnx_scoring_context(std::shared_ptr<Ort::Session> session, const std::string& output_name, bool use_io_binding, i_trace* trace_logger);
+
+    onnx_scoring_context(const onnx_scoring_context&) = delete;
+    onnx_scoring_context& operator=(const onnx_scoring_context&) = delete;
+
+    //! Score the tensor notation features. The output values are stored as a single slot of ranking.
+    int score(const char* features, ranking_buffer& ranking, api_status* status = nullptr);
+
+    bool uses_io_binding() const;
+
+  private:
+    struct bound_input {
+      std::string name;
+      std::vector<int64_t> dims;
+      std::vector<float> values;
+      bool provided;
+    };
+
+    int score_bound(const char* features, ranking_buffer& ranking, api_status* status);
+    int score_unbound(const char* features, ranking_buffer& ranking, api_status* status);
+
+    int bind_tensor_notation(const char* features, api_status* status);
+    int bind_tensor(bound_input& input, const char* dims_first, const char* dims_last, const char* values_first, const char* values_last, api_status* status);
+
+    std::shared_ptr<Ort::Session> _session;
+    const std::string _output_name;
+    i_trace* _trace_logger;
+
+    Ort::MemoryInfo _memory_info;
+    Ort::RunOptions _run_options;
+
+    // Only used with IoBinding
+    std::unique_ptr<Ort::IoBinding> _binding;
+    std::vector<bound_input> _inputs;
+    std::vector<float> _output_values;
+    bool _static_output;
+    std::string _name_scratch;
+    std::vector<int64_t> _dims_scratch;
+  };
+
+  class onnx_scoring_context_factory {
+  public:
+    onnx_scoring_context_factory(std::shared_ptr<Ort::Session> session, const std::string& output_name, bool use_io_binding, i_trace* trace_logger);
+
+    onnx_scoring_context* operator()();
+
+  private:
+    std::shared_ptr<Ort::Session> _session;
+    const std::string _output_name;
+    const bool _use_io_binding;
+    i_trace* _trace_logger;
+  };
+}}
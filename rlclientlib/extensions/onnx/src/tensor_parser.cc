@@ -3,12 +3,25 @@
 #include <algorithm>
 #include <sstream>
 
+#include "base64.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define RL_TENSOR_PARSER_SSE2
+#  include <emmintrin.h>
+#  if defined(_MSC_VER)
+#    include <intrin.h>
+#  endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define RL_TENSOR_PARSER_NEON
+#  include <arm_neon.h>
+#endif
+
 namespace reinforcement_learning { namespace onnx {
 
 namespace tensor_parser
 {
   enum CONSUME_TYPE : bool { EXCLUSIVE = false, INCLUSIVE = true };
-  enum KNOWN_CHARS : char { END = '\0', DOUBLE_QUOTE = '\"', SEMICOLON = ';', COMMA = ',', OPEN_BRACE = '{', CLOSE_BRACE = '}', BACKSLASH = '\\', COLON = ':' };
+  enum KNOWN_CHARS : char { END = '\0', DOUBLE_QUOTE = '\"', SEMICOLON = ';', COMMA = ',', OPEN_BRACE = '{', CLOSE_BRACE = '}', OPEN_BRACKET = '[', CLOSE_BRACKET = ']', BACKSLASH = '\\', COLON = ':' };
 
   namespace errors
   {
@@ -150,123 +163,6 @@ namespace tensor_parser
     }
   }
 
-  namespace base64
-  {
-    struct parse_context
-    {
-    private:
-      size_t _count;
-      uint32_t _running;
-      size_t _padding_count;
-      std::vector<uint8_t>& _bytes;
-      errors::error_context& _error_context;
-
-    public:
-
-      inline parse_context(std::vector<uint8_t>& target, errors::error_context& errors_target) : _bytes(target), _error_context(errors_target), _count(0), _running(0), _padding_count(0)
-      {
-      }
-
-      inline bool invoke(const char c)
-      {
-        _running = _running << 6;
-        _count++;
-
-        if (_padding_count || c == '=')
-        {
-          _padding_count++;
-        }
-        else if (!_padding_count)
-        {
-          if (c >= 'A' /* 65 */ && c <= 'Z' /* 90 */)
-          {
-            _running = _running | (c - 'A' + 0); // 0 - 25
-          }
-          else if (c >= 'a' /* 97 */ && c <= 'z' /* 122 */)
-          {
-            _running = _running | (c - 'a' + 26); // 26 - 51
-          }
-          else if (c >= '0' /* 48 */ && c <= '9' /* 57 */)
-          {
-            _running = _running | (c - '0' + 52); // 52 - 61
-          }
-          else if (c == '+')
-          {
-            _running = _running | 62;
-          }
-          else if (c == '/')
-          {
-            _running = _running | 63;
-          }
-          else
-          {
-            // TODO: Bad character
-            std::stringstream error_detail_builder;
-            error_detail_builder << "Invalid base64 character: '" << c << "'.";
-
-            return _error_context.append_error(std::string(error_detail_builder.str()));
-          }
-
-          if (_count % 4 == 0)
-          {
-            _bytes.push_back((_running >> 16) & 0xFF);
-            _bytes.push_back((_running >> 8) & 0xFF);
-            _bytes.push_back(_running & 0xFF);
-
-            _running = 0;
-          }
-        }
-
-        return true;
-      }
-
-      inline bool end()
-      {
-        if (_count % 4 != 0)
-        {
-          std::stringstream error_detail_builder;
-          error_detail_builder << "Invalid number of base64 characters: '" << _count << "'.";
-
-          return _error_context.append_error(std::string(error_detail_builder.str()));
-        }
-
-        switch (_padding_count)
-        {
-        case 0:
-          break;
-        case 1:
-          _bytes.push_back((_running >> 16) & 0xFF);
-          _bytes.push_back((_running >> 8) & 0xFF);
-          break;
-        case 2:
-          _bytes.push_back((_running >> 16) & 0xFF);
-          break;
-        default:
-          std::stringstream error_detail_builder;
-          error_detail_builder << "Invalid number of base64 padding characters: '" << _padding_count << "'.";
-
-          return _error_context.append_error(std::string(error_detail_builder.str()));
-        }
-
-        return true;
-      }
-    };
-
-    using parse_action = primitives::routing_action<parse_context>;
-
-    template <typename until_t>
-    using frame = primitives::parse_frame<parse_context, until_t, parse_action>;
-
-    template <char ch>
-    using until = primitives::until<parse_context, ch>;
-
-    template <bool inclusive, typename until_t>
-    inline bool consume(const char*& c, parse_context& context)
-    {
-      return primitives::consume<inclusive, frame<until_t>, parse_context>(c, context);
-    }
-  }
-
   template <char escape>
   class escaped_string 
   {
@@ -323,31 +219,155 @@ namespace tensor_parser
 
   using escaped = escaped_string<BACKSLASH>;
 
-  bool parse_tensor_value(const char*& reading_head, std::vector<byte_t>& dims, std::vector<byte_t>& data, errors::error_context& error_target)
+  // Decode the base64 text [first, last) straight into its final buffer
+  bool decode_base64(const char* first, const char* last, bytes_t& bytes, errors::error_context& error_context)
   {
-    errors::error_context error_context = error_target.with_prefix("while parsing tensor value");
+    size_t size = 0;
+    if (!base64::decoded_size(first, last, size))
+    {
+      std::stringstream error_detail_builder;
+      error_detail_builder << "Invalid number of base64 characters: '" << (last - first) << "'.";
 
-    auto dims_context = base64::parse_context(dims, error_context);
-    auto data_context = base64::parse_context(data, error_context);
+      return error_context.append_error(error_detail_builder.str());
+    }
+
+    bytes.resize(size);
+    return base64::decode(first, last, bytes.data())
+      || // on error:
+         error_context.append_error("Invalid base64 character or padding.");
+  }
+
+  bool parse_tensor_value(const char*& reading_head, const char* line_end, bytes_t& dims, bytes_t& data, errors::error_context& error_target)
+  {
+    errors::error_context error_context = error_target.with_prefix("while parsing tensor value");
 
     // " <base64 dimensions> ; <base64 data> "
-    return consume_exact<DOUBLE_QUOTE>(reading_head) &&
-      base64::consume<INCLUSIVE, base64::until<SEMICOLON>>(reading_head, dims_context) &&
-      base64::consume<INCLUSIVE, base64::until<DOUBLE_QUOTE>>(reading_head, data_context);
+    if (!consume_exact<DOUBLE_QUOTE>(reading_head))
+    {
+      return false;
+    }
+
+    const char* dims_first = reading_head;
+    reading_head = find_value_delimiter(reading_head, line_end);
+    if (!consume_exact<SEMICOLON>(reading_head))
+    {
+      return error_context.append_error("Expected ';'.");
+    }
+
+    const char* data_first = reading_head;
+    reading_head = find_value_delimiter(reading_head, line_end);
+    if (!consume_exact<DOUBLE_QUOTE>(reading_head))
+    {
+      return error_context.append_error("Expected '\"'.");
+    }
+
+    return decode_base64(dims_first, data_first - 1, dims, error_context) &&
+      decode_base64(data_first, reading_head - 1, data, error_context);
   }
 
-  bool parse_tensor_name_value(const char*& reading_head, std::string& name, bytes_t& shape_bytes, bytes_t& value_bytes, errors::error_context& error_target)
+  bool parse_tensor_name(const char*& reading_head, std::string& name, errors::error_context& error_target)
   {
     auto name_context = escaped::parse_context(name);
 
-    // " <escaped_name> " : <tensor_value>
+    // " <escaped_name> " :
     return 
       consume_exact<DOUBLE_QUOTE>(reading_head) &&
       (escaped::consume<INCLUSIVE, escaped::until<DOUBLE_QUOTE>>(reading_head, name_context) 
         || // on error:
            error_target.with_prefix("while parsing tensor name").append_error("Expected '\"'.")) &&
-      consume_exact<COLON>(reading_head) &&
-      parse_tensor_value(reading_head, shape_bytes, value_bytes, error_target);
+      consume_exact<COLON>(reading_head);
+  }
+
+  bool skip_json_value(const char*& reading_head)
+  {
+    // Strings are skipped whole; objects and arrays by tracking their nesting. A value ends at the first ',' or '}'
+    // outside of them.
+    int depth = 0;
+    while (*reading_head != END)
+    {
+      const char c = *reading_head;
+      if (depth == 0 && (c == COMMA || c == CLOSE_BRACE))
+      {
+        return true;
+      }
+
+      if (c == DOUBLE_QUOTE)
+      {
+        for (reading_head++; *reading_head != DOUBLE_QUOTE; reading_head++)
+        {
+          if (*reading_head == END || (*reading_head == BACKSLASH && *++reading_head == END))
+          {
+            return false;
+          }
+        }
+      }
+      else if (c == OPEN_BRACE || c == OPEN_BRACKET)
+      {
+        depth++;
+      }
+      else if (c == CLOSE_BRACE || c == CLOSE_BRACKET)
+      {
+        if (depth == 0)
+        {
+          return false;
+        }
+        depth--;
+      }
+
+      reading_head++;
+    }
+
+    return false;
+  }
+
+  const char* find_value_delimiter(const char* first, const char* last)
+  {
+#if defined(RL_TENSOR_PARSER_SSE2)
+    const __m128i semicolon = _mm_set1_epi8(SEMICOLON);
+    const __m128i double_quote = _mm_set1_epi8(DOUBLE_QUOTE);
+    const __m128i end = _mm_setzero_si128();
+    for (; last - first >= 16; first += 16)
+    {
+      const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+      const __m128i found = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, semicolon), _mm_cmpeq_epi8(chunk, double_quote)), _mm_cmpeq_epi8(chunk, end));
+      const int mask = _mm_movemask_epi8(found);
+      if (mask != 0)
+      {
+#  if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, static_cast<unsigned long>(mask));
+        return first + index;
+#  else
+        return first + __builtin_ctz(static_cast<unsigned int>(mask));
+#  endif
+      }
+    }
+#elif defined(RL_TENSOR_PARSER_NEON)
+    const uint8x16_t semicolon = vdupq_n_u8(SEMICOLON);
+    const uint8x16_t double_quote = vdupq_n_u8(DOUBLE_QUOTE);
+    const uint8x16_t end = vdupq_n_u8(END);
+    for (; last - first >= 16; first += 16)
+    {
+      const uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(first));
+      const uint8x16_t found = vorrq_u8(vorrq_u8(vceqq_u8(chunk, semicolon), vceqq_u8(chunk, double_quote)), vceqq_u8(chunk, end));
+      if (vmaxvq_u8(found) != 0)
+      {
+        break;
+      }
+    }
+#endif
+
+    // The tail, or the chunk holding the delimiter when the position is not extracted from a mask
+    for (; first != last; first++)
+    {
+      const char c = *first;
+      if (c == SEMICOLON || c == DOUBLE_QUOTE || c == END)
+      {
+        return first;
+      }
+    }
+
+    return last;
   }
 
   bool parse(parser_context& context)
@@ -366,6 +386,7 @@ namespace tensor_parser
     }
 
     const char*& reading_head = context._reading_head;
+    const char* const line_end = context._line.c_str() + context._line.size();
 
     // '{' <tensor_name_value> [ ',' <tensor_name_value> ]* 
     if (!consume_exact<OPEN_BRACE>(reading_head))
@@ -387,7 +408,21 @@ namespace tensor_parser
       bytes_t tensor_shape_bytes;
       bytes_t tensor_data_bytes;
 
-      if (!parse_tensor_name_value(reading_head, name, tensor_shape_bytes, tensor_data_bytes, error_context))
+      if (!parse_tensor_name(reading_head, name, error_context))
+      {
+        return false;
+      }
+
+      if (is_skipped_field(name.c_str()))
+      {
+        if (!skip_json_value(reading_head))
+        {
+          return error_context.with_prefix("while skipping field '" + name + "'").append_error("Malformed value.");
+        }
+        continue;
+      }
+
+      if (!parse_tensor_value(reading_head, line_end, tensor_shape_bytes, tensor_data_bytes, error_context))
       {
         return false;
       }
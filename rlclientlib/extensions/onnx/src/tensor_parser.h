@@ -20,6 +20,10 @@ namespace reinforcement_learning { namespace onnx {
 // the current setup for RLClientLib to log the context as JSON. Note that whitespace is
 // not allowed.
 //
+// The exception are fields whose name starts with '_'. Their values are skipped rather than
+// read as tensors, which lets multi-slot contexts carry the "_multi" and "_slots" arrays
+// that RLClientLib reads to count actions and slots.
+//
 // Ideally, we would use protobuf definitions from ONNX to represent the IOContext
 
 namespace tensor_parser
@@ -64,5 +68,18 @@ namespace tensor_parser
   };
 
   bool parse(parser_context& context);
+
+  // Fields that are not tensors, see above
+  inline bool is_skipped_field(const char* name)
+  {
+    return name[0] == '_';
+  }
+
+  // Move reading_head past one JSON value, stopping at the ',' or '}' that follows it
+  bool skip_json_value(const char*& reading_head);
+
+  // First position in [first, last) holding ';', '"' or '\0', or last if there is none. These are the characters
+  // that can end the base64 text of a tensor. Uses SSE2 or NEON compares when available.
+  const char* find_value_delimiter(const char* first, const char* last);
 }
 }}
\ No newline at end of file
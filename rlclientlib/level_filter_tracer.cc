@@ -0,0 +1,17 @@
+#include "level_filter_tracer.h"
+
+namespace reinforcement_learning {
+  level_filter_tracer::level_filter_tracer(i_trace* inner, int min_level)
+    : _inner(inner), _min_level(min_level)
+  {}
+
+  void level_filter_tracer::log(int log_level, const std::string& msg) {
+    if (is_enabled(log_level)) {
+      _inner->log(log_level, msg);
+    }
+  }
+
+  bool level_filter_tracer::is_enabled(int log_level) const {
+    return log_level >= _min_level && _inner->is_enabled(log_level);
+  }
+}
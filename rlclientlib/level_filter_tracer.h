@@ -0,0 +1,24 @@
+#pragma once
+#include "trace_logger.h"
+
+#include <memory>
+#include <string>
+
+namespace reinforcement_learning {
+  //! Trace logger which drops the messages below a minimum level before they reach the wrapped logger
+  class level_filter_tracer : public i_trace {
+  public:
+    //! Takes ownership of inner
+    level_filter_tracer(i_trace* inner, int min_level);
+
+    level_filter_tracer(const level_filter_tracer&) = delete;
+    level_filter_tracer& operator=(const level_filter_tracer&) = delete;
+
+    void log(int log_level, const std::string& msg) override;
+    bool is_enabled(int log_level) const override;
+
+  private:
+    std::unique_ptr<i_trace> _inner;
+    const int _min_level;
+  };
+}
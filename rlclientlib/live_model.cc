@@ -25,6 +25,9 @@ namespace reinforcement_learning
       new live_model_impl(config, fn, err_context, trace_factory, t_factory, m_factory, s_factory, time_prov_factory));
 	}
 
+  live_model::live_model(live_model_impl* impl)
+    : _pimpl(impl) {}
+
 	live_model::live_model(live_model&& other) {
 		std::swap(_pimpl, other._pimpl);
 		_initialized = other._initialized;
@@ -86,6 +89,30 @@ namespace reinforcement_learning
     return _pimpl->choose_rank(context_json, flags, response, status);
   }
 
+  int live_model::register_shared_context(const char* shared_json, uint64_t& shared_context, api_status* status)
+  {
+    INIT_CHECK();
+    return _pimpl->register_shared_context(shared_json, shared_context, status);
+  }
+
+  int live_model::unregister_shared_context(uint64_t shared_context, api_status* status)
+  {
+    INIT_CHECK();
+    return _pimpl->unregister_shared_context(shared_context, status);
+  }
+
+  int live_model::choose_rank(const char* event_id, uint64_t shared_context, const char* actions_json, ranking_response& response, api_status* status)
+  {
+    INIT_CHECK();
+    return choose_rank(event_id, shared_context, actions_json, action_flags::DEFAULT, response, status);
+  }
+
+  int live_model::choose_rank(const char* event_id, uint64_t shared_context, const char* actions_json, unsigned int flags, ranking_response& response, api_status* status)
+  {
+    INIT_CHECK();
+    return _pimpl->choose_rank(event_id, shared_context, actions_json, flags, response, status);
+  }
+
   int live_model::request_continuous_action(const char * event_id, const char * context_json, unsigned int flags, continuous_action_response& response, api_status* status)
   {
     INIT_CHECK();
@@ -235,4 +262,34 @@ namespace reinforcement_learning
     INIT_CHECK();
     return _pimpl->refresh_model(status);
   }
+
+  int live_model::get_interaction_queue_stats(queue_stats& stats, api_status* status) const
+  {
+    INIT_CHECK();
+    return _pimpl->get_interaction_queue_stats(stats, status);
+  }
+
+  int live_model::get_observation_queue_stats(queue_stats& stats, api_status* status) const
+  {
+    INIT_CHECK();
+    return _pimpl->get_observation_queue_stats(stats, status);
+  }
+
+  int live_model::get_prediction_cache_stats(prediction_cache_stats& stats, api_status* status) const
+  {
+    INIT_CHECK();
+    return _pimpl->get_prediction_cache_stats(stats, status);
+  }
+
+  int live_model::get_metrics(metrics_snapshot& metrics, api_status* status) const
+  {
+    INIT_CHECK();
+    return _pimpl->get_metrics(metrics, status);
+  }
+
+  int live_model::update_configuration(const utility::configuration& changes, api_status* status)
+  {
+    INIT_CHECK();
+    return _pimpl->update_configuration(changes, status);
+  }
 }
@@ -0,0 +1,42 @@
+#include "live_model_host.h"
+#include "live_model_host_impl.h"
+#include "live_model_impl.h"
+#include "err_constants.h"
+
+namespace reinforcement_learning {
+  live_model_host::live_model_host(
+    const utility::configuration& config,
+    error_fn fn,
+    void* err_context,
+    trace_logger_factory_t* trace_factory,
+    data_transport_factory_t* t_factory,
+    model_factory_t* m_factory,
+    sender_factory_t* s_factory,
+    time_provider_factory_t* time_prov_factory)
+    : _pimpl(std::make_shared<live_model_host_impl>(config, fn, err_context, trace_factory, t_factory, m_factory, s_factory, time_prov_factory)) {}
+
+  live_model_host::~live_model_host() = default;
+
+  int live_model_host::init(api_status* status) {
+    if (_initialized) {
+      return error_code::success;
+    }
+
+    RETURN_IF_FAIL(_pimpl->init(status));
+    _initialized = true;
+    return error_code::success;
+  }
+
+  int live_model_host::create_live_model(const utility::configuration& config, error_fn fn, void* err_context, std::unique_ptr<live_model>& model, api_status* status) {
+    if (!_initialized) {
+      RETURN_ERROR_ARG(nullptr, status, not_initialized, "Library not initialized. Call init() first.");
+    }
+
+    std::unique_ptr<live_model> created(new live_model(new live_model_impl(config, fn, err_context,
+      _pimpl->trace_factory(), _pimpl->data_transport_factory(), _pimpl->model_factory(), _pimpl->sender_factory(),
+      _pimpl->time_provider_factory(), _pimpl)));
+    RETURN_IF_FAIL(created->init(status));
+    model = std::move(created);
+    return error_code::success;
+  }
+}
@@ -0,0 +1,305 @@
+#include "live_model_host_impl.h"
+#include "api_status.h"
+#include "constants.h"
+#include "err_constants.h"
+#include "hash.h"
+#include "prediction_cache_stats.h"
+#include "model_mgmt/model_delta.h"
+#include "str_util.h"
+
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+
+namespace reinforcement_learning {
+  namespace m = model_management;
+  namespace u = utility;
+
+  namespace {
+    // Apps whose settings differ in any of these do not share
+    const std::initializer_list<const char*> TRANSPORT_SETTINGS = {
+      name::MODEL_BLOB_URI, name::MODEL_DELTA_BLOB_URI, name::MODEL_FILE_NAME, name::MODEL_FILE_MUST_EXIST,
+      name::MODEL_DOWNLOAD_CHUNK_SIZE, name::MODEL_DOWNLOAD_PARALLEL_CHUNKS, name::MODEL_DOWNLOAD_MAX_RETRIES,
+      name::HTTP_CLIENT_TIMEOUT, name::HTTP_CLIENT_DISABLE_CERT_VALIDATION
+    };
+    // Settings of the VW model, models of other implementations are not shared as their settings are not known here
+    const std::initializer_list<const char*> MODEL_SETTINGS = {
+      name::MODEL_SRC, name::MODEL_VW_INITIAL_COMMAND_LINE, name::VW_CMDLINE, name::VW_POOL_INIT_SIZE,
+      name::MODEL_CACHE_MAX_ENTRIES, name::MODEL_CACHE_TTL_MS
+    };
+    const std::initializer_list<const char*> INTERACTION_HUB_SETTINGS = {
+      name::INTERACTION_EH_HOST, name::INTERACTION_EH_NAME, name::INTERACTION_EH_KEY_NAME, name::INTERACTION_EH_KEY,
+      name::INTERACTION_EH_TASKS_LIMIT, name::INTERACTION_EH_MAX_HTTP_RETRIES, name::HTTP_CLIENT_TIMEOUT,
+      name::HTTP_CLIENT_DISABLE_CERT_VALIDATION
+    };
+    const std::initializer_list<const char*> OBSERVATION_HUB_SETTINGS = {
+      name::OBSERVATION_EH_HOST, name::OBSERVATION_EH_NAME, name::OBSERVATION_EH_KEY_NAME, name::OBSERVATION_EH_KEY,
+      name::OBSERVATION_EH_TASKS_LIMIT, name::OBSERVATION_EH_MAX_HTTP_RETRIES, name::HTTP_CLIENT_TIMEOUT,
+      name::HTTP_CLIENT_DISABLE_CERT_VALIDATION
+    };
+
+    void append_settings(std::string& key, const u::configuration& config, std::initializer_list<const char*> names) {
+      for (const auto setting : names) {
+        key.append(1, '\n').append(config.get(setting, ""));
+      }
+    }
+
+    // Entry of the map, or a new one created by create_fn when the apps which shared the previous one are gone
+    template<typename TShared, typename TCreate>
+    int find_or_create(std::map<std::string, std::weak_ptr<TShared>>& shared_map, const std::string& key,
+      std::shared_ptr<TShared>& shared, TCreate create_fn) {
+      shared = shared_map[key].lock();
+      if (shared != nullptr) {
+        return error_code::success;
+      }
+
+      shared = std::make_shared<TShared>();
+      RETURN_IF_FAIL(create_fn(*shared));
+      shared_map[key] = shared;
+
+      // Forget the entries released since
+      for (auto it = shared_map.begin(); it != shared_map.end();) {
+        it = it->second.expired() ? shared_map.erase(it) : std::next(it);
+      }
+      return error_code::success;
+    }
+  }
+
+  const size_t live_model_host_impl::MODEL_HISTORY;
+  const size_t live_model_host_impl::DELTA_HISTORY;
+
+  live_model_host_impl::live_model_host_impl(
+    const u::configuration& config,
+    error_fn fn,
+    void* err_context,
+    trace_logger_factory_t* trace_factory,
+    data_transport_factory_t* t_factory,
+    model_factory_t* m_factory,
+    sender_factory_t* sender_factory,
+    time_provider_factory_t* time_provider_factory)
+    : _configuration(config)
+    , _error_cb(fn, err_context)
+    , _trace_factory(trace_factory)
+    , _t_factory(t_factory)
+    , _m_factory(m_factory)
+    , _sender_factory(sender_factory)
+    , _time_provider_factory(time_provider_factory) {}
+
+  int live_model_host_impl::init(api_status* status) {
+    const auto trace_impl = _configuration.get(name::TRACE_LOG_IMPLEMENTATION, value::NULL_TRACE_LOGGER);
+    i_trace* plogger;
+    RETURN_IF_FAIL(_trace_factory->create(&plogger, trace_impl, _configuration, nullptr, status));
+    _trace_logger.reset(plogger);
+
+    const auto threads = _configuration.get_int(name::BACKGROUND_EXECUTOR_THREADS, value::DEFAULT_HOST_BACKGROUND_EXECUTOR_THREADS);
+    if (threads > 0) {
+      std::shared_ptr<u::background_executor> executor(new u::background_executor(static_cast<size_t>(threads), _trace_logger.get()));
+      RETURN_IF_FAIL(executor->init(status));
+      _executor = std::move(executor);
+    }
+    return error_code::success;
+  }
+
+  int live_model_host_impl::create_model(const char* impl, const u::configuration& config, m::i_model** retval, api_status* status) {
+    *retval = nullptr;
+    if (std::strcmp(impl, value::VW) != 0) {
+      return error_code::success;
+    }
+
+    std::string key(impl);
+    append_settings(key, config, MODEL_SETTINGS);
+    append_settings(key, config, TRANSPORT_SETTINGS);
+
+    std::shared_ptr<shared_model> shared;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      RETURN_IF_FAIL(find_or_create(_models, key, shared, [&](shared_model& created) {
+        m::i_model* pmodel;
+        RETURN_IF_FAIL(_m_factory->create(&pmodel, impl, config, _trace_logger.get(), status));
+        created.model.reset(pmodel);
+        return error_code::success;
+      }));
+    }
+    *retval = new m::shared_model_proxy(std::move(shared), _trace_logger.get());
+    return error_code::success;
+  }
+
+  int live_model_host_impl::create_data_transport(const char* impl, const u::configuration& config, m::i_data_transport** retval, api_status* status) {
+    std::string key(impl);
+    append_settings(key, config, TRANSPORT_SETTINGS);
+
+    std::shared_ptr<shared_transport> shared;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      RETURN_IF_FAIL(find_or_create(_transports, key, shared, [&](shared_transport& created) {
+        m::i_data_transport* ptransport;
+        RETURN_IF_FAIL(_t_factory->create(&ptransport, impl, config, _trace_logger.get(), status));
+        created.transport.reset(ptransport);
+        return error_code::success;
+      }));
+    }
+    *retval = new m::shared_transport_proxy(std::move(shared));
+    return error_code::success;
+  }
+
+  int live_model_host_impl::create_sender(const char* impl, const u::configuration& config, i_sender** retval, api_status* status) {
+    *retval = nullptr;
+    const std::string sender_impl(impl);
+    std::string key(impl);
+    if (sender_impl == value::INTERACTION_EH_SENDER) {
+      append_settings(key, config, INTERACTION_HUB_SETTINGS);
+    }
+    else if (sender_impl == value::OBSERVATION_EH_SENDER) {
+      append_settings(key, config, OBSERVATION_HUB_SETTINGS);
+    }
+    else {
+      return error_code::success;
+    }
+
+    // Errors of a shared hub are reported to the host, apps may come and go
+    std::shared_ptr<shared_sender> shared;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      RETURN_IF_FAIL(find_or_create(_senders, key, shared, [&](shared_sender& created) {
+        i_sender* psender;
+        RETURN_IF_FAIL(_sender_factory->create(&psender, sender_impl, config, &_error_cb, _trace_logger.get(), status));
+        created.sender.reset(psender);
+        return created.sender->init(status);
+      }));
+    }
+    *retval = new shared_sender_proxy(std::move(shared));
+    return error_code::success;
+  }
+
+  std::shared_ptr<u::background_executor> live_model_host_impl::executor() const { return _executor; }
+
+  trace_logger_factory_t* live_model_host_impl::trace_factory() const { return _trace_factory; }
+  data_transport_factory_t* live_model_host_impl::data_transport_factory() const { return _t_factory; }
+  model_factory_t* live_model_host_impl::model_factory() const { return _m_factory; }
+  sender_factory_t* live_model_host_impl::sender_factory() const { return _sender_factory; }
+  time_provider_factory_t* live_model_host_impl::time_provider_factory() const { return _time_provider_factory; }
+
+  namespace model_management {
+    shared_model_proxy::shared_model_proxy(std::shared_ptr<live_model_host_impl::shared_model> shared, i_trace* trace)
+      : _shared(std::move(shared)), _trace(trace) {}
+
+    int shared_model_proxy::update(const model_data& data, bool& model_ready, api_status* status) {
+      const auto content = uniform_hash(data.data(), data.data_sz(), 0);
+
+      std::lock_guard<std::mutex> lock(_shared->mutex);
+      auto& loaded = _shared->loaded;
+      if (std::find(loaded.begin(), loaded.end(), content) != loaded.end()) {
+        TRACE_INFO(_trace, "Model data is already loaded by another app");
+        model_ready = _shared->ready;
+        return error_code::success;
+      }
+
+      bool ready = false;
+      RETURN_IF_FAIL(_shared->model->update(data, ready, status));
+      _shared->ready = _shared->ready || ready;
+      model_ready = _shared->ready;
+
+      loaded.push_back(content);
+      if (loaded.size() > live_model_host_impl::MODEL_HISTORY) {
+        loaded.pop_front();
+      }
+      return error_code::success;
+    }
+
+    int shared_model_proxy::choose_rank(uint64_t rnd_seed, const char* features, std::vector<int>& action_ids, std::vector<float>& action_pdf, std::string& model_version, api_status* status) {
+      return _shared->model->choose_rank(rnd_seed, features, action_ids, action_pdf, model_version, status);
+    }
+
+    int shared_model_proxy::choose_rank_flat(uint64_t rnd_seed, const char* features, ranking_buffer& ranking, std::string& model_version, api_status* status) {
+      return _shared->model->choose_rank_flat(rnd_seed, features, ranking, model_version, status);
+    }
+
+    int shared_model_proxy::choose_rank_shared(uint64_t rnd_seed, const shared_context& shared, const char* actions, const char* context, ranking_buffer& ranking, std::string& model_version, api_status* status) {
+      return _shared->model->choose_rank_shared(rnd_seed, shared, actions, context, ranking, model_version, status);
+    }
+
+    int shared_model_proxy::choose_continuous_action(uint64_t rnd_seed, const char* features, float& action, float& pdf_value, std::string& model_version, api_status* status) {
+      return _shared->model->choose_continuous_action(rnd_seed, features, action, pdf_value, model_version, status);
+    }
+
+    int shared_model_proxy::request_decision(const std::vector<const char*>& event_ids, const char* features, std::vector<std::vector<uint32_t>>& actions_ids, std::vector<std::vector<float>>& action_pdfs, std::string& model_version, api_status* status) {
+      return _shared->model->request_decision(event_ids, features, actions_ids, action_pdfs, model_version, status);
+    }
+
+    int shared_model_proxy::request_multi_slot_decision(const char* event_id, const std::vector<std::string>& slot_ids, const char* features, std::vector<std::vector<uint32_t>>& actions_ids, std::vector<std::vector<float>>& action_pdfs, std::string& model_version, api_status* status) {
+      return _shared->model->request_multi_slot_decision(event_id, slot_ids, features, actions_ids, action_pdfs, model_version, status);
+    }
+
+    model_type_t shared_model_proxy::model_type() const {
+      return _shared->model->model_type();
+    }
+
+    int shared_model_proxy::get_prediction_cache_stats(prediction_cache_stats& stats, api_status* status) const {
+      return _shared->model->get_prediction_cache_stats(stats, status);
+    }
+
+    shared_transport_proxy::shared_transport_proxy(std::shared_ptr<live_model_host_impl::shared_transport> shared)
+      : _shared(std::move(shared)) {}
+
+    int shared_transport_proxy::get_data(model_data& data, api_status* status) {
+      std::lock_guard<std::mutex> lock(_shared->mutex);
+      model_data downloaded;
+      RETURN_IF_FAIL(_shared->transport->get_data(downloaded, status));
+      if (downloaded.refresh_count() > 0) {
+        ++_shared->version;
+        if (model_delta::is_delta(downloaded.data(), downloaded.data_sz())) {
+          _shared->deltas.push_back(std::move(downloaded));
+          if (_shared->deltas.size() > live_model_host_impl::DELTA_HISTORY) {
+            _shared->deltas.pop_front();
+            ++_shared->delta_base;
+            if (!_shared->full_pending) {
+              _shared->full_pending = true;
+              _shared->transport->request_full_model();
+            }
+          }
+        }
+        else {
+          _shared->latest_full = std::move(downloaded);
+          _shared->full_version = _shared->version;
+          _shared->delta_base = _shared->version;
+          _shared->full_pending = false;
+          _shared->deltas.clear();
+        }
+      }
+
+      // An app which is behind gets the full model, then each delta since, one per call. An app behind the deltas
+      // kept gets nothing until the full model requested when they were dropped is downloaded.
+      if ((_full_requested && _shared->full_version > 0) || _seen < _shared->full_version) {
+        _full_requested = false;
+        data = _shared->latest_full;
+        _seen = _shared->full_version;
+      }
+      else if (_seen >= _shared->delta_base && _seen < _shared->version) {
+        data = _shared->deltas[_seen - _shared->delta_base];
+        ++_seen;
+      }
+      return error_code::success;
+    }
+
+    void shared_transport_proxy::request_full_model() {
+      std::lock_guard<std::mutex> lock(_shared->mutex);
+      _full_requested = true;
+      if (_shared->full_version == 0) {
+        _shared->transport->request_full_model();
+      }
+    }
+  }
+
+  shared_sender_proxy::shared_sender_proxy(std::shared_ptr<live_model_host_impl::shared_sender> shared)
+    : _shared(std::move(shared)) {}
+
+  int shared_sender_proxy::init(api_status*) {
+    return error_code::success;
+  }
+
+  int shared_sender_proxy::v_send(const buffer& data, api_status* status) {
+    std::lock_guard<std::mutex> lock(_shared->mutex);
+    return _shared->sender->send(data, status);
+  }
+}
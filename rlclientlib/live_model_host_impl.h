@@ -0,0 +1,169 @@
+#pragma once
+#include "configuration.h"
+#include "error_callback_fn.h"
+#include "factory_resolver.h"
+#include "model_mgmt.h"
+#include "sender.h"
+#include "trace_logger.h"
+#include "utility/background_executor.h"
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace reinforcement_learning {
+  class api_status;
+
+  /**
+   * Infrastructure shared by the live_model instances of a live_model_host.
+   *
+   * - VW models are shared by apps which get them from the same source and load them the same way. Updates are
+   *   addressed by content: model data already loaded by another app is not loaded again.
+   * - Data transports are shared by source. Each download is handed once to every app polling the source. The latest
+   *   deltas since the full model are kept, so that an app polling less often than the others still applies each. An app
+   *   left behind the kept deltas waits for a new full model.
+   * - Event Hub senders are shared by hub, so the requests of every app go through one connection pool. Other senders
+   *   belong to their app.
+   * - Background procs of every app run on one executor.
+   *
+   * Apps hold it by shared pointer, so the shared objects outlive whichever of the host and its apps goes last.
+   */
+  class live_model_host_impl {
+  public:
+    using error_fn = void(*)(const api_status&, void*);
+
+    //! Recent model updates remembered by content hash, so that a late download of a replaced model is not reloaded
+    static const size_t MODEL_HISTORY = 4;
+    //! Deltas kept for the apps sharing a transport. Once there are more, a full model is requested from the source.
+    static const size_t DELTA_HISTORY = 32;
+
+    live_model_host_impl(
+      const utility::configuration& config,
+      error_fn fn,
+      void* err_context,
+      trace_logger_factory_t* trace_factory,
+      data_transport_factory_t* t_factory,
+      model_factory_t* m_factory,
+      sender_factory_t* sender_factory,
+      time_provider_factory_t* time_provider_factory);
+
+    live_model_host_impl(const live_model_host_impl&) = delete;
+    live_model_host_impl& operator=(const live_model_host_impl&) = delete;
+
+    int init(api_status* status);
+
+    //! Sets retval to null when the model is not shared, the app then creates its own
+    int create_model(const char* impl, const utility::configuration& config, model_management::i_model** retval, api_status* status);
+    int create_data_transport(const char* impl, const utility::configuration& config, model_management::i_data_transport** retval, api_status* status);
+    //! Sets retval to null when the sender is not shared, the app then creates its own
+    int create_sender(const char* impl, const utility::configuration& config, i_sender** retval, api_status* status);
+
+    //! Executor of the background procs of every app, null when each proc keeps its own thread
+    std::shared_ptr<utility::background_executor> executor() const;
+
+    trace_logger_factory_t* trace_factory() const;
+    data_transport_factory_t* data_transport_factory() const;
+    model_factory_t* model_factory() const;
+    sender_factory_t* sender_factory() const;
+    time_provider_factory_t* time_provider_factory() const;
+
+    struct shared_model {
+      std::mutex mutex;  // Serializes updates
+      std::unique_ptr<model_management::i_model> model;
+      std::deque<uint64_t> loaded;  // Content hashes of the latest updates, newest last
+      bool ready = false;
+    };
+
+    struct shared_transport {
+      std::mutex mutex;
+      std::unique_ptr<model_management::i_data_transport> transport;
+      model_management::model_data latest_full;             // Deltas are applied on top of it
+      std::deque<model_management::model_data> deltas;      // The latest downloaded since latest_full, oldest first
+      uint64_t version = 0;                                 // Downloads so far
+      uint64_t full_version = 0;                            // Download which brought latest_full
+      uint64_t delta_base = 0;                              // Download before the oldest delta kept
+      bool full_pending = false;                            // Deltas were dropped, a full model was requested
+    };
+
+    struct shared_sender {
+      std::mutex mutex;  // Senders are not safe to call concurrently
+      std::unique_ptr<i_sender> sender;
+    };
+
+  private:
+    template<typename TShared>
+    using shared_map = std::map<std::string, std::weak_ptr<TShared>>;
+
+    const utility::configuration _configuration;
+    error_callback_fn _error_cb;
+    std::unique_ptr<i_trace> _trace_logger;
+
+    trace_logger_factory_t* _trace_factory;
+    data_transport_factory_t* _t_factory;
+    model_factory_t* _m_factory;
+    sender_factory_t* _sender_factory;
+    time_provider_factory_t* _time_provider_factory;
+
+    std::shared_ptr<utility::background_executor> _executor;
+
+    std::mutex _mutex;
+    shared_map<shared_model> _models;
+    shared_map<shared_transport> _transports;
+    shared_map<shared_sender> _senders;
+  };
+
+  namespace model_management {
+    //! Model of one app, forwarding to the model it shares with the others
+    class shared_model_proxy : public i_model {
+    public:
+      shared_model_proxy(std::shared_ptr<live_model_host_impl::shared_model> shared, i_trace* trace);
+
+      int update(const model_data& data, bool& model_ready, api_status* status = nullptr) override;
+      int choose_rank(uint64_t rnd_seed, const char* features, std::vector<int>& action_ids, std::vector<float>& action_pdf, std::string& model_version, api_status* status = nullptr) override;
+      int choose_rank_flat(uint64_t rnd_seed, const char* features, ranking_buffer& ranking, std::string& model_version, api_status* status = nullptr) override;
+      int choose_rank_shared(uint64_t rnd_seed, const shared_context& shared, const char* actions, const char* context, ranking_buffer& ranking, std::string& model_version, api_status* status = nullptr) override;
+      int choose_continuous_action(uint64_t rnd_seed, const char* features, float& action, float& pdf_value, std::string& model_version, api_status* status = nullptr) override;
+      int request_decision(const std::vector<const char*>& event_ids, const char* features, std::vector<std::vector<uint32_t>>& actions_ids, std::vector<std::vector<float>>& action_pdfs, std::string& model_version, api_status* status = nullptr) override;
+      int request_multi_slot_decision(const char* event_id, const std::vector<std::string>& slot_ids, const char* features, std::vector<std::vector<uint32_t>>& actions_ids, std::vector<std::vector<float>>& action_pdfs, std::string& model_version, api_status* status = nullptr) override;
+      model_type_t model_type() const override;
+      int get_prediction_cache_stats(prediction_cache_stats& stats, api_status* status = nullptr) const override;
+
+    private:
+      std::shared_ptr<live_model_host_impl::shared_model> _shared;
+      i_trace* _trace;
+    };
+
+    //! Transport of one app, handing it each download of the shared transport once
+    class shared_transport_proxy : public i_data_transport {
+    public:
+      explicit shared_transport_proxy(std::shared_ptr<live_model_host_impl::shared_transport> shared);
+
+      int get_data(model_data& data, api_status* status = nullptr) override;
+      void request_full_model() override;
+
+    private:
+      std::shared_ptr<live_model_host_impl::shared_transport> _shared;
+      uint64_t _seen = 0;
+      bool _full_requested = false;
+    };
+  }
+
+  //! Sender of one app, sending through the sender of its hub
+  class shared_sender_proxy : public i_sender {
+  public:
+    explicit shared_sender_proxy(std::shared_ptr<live_model_host_impl::shared_sender> shared);
+
+    //! The shared sender is initialized once by the host
+    int init(api_status* status) override;
+
+  protected:
+    int v_send(const buffer& data, api_status* status) override;
+
+  private:
+    std::shared_ptr<live_model_host_impl::shared_sender> _shared;
+  };
+}
@@ -1,7 +1,5 @@
-#include <boost/uuid/uuid_io.hpp>
-#include <boost/uuid/random_generator.hpp>
-
 #include "utility/context_helper.h"
+#include "utility/event_id_generator.h"
 #include "sender.h"
 #include "api_status.h"
 #include "configuration.h"
@@ -12,12 +10,17 @@
 #include "constants.h"
 #include "vw_model/safe_vw.h"
 #include "trace_logger.h"
+#include "async_tracer.h"
+#include "level_filter_tracer.h"
+#include "live_model_host_impl.h"
 #include "explore_internal.h"
 #include "hash.h"
 #include "factory_resolver.h"
 #include "logger/preamble_sender.h"
 #include "sampling.h"
+#include "explore_kernels.h"
 
+#include <algorithm>
 #include <cstring>
 
 // Some namespace changes for more concise code
@@ -48,9 +51,13 @@ namespace reinforcement_learning {
 
   int live_model_impl::init(api_status* status) {
     RETURN_IF_FAIL(init_trace(status));
+    RETURN_IF_FAIL(_config_snapshot.resolve(_configuration, _trace_logger.get(), status));
+    RETURN_IF_FAIL(init_background_executor(status));
     RETURN_IF_FAIL(init_model(status));
     RETURN_IF_FAIL(init_model_mgmt(status));
     RETURN_IF_FAIL(init_loggers(status));
+    RETURN_IF_FAIL(init_metrics(status));
+    RETURN_IF_FAIL(init_span_tracer(status));
 
     if (_protocol_version == 1) {
       if(_configuration.get_bool("interaction", name::USE_COMPRESSION, false) || 
@@ -60,7 +67,6 @@ namespace reinforcement_learning {
       }
     }
 
-    _initial_epsilon = _configuration.get_float(name::INITIAL_EPSILON, 0.2f);
     const char* app_id = _configuration.get(name::APP_ID, "");
     _seed_shift = uniform_hash(app_id, strlen(app_id), 0);
     return error_code::success;
@@ -74,12 +80,64 @@ namespace reinforcement_learning {
 
     //check arguments
     RETURN_IF_FAIL(check_null_or_empty(event_id, context, _trace_logger.get(), status));
+    utility::request_span request(_span_tracer.get(), "choose_rank", event_id);
+    return choose_rank_impl(event_id, context, nullptr, nullptr, flags, response, status);
+  }
+
+  //here the event_id is auto-generated
+  int live_model_impl::choose_rank(const char* context, unsigned int flags, ranking_response& response, api_status* status) {
+    char uuid[utility::UUID_STRING_LENGTH + 1];
+    utility::generate_uuid(uuid);
+    return choose_rank(uuid, context, flags, response,
+      status);
+  }
+
+  int live_model_impl::choose_rank(const char* event_id, uint64_t shared_context, const char* actions_json, unsigned int flags, ranking_response& response,
+    api_status* status) {
+    response.clear();
+    //clear previous errors if any
+    api_status::try_clear(status);
+
+    //check arguments
+    RETURN_IF_FAIL(check_null_or_empty(event_id, actions_json, _trace_logger.get(), status));
+    utility::request_span request(_span_tracer.get(), "choose_rank_shared", event_id);
+
+    m::shared_context shared;
+    RETURN_IF_FAIL(_shared_contexts.get(shared_context, shared, _trace_logger.get(), status));
+
+    // The joined context is logged for training and ranked by models which cannot reuse parsed shared features
+    static thread_local std::string context;
+    {
+      utility::stage_span span("join_shared_context");
+      RETURN_IF_FAIL(u::shared_context_registry::join(*shared.features, actions_json, context, _trace_logger.get(), status));
+    }
+
+    return choose_rank_impl(event_id, context.c_str(), &shared, actions_json, flags, response, status);
+  }
+
+  int live_model_impl::register_shared_context(const char* shared_json, uint64_t& shared_context, api_status* status) {
+    //clear previous errors if any
+    api_status::try_clear(status);
+
+    RETURN_IF_FAIL(check_null_or_empty(shared_json, _trace_logger.get(), status));
+    return _shared_contexts.add(shared_json, shared_context, _trace_logger.get(), status);
+  }
+
+  int live_model_impl::unregister_shared_context(uint64_t shared_context, api_status* status) {
+    //clear previous errors if any
+    api_status::try_clear(status);
+
+    return _shared_contexts.remove(shared_context, _trace_logger.get(), status);
+  }
+
+  int live_model_impl::choose_rank_impl(const char* event_id, const char* context, const m::shared_context* shared, const char* actions,
+    unsigned int flags, ranking_response& response, api_status* status) {
     if (!_model_ready) {
       RETURN_IF_FAIL(explore_only(event_id, context, response, status));
       response.set_model_id("N/A");
     }
     else {
-      RETURN_IF_FAIL(explore_exploit(event_id, context, response, status));
+      RETURN_IF_FAIL(explore_exploit(event_id, context, shared, actions, response, status));
     }
     response.set_event_id(event_id);
 
@@ -89,7 +147,10 @@ namespace reinforcement_learning {
       RETURN_IF_FAIL(reset_action_order(response));
     }
 
-    RETURN_IF_FAIL(_interaction_logger->log(context, flags, response, status, _learning_mode));
+    {
+      utility::stage_span span("log_interaction");
+      RETURN_IF_FAIL(_interaction_logger->log(context, flags, response, status, _learning_mode));
+    }
 
     if (_learning_mode == APPRENTICE)
     {
@@ -105,13 +166,6 @@ namespace reinforcement_learning {
     return error_code::success;
   }
 
-  //here the event_id is auto-generated
-  int live_model_impl::choose_rank(const char* context, unsigned int flags, ranking_response& response, api_status* status) {
-    const auto uuid = boost::uuids::to_string(boost::uuids::random_generator()());
-    return choose_rank(uuid.c_str(), context, flags, response,
-      status);
-  }
-
   int live_model_impl::request_continuous_action(const char* event_id, const char* context, unsigned int flags, continuous_action_response& response, api_status* status)
   {
     response.clear();
@@ -119,14 +173,20 @@ namespace reinforcement_learning {
     api_status::try_clear(status);
 
     RETURN_IF_FAIL(check_null_or_empty(event_id, context, _trace_logger.get(), status));
+    utility::request_span request(_span_tracer.get(), "request_continuous_action", event_id);
 
     float action;
     float pdf_value;
     std::string model_version;
 
-    RETURN_IF_FAIL(_model->choose_continuous_action(context, action, pdf_value, model_version, status));
+    // The seed used is composed of uniform_hash(app_id) + uniform_hash(event_id)
+    const uint64_t seed = uniform_hash(event_id, strlen(event_id), 0) + _seed_shift;
+    RETURN_IF_FAIL(_model->choose_continuous_action(seed, context, action, pdf_value, model_version, status));
     RETURN_IF_FAIL(populate_response(action, pdf_value, std::string(event_id), std::string(model_version), response, _trace_logger.get(), status));
-    RETURN_IF_FAIL(_interaction_logger->log_continuous_action(context, flags, response, status));
+    {
+      utility::stage_span span("log_interaction");
+      RETURN_IF_FAIL(_interaction_logger->log_continuous_action(context, flags, response, status));
+    }
 
     if (_watchdog.has_background_error_been_reported())
     {
@@ -138,8 +198,9 @@ namespace reinforcement_learning {
 
   int live_model_impl::request_continuous_action(const char* context, unsigned int flags, continuous_action_response& response, api_status* status)
   {
-    const auto uuid = boost::uuids::to_string(boost::uuids::random_generator()());
-    return request_continuous_action(uuid.c_str(), context, flags, response, status);
+    char uuid[utility::UUID_STRING_LENGTH + 1];
+    utility::generate_uuid(uuid);
+    return request_continuous_action(uuid, context, flags, response, status);
   }
 
   int live_model_impl::request_decision(const char* context_json, unsigned int flags, decision_response& resp, api_status* status)
@@ -155,9 +216,13 @@ namespace reinforcement_learning {
 
     //check arguments
     RETURN_IF_FAIL(check_null_or_empty(context_json, _trace_logger.get(), status));
+    utility::request_span request(_span_tracer.get(), "request_decision", nullptr);
 
     utility::ContextInfo context_info;
-    RETURN_IF_FAIL(utility::get_context_info(context_json, context_info, _trace_logger.get(), status));
+    {
+      utility::stage_span span("get_context_info");
+      RETURN_IF_FAIL(utility::get_context_info(context_json, context_info, _trace_logger.get(), status));
+    }
 
     // Ensure multi comes before slots, this is a current limitation of the parser.
     if(context_info.slots.size() < 1 || context_info.actions.size() < 1 || context_info.slots[0].first < context_info.actions[0].first) {
@@ -185,7 +250,10 @@ namespace reinforcement_learning {
     // This will behave correctly both before a model is loaded and after. Prior to a model being loaded it operates in explore only mode.
     RETURN_IF_FAIL(_model->request_decision(event_ids, context_json, actions_ids, actions_pdfs, model_version, status));
     RETURN_IF_FAIL(populate_response(actions_ids, actions_pdfs, event_ids, std::string(model_version), resp, _trace_logger.get(), status));
-    RETURN_IF_FAIL(_interaction_logger->log_decisions(event_ids, context_json, flags, actions_ids, actions_pdfs, model_version, status));
+    {
+      utility::stage_span span("log_interaction");
+      RETURN_IF_FAIL(_interaction_logger->log_decisions(event_ids, context_json, flags, std::move(actions_ids), std::move(actions_pdfs), model_version, status));
+    }
 
     // Check watchdog for any background errors. Do this at the end of function so that the work is still done.
     if (_watchdog.has_background_error_been_reported()) {
@@ -205,7 +273,10 @@ namespace reinforcement_learning {
     RETURN_IF_FAIL(check_null_or_empty(context_json, _trace_logger.get(), status));
 
     utility::ContextInfo context_info;
-    RETURN_IF_FAIL(utility::get_context_info(context_json, context_info, _trace_logger.get(), status));
+    {
+      utility::stage_span span("get_context_info");
+      RETURN_IF_FAIL(utility::get_context_info(context_json, context_info, _trace_logger.get(), status));
+    }
 
     // Ensure multi comes before slots, this is a current limitation of the parser.
     if (context_info.slots.size() < 1 || context_info.actions.size() < 1 || context_info.slots[0].first < context_info.actions[0].first) {
@@ -223,8 +294,9 @@ namespace reinforcement_learning {
 
   int live_model_impl::request_multi_slot_decision(const char * context_json, unsigned int flags, multi_slot_response& resp, const std::vector<int>& baseline_actions, api_status* status)
   {
-    const auto uuid = boost::uuids::to_string(boost::uuids::random_generator()());
-    return request_multi_slot_decision(uuid.c_str(), context_json, flags, resp, baseline_actions, status);
+    char uuid[utility::UUID_STRING_LENGTH + 1];
+    utility::generate_uuid(uuid);
+    return request_multi_slot_decision(uuid, context_json, flags, resp, baseline_actions, status);
   }
 
   int live_model_impl::request_multi_slot_decision(const char * event_id, const char * context_json, unsigned int flags, multi_slot_response& resp, const std::vector<int>& baseline_actions, api_status* status)
@@ -241,9 +313,13 @@ namespace reinforcement_learning {
     std::vector<std::vector<float>> action_pdfs;
     std::string model_version;
 
+    utility::request_span request(_span_tracer.get(), "request_multi_slot_decision", event_id);
     RETURN_IF_FAIL(live_model_impl::request_multi_slot_decision_impl(event_id, context_json, slot_ids, action_ids, action_pdfs, model_version, status));
     RETURN_IF_FAIL(populate_multi_slot_response(action_ids, action_pdfs, std::string(event_id), std::string(model_version), slot_ids, resp, _trace_logger.get(), status));
-    RETURN_IF_FAIL(_interaction_logger->log_decision(event_id, context_json, flags, action_ids, action_pdfs, model_version, slot_ids, status, baseline_actions, _learning_mode));
+    {
+      utility::stage_span span("log_interaction");
+      RETURN_IF_FAIL(_interaction_logger->log_decision(event_id, context_json, flags, std::move(action_ids), std::move(action_pdfs), model_version, slot_ids, status, baseline_actions, _learning_mode));
+    }
 
     if (_learning_mode == APPRENTICE || _learning_mode == LOGGINGONLY)
     {
@@ -261,8 +337,9 @@ namespace reinforcement_learning {
 
   int live_model_impl::request_multi_slot_decision(const char * context_json, unsigned int flags, multi_slot_response_detailed& resp, const std::vector<int>& baseline_actions, api_status* status)
   {
-    const auto uuid = boost::uuids::to_string(boost::uuids::random_generator()());
-    return request_multi_slot_decision(uuid.c_str(), context_json, flags, resp, baseline_actions, status);
+    char uuid[utility::UUID_STRING_LENGTH + 1];
+    utility::generate_uuid(uuid);
+    return request_multi_slot_decision(uuid, context_json, flags, resp, baseline_actions, status);
   }
 
   int live_model_impl::request_multi_slot_decision(const char * event_id, const char * context_json, unsigned int flags, multi_slot_response_detailed& resp, const std::vector<int>& baseline_actions, api_status* status)
@@ -279,13 +356,17 @@ namespace reinforcement_learning {
     std::vector<std::vector<float>> action_pdfs;
     std::string model_version;
 
+    utility::request_span request(_span_tracer.get(), "request_multi_slot_decision", event_id);
     RETURN_IF_FAIL(live_model_impl::request_multi_slot_decision_impl(event_id, context_json, slot_ids, action_ids, action_pdfs, model_version, status));
 
     //set the size of buffer in response to match the number of slots
     resp.resize(slot_ids.size());
 
     RETURN_IF_FAIL(populate_multi_slot_response_detailed(action_ids, action_pdfs, std::string(event_id), std::string(model_version), slot_ids, resp, _trace_logger.get(), status));
-    RETURN_IF_FAIL(_interaction_logger->log_decision(event_id, context_json, flags, action_ids, action_pdfs, model_version, slot_ids, status, baseline_actions, _learning_mode));
+    {
+      utility::stage_span span("log_interaction");
+      RETURN_IF_FAIL(_interaction_logger->log_decision(event_id, context_json, flags, std::move(action_ids), std::move(action_pdfs), model_version, slot_ids, status, baseline_actions, _learning_mode));
+    }
 
     if (_learning_mode == APPRENTICE || _learning_mode == LOGGINGONLY)
     {
@@ -356,14 +437,57 @@ namespace reinforcement_learning {
     model_management::model_data md;
     RETURN_IF_FAIL(_transport->get_data(md, status));
 
+    return update_model(md, status);
+  }
+
+  int live_model_impl::update_model(const model_management::model_data& data, api_status* status) {
     bool model_ready = false;
-    RETURN_IF_FAIL(_model->update(md, model_ready, status));
+    const int scode = _model->update(data, model_ready, status);
+
+    if (scode == error_code::model_delta_base_mismatch) {
+      // The delta was published for another model: load the full model, which it may have been built against
+      TRACE_INFO(_trace_logger, "Model delta does not apply to the current model, getting the full model");
+      api_status::try_clear(status);
+      _transport->request_full_model();
+
+      model_management::model_data full_model;
+      RETURN_IF_FAIL(_transport->get_data(full_model, status));
+      if (full_model.refresh_count() == 0) {
+        // The full model did not change since it was loaded: keep the current one
+        return error_code::success;
+      }
+      RETURN_IF_FAIL(_model->update(full_model, model_ready, status));
+    }
+    else if (scode != error_code::success) {
+      return scode;
+    }
 
     _model_ready = model_ready;
 
     return error_code::success;
   }
 
+  int live_model_impl::get_interaction_queue_stats(queue_stats& stats, api_status* status) const {
+    return _interaction_logger->get_queue_stats(stats, status);
+  }
+
+  int live_model_impl::get_observation_queue_stats(queue_stats& stats, api_status* status) const {
+    return _outcome_logger->get_queue_stats(stats, status);
+  }
+
+  int live_model_impl::get_prediction_cache_stats(prediction_cache_stats& stats, api_status* status) const {
+    return _model->get_prediction_cache_stats(stats, status);
+  }
+
+  int live_model_impl::get_metrics(metrics_snapshot& metrics, api_status* status) const {
+    utility::metrics_registry::instance().get(metrics);
+    return error_code::success;
+  }
+
+  int live_model_impl::update_configuration(const utility::configuration& changes, api_status* status) {
+    return _config_snapshot.reload(changes, _trace_logger.get(), status);
+  }
+
   live_model_impl::live_model_impl(
     const utility::configuration& config,
     const error_fn fn,
@@ -372,9 +496,11 @@ namespace reinforcement_learning {
     data_transport_factory_t* t_factory,
     model_factory_t* m_factory,
     sender_factory_t* sender_factory,
-    time_provider_factory_t* time_provider_factory
+    time_provider_factory_t* time_provider_factory,
+    std::shared_ptr<live_model_host_impl> host
   )
-    : _configuration(config),
+    : _host(std::move(host)),
+    _configuration(config),
     _error_cb(fn, err_context),
     _data_cb(_handle_model_update, this),
     _watchdog(&_error_cb),
@@ -402,15 +528,91 @@ namespace reinforcement_learning {
     i_trace* plogger;
     RETURN_IF_FAIL(_trace_factory->create(&plogger, trace_impl, _configuration, nullptr, status));
     _trace_logger.reset(plogger);
+    if (_trace_logger == nullptr) {
+      return error_code::success;
+    }
+
+    const auto level_str = _configuration.get(name::TRACE_LOG_LEVEL, STR_LEVEL_DEBUG);
+    int level;
+    if (!get_log_level(level_str, level)) {
+      RETURN_ERROR_ARG(nullptr, status, invalid_argument, "Unknown trace level ", level_str);
+    }
+
+    if (_configuration.get_bool(name::TRACE_LOG_ASYNC, value::DEFAULT_TRACE_LOG_ASYNC)) {
+      const auto queue_size = _configuration.get_int(name::TRACE_LOG_ASYNC_QUEUE_SIZE, value::DEFAULT_TRACE_LOG_ASYNC_QUEUE_SIZE);
+      std::unique_ptr<async_tracer> async(new async_tracer(_trace_logger.release(), static_cast<size_t>((std::max)(1, queue_size))));
+      RETURN_IF_FAIL(async->init(status));
+      _trace_logger.reset(async.release());
+    }
+    // Filtering in front of the async tracer keeps the dropped messages out of its queue
+    if (level > LEVEL_DEBUG) {
+      _trace_logger.reset(new level_filter_tracer(_trace_logger.release(), level));
+    }
     TRACE_INFO(_trace_logger, "API Tracing initialized");
     _watchdog.set_trace_log(_trace_logger.get());
     return error_code::success;
   }
 
+  int live_model_impl::init_background_executor(api_status* status) {
+    if (_host != nullptr && _host->executor() != nullptr) {
+      _watchdog.set_executor(_host->executor());
+      return error_code::success;
+    }
+
+    // Without shared threads every background proc keeps its own thread
+    const auto threads = _configuration.get_int(name::BACKGROUND_EXECUTOR_THREADS, value::DEFAULT_BACKGROUND_EXECUTOR_THREADS);
+    if (threads <= 0) {
+      return error_code::success;
+    }
+
+    std::shared_ptr<utility::background_executor> executor;
+    RETURN_IF_FAIL(utility::background_executor::get_shared(static_cast<size_t>(threads), executor, _trace_logger.get(), status));
+    _watchdog.set_executor(std::move(executor));
+    return error_code::success;
+  }
+
+  int live_model_impl::init_metrics(api_status* status) {
+    const auto interval_ms = _configuration.get_int(name::METRICS_DUMP_INTERVAL_MS, value::DEFAULT_METRICS_DUMP_INTERVAL_MS);
+    if (interval_ms <= 0) {
+      return error_code::success;
+    }
+
+    _metrics_dumper.reset(new utility::metrics_dumper(utility::metrics_registry::instance(), _configuration.get(name::METRICS_DUMP_FILE_NAME, nullptr), _trace_logger.get()));
+    RETURN_IF_FAIL(_metrics_dumper->init(status));
+    _bg_metrics_proc.reset(new utility::periodic_background_proc<utility::metrics_dumper>(interval_ms, _watchdog, "Metrics dumper", &_error_cb));
+    return _bg_metrics_proc->init(_metrics_dumper.get(), status);
+  }
+
+  int live_model_impl::init_span_tracer(api_status* status) {
+    const auto sample_rate = _configuration.get_int(name::TRACE_SPANS_SAMPLE_RATE, value::DEFAULT_TRACE_SPANS_SAMPLE_RATE);
+    const auto threshold_us = _configuration.get_int(name::TRACE_SPANS_THRESHOLD_US, value::DEFAULT_TRACE_SPANS_THRESHOLD_US);
+    if (sample_rate <= 0 && threshold_us <= 0) {
+      return error_code::success;
+    }
+
+    const auto max_pending = _configuration.get_int(name::TRACE_SPANS_MAX_PENDING, value::DEFAULT_TRACE_SPANS_MAX_PENDING);
+    _span_tracer.reset(new utility::span_tracer(
+      static_cast<uint64_t>((std::max)(0, sample_rate)),
+      static_cast<uint64_t>((std::max)(0, threshold_us)),
+      static_cast<size_t>((std::max)(0, max_pending)),
+      _configuration.get(name::TRACE_SPANS_FILE_NAME, value::DEFAULT_TRACE_SPANS_FILE_NAME),
+      _trace_logger.get()));
+    RETURN_IF_FAIL(_span_tracer->init(status));
+
+    const auto flush_interval_ms = _configuration.get_int(name::TRACE_SPANS_FLUSH_INTERVAL_MS, value::DEFAULT_TRACE_SPANS_FLUSH_INTERVAL_MS);
+    _bg_span_proc.reset(new utility::periodic_background_proc<utility::span_tracer>(flush_interval_ms, _watchdog, "Span tracer", &_error_cb));
+    return _bg_span_proc->init(_span_tracer.get(), status);
+  }
+
   int live_model_impl::init_model(api_status* status) {
     const auto model_impl = _configuration.get(name::MODEL_IMPLEMENTATION, value::VW);
-    m::i_model* pmodel;
-    RETURN_IF_FAIL(_m_factory->create(&pmodel, model_impl, _configuration, _trace_logger.get(), status));
+    m::i_model* pmodel = nullptr;
+    if (_host != nullptr) {
+      RETURN_IF_FAIL(_host->create_model(model_impl, _configuration, &pmodel, status));
+    }
+    if (pmodel == nullptr) {
+      RETURN_IF_FAIL(_m_factory->create(&pmodel, model_impl, _configuration, _trace_logger.get(), status));
+    }
     _model.reset(pmodel);
     return error_code::success;
   }
@@ -421,7 +623,7 @@ namespace reinforcement_learning {
     i_sender* ranking_data_sender;
 
     // Use the name to create an instance of raw data sender for interactions
-    RETURN_IF_FAIL(_sender_factory->create(&ranking_data_sender, ranking_sender_impl, _configuration, &_error_cb, _trace_logger.get(), status));
+    RETURN_IF_FAIL(create_sender(ranking_sender_impl, &ranking_data_sender, status));
     RETURN_IF_FAIL(ranking_data_sender->init(status));
 
     // Create a message sender that will prepend the message with a preamble and send the raw data using the
@@ -437,12 +639,13 @@ namespace reinforcement_learning {
 
     //Create the logger extension
     _logger_extensions.reset(logger::i_logger_extensions::get_extensions(_configuration, logger_extensions_time_provider));
+    _logger_extensions->set_config_snapshot(&_config_snapshot);
 
     i_time_provider* ranking_time_provider;
     RETURN_IF_FAIL(_time_provider_factory->create(&ranking_time_provider, time_provider_impl, _configuration, _trace_logger.get(), status));
 
     // Create a logger for interactions that will use msg sender to send interaction messages
-    _interaction_logger.reset(new logger::interaction_logger_facade(_model->model_type(), _configuration, ranking_msg_sender, _watchdog, ranking_time_provider, *_logger_extensions.get(), &_error_cb));
+    _interaction_logger.reset(new logger::interaction_logger_facade(_model->model_type(), _configuration, ranking_msg_sender, _watchdog, ranking_time_provider, *_logger_extensions.get(), &_error_cb, &_config_snapshot));
     RETURN_IF_FAIL(_interaction_logger->init(status));
 
     // Get the name of raw data (as opposed to message) sender for observations.
@@ -450,7 +653,7 @@ namespace reinforcement_learning {
     i_sender* outcome_sender;
 
     // Use the name to create an instance of raw data sender for observations
-    RETURN_IF_FAIL(_sender_factory->create(&outcome_sender, outcome_sender_impl, _configuration, &_error_cb, _trace_logger.get(), status));
+    RETURN_IF_FAIL(create_sender(outcome_sender_impl, &outcome_sender, status));
     RETURN_IF_FAIL(outcome_sender->init(status));
 
     // Create a message sender that will prepend the message with a preamble and send the raw data using the
@@ -463,12 +666,23 @@ namespace reinforcement_learning {
     RETURN_IF_FAIL(_time_provider_factory->create(&observation_time_provider, time_provider_impl, _configuration, _trace_logger.get(), status));
 
     // Create a logger for observations that will use msg sender to send observation messages
-    _outcome_logger.reset(new logger::observation_logger_facade(_configuration, outcome_msg_sender, _watchdog, observation_time_provider, &_error_cb));
+    _outcome_logger.reset(new logger::observation_logger_facade(_configuration, outcome_msg_sender, _watchdog, observation_time_provider, &_error_cb, &_config_snapshot));
     RETURN_IF_FAIL(_outcome_logger->init(status));
 
     return error_code::success;
   }
 
+  int live_model_impl::create_sender(const char* impl, i_sender** retval, api_status* status) {
+    // Hosted apps share the senders of their hubs
+    if (_host != nullptr) {
+      RETURN_IF_FAIL(_host->create_sender(impl, _configuration, retval, status));
+      if (*retval != nullptr) {
+        return error_code::success;
+      }
+    }
+    return _sender_factory->create(retval, impl, _configuration, &_error_cb, _trace_logger.get(), status);
+  }
+
   void inline live_model_impl::_handle_model_update(const m::model_data& data, live_model_impl* ctxt) {
     ctxt->handle_model_update(data);
   }
@@ -481,13 +695,9 @@ namespace reinforcement_learning {
 
     api_status status;
 
-    bool model_ready = false;
-
-    if (_model->update(data, model_ready, &status) != error_code::success) {
+    if (update_model(data, &status) != error_code::success) {
       _error_cb.report_error(status);
-      return;
     }
-    _model_ready = model_ready;
   }
 
   int live_model_impl::explore_only(const char* event_id, const char* context, ranking_response& response,
@@ -495,19 +705,23 @@ namespace reinforcement_learning {
 
     // Generate egreedy pdf
     utility::ContextInfo context_info;
-    RETURN_IF_FAIL(utility::get_context_info(context, context_info, _trace_logger.get(), status));
+    {
+      utility::stage_span span("get_context_info");
+      RETURN_IF_FAIL(utility::get_context_info(context, context_info, _trace_logger.get(), status));
+    }
 
     size_t action_count = context_info.actions.size();
     if(action_count < 1) {
         RETURN_ERROR_LS(_trace_logger.get(), status, json_no_actions_found) << "Context must have at least one action";
     }
 
+    utility::stage_span span("sampling");
     vector<float> pdf(action_count);
     // Generate a pdf with epsilon distributed between all action.
     // The top action gets the remaining (1 - epsilon)
     // Assume that the user's top choice for action is at index 0
     const auto top_action_id = 0;
-    auto scode = e::generate_epsilon_greedy(_initial_epsilon, top_action_id, begin(pdf), end(pdf));
+    auto scode = explore_kernels::generate_epsilon_greedy(_config_snapshot.get_float(utility::config_key::INITIAL_EPSILON), top_action_id, pdf.data(), pdf.data() + pdf.size());
     if (S_EXPLORATION_OK != scode) {
       RETURN_ERROR_LS(_trace_logger.get(), status, exploration_error) << "Exploration error code: " << scode;
     }
@@ -517,7 +731,7 @@ namespace reinforcement_learning {
 
     // Pick a slot using the pdf. NOTE: sample_after_normalizing() can change the pdf
     uint32_t chosen_index;
-    scode = e::sample_after_normalizing(seed, begin(pdf), end(pdf), chosen_index);
+    scode = explore_kernels::sample_after_normalizing(seed, pdf.data(), pdf.data() + pdf.size(), chosen_index);
 
     if (S_EXPLORATION_OK != scode) {
       RETURN_ERROR_LS(_trace_logger.get(), status, exploration_error) << "Exploration error code: " << scode;
@@ -551,25 +765,37 @@ namespace reinforcement_learning {
     return error_code::success;
   }
 
-  int live_model_impl::explore_exploit(const char* event_id, const char* context, ranking_response& response,
-    api_status* status) const {
+  int live_model_impl::explore_exploit(const char* event_id, const char* context, const m::shared_context* shared, const char* actions,
+    ranking_response& response, api_status* status) const {
     // The seed used is composed of uniform_hash(app_id) + uniform_hash(event_id)
     const uint64_t seed = uniform_hash(event_id, strlen(event_id), 0) + _seed_shift;
 
-    std::vector<int> action_ids;
-    std::vector<float> action_pdf;
-    std::string model_version;
+    // Scratch space reused by every call made on this thread. Together with a reused response
+    // the model output reaches the response without allocating once the buffers have grown.
+    static thread_local ranking_buffer ranking;
+    static thread_local std::string model_version;
 
-    RETURN_IF_FAIL(_model->choose_rank(seed, context, action_ids, action_pdf, model_version, status));
+    if (shared != nullptr) {
+      RETURN_IF_FAIL(_model->choose_rank_shared(seed, *shared, actions, context, ranking, model_version, status));
+    }
+    else {
+      RETURN_IF_FAIL(_model->choose_rank_flat(seed, context, ranking, model_version, status));
+    }
 
-    return sample_and_populate_response(seed, action_ids, action_pdf, std::move(model_version), response, _trace_logger.get(), status);
+    utility::stage_span span("sampling");
+    return sample_and_populate_response(seed, ranking, model_version.c_str(), response, _trace_logger.get(), status);
   }
 
   int live_model_impl::init_model_mgmt(api_status* status) {
     // Initialize transport for the model using transport factory
     const auto tranport_impl = _configuration.get(name::MODEL_SRC, value::get_default_data_transport());
     m::i_data_transport* ptransport;
-    RETURN_IF_FAIL(_t_factory->create(&ptransport, tranport_impl, _configuration, status));
+    if (_host != nullptr) {
+      RETURN_IF_FAIL(_host->create_data_transport(tranport_impl, _configuration, &ptransport, status));
+    }
+    else {
+      RETURN_IF_FAIL(_t_factory->create(&ptransport, tranport_impl, _configuration, status));
+    }
     // This class manages lifetime of transport
     this->_transport.reset(ptransport);
 
@@ -656,7 +882,10 @@ namespace reinforcement_learning {
     {
       if (complete_ids[i].empty())
       {
-        complete_ids[i] = boost::uuids::to_string(boost::uuids::random_generator()()) + std::to_string(seed_shift);
+        char uuid[utility::UUID_STRING_LENGTH + 1];
+        utility::generate_uuid(uuid);
+        complete_ids[i].assign(uuid, utility::UUID_STRING_LENGTH);
+        complete_ids[i] += std::to_string(seed_shift);
       }
     }
   }
@@ -4,7 +4,11 @@
 #include "model_mgmt.h"
 #include "model_mgmt/data_callback_fn.h"
 #include "model_mgmt/model_downloader.h"
+#include "utility/config_snapshot.h"
+#include "utility/metrics_registry.h"
 #include "utility/periodic_background_proc.h"
+#include "utility/shared_context_registry.h"
+#include "utility/span_tracer.h"
 #include "multi_slot_response_detailed.h"
 
 #include "factory_resolver.h"
@@ -15,6 +19,7 @@
 
 namespace reinforcement_learning
 {
+  class live_model_host_impl;
   class safe_vw_factory;
   class safe_vw;
   class ranking_response;
@@ -29,6 +34,9 @@ namespace reinforcement_learning
     int choose_rank(const char* event_id, const char* context, unsigned int flags, ranking_response& response, api_status* status);
     //here the event_id is auto-generated
     int choose_rank(const char* context, unsigned int flags, ranking_response& response, api_status* status);
+    int choose_rank(const char* event_id, uint64_t shared_context, const char* actions_json, unsigned int flags, ranking_response& response, api_status* status);
+    int register_shared_context(const char* shared_json, uint64_t& shared_context, api_status* status);
+    int unregister_shared_context(uint64_t shared_context, api_status* status);
     int request_continuous_action(const char* event_id, const char* context, unsigned int flags, continuous_action_response& response, api_status* status);
     //here the event_id is auto-generated
     int request_continuous_action(const char* context, unsigned int flags, continuous_action_response& response, api_status* status);
@@ -50,6 +58,12 @@ namespace reinforcement_learning
 
     int refresh_model(api_status* status);
 
+    int get_interaction_queue_stats(queue_stats& stats, api_status* status) const;
+    int get_observation_queue_stats(queue_stats& stats, api_status* status) const;
+    int get_prediction_cache_stats(prediction_cache_stats& stats, api_status* status) const;
+    int get_metrics(metrics_snapshot& metrics, api_status* status) const;
+    int update_configuration(const utility::configuration& changes, api_status* status);
+
     explicit live_model_impl(
       const utility::configuration& config,
       error_fn fn,
@@ -58,7 +72,8 @@ namespace reinforcement_learning
       data_transport_factory_t* t_factory,
       model_factory_t* m_factory,
       sender_factory_t* sender_factory,
-      time_provider_factory_t* time_provider_factory);
+      time_provider_factory_t* time_provider_factory,
+      std::shared_ptr<live_model_host_impl> host = nullptr);
 
     live_model_impl(const live_model_impl&) = delete;
     live_model_impl(live_model_impl&&) = delete;
@@ -71,10 +86,16 @@ namespace reinforcement_learning
     int init_model_mgmt(api_status* status);
     int init_loggers(api_status* status);
     int init_trace(api_status* status);
+    int init_background_executor(api_status* status);
+    int init_metrics(api_status* status);
+    int init_span_tracer(api_status* status);
+    int create_sender(const char* impl, i_sender** retval, api_status* status);
     static void _handle_model_update(const model_management::model_data& data, live_model_impl* ctxt);
     void handle_model_update(const model_management::model_data& data);
+    int update_model(const model_management::model_data& data, api_status* status);
     int explore_only(const char* event_id, const char* context, ranking_response& response, api_status* status) const;
-    int explore_exploit(const char* event_id, const char* context, ranking_response& response, api_status* status) const;
+    int explore_exploit(const char* event_id, const char* context, const model_management::shared_context* shared, const char* actions, ranking_response& response, api_status* status) const;
+    int choose_rank_impl(const char* event_id, const char* context, const model_management::shared_context* shared, const char* actions, unsigned int flags, ranking_response& response, api_status* status);
     template<typename D>
     int report_outcome_internal(const char* event_id, D outcome, api_status* status);
     template<typename D, typename I>
@@ -83,9 +104,12 @@ namespace reinforcement_learning
 
   private:
     // Internal implementation state
+    // Set when hosted, shared objects must outlive the ones below
+    std::shared_ptr<live_model_host_impl> _host;
     std::atomic_bool _model_ready{false};
-    float _initial_epsilon = 0.2f;
     utility::configuration _configuration;
+    // Typed settings, resolved at init and read by the loggers until they are destroyed
+    utility::config_snapshot _config_snapshot;
     error_callback_fn _error_cb;
     model_management::data_callback_fn _data_cb;
     utility::watchdog _watchdog;
@@ -100,6 +124,7 @@ namespace reinforcement_learning
 
     std::unique_ptr<model_management::i_data_transport> _transport{nullptr};
     std::unique_ptr<model_management::i_model> _model{nullptr};
+    utility::shared_context_registry _shared_contexts;
 
     std::unique_ptr<logger::i_logger_extensions> _logger_extensions{nullptr};
     std::unique_ptr<logger::interaction_logger_facade> _interaction_logger{nullptr};
@@ -109,6 +134,10 @@ namespace reinforcement_learning
     std::unique_ptr<i_trace> _trace_logger{nullptr};
 
     std::unique_ptr<utility::periodic_background_proc<model_management::model_downloader>> _bg_model_proc;
+    std::unique_ptr<utility::metrics_dumper> _metrics_dumper{nullptr};
+    std::unique_ptr<utility::periodic_background_proc<utility::metrics_dumper>> _bg_metrics_proc;
+    std::unique_ptr<utility::span_tracer> _span_tracer{nullptr};
+    std::unique_ptr<utility::periodic_background_proc<utility::span_tracer>> _bg_span_proc;
     uint64_t _seed_shift;
   };
 
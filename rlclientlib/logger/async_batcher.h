@@ -6,13 +6,20 @@
 #include "error_callback_fn.h"
 #include "err_constants.h"
 #include "data_buffer.h"
+#include "queue_stats.h"
 #include "utility/periodic_background_proc.h"
 
 #include "serialization/fb_serializer.h"
 #include "serialization/json_serializer.h"
 #include "message_sender.h"
 #include "utility/config_helper.h"
-#include "utility/object_pool.h"
+#include "utility/config_snapshot.h"
+#include "utility/data_buffer_pool.h"
+#include "utility/metrics_registry.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
 
 namespace reinforcement_learning {
   class error_callback_fn;
@@ -30,6 +37,34 @@ namespace reinforcement_learning { namespace logger {
     virtual int append(TEvent& evt, api_status* status = nullptr) = 0;
 
     virtual int run_iteration(api_status* status) = 0;
+
+    virtual void get_stats(queue_stats& stats) = 0;
+  };
+
+  // Process wide metrics of the batchers of one section, see live_model::get_metrics
+  struct batcher_metrics {
+    explicit batcher_metrics(const std::string& section)
+      : queue_depth(utility::metrics_registry::instance().gauge(section + ".queue.depth"))
+      , queue_bytes(utility::metrics_registry::instance().gauge(section + ".queue.bytes"))
+      , dropped_events(utility::metrics_registry::instance().counter(section + ".queue.dropped_events"))
+      , block_timeouts(utility::metrics_registry::instance().counter(section + ".queue.block_timeouts"))
+      , sent_events(utility::metrics_registry::instance().counter(section + ".sent_events"))
+      , batch_events(utility::metrics_registry::instance().histogram(section + ".batch.events"))
+      , batch_bytes(utility::metrics_registry::instance().histogram(section + ".batch.bytes"))
+      , batch_send_us(utility::metrics_registry::instance().histogram(section + ".batch.send_us"))
+      , flush_us(utility::metrics_registry::instance().histogram(section + ".flush_us"))
+    {}
+
+    // Queue levels are sampled at the start of every flush
+    utility::metrics_gauge& queue_depth;
+    utility::metrics_gauge& queue_bytes;
+    utility::metrics_counter& dropped_events;
+    utility::metrics_counter& block_timeouts;
+    utility::metrics_counter& sent_events;
+    utility::metrics_histogram& batch_events;
+    utility::metrics_histogram& batch_bytes;
+    utility::metrics_histogram& batch_send_us;
+    utility::metrics_histogram& flush_us;
   };
 
   // This class takes uses a queue and a background thread to accumulate events, and send them by batch asynchronously.
@@ -46,7 +81,16 @@ namespace reinforcement_learning { namespace logger {
 
     int run_iteration(api_status* status) override;
 
+    void get_stats(queue_stats& stats) override;
+
   private:
+    float admission_pass_prob() const;
+    void wait_for_room();
+    void update_rates(size_t drained);
+    void count_dropped(uint64_t dropped);
+    void report_queue_level(size_t depth, size_t bytes);
+    void apply_reloaded_config();
+
     int fill_buffer(std::shared_ptr<utility::data_buffer>& retbuffer,
       size_t& remaining, 
       api_status* status);
@@ -66,16 +110,40 @@ namespace reinforcement_learning { namespace logger {
 
     event_queue<TEvent> _queue;       // A queue to accumulate batch of events.
     size_t _send_high_water_mark;
+    const bool _flush_on_high_water_mark;
     error_callback_fn* _perror_cb;
     shared_state_t& _shared_state;
 
     utility::periodic_background_proc<async_batcher> _periodic_background_proc;
     float _pass_prob;
-    queue_mode_enum _queue_mode;
+    std::atomic<queue_mode_enum> _queue_mode;
+    std::atomic<int> _block_timeout_ms;
+    float _adaptive_low_water_mark;
+    float _adaptive_min_pass_prob;
     std::condition_variable _cv;
     std::mutex _m;
-    utility::object_pool<utility::data_buffer> _buffer_pool;
+    utility::data_buffer_pool _buffer_pool;
     const char* _batch_content_encoding;
+
+    // Reloadable settings are followed from the snapshot by the background thread
+    const utility::config_snapshot* _snapshot;
+    const utility::config_section _config_section;
+    std::atomic<uint64_t> _snapshot_version;
+    int _send_batch_interval_ms;
+
+    // Admission control state. Producers only read _controller_pass_prob and bump the counters.
+    std::atomic<float> _controller_pass_prob;
+    std::atomic<float> _drain_rate;
+    std::atomic<size_t> _appended_since_flush;
+    std::atomic<uint64_t> _dropped_events;
+    std::atomic<uint64_t> _block_timeouts;
+    std::atomic<bool> _flush_requested;
+    std::chrono::steady_clock::time_point _last_flush;
+
+    batcher_metrics _metrics;
+    // Queue level last added to the process wide gauges, taken back out when the batcher is destroyed
+    int64_t _reported_depth;
+    int64_t _reported_bytes;
   };
 
   template<typename TEvent, template<typename> class TSerializer>
@@ -84,24 +152,166 @@ namespace reinforcement_learning { namespace logger {
     return error_code::success;
   }
 
+  // Admission drops use a fixed drop pass so the decision for a given event id is the same
+  // in the interaction and observation queues.
+  constexpr int admission_drop_pass = -1;
+
   template<typename TEvent, template<typename> class TSerializer>
   int async_batcher<TEvent, TSerializer>::append(TEvent&& evt, api_status* status) {
+    _appended_since_flush.fetch_add(1, std::memory_order_relaxed);
+
+    const auto queue_mode = _queue_mode.load(std::memory_order_relaxed);
+    if (queue_mode_enum::ADAPTIVE == queue_mode) {
+      const float pass_prob = admission_pass_prob();
+      // try_drop records pass_prob in the event so the logged data stays unbiased
+      if (pass_prob < 1.f && evt.try_drop(pass_prob, admission_drop_pass)) {
+        count_dropped(1);
+        return error_code::success;
+      }
+    }
+
     _queue.push(std::move(evt), TSerializer<TEvent>::serializer_t::size_estimate(evt));
 
+    // Only the append which fills a batch wakes the background thread, so producers take its lock once per flush.
+    // Reloaded settings also take effect with an early flush rather than at the end of the old interval.
+    const bool wake = (_flush_on_high_water_mark && _queue.capacity() >= _send_high_water_mark) ||
+      (_snapshot != nullptr && _snapshot->version() != _snapshot_version.load(std::memory_order_relaxed));
+    if (wake && !_flush_requested.exchange(true, std::memory_order_relaxed)) {
+      _periodic_background_proc.wake();
+    }
+
     //block or drop events if the queue if full
     if (_queue.is_full()) {
-      if (queue_mode_enum::BLOCK == _queue_mode) {
-        std::unique_lock<std::mutex> lk(_m);
-        _cv.wait(lk, [this] { return !_queue.is_full(); });
+      if (queue_mode_enum::DROP == queue_mode) {
+        count_dropped(_queue.prune(_pass_prob));
       }
-      else if (queue_mode_enum::DROP == _queue_mode) {
-        _queue.prune(_pass_prob);
+      else {
+        wait_for_room();
       }
     }
 
     return error_code::success;
   }
 
+  template<typename TEvent, template<typename> class TSerializer>
+  void async_batcher<TEvent, TSerializer>::wait_for_room() {
+    // Producers also stop waiting when the queue mode is reloaded to DROP
+    const auto has_room = [this] { return !_queue.is_full() || _queue_mode.load(std::memory_order_relaxed) == queue_mode_enum::DROP; };
+    const auto block_timeout_ms = _block_timeout_ms.load(std::memory_order_relaxed);
+    std::unique_lock<std::mutex> lk(_m);
+    if (block_timeout_ms < 0) {
+      _cv.wait(lk, has_room);
+      return;
+    }
+
+    if (!_cv.wait_for(lk, std::chrono::milliseconds(block_timeout_ms), has_room)) {
+      // Gave up waiting, fall back to DROP behavior to bound the queue size
+      _block_timeouts.fetch_add(1, std::memory_order_relaxed);
+      _metrics.block_timeouts.add();
+      count_dropped(_queue.prune(_pass_prob));
+    }
+  }
+
+  // Admit everything below the low water mark, then subsample linearly down to the min pass probability
+  // as the queue fills up. The controller probability tightens this further when events arrive faster
+  // than the background thread drains them.
+  template<typename TEvent, template<typename> class TSerializer>
+  float async_batcher<TEvent, TSerializer>::admission_pass_prob() const {
+    const float fill = static_cast<float>(_queue.capacity()) / (std::max)(_queue.max_capacity(), static_cast<size_t>(1));
+    if (fill < _adaptive_low_water_mark) {
+      return 1.f;
+    }
+
+    const float headroom = (1.f - fill) / (std::max)(1.f - _adaptive_low_water_mark, 1e-6f);
+    const float fill_pass_prob = _adaptive_min_pass_prob + (1.f - _adaptive_min_pass_prob) * (std::max)(headroom, 0.f);
+    return (std::min)(fill_pass_prob, _controller_pass_prob.load(std::memory_order_relaxed));
+  }
+
+  // Called from the background thread on every flush with the number of events it is about to drain.
+  template<typename TEvent, template<typename> class TSerializer>
+  void async_batcher<TEvent, TSerializer>::update_rates(size_t drained) {
+    const auto now = std::chrono::steady_clock::now();
+    const float elapsed_s = std::chrono::duration<float>(now - _last_flush).count();
+    _last_flush = now;
+    if (elapsed_s <= 0.f) {
+      return;
+    }
+
+    const auto arrived = _appended_since_flush.exchange(0, std::memory_order_relaxed);
+    const float drain_rate = drained / elapsed_s;
+    _drain_rate.store(0.5f * _drain_rate.load(std::memory_order_relaxed) + 0.5f * drain_rate, std::memory_order_relaxed);
+
+    // Ask producers to subsample by the ratio we are able to keep up with
+    float target = 1.f;
+    if (arrived > drained && arrived > 0) {
+      target = (std::max)(static_cast<float>(drained) / arrived, _adaptive_min_pass_prob);
+    }
+    _controller_pass_prob.store(0.5f * _controller_pass_prob.load(std::memory_order_relaxed) + 0.5f * target, std::memory_order_relaxed);
+  }
+
+  template<typename TEvent, template<typename> class TSerializer>
+  void async_batcher<TEvent, TSerializer>::count_dropped(uint64_t dropped) {
+    if (dropped > 0) {
+      _dropped_events.fetch_add(dropped, std::memory_order_relaxed);
+      _metrics.dropped_events.add(dropped);
+    }
+  }
+
+  // Gauges are shared by every batcher of the section, so each batcher adds the change since its last report
+  template<typename TEvent, template<typename> class TSerializer>
+  void async_batcher<TEvent, TSerializer>::report_queue_level(size_t depth, size_t bytes) {
+    _metrics.queue_depth.add(static_cast<int64_t>(depth) - _reported_depth);
+    _metrics.queue_bytes.add(static_cast<int64_t>(bytes) - _reported_bytes);
+    _reported_depth = static_cast<int64_t>(depth);
+    _reported_bytes = static_cast<int64_t>(bytes);
+  }
+
+  // Called from the background thread before every flush
+  template<typename TEvent, template<typename> class TSerializer>
+  void async_batcher<TEvent, TSerializer>::apply_reloaded_config() {
+    const auto version = _snapshot != nullptr ? _snapshot->version() : 0;
+    if (version == _snapshot_version.load(std::memory_order_relaxed)) {
+      return;
+    }
+    _snapshot_version.store(version, std::memory_order_relaxed);
+
+    const auto queue_mode = _snapshot->get_queue_mode(_config_section);
+    if (queue_mode != _queue_mode.load(std::memory_order_relaxed)) {
+      if (!_snapshot->is_set(utility::config_key::QUEUE_BLOCK_TIMEOUT_MS, _config_section)) {
+        _block_timeout_ms.store(utility::default_queue_block_timeout_ms(queue_mode), std::memory_order_relaxed);
+      }
+      {
+        std::lock_guard<std::mutex> lk(_m);
+        _queue_mode.store(queue_mode, std::memory_order_relaxed);
+      }
+      _cv.notify_all();
+    }
+
+    const auto send_batch_interval_ms = _snapshot->get_int(utility::config_key::SEND_BATCH_INTERVAL_MS, _config_section);
+    if (send_batch_interval_ms != _send_batch_interval_ms) {
+      _send_batch_interval_ms = send_batch_interval_ms;
+      _periodic_background_proc.set_interval(send_batch_interval_ms);
+    }
+  }
+
+  template<typename TEvent, template<typename> class TSerializer>
+  void async_batcher<TEvent, TSerializer>::get_stats(queue_stats& stats) {
+    stats.queue_depth = _queue.size();
+    stats.queue_bytes = _queue.capacity();
+    stats.drain_rate = _drain_rate.load(std::memory_order_relaxed);
+    stats.admission_pass_prob = queue_mode_enum::ADAPTIVE == _queue_mode.load(std::memory_order_relaxed) ? admission_pass_prob() : 1.f;
+    stats.dropped_events = _dropped_events.load(std::memory_order_relaxed);
+    stats.block_timeouts = _block_timeouts.load(std::memory_order_relaxed);
+
+    utility::data_buffer_pool_stats pool_stats;
+    _buffer_pool.get_stats(pool_stats);
+    stats.pooled_buffers = pool_stats.pooled_buffers;
+    stats.pooled_buffer_bytes = pool_stats.pooled_bytes;
+    stats.buffers_allocated = pool_stats.allocated;
+    stats.buffers_reused = pool_stats.reused;
+    stats.buffers_discarded = pool_stats.discarded;
+  }
+
   template<typename TEvent, template<typename> class TSerializer>
   int async_batcher<TEvent, TSerializer>::append(TEvent& evt, api_status* status) {
     return append(std::move(evt), status);
@@ -109,6 +319,7 @@ namespace reinforcement_learning { namespace logger {
 
   template<typename TEvent, template<typename> class TSerializer>
   int async_batcher<TEvent, TSerializer>::run_iteration(api_status* status) {
+    apply_reloaded_config();
     flush();
     return error_code::success;
   }
@@ -124,7 +335,7 @@ namespace reinforcement_learning { namespace logger {
 
     while (remaining > 0 && collection_serializer.size() < _send_high_water_mark) {
       if (_queue.pop(&evt)) {
-        if (queue_mode_enum::BLOCK == _queue_mode) {
+        if (queue_mode_enum::DROP != _queue_mode.load(std::memory_order_relaxed)) {
           _cv.notify_one();
         }
         RETURN_IF_FAIL(collection_serializer.add(evt, status));
@@ -139,13 +350,19 @@ namespace reinforcement_learning { namespace logger {
 
   template<typename TEvent, template<typename> class TSerializer>
   void async_batcher<TEvent, TSerializer>::flush() {
+    // Events appended from now on wake the background thread again once they fill a batch
+    _flush_requested.store(false, std::memory_order_relaxed);
+
     const auto queue_size = _queue.size();
+    update_rates(queue_size);
+    report_queue_level(queue_size, _queue.capacity());
 
     // Early exit if queue is empty.
     if (queue_size == 0) {
       return;
     }
 
+    const auto flush_start = std::chrono::steady_clock::now();
     auto remaining = queue_size;
     // Handle batching
     while (remaining > 0) {
@@ -153,14 +370,22 @@ namespace reinforcement_learning { namespace logger {
 
       auto buffer = _buffer_pool.acquire();
 
+      const auto batch_start = remaining;
       if (fill_buffer(buffer, remaining, &status) != error_code::success) {
         ERROR_CALLBACK(_perror_cb, status);
       }
+      _metrics.batch_events.record(batch_start - remaining);
+      _metrics.batch_bytes.record(buffer->body_filled_size());
 
+      const auto send_start = std::chrono::steady_clock::now();
       if (_sender->send(TSerializer<TEvent>::message_id(), buffer, &status) != error_code::success) {
         ERROR_CALLBACK(_perror_cb, status);
       }
+      _metrics.batch_send_us.record(utility::microseconds_since(send_start));
     }
+
+    _metrics.sent_events.add(queue_size);
+    _metrics.flush_us.record(utility::microseconds_since(flush_start));
   }
 
   template<typename TEvent, template<typename> class TSerializer>
@@ -173,12 +398,32 @@ namespace reinforcement_learning { namespace logger {
     : _sender(sender)
     , _queue(config.send_queue_max_capacity)
     , _send_high_water_mark(config.send_high_water_mark)
+    , _flush_on_high_water_mark(config.flush_on_high_water_mark)
     , _perror_cb(perror_cb)
     , _shared_state(shared_state)
     , _periodic_background_proc(static_cast<int>(config.send_batch_interval_ms), watchdog, "Async batcher thread", perror_cb)
     , _pass_prob(0.5)
     , _queue_mode(config.queue_mode)
+    , _block_timeout_ms(config.queue_block_timeout_ms)
+    , _adaptive_low_water_mark(config.adaptive_low_water_mark)
+    , _adaptive_min_pass_prob(config.adaptive_min_pass_prob)
+    // Batches are filled up to the high water mark, plus the event crossing it
+    , _buffer_pool(config.send_high_water_mark, static_cast<size_t>(config.buffer_pool_max_kb) * 1024)
     , _batch_content_encoding(config.batch_content_encoding)
+    , _snapshot(config.snapshot)
+    , _config_section(utility::to_config_section(config.section))
+    , _snapshot_version(0)
+    , _send_batch_interval_ms(config.send_batch_interval_ms)
+    , _controller_pass_prob(1.f)
+    , _drain_rate(0.f)
+    , _appended_since_flush(0)
+    , _dropped_events(0)
+    , _block_timeouts(0)
+    , _flush_requested(false)
+    , _last_flush(std::chrono::steady_clock::now())
+    , _metrics(config.section)
+    , _reported_depth(0)
+    , _reported_bytes(0)
   {}
 
   template<typename TEvent, template<typename> class TSerializer>
@@ -188,5 +433,6 @@ namespace reinforcement_learning { namespace logger {
     if (_queue.size() > 0) {
       flush();
     }
+    report_queue_level(0, 0);
   }
 }}
@@ -8,16 +8,16 @@ namespace reinforcement_learning { namespace logger {
     return append(ranking_event::choose_rank(event_id, context, flags, response, now, 1.0f, learning_mode), status);
   }
 
-  int ccb_logger::log_decisions(std::vector<const char*>& event_ids, const char* context, unsigned int flags, const std::vector<std::vector<uint32_t>>& action_ids,
-    const std::vector<std::vector<float>>& pdfs, const std::string& model_version, api_status* status) {
+  int ccb_logger::log_decisions(std::vector<const char*>& event_ids, const char* context, unsigned int flags, std::vector<std::vector<uint32_t>>&& action_ids,
+    std::vector<std::vector<float>>&& pdfs, const std::string& model_version, api_status* status) {
     const auto now = _time_provider != nullptr ? _time_provider->gmt_now() : timestamp();
-    return append(std::move(decision_ranking_event::request_decision(event_ids, context, flags, action_ids, pdfs, model_version, now)), status);
+    return append(std::move(decision_ranking_event::request_decision(event_ids, context_buffer(context), flags, std::move(action_ids), std::move(pdfs), model_version, now)), status);
   }
-  int multi_slot_logger::log_decision(const std::string &event_id, const char* context, unsigned int flags, const std::vector<std::vector<uint32_t>>& action_ids,
-      const std::vector<std::vector<float>>& pdfs, const std::string& model_version, api_status* status) {
+  int multi_slot_logger::log_decision(const std::string &event_id, const char* context, unsigned int flags, std::vector<std::vector<uint32_t>>&& action_ids,
+      std::vector<std::vector<float>>&& pdfs, const std::string& model_version, api_status* status) {
 
     const auto now = _time_provider != nullptr ? _time_provider->gmt_now() : timestamp();
-    return append(std::move(multi_slot_decision_event::request_decision(event_id, context, flags, action_ids, pdfs, model_version, now)), status);
+    return append(std::move(multi_slot_decision_event::request_decision(event_id, context_buffer(context), flags, std::move(action_ids), std::move(pdfs), model_version, now)), status);
   }
 
   int observation_logger::report_action_taken(const char* event_id, api_status* status) {
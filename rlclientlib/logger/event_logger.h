@@ -29,6 +29,8 @@ namespace reinforcement_learning { namespace logger {
 
     int init(api_status* status);
 
+    void get_stats(queue_stats& stats) const;
+
   protected:
     int append(TEvent&& item, api_status* status);
     int append(TEvent& item, api_status* status);
@@ -55,6 +57,11 @@ namespace reinforcement_learning { namespace logger {
     return error_code::success;
   }
 
+  template<typename TEvent>
+  void event_logger<TEvent>::get_stats(queue_stats& stats) const {
+    _batcher->get_stats(stats);
+  }
+
   template<typename TEvent>
   int event_logger<TEvent>::append(TEvent&& item, api_status* status) {
     if (!_initialized) {
@@ -87,8 +94,8 @@ class ccb_logger : public event_logger<decision_ranking_event> {
       : event_logger(time_provider, batcher)
     {}
 
-    int log_decisions(std::vector<const char*>& event_ids, const char* context, unsigned int flags, const std::vector<std::vector<uint32_t>>& action_ids,
-      const std::vector<std::vector<float>>& pdfs, const std::string& model_version, api_status* status);
+    int log_decisions(std::vector<const char*>& event_ids, const char* context, unsigned int flags, std::vector<std::vector<uint32_t>>&& action_ids,
+      std::vector<std::vector<float>>&& pdfs, const std::string& model_version, api_status* status);
   };
 
 class multi_slot_logger : public event_logger<multi_slot_decision_event> {
@@ -97,8 +104,8 @@ class multi_slot_logger : public event_logger<multi_slot_decision_event> {
       : event_logger(time_provider, batcher)
     {}
 
-    int log_decision(const std::string &event_id, const char* context, unsigned int flags, const std::vector<std::vector<uint32_t>>& action_ids,
-      const std::vector<std::vector<float>>& pdfs, const std::string& model_version, api_status* status);
+    int log_decision(const std::string &event_id, const char* context, unsigned int flags, std::vector<std::vector<uint32_t>>&& action_ids,
+      std::vector<std::vector<float>>&& pdfs, const std::string& model_version, api_status* status);
   };
 
   class observation_logger : public event_logger<outcome_event> {
@@ -52,14 +52,17 @@ namespace reinforcement_learning {
       _queue.push_back({std::forward<T>(item),item_size});
     }
 
-    void prune(float pass_prob)
+    //returns the number of dropped events
+    size_t prune(float pass_prob)
     {
       std::unique_lock<std::mutex> mlock(_mutex);
-      if (!is_full()) return;
+      if (!is_full()) return 0;
+      const auto size_before = _queue.size();
       for (auto it = _queue.begin(); it != _queue.end();) {
         it = it->first.try_drop(pass_prob, _drop_pass) ? erase(it) : (++it);
       }
       ++_drop_pass;
+      return size_before - _queue.size();
     }
 
     //approximate size
@@ -78,6 +81,11 @@ namespace reinforcement_learning {
       return _capacity;
     }
 
+    size_t max_capacity() const
+    {
+      return _max_capacity;
+    }
+
   private:
     //thread-unsafe
     iterator_t erase(iterator_t it) {
@@ -6,6 +6,8 @@
 
 #include "utility/http_authorization.h"
 #include "utility/http_client.h"
+#include "utility/metrics_registry.h"
+#include "utility/trace_rate_limiter.h"
 
 #include <sstream>
 #include "utility/stl_container_adapter.h"
@@ -17,6 +19,33 @@ using namespace web::http; // Common HTTP functionality
 namespace u = reinforcement_learning::utility;
 
 namespace reinforcement_learning {
+  namespace {
+    // Process wide metrics of every eventhub_client, see live_model::get_metrics
+    struct eventhub_metrics {
+      eventhub_metrics()
+        : requests(u::metrics_registry::instance().counter("eventhub.requests"))
+        , retries(u::metrics_registry::instance().counter("eventhub.retries"))
+        , failures(u::metrics_registry::instance().counter("eventhub.failures"))
+        , request_us(u::metrics_registry::instance().histogram("eventhub.request_us"))
+        , pending_requests(u::metrics_registry::instance().gauge("eventhub.pending_requests"))
+      {}
+
+      u::metrics_counter& requests;
+      u::metrics_counter& retries;
+      u::metrics_counter& failures; // Requests which failed after all their retries
+      u::metrics_histogram& request_us; // Every HTTP attempt, retries included
+      u::metrics_gauge& pending_requests;
+    };
+
+    eventhub_metrics& metrics() {
+      static eventhub_metrics instance;
+      return instance;
+    }
+
+    // Failures come once per request while the service is unavailable, the retry count is in the metrics
+    const int64_t FAILURE_TRACE_INTERVAL_MS = 1000;
+  }
+
   eventhub_client::http_request_task::http_request_task(
     i_http_client* client,
     const std::string& host,
@@ -46,7 +75,9 @@ namespace reinforcement_learning {
     const auto stream = concurrency::streams::bytestream::open_istream(container);
     request.set_body(stream, container_size);
 
-    return _client->request(request).then([this, try_count](pplx::task<http_response> response) {
+    const auto request_start = std::chrono::steady_clock::now();
+    return _client->request(request).then([this, try_count, request_start](pplx::task<http_response> response) {
+      metrics().request_us.record(u::microseconds_since(request_start));
       web::http::status_code code = status_codes::InternalError;
       api_status status;
 
@@ -54,14 +85,15 @@ namespace reinforcement_learning {
         code = response.get().status_code();
       }
       catch (const std::exception& e) {
-        TRACE_ERROR(_trace, e.what());
+        TRACE_ERROR_RATE_LIMITED(_trace, FAILURE_TRACE_INTERVAL_MS, e.what());
       }
 
       // If the response is not the expected code then it has failed. Retry if possible otherwise report background error.
       if(code != status_codes::Created) {
         // Stop condition of recurison.
         if(try_count < _max_retries){
-          TRACE_ERROR(_trace, "HTTP request failed, retrying...");
+          TRACE_ERROR_RATE_LIMITED(_trace, FAILURE_TRACE_INTERVAL_MS, "HTTP request failed, retrying...");
+          metrics().retries.add();
 
           // Yes, recursively send another request inside this one. If a subsequent request returns success we are good, otherwise the failure will propagate.
           return send_request(try_count + 1).get();
@@ -70,6 +102,7 @@ namespace reinforcement_learning {
           auto msg = u::concat("(expected 201): Found ", code, ", failed after ", try_count, " retries.");
           api_status::try_update(&status, error_code::http_bad_status_code, msg.c_str());
           ERROR_CALLBACK(_error_callback, status);
+          metrics().failures.add();
 
           return code;
         }
@@ -99,6 +132,7 @@ namespace reinforcement_learning {
 
     std::unique_ptr<http_request_task> oldest;
     _tasks.pop(&oldest);
+    metrics().pending_requests.add(-1);
 
     try {
       // This will block if the task is not complete yet.
@@ -125,6 +159,8 @@ namespace reinforcement_learning {
 
       std::unique_ptr<http_request_task> request_task(new http_request_task(_client.get(), _eventhub_host, auth_str, post_data, _max_retries, _error_callback, _trace));
       _tasks.push(std::move(request_task));
+      metrics().requests.add();
+      metrics().pending_requests.add(1);
     }
     catch (const std::exception& e) {
       RETURN_ERROR_LS(_trace, status, eventhub_http_generic) << e.what();
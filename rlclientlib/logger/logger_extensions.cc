@@ -11,7 +11,7 @@ public:
 	}
 
 	i_async_batcher<generic_event>* create_batcher(i_message_sender* sender, utility::watchdog& watchdog, error_callback_fn* perror_cb, const char* section) override {
-		auto config = utility::get_batcher_config(_config, section);
+		auto config = get_batcher_config(section);
 		return new async_batcher<generic_event, fb_collection_serializer>(
 				sender,
 				watchdog,
@@ -39,6 +39,12 @@ private:
 i_logger_extensions::i_logger_extensions(const utility::configuration& config): _config(config) { }
 i_logger_extensions::~i_logger_extensions() { }
 
+void i_logger_extensions::set_config_snapshot(const utility::config_snapshot* snapshot) { _snapshot = snapshot; }
+
+utility::async_batcher_config i_logger_extensions::get_batcher_config(const char* section) const {
+	return _snapshot != nullptr ? utility::get_batcher_config(*_snapshot, section) : utility::get_batcher_config(_config, section);
+}
+
 
 i_logger_extensions* i_logger_extensions::get_extensions(const utility::configuration& config, i_time_provider* time_provider) {
 	const char *section = "interaction"; //fixme lift this to live_model_impl;
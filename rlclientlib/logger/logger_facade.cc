@@ -1,5 +1,6 @@
 #include "logger_facade.h"
 #include "err_constants.h"
+#include "utility/span_tracer.h"
 
 namespace err = reinforcement_learning::error_code;
 
@@ -12,10 +13,10 @@ namespace reinforcement_learning {
     }
 
     template<typename T>
-    i_async_batcher<T>* create_legacy_async_batcher(const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog,
+    i_async_batcher<T>* create_legacy_async_batcher(const utility::configuration& c, const utility::config_snapshot* snapshot, i_message_sender* sender, utility::watchdog& watchdog,
       error_callback_fn* perror_cb, const char *section, typename async_batcher<T, fb_collection_serializer>::shared_state_t &shared_state) {
 
-      auto config = utility::get_batcher_config(c, section);
+      auto config = snapshot != nullptr ? utility::get_batcher_config(*snapshot, section) : utility::get_batcher_config(c, section);
       return new async_batcher<T, fb_collection_serializer>(
         sender,
         watchdog,
@@ -32,14 +33,15 @@ namespace reinforcement_learning {
       utility::watchdog& watchdog,
       i_time_provider* time_provider,
       i_logger_extensions& ext,
-      error_callback_fn* perror_cb)
+      error_callback_fn* perror_cb,
+      const utility::config_snapshot* snapshot)
     : _model_type(model_type)
     , _version(c.get_int(name::PROTOCOL_VERSION, value::DEFAULT_PROTOCOL_VERSION))
     , _serializer_shared_state(0)
     , _ext(ext)
-    , _v1_cb(_version == 1 && _model_type == model_type_t::CB ? new interaction_logger(time_provider, create_legacy_async_batcher<ranking_event>(c, sender, watchdog, perror_cb, INTERACTION_SECTION, _serializer_shared_state)) : nullptr)
-    , _v1_ccb(_version == 1 && _model_type == model_type_t::CCB ? new ccb_logger(time_provider, create_legacy_async_batcher<decision_ranking_event>(c, sender, watchdog, perror_cb, INTERACTION_SECTION, _serializer_shared_state)) : nullptr)
-    , _v1_multislot(_version == 1 && _model_type == model_type_t::SLATES ? new multi_slot_logger(time_provider, create_legacy_async_batcher<multi_slot_decision_event>(c, sender, watchdog, perror_cb, INTERACTION_SECTION, _serializer_shared_state)) : nullptr)
+    , _v1_cb(_version == 1 && _model_type == model_type_t::CB ? new interaction_logger(time_provider, create_legacy_async_batcher<ranking_event>(c, snapshot, sender, watchdog, perror_cb, INTERACTION_SECTION, _serializer_shared_state)) : nullptr)
+    , _v1_ccb(_version == 1 && _model_type == model_type_t::CCB ? new ccb_logger(time_provider, create_legacy_async_batcher<decision_ranking_event>(c, snapshot, sender, watchdog, perror_cb, INTERACTION_SECTION, _serializer_shared_state)) : nullptr)
+    , _v1_multislot(_version == 1 && _model_type == model_type_t::SLATES ? new multi_slot_logger(time_provider, create_legacy_async_batcher<multi_slot_decision_event>(c, snapshot, sender, watchdog, perror_cb, INTERACTION_SECTION, _serializer_shared_state)) : nullptr)
     , _v2(_version == 2 ? new generic_event_logger(
       time_provider,
       ext.create_batcher(sender, watchdog, perror_cb, INTERACTION_SECTION)) : nullptr) {
@@ -63,13 +65,19 @@ namespace reinforcement_learning {
     template<typename TSerializer, typename... Rest>
     int wrap_log_call(i_logger_extensions& ext, TSerializer& serializer, const char* context, generic_event::object_list_t& objects, generic_event::payload_buffer_t& payload, event_content_type &content_type, api_status* status, const Rest&... rest) {
       if(!ext.is_object_extraction_enabled()) {
+        utility::stage_span span("serialize");
         payload = serializer.event(context, rest...);
       } else {
         std::string tmp;
-        RETURN_IF_FAIL(ext.transform_payload_and_extract_objects(context, tmp, objects, status));
+        {
+          utility::stage_span span("dedup_transform");
+          RETURN_IF_FAIL(ext.transform_payload_and_extract_objects(context, tmp, objects, status));
+        }
+        utility::stage_span span("serialize");
         payload = serializer.event(tmp.c_str(), rest...);
       }
       if(ext.is_serialization_transform_enabled()) {
+        utility::stage_span span("payload_transform");
         RETURN_IF_FAIL(ext.transform_serialized_payload(payload, content_type, status));
       } else {
         content_type = event_content_type::IDENTITY;
@@ -79,7 +87,10 @@ namespace reinforcement_learning {
 
     int interaction_logger_facade::log(const char* context, unsigned int flags, const ranking_response& response, api_status* status, learning_mode learning_mode) {
       switch (_version) {
-        case 1: return _v1_cb->log(response.get_event_id(), context, flags, response, status, learning_mode);
+        case 1: {
+          utility::stage_span span("queue_push");
+          return _v1_cb->log(response.get_event_id(), context, flags, response, status, learning_mode);
+        }
         case 2: {
           v2::LearningModeType lmt;
           RETURN_IF_FAIL(get_learning_mode(learning_mode, lmt, status));
@@ -88,16 +99,17 @@ namespace reinforcement_learning {
           event_content_type content_type;
 
           RETURN_IF_FAIL(wrap_log_call(_ext, _serializer_cb, context, actions, payload, content_type, status, flags, lmt, response));
+          utility::stage_span span("queue_push");
           return _v2->log(response.get_event_id(), std::move(payload), _serializer_cb.type, content_type, std::move(actions), status);
         }
         default: return protocol_not_supported(status);
       }
     }
 
-    int interaction_logger_facade::log_decisions(std::vector<const char*>& event_ids, const char* context, unsigned int flags, const std::vector<std::vector<uint32_t>>& action_ids,
-      const std::vector<std::vector<float>>& pdfs, const std::string& model_version, api_status* status) {
+    int interaction_logger_facade::log_decisions(std::vector<const char*>& event_ids, const char* context, unsigned int flags, std::vector<std::vector<uint32_t>>&& action_ids,
+      std::vector<std::vector<float>>&& pdfs, const std::string& model_version, api_status* status) {
       switch (_version) {
-      case 1: return _v1_ccb->log_decisions(event_ids, context, flags, action_ids, pdfs, model_version, status);
+      case 1: return _v1_ccb->log_decisions(event_ids, context, flags, std::move(action_ids), std::move(pdfs), model_version, status);
       default: return protocol_not_supported(status);
       }
     }
@@ -116,13 +128,13 @@ namespace reinforcement_learning {
     }
 
 
-    int interaction_logger_facade::log_decision(const std::string& event_id, const char* context, unsigned int flags, const std::vector<std::vector<uint32_t>>& action_ids,
-      const std::vector<std::vector<float>>& pdfs, const std::string& model_version, const std::vector<std::string>& slot_ids, api_status* status,
+    int interaction_logger_facade::log_decision(const std::string& event_id, const char* context, unsigned int flags, std::vector<std::vector<uint32_t>>&& action_ids,
+      std::vector<std::vector<float>>&& pdfs, const std::string& model_version, const std::vector<std::string>& slot_ids, api_status* status,
       const std::vector<int>& baseline_actions, learning_mode learning_mode) {
       switch (_version) {
       case 1: {
         switch (_model_type) {
-        case model_type_t::SLATES: return _v1_multislot->log_decision(event_id, context, flags, action_ids, pdfs, model_version, status);
+        case model_type_t::SLATES: return _v1_multislot->log_decision(event_id, context, flags, std::move(action_ids), std::move(pdfs), model_version, status);
         default: RETURN_ERROR_ARG(nullptr, status, protocol_not_supported, "multi_slot logger under v1 protocol can only log slates.");
         }
       }
@@ -138,6 +150,7 @@ namespace reinforcement_learning {
         event_content_type content_type;
 
         RETURN_IF_FAIL(wrap_log_call(_ext, _serializer_multislot, context, actions, payload, content_type, status, flags, action_ids, pdfs, model_version, slot_ids, baseline_actions, lmt));
+        utility::stage_span span("queue_push");
         return _v2->log(event_id.c_str(), std::move(payload), payload_type, content_type, std::move(actions), status);
       }
       default: return protocol_not_supported(status);
@@ -152,24 +165,40 @@ namespace reinforcement_learning {
         event_content_type content_type;
 
         RETURN_IF_FAIL(wrap_log_call(_ext, _serializer_ca, context, actions, payload, content_type, status, flags, response));
+        utility::stage_span span("queue_push");
         return _v2->log(response.get_event_id(), std::move(payload), _serializer_ca.type, content_type, std::move(actions), status);
       }
       default: return protocol_not_supported(status);
       }
     }
 
+    int interaction_logger_facade::get_queue_stats(queue_stats& stats, api_status* status) const {
+      switch (_version) {
+        case 1:
+          switch (_model_type) {
+          case model_type_t::CB: _v1_cb->get_stats(stats); return error_code::success;
+          case model_type_t::CCB: _v1_ccb->get_stats(stats); return error_code::success;
+          case model_type_t::SLATES: _v1_multislot->get_stats(stats); return error_code::success;
+          default: return protocol_not_supported(status);
+          }
+        case 2: _v2->get_stats(stats); return error_code::success;
+        default: return protocol_not_supported(status);
+      }
+    }
+
     observation_logger_facade::observation_logger_facade(
       const utility::configuration& c,
       i_message_sender* sender,
       utility::watchdog& watchdog,
       i_time_provider* time_provider,
-      error_callback_fn* perror_cb)
+      error_callback_fn* perror_cb,
+      const utility::config_snapshot* snapshot)
     : _version(c.get_int(name::PROTOCOL_VERSION, value::DEFAULT_PROTOCOL_VERSION))
     , _serializer_shared_state(0)
-    , _v1(_version == 1 ? new observation_logger(time_provider, create_legacy_async_batcher<outcome_event>(c, sender, watchdog, perror_cb, OBSERVATION_SECTION, _serializer_shared_state)) : nullptr)
+    , _v1(_version == 1 ? new observation_logger(time_provider, create_legacy_async_batcher<outcome_event>(c, snapshot, sender, watchdog, perror_cb, OBSERVATION_SECTION, _serializer_shared_state)) : nullptr)
     , _v2(_version == 2 ? new generic_event_logger(
       time_provider,
-      create_legacy_async_batcher<generic_event>(c, sender, watchdog, perror_cb, OBSERVATION_SECTION, _serializer_shared_state)) : nullptr) {
+      create_legacy_async_batcher<generic_event>(c, snapshot, sender, watchdog, perror_cb, OBSERVATION_SECTION, _serializer_shared_state)) : nullptr) {
     }
 
     int observation_logger_facade::init(api_status* status) {
@@ -232,5 +261,13 @@ namespace reinforcement_learning {
         default: return protocol_not_supported(status);
       }
     }
+
+    int observation_logger_facade::get_queue_stats(queue_stats& stats, api_status* status) const {
+      switch (_version) {
+        case 1: _v1->get_stats(stats); return error_code::success;
+        case 2: _v2->get_stats(stats); return error_code::success;
+        default: return protocol_not_supported(status);
+      }
+    }
   }
 }
@@ -6,6 +6,7 @@
 #include "learning_mode.h"
 #include "ranking_response.h"
 #include "error_callback_fn.h"
+#include "utility/config_snapshot.h"
 #include "utility/watchdog.h"
 
 #include "message_sender.h"
@@ -22,11 +23,18 @@ namespace reinforcement_learning
     class i_logger_extensions {
     protected:
       const utility::configuration& _config;
+      const utility::config_snapshot* _snapshot = nullptr;
+
+      //! Batcher settings of the section, from the snapshot when there is one
+      utility::async_batcher_config get_batcher_config(const char* section) const;
     public:
       i_logger_extensions(const utility::configuration&);
 
       virtual ~i_logger_extensions();
 
+      //! Batchers created from now on follow the reloadable settings of the snapshot
+      void set_config_snapshot(const utility::config_snapshot* snapshot);
+
       virtual bool is_object_extraction_enabled() const = 0;
       virtual bool is_serialization_transform_enabled() const = 0;
 
@@ -41,7 +49,8 @@ namespace reinforcement_learning
     public:
       interaction_logger_facade(reinforcement_learning::model_management::model_type_t model_type,
         const utility::configuration& c, i_message_sender* sender, utility::watchdog& watchdog,
-        i_time_provider* time_provider, i_logger_extensions& ext, error_callback_fn* perror_cb = nullptr);
+        i_time_provider* time_provider, i_logger_extensions& ext, error_callback_fn* perror_cb = nullptr,
+        const utility::config_snapshot* snapshot = nullptr);
 
       interaction_logger_facade(const interaction_logger_facade& other) = delete;
       interaction_logger_facade& operator=(const interaction_logger_facade& other) = delete;
@@ -56,16 +65,18 @@ namespace reinforcement_learning
       int log(const char* context, unsigned int flags, const ranking_response& response, api_status* status, learning_mode learning_mode = ONLINE);
 
       //CCB v1
-      int log_decisions(std::vector<const char*>& event_ids, const char* context, unsigned int flags, const std::vector<std::vector<uint32_t>>& action_ids,
-        const std::vector<std::vector<float>>& pdfs, const std::string& model_version, api_status* status);
+      int log_decisions(std::vector<const char*>& event_ids, const char* context, unsigned int flags, std::vector<std::vector<uint32_t>>&& action_ids,
+        std::vector<std::vector<float>>&& pdfs, const std::string& model_version, api_status* status);
 
       //Multislot (Slates v1/v2 + CCB v2)
-      int log_decision(const std::string& event_id, const char* context, unsigned int flags, const std::vector<std::vector<uint32_t>>& action_ids,
-        const std::vector<std::vector<float>>& pdfs, const std::string& model_version, const std::vector<std::string>& slot_ids, api_status* status, const std::vector<int>& baseline_actions, learning_mode learning_mode = ONLINE);
+      int log_decision(const std::string& event_id, const char* context, unsigned int flags, std::vector<std::vector<uint32_t>>&& action_ids,
+        std::vector<std::vector<float>>&& pdfs, const std::string& model_version, const std::vector<std::string>& slot_ids, api_status* status, const std::vector<int>& baseline_actions, learning_mode learning_mode = ONLINE);
 
       //Continuous
       int log_continuous_action(const char* context, unsigned int flags, const continuous_action_response& response, api_status* status);
 
+      int get_queue_stats(queue_stats& stats, api_status* status) const;
+
     private:
       const reinforcement_learning::model_management::model_type_t _model_type;
       const int _version;
@@ -87,7 +98,8 @@ namespace reinforcement_learning
     class observation_logger_facade {
     public:
       observation_logger_facade(const utility::configuration& c,
-        i_message_sender* sender, utility::watchdog& watchdog, i_time_provider* time_provider, error_callback_fn* perror_cb = nullptr);
+        i_message_sender* sender, utility::watchdog& watchdog, i_time_provider* time_provider, error_callback_fn* perror_cb = nullptr,
+        const utility::config_snapshot* snapshot = nullptr);
 
       observation_logger_facade(const observation_logger_facade& other) = delete;
       observation_logger_facade& operator=(const observation_logger_facade& other) = delete;
@@ -108,6 +120,8 @@ namespace reinforcement_learning
 
       int report_action_taken(const char* event_id, api_status* status);
 
+      int get_queue_stats(queue_stats& stats, api_status* status) const;
+
     private:
       const int _version;
       int _serializer_shared_state;
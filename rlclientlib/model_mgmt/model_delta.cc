@@ -0,0 +1,88 @@
+#include "model_delta.h"
+#include "api_status.h"
+#include "err_constants.h"
+#include "trace_logger.h"
+
+#include <cstring>
+
+namespace reinforcement_learning { namespace model_management {
+  namespace {
+    const char magic[] = { 'R', 'L', 'D', 'E', 'L', 'T', 'A', '1' };
+    const size_t patch_size = sizeof(uint64_t) + sizeof(float);
+
+    // Reads little endian values from a bounded buffer, failing instead of reading past its end
+    class reader {
+    public:
+      reader(const char* data, size_t size) : _p(reinterpret_cast<const unsigned char*>(data)), _end(_p + size) {}
+
+      bool read(uint64_t& value, size_t bytes) {
+        if (remaining() < bytes) {
+          return false;
+        }
+        value = 0;
+        for (size_t i = 0; i < bytes; ++i) {
+          value |= static_cast<uint64_t>(_p[i]) << (8 * i);
+        }
+        _p += bytes;
+        return true;
+      }
+
+      bool read(std::string& value) {
+        uint64_t size;
+        if (!read(size, sizeof(uint32_t)) || remaining() < size) {
+          return false;
+        }
+        value.assign(reinterpret_cast<const char*>(_p), static_cast<size_t>(size));
+        _p += size;
+        return true;
+      }
+
+      bool read(float& value) {
+        uint64_t bits;
+        if (!read(bits, sizeof(uint32_t))) {
+          return false;
+        }
+        const uint32_t bits32 = static_cast<uint32_t>(bits);
+        memcpy(&value, &bits32, sizeof(value));
+        return true;
+      }
+
+      void skip(size_t bytes) { _p += bytes; }
+      size_t remaining() const { return static_cast<size_t>(_end - _p); }
+
+    private:
+      const unsigned char* _p;
+      const unsigned char* _end;
+    };
+  }
+
+  bool model_delta::is_delta(const char* data, size_t size) {
+    return data != nullptr && size >= sizeof(magic) && memcmp(data, magic, sizeof(magic)) == 0;
+  }
+
+  int model_delta::parse(const char* data, size_t size, model_delta& delta, i_trace* trace, api_status* status) {
+    if (!is_delta(data, size)) {
+      RETURN_ERROR_LS(trace, status, model_delta_format_error) << "missing header";
+    }
+
+    reader in(data, size);
+    in.skip(sizeof(magic));
+
+    uint64_t count;
+    if (!in.read(delta.base_version) || !in.read(delta.version) || !in.read(count, sizeof(uint64_t))) {
+      RETURN_ERROR_LS(trace, status, model_delta_format_error) << "truncated header";
+    }
+
+    if (count != in.remaining() / patch_size || in.remaining() % patch_size != 0) {
+      RETURN_ERROR_LS(trace, status, model_delta_format_error) << "expected " << count << " patches in " << in.remaining() << " bytes";
+    }
+
+    delta.patches.resize(static_cast<size_t>(count));
+    for (auto& patch : delta.patches) {
+      in.read(patch.index, sizeof(uint64_t));
+      in.read(patch.value);
+    }
+
+    return error_code::success;
+  }
+}}
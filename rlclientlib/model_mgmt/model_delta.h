@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace reinforcement_learning {
+  class api_status;
+  class i_trace;
+  namespace model_management {
+
+  //! New value of one weight, by its index in the weight array of the model
+  struct weight_patch {
+    uint64_t index;
+    float value;
+  };
+
+  /**
+   * Sparse update of a model: the weights which changed between two versions of the same model.
+   *
+   * Versions are the model ids (VW --id). A delta only applies to a model whose version is base_version, and the model
+   * reports version once it is applied. Layout, integers and floats little endian:
+   *
+   *   8 bytes   magic "RLDELTA1"
+   *   uint32    size of base_version, followed by its characters
+   *   uint32    size of version, followed by its characters
+   *   uint64    number of patches
+   *   patches   uint64 index, float32 value
+   */
+  struct model_delta {
+    std::string base_version;
+    std::string version;
+    std::vector<weight_patch> patches;
+
+    //! True when data starts like a delta rather than a full model
+    static bool is_delta(const char* data, size_t size);
+    static int parse(const char* data, size_t size, model_delta& delta, i_trace* trace, api_status* status);
+  };
+}}
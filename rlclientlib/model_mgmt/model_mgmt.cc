@@ -1,4 +1,8 @@
 #include "model_mgmt.h"
+#include "api_status.h"
+#include "err_constants.h"
+#include "prediction_cache_stats.h"
+#include "ranking_buffer.h"
 
 #include <new>
 #include <cstring>
@@ -63,4 +67,26 @@ namespace reinforcement_learning {
 
       return *this;
     }
+
+    int i_model::choose_rank_flat(uint64_t rnd_seed, const char* features, ranking_buffer& ranking, std::string& model_version, api_status* status) {
+      std::vector<int> action_ids;
+      std::vector<float> action_pdf;
+      RETURN_IF_FAIL(choose_rank(rnd_seed, features, action_ids, action_pdf, model_version, status));
+
+      ranking.clear();
+      ranking.add_slot();
+      for (size_t i = 0; i < action_ids.size() && i < action_pdf.size(); ++i) {
+        ranking.push_back(static_cast<uint32_t>(action_ids[i]), action_pdf[i]);
+      }
+      return error_code::success;
+    }
+
+    int i_model::choose_rank_shared(uint64_t rnd_seed, const shared_context& shared, const char* actions, const char* context, ranking_buffer& ranking, std::string& model_version, api_status* status) {
+      return choose_rank_flat(rnd_seed, context, ranking, model_version, status);
+    }
+
+    int i_model::get_prediction_cache_stats(prediction_cache_stats& stats, api_status* status) const {
+      stats = prediction_cache_stats();
+      return error_code::success;
+    }
 }}
@@ -0,0 +1,222 @@
+#include "prediction_cache.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace reinforcement_learning { namespace model_management {
+  namespace {
+    // More shards than this do not reduce contention any further for the thread counts seen in practice
+    const size_t max_shards = 16;
+
+    inline uint64_t rotl64(uint64_t x, int r) {
+      return (x << r) | (x >> (64 - r));
+    }
+
+    inline uint64_t fmix64(uint64_t k) {
+      k ^= k >> 33;
+      k *= 0xff51afd7ed558ccdULL;
+      k ^= k >> 33;
+      k *= 0xc4ceb9fe1a85ec53ULL;
+      k ^= k >> 33;
+      return k;
+    }
+
+    inline uint64_t read64(const unsigned char* p) {
+      uint64_t value;
+      memcpy(&value, p, sizeof(value));
+      return value;
+    }
+  }
+
+  prediction_cache::prediction_cache(size_t max_entries, std::chrono::milliseconds ttl)
+    : _max_entries(max_entries)
+    , _ttl(ttl) {
+    const size_t shard_count = (std::min)(max_shards, max_entries);
+    for (size_t i = 0; i < shard_count; ++i) {
+      std::unique_ptr<shard> s(new shard());
+      s->capacity = max_entries / shard_count + (i < max_entries % shard_count ? 1 : 0);
+      s->entries.reserve(s->capacity);
+      _shards.push_back(std::move(s));
+    }
+  }
+
+  bool prediction_cache::lookup(const char* context, ranking_buffer& ranking, std::string& model_version, ticket& ticket) {
+    ticket.enabled = !_shards.empty() && context != nullptr;
+    if (!ticket.enabled) {
+      return false;
+    }
+
+    ticket.key = hash(context, strlen(context));
+    ticket.generation = _generation.load(std::memory_order_acquire);
+
+    shard& target = shard_for(ticket.key);
+    {
+      std::lock_guard<std::mutex> lock(target.mutex);
+      const auto found = target.index.find(ticket.key);
+      if (found != target.index.end()) {
+        entry& cached = target.entries[found->second];
+        if (_ttl.count() > 0 && std::chrono::steady_clock::now() >= cached.expires) {
+          remove(target, found->second);
+          _expirations.fetch_add(1, std::memory_order_relaxed);
+        }
+        else {
+          ranking = cached.ranking;
+          model_version = cached.model_version;
+          cached.referenced = true;
+          _hits.fetch_add(1, std::memory_order_relaxed);
+          return true;
+        }
+      }
+    }
+
+    _misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  void prediction_cache::store(const ticket& ticket, const ranking_buffer& ranking, const std::string& model_version) {
+    if (!ticket.enabled) {
+      return;
+    }
+
+    shard& target = shard_for(ticket.key);
+    std::lock_guard<std::mutex> lock(target.mutex);
+
+    // The ranking comes from a model which was replaced while it was computed
+    if (ticket.generation != _generation.load(std::memory_order_acquire)) {
+      return;
+    }
+
+    size_t position;
+    const auto found = target.index.find(ticket.key);
+    if (found != target.index.end()) {
+      // Another thread missed on the same context at the same time
+      position = found->second;
+    }
+    else if (target.entries.size() < target.capacity) {
+      position = target.entries.size();
+      target.entries.emplace_back();
+      target.index.emplace(ticket.key, position);
+    }
+    else {
+      // CLOCK: give every referenced entry a second chance before replacing it
+      while (target.entries[target.hand].referenced) {
+        target.entries[target.hand].referenced = false;
+        target.hand = (target.hand + 1) % target.entries.size();
+      }
+
+      position = target.hand;
+      target.hand = (target.hand + 1) % target.entries.size();
+
+      target.index.erase(target.entries[position].key);
+      target.index.emplace(ticket.key, position);
+      _evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    entry& cached = target.entries[position];
+    cached.key = ticket.key;
+    cached.ranking = ranking;
+    cached.model_version = model_version;
+    cached.expires = std::chrono::steady_clock::now() + _ttl;
+    cached.referenced = false;
+  }
+
+  void prediction_cache::clear() {
+    _generation.fetch_add(1, std::memory_order_acq_rel);
+    for (auto& s : _shards) {
+      std::lock_guard<std::mutex> lock(s->mutex);
+      s->entries.clear();
+      s->index.clear();
+      s->hand = 0;
+    }
+  }
+
+  void prediction_cache::get_stats(prediction_cache_stats& stats) const {
+    stats.entries = 0;
+    for (const auto& s : _shards) {
+      std::lock_guard<std::mutex> lock(s->mutex);
+      stats.entries += s->entries.size();
+    }
+
+    stats.capacity = _max_entries;
+    stats.hits = _hits.load(std::memory_order_relaxed);
+    stats.misses = _misses.load(std::memory_order_relaxed);
+    stats.evictions = _evictions.load(std::memory_order_relaxed);
+    stats.expirations = _expirations.load(std::memory_order_relaxed);
+    stats.invalidations = _generation.load(std::memory_order_relaxed);
+  }
+
+  // MurmurHash3 x64 128 by Austin Appleby, which is in the public domain
+  prediction_cache::cache_key prediction_cache::hash(const char* data, size_t size) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    const size_t block_count = size / 16;
+
+    uint64_t h1 = 0;
+    uint64_t h2 = 0;
+    const uint64_t c1 = 0x87c37b91114253d5ULL;
+    const uint64_t c2 = 0x4cf5ad432745937fULL;
+
+    for (size_t i = 0; i < block_count; ++i) {
+      uint64_t k1 = read64(bytes + i * 16);
+      uint64_t k2 = read64(bytes + i * 16 + 8);
+
+      k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+      h1 = rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+
+      k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+      h2 = rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    const unsigned char* tail = bytes + block_count * 16;
+    uint64_t k1 = 0;
+    uint64_t k2 = 0;
+    switch (size & 15) {
+    case 15: k2 ^= static_cast<uint64_t>(tail[14]) << 48;  // fall through
+    case 14: k2 ^= static_cast<uint64_t>(tail[13]) << 40;  // fall through
+    case 13: k2 ^= static_cast<uint64_t>(tail[12]) << 32;  // fall through
+    case 12: k2 ^= static_cast<uint64_t>(tail[11]) << 24;  // fall through
+    case 11: k2 ^= static_cast<uint64_t>(tail[10]) << 16;  // fall through
+    case 10: k2 ^= static_cast<uint64_t>(tail[9]) << 8;  // fall through
+    case 9: k2 ^= static_cast<uint64_t>(tail[8]);
+      k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;  // fall through
+    case 8: k1 ^= static_cast<uint64_t>(tail[7]) << 56;  // fall through
+    case 7: k1 ^= static_cast<uint64_t>(tail[6]) << 48;  // fall through
+    case 6: k1 ^= static_cast<uint64_t>(tail[5]) << 40;  // fall through
+    case 5: k1 ^= static_cast<uint64_t>(tail[4]) << 32;  // fall through
+    case 4: k1 ^= static_cast<uint64_t>(tail[3]) << 24;  // fall through
+    case 3: k1 ^= static_cast<uint64_t>(tail[2]) << 16;  // fall through
+    case 2: k1 ^= static_cast<uint64_t>(tail[1]) << 8;  // fall through
+    case 1: k1 ^= static_cast<uint64_t>(tail[0]);
+      k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+    }
+
+    h1 ^= size;
+    h2 ^= size;
+    h1 += h2;
+    h2 += h1;
+    h1 = fmix64(h1);
+    h2 = fmix64(h2);
+    h1 += h2;
+    h2 += h1;
+
+    return cache_key{ h1, h2 };
+  }
+
+  prediction_cache::shard& prediction_cache::shard_for(const cache_key& key) {
+    return *_shards[key.high % _shards.size()];
+  }
+
+  void prediction_cache::remove(shard& target, size_t position) {
+    target.index.erase(target.entries[position].key);
+
+    const size_t last = target.entries.size() - 1;
+    if (position != last) {
+      target.entries[position] = std::move(target.entries[last]);
+      target.index[target.entries[position].key] = position;
+    }
+    target.entries.pop_back();
+
+    if (target.hand >= target.entries.size()) {
+      target.hand = 0;
+    }
+  }
+}}
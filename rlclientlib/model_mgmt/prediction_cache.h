@@ -0,0 +1,96 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "prediction_cache_stats.h"
+#include "ranking_buffer.h"
+
+namespace reinforcement_learning { namespace model_management {
+  /**
+   * Bounded cache of the scores a model produced for a context.
+   *
+   * Entries are keyed on a 128 bit hash of the context and hold the ranking returned by the model, before exploration
+   * samples from it. Callers still sample on every request with their own seed, so a cache hit changes the cost of a
+   * decision but not its distribution. Entries are replaced with the CLOCK policy: a hit marks the entry as referenced,
+   * and eviction skips referenced entries once, clearing their mark.
+   *
+   * The entries are spread over independently locked shards to keep concurrent lookups from contending. clear() is
+   * called when the model is updated. Rankings computed with the previous model, but stored after clear(), are dropped
+   * thanks to the generation recorded by lookup().
+   */
+  class prediction_cache {
+  public:
+    struct cache_key {
+      uint64_t low;
+      uint64_t high;
+
+      bool operator==(const cache_key& other) const { return low == other.low && high == other.high; }
+    };
+
+    //! Result of lookup(), to pass to store() after a miss
+    struct ticket {
+      cache_key key;
+      uint64_t generation;
+      bool enabled;
+    };
+
+    //! A max_entries of zero disables the cache. A ttl of zero keeps entries until they are evicted or invalidated.
+    prediction_cache(size_t max_entries, std::chrono::milliseconds ttl);
+
+    prediction_cache(const prediction_cache&) = delete;
+    prediction_cache& operator=(const prediction_cache&) = delete;
+
+    //! Copy the cached ranking of the context into ranking and model_version. Returns false on a miss.
+    bool lookup(const char* context, ranking_buffer& ranking, std::string& model_version, ticket& ticket);
+
+    //! Cache the ranking computed after a missed lookup
+    void store(const ticket& ticket, const ranking_buffer& ranking, const std::string& model_version);
+
+    //! Drop all entries. Called when the model changes.
+    void clear();
+
+    void get_stats(prediction_cache_stats& stats) const;
+
+    static cache_key hash(const char* data, size_t size);
+
+  private:
+    struct key_hash {
+      size_t operator()(const cache_key& key) const { return static_cast<size_t>(key.low); }
+    };
+
+    struct entry {
+      cache_key key;
+      ranking_buffer ranking;
+      std::string model_version;
+      std::chrono::steady_clock::time_point expires;
+      bool referenced = false;
+    };
+
+    struct shard {
+      std::mutex mutex;
+      std::vector<entry> entries;
+      std::unordered_map<cache_key, size_t, key_hash> index;
+      size_t hand = 0;
+      size_t capacity = 0;
+    };
+
+    shard& shard_for(const cache_key& key);
+    void remove(shard& target, size_t position);
+
+    const size_t _max_entries;
+    const std::chrono::milliseconds _ttl;
+    std::vector<std::unique_ptr<shard>> _shards;
+    std::atomic<uint64_t> _generation{0};
+
+    std::atomic<uint64_t> _hits{0};
+    std::atomic<uint64_t> _misses{0};
+    std::atomic<uint64_t> _evictions{0};
+    std::atomic<uint64_t> _expirations{0};
+  };
+}}
@@ -1,3 +1,4 @@
+#define OPENSSL_API_COMPAT 0x0908
 #include "restapi_data_transport.h"
 #include <cpprest/http_client.h>
 #include <cpprest/asyncrt_utils.h>
@@ -5,6 +6,13 @@
 #include "api_status.h"
 #include "factory_resolver.h"
 #include "trace_logger.h"
+#include "str_util.h"
+
+#include <openssl/md5.h>
+
+#include <algorithm>
+#include <deque>
+#include <future>
 
 using namespace web; // Common features like URIs.
 using namespace web::http; // Common HTTP functionality
@@ -14,8 +22,31 @@ namespace u = reinforcement_learning::utility;
 
 namespace reinforcement_learning { namespace model_management {
 
+  //! Incremental MD5 digest, compared with the Content-MD5 of a blob once it is downloaded
+  class md5_hash {
+  public:
+    md5_hash() { MD5_Init(&_ctx); }
+    void update(const char* data, size_t size) { MD5_Update(&_ctx, data, size); }
+    std::vector<unsigned char> digest() {
+      std::vector<unsigned char> digest(MD5_DIGEST_LENGTH);
+      MD5_Final(digest.data(), &_ctx);
+      return digest;
+    }
+
+  private:
+    MD5_CTX _ctx;
+  };
+
   restapi_data_transport::restapi_data_transport(i_http_client* httpcli, i_trace* trace)
-    : _httpcli(httpcli), _datasz{ 0 }, _trace{ trace }
+    : restapi_data_transport(httpcli, nullptr, trace)
+  {}
+
+  restapi_data_transport::restapi_data_transport(i_http_client* httpcli, i_http_client* delta_httpcli, i_trace* trace)
+    : restapi_data_transport(httpcli, delta_httpcli, download_options(), trace)
+  {}
+
+  restapi_data_transport::restapi_data_transport(i_http_client* httpcli, i_http_client* delta_httpcli, const download_options& options, i_trace* trace)
+    : _httpcli(httpcli), _delta_httpcli(delta_httpcli), _options(options), _trace{ trace }
   {}
 
   /*
@@ -38,24 +69,29 @@ namespace reinforcement_learning { namespace model_management {
    * x-ms-version = 2017-04-17
    */
 
-  int restapi_data_transport::get_data_info(::utility::datetime& last_modified, ::utility::size64_t& sz, api_status* status) {
+  int restapi_data_transport::get_data_info(i_http_client& client, blob_info& info, api_status* status) {
 
     // Build request URI and start the request.
-    auto request_task = _httpcli->request(methods::HEAD)
+    auto request_task = client.request(methods::HEAD)
       // Handle response headers arriving.
       .then([&](http_response response) {
       if ( response.status_code() != 200 )
-        RETURN_ERROR_ARG(_trace, status, http_bad_status_code, _httpcli->get_url());
+        RETURN_ERROR_ARG(_trace, status, http_bad_status_code, client.get_url());
 
       const auto iter = response.headers().find(U("Last-Modified"));
       if ( iter == response.headers().end() )
-        RETURN_ERROR_ARG(_trace, status, last_modified_not_found, _httpcli->get_url());
+        RETURN_ERROR_ARG(_trace, status, last_modified_not_found, client.get_url());
 
-      last_modified = ::utility::datetime::from_string(iter->second);
-      if( last_modified.to_interval() == 0)
-        RETURN_ERROR_ARG(_trace, status, last_modified_invalid, _httpcli->get_url());
+      info.last_modified = ::utility::datetime::from_string(iter->second);
+      if( info.last_modified.to_interval() == 0)
+        RETURN_ERROR_ARG(_trace, status, last_modified_invalid, client.get_url());
 
-      sz = response.headers().content_length();
+      info.size = response.headers().content_length();
+
+      const auto md5 = response.headers().find(U("Content-MD5"));
+      info.content_md5.clear();
+      if ( md5 != response.headers().end() )
+        info.content_md5 = ::utility::conversions::from_base64(md5->second);
 
       return error_code::success;
     });
@@ -65,69 +101,187 @@ namespace reinforcement_learning { namespace model_management {
       return request_task.get();
     }
     catch ( const std::exception &e ) {
-      RETURN_ERROR_LS(_trace, status,exception_during_http_req) << e.what() << "\n URL: " << _httpcli->get_url();
+      RETURN_ERROR_LS(_trace, status,exception_during_http_req) << e.what() << "\n URL: " << client.get_url();
     }
   }
 
-  int restapi_data_transport::get_data(model_data& ret, api_status* status) {
+  int restapi_data_transport::get_blob(i_http_client& client, blob_state& state, model_data& ret, bool& received, api_status* status) {
+    received = false;
 
-    ::utility::datetime curr_last_modified;
-    ::utility::size64_t curr_datasz;
-    RETURN_IF_FAIL(get_data_info(curr_last_modified, curr_datasz, status));
+    blob_info info;
+    RETURN_IF_FAIL(get_data_info(client, info, status));
 
-    if ( curr_last_modified == _last_modified && curr_datasz == _datasz )
+    if ( info.last_modified == state.last_modified && info.size == state.datasz )
       return error_code::success;
 
-    // Build request URI and start the request.
-    auto request_task = _httpcli->request(methods::GET)
-      // Handle response headers arriving.
-      .then([&](pplx::task<http_response> resp_task) {
-      auto response = resp_task.get();
-      if ( response.status_code() != 200 )
-        RETURN_ERROR_ARG(_trace, status, http_bad_status_code, "Found: ", response.status_code(), _httpcli->get_url());
+    if ( info.size == 0 ) {
+      ret.data_sz(0);
+      state.last_modified = info.last_modified;
+      return error_code::success;
+    }
 
-      const auto iter = response.headers().find(U("Last-Modified"));
-      if ( iter == response.headers().end() )
-        RETURN_ERROR_ARG(_trace, status, last_modified_not_found, _httpcli->get_url());
+    const auto buff = ret.alloc(static_cast<size_t>(info.size));
+    const int scode = download(client, info, buff, status);
+    if ( scode != error_code::success ) {
+      ret.free();
+      return scode;
+    }
+
+    ret.data_sz(static_cast<size_t>(info.size));
+    ret.increment_refresh_count();
+    state.datasz = info.size;
+    state.last_modified = info.last_modified;
+    received = true;
+    return error_code::success;
+  }
 
-      curr_last_modified = ::utility::datetime::from_string(iter->second);
-      if ( curr_last_modified.to_interval() == 0 )
-        RETURN_ERROR_ARG(_trace, status, last_modified_invalid, "Found: ",
-          ::utility::conversions::to_utf8string(curr_last_modified.to_string()), _httpcli->get_url());
+  int restapi_data_transport::download(i_http_client& client, const blob_info& info, char* buffer, api_status* status) {
+    std::unique_ptr<md5_hash> md5(info.content_md5.empty() ? nullptr : new md5_hash());
+    const uint64_t chunk_size = _options.chunk_size == 0 ? info.size : (std::min)(_options.chunk_size, info.size);
+    const uint64_t chunks = (info.size + chunk_size - 1) / chunk_size;
 
-      curr_datasz = response.headers().content_length();
-      if ( curr_datasz > 0 ) {
-        const auto buff = ret.alloc(curr_datasz);
-        const Concurrency::streams::rawptr_buffer<char> rb(buff, curr_datasz, std::ios::out);
+    if ( chunks == 1 || _options.parallel_chunks <= 1 ) {
+      for ( uint64_t offset = 0; offset < info.size; offset += chunk_size ) {
+        RETURN_IF_FAIL(download_chunk(client, info, buffer, offset, (std::min)(chunk_size, info.size - offset), md5.get(), status));
+      }
+    }
+    else {
+      // Chunks finish in any order. They are added to the digest in order, as soon as the chunks before them are done.
+      std::vector<api_status> statuses(static_cast<size_t>(chunks));
+      std::deque<std::future<int>> in_flight;
+      uint64_t next = 0;
+      for ( uint64_t done = 0; done < chunks; ++done ) {
+        for ( ; next < chunks && in_flight.size() < static_cast<size_t>(_options.parallel_chunks); ++next ) {
+          const uint64_t offset = next * chunk_size;
+          const uint64_t size = (std::min)(chunk_size, info.size - offset);
+          api_status* chunk_status = &statuses[static_cast<size_t>(next)];
+          in_flight.push_back(std::async(std::launch::async, [this, &client, &info, buffer, offset, size, chunk_status]() {
+            return download_chunk(client, info, buffer, offset, size, nullptr, chunk_status);
+          }));
+        }
 
-        // Write response body into the file.
-        const auto readval = response.body().read_to_end(rb).get();  // need to use task.get to throw exceptions properly
+        const int scode = in_flight.front().get();
+        in_flight.pop_front();
+        const api_status& chunk_status = statuses[static_cast<size_t>(done)];
+        if ( scode != error_code::success ) {
+          // Chunks still in flight write to buffer: wait for them before it is released
+          for ( auto& chunk : in_flight ) {
+            chunk.wait();
+          }
+          api_status::try_update(status, scode, chunk_status.get_error_msg());
+          return scode;
+        }
 
-        ret.data_sz(readval);
-        ret.increment_refresh_count();
-        _datasz = readval;
+        if ( md5 ) {
+          const uint64_t offset = done * chunk_size;
+          md5->update(buffer + offset, static_cast<size_t>((std::min)(chunk_size, info.size - offset)));
+        }
       }
-      else {
-        ret.data_sz(0);
+    }
+
+    if ( md5 && md5->digest() != info.content_md5 ) {
+      RETURN_ERROR_ARG(_trace, status, model_checksum_mismatch, client.get_url());
+    }
+    return error_code::success;
+  }
+
+  int restapi_data_transport::download_chunk(i_http_client& client, const blob_info& info, char* buffer, uint64_t offset, uint64_t size, md5_hash* md5, api_status* status) {
+    const bool whole_blob = offset == 0 && size == info.size;
+    uint64_t received = 0;
+    int retries = 0;
+    while ( true ) {
+      const uint64_t before = received;
+      api_status attempt_status;
+      // Only the first request for a whole blob does without a range, a resumed one asks for the bytes still missing
+      const int scode = request_range(client, info, buffer + offset + received, offset + received, size - received,
+        whole_blob && received == 0, received, md5, &attempt_status);
+      if ( scode == error_code::success )
+        return error_code::success;
+
+      // Requests which received some bytes before failing do not count as retries
+      if ( received > before )
+        retries = 0;
+
+      if ( scode == error_code::model_changed_during_download || retries++ >= _options.max_retries ) {
+        api_status::try_update(status, scode, attempt_status.get_error_msg());
+        return scode;
       }
 
-      _last_modified = curr_last_modified;
-      return error_code::success;
-    });
+      TRACE_WARN(_trace, u::concat("Resuming model download at byte ", offset + received, " after: ", attempt_status.get_error_msg()));
+    }
+  }
+
+  int restapi_data_transport::request_range(i_http_client& client, const blob_info& info, char* buffer, uint64_t offset, uint64_t size, bool whole_blob,
+    uint64_t& received, md5_hash* md5, api_status* status) {
+    i_http_client::request_t request(methods::GET);
+    if ( !whole_blob )
+      request.headers().add(U("Range"), ::utility::conversions::to_string_t(u::concat("bytes=", offset, "-", offset + size - 1)));
 
-    // Wait for all the outstanding I/O to complete and handle any exceptions
     try {
-      request_task.wait();
+      auto response = client.request(request).get();
+      const auto expected = whole_blob ? status_codes::OK : status_codes::PartialContent;
+      if ( response.status_code() != expected )
+        RETURN_ERROR_ARG(_trace, status, http_bad_status_code, "Found: ", response.status_code(), client.get_url());
+
+      // Every request must read the blob described by the HEAD request, or the model would mix two versions
+      const auto iter = response.headers().find(U("Last-Modified"));
+      if ( iter == response.headers().end() )
+        RETURN_ERROR_ARG(_trace, status, last_modified_not_found, client.get_url());
+      if ( ::utility::datetime::from_string(iter->second) != info.last_modified )
+        RETURN_ERROR_ARG(_trace, status, model_changed_during_download, client.get_url());
+
+      // Read the body as it arrives, so bytes received before a failure are kept when the download is resumed
+      auto body = response.body();
+      uint64_t read = 0;
+      while ( read < size ) {
+        const size_t remaining = static_cast<size_t>(size - read);
+        const Concurrency::streams::rawptr_buffer<uint8_t> rb(reinterpret_cast<uint8_t*>(buffer + read), remaining, std::ios::out);
+        const size_t count = body.read(rb, remaining).get();  // need to use task.get to throw exceptions properly
+        if ( count == 0 ) {
+          RETURN_ERROR_LS(_trace, status, exception_during_http_req) << "Connection closed after " << read << " of " << size
+            << " bytes\n URL: " << client.get_url();
+        }
+
+        if ( md5 != nullptr )
+          md5->update(buffer + read, count);
+        read += count;
+        received += count;
+      }
     }
     catch ( const std::exception &e ) {
-      ret.free();
-      RETURN_ERROR_LS(_trace, status, exception_during_http_req) <<  e.what();
+      RETURN_ERROR_LS(_trace, status, exception_during_http_req) << e.what() << "\n URL: " << client.get_url();
     }
     catch ( ... ) {
-      ret.free();
       RETURN_ERROR_LS(_trace, status, exception_during_http_req) << error_code::unknown_s;
     }
 
-    return request_task.get();
+    return error_code::success;
+  }
+
+  int restapi_data_transport::get_data(model_data& ret, api_status* status) {
+    if (_delta_httpcli && !_full_model_requested) {
+      bool received = false;
+      api_status delta_status;
+      if (get_blob(*_delta_httpcli, _delta_state, ret, received, &delta_status) != error_code::success) {
+        TRACE_WARN(_trace, u::concat("Unable to get the model delta, checking the full model instead: ", delta_status.get_error_msg()));
+      }
+      else if (received) {
+        return error_code::success;
+      }
+    }
+
+    bool received = false;
+    RETURN_IF_FAIL(get_blob(*_httpcli, _model_state, ret, received, status));
+    _full_model_requested = false;
+
+    if (received) {
+      // The delta seen last may have been published for this model: get it again on the next call
+      _delta_state = blob_state();
+    }
+    return error_code::success;
+  }
+
+  void restapi_data_transport::request_full_model() {
+    _full_model_requested = true;
   }
 }}
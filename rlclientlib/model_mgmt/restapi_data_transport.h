@@ -3,23 +3,64 @@
 #include "utility/http_client.h"
 
 #include <chrono>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace reinforcement_learning {
   class i_trace;
   namespace model_management {
+
+  //! How models are downloaded. The defaults get a model in one GET which is not resumed.
+  struct download_options {
+    //! Bytes per ranged GET, 0 to download the model in one GET
+    uint64_t chunk_size = 0;
+    //! Chunks downloaded at the same time
+    int parallel_chunks = 1;
+    //! Failed requests in a row after which a chunk is given up, requests which receive some bytes do not count.
+    //! Failed chunks are resumed from the first byte missing.
+    int max_retries = 0;
+  };
+
+  class md5_hash;
+
   class restapi_data_transport : public i_data_transport {
   public:
     // Takes the ownership of the i_http_client and delete it at the end of lifetime
     restapi_data_transport(i_http_client* httpcli, i_trace* trace);
+    // Also polls delta_httpcli for model deltas, which are returned instead of the full model while they apply to it.
+    // Takes the ownership of both clients.
+    restapi_data_transport(i_http_client* httpcli, i_http_client* delta_httpcli, i_trace* trace);
+    restapi_data_transport(i_http_client* httpcli, i_http_client* delta_httpcli, const download_options& options, i_trace* trace);
 
     int get_data(model_data& data, api_status* status) override;
+    void request_full_model() override;
   private:
     using time_t = std::chrono::time_point<std::chrono::system_clock>;
-    int get_data_info(::utility::datetime& last_modified, ::utility::size64_t& sz, api_status* status);
+    struct blob_state {
+      ::utility::datetime last_modified;
+      uint64_t datasz = 0;
+    };
+    //! Size and version of a blob, and its MD5 digest if the blob has a Content-MD5
+    struct blob_info {
+      ::utility::datetime last_modified;
+      ::utility::size64_t size = 0;
+      std::vector<unsigned char> content_md5;
+    };
+    int get_data_info(i_http_client& client, blob_info& info, api_status* status);
+    int get_blob(i_http_client& client, blob_state& state, model_data& ret, bool& received, api_status* status);
+    int download(i_http_client& client, const blob_info& info, char* buffer, api_status* status);
+    // Download [offset, offset + size) of the blob into buffer + offset, resuming after failures. Bytes are added to md5 if set.
+    int download_chunk(i_http_client& client, const blob_info& info, char* buffer, uint64_t offset, uint64_t size, md5_hash* md5, api_status* status);
+    // Single GET writing the bytes received to buffer, which stands for offset in the blob
+    int request_range(i_http_client& client, const blob_info& info, char* buffer, uint64_t offset, uint64_t size, bool whole_blob,
+      uint64_t& received, md5_hash* md5, api_status* status);
     std::unique_ptr<i_http_client> _httpcli;
-    ::utility::datetime _last_modified;
-    uint64_t _datasz;
+    std::unique_ptr<i_http_client> _delta_httpcli;
+    blob_state _model_state;
+    blob_state _delta_state;
+    bool _full_model_requested = true;
+    const download_options _options;
     i_trace* _trace;
   };
 }}
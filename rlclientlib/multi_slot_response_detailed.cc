@@ -32,7 +32,7 @@ namespace reinforcement_learning
   }
 
   int multi_slot_response_detailed::set_slot_at_index(const unsigned int index, slot_ranking&& slot, api_status* status) {
-    if (index >= _decision.size()) {
+    if (index >= _size) {
       RETURN_ERROR_ARG(nullptr, status, slot_index_out_of_bounds_error, "Slot index out of bounds");
     }
     _decision[index] = std::move(slot);
@@ -42,11 +42,11 @@ namespace reinforcement_learning
   void multi_slot_response_detailed::clear() {
     _model_id.clear();
     _event_id.clear();
-    _decision.clear();
+    resize(0);
   }
 
   size_t multi_slot_response_detailed::size() const {
-    return _decision.size();
+    return _size;
   }
 
   multi_slot_response_detailed::const_iterator_t multi_slot_response_detailed::begin() const {
@@ -58,14 +58,21 @@ namespace reinforcement_learning
   }
 
   multi_slot_response_detailed::const_iterator_t multi_slot_response_detailed::end() const {
-    return { _decision, _decision.size() };
+    return { _decision, _size };
   }
 
   multi_slot_response_detailed::iterator_t multi_slot_response_detailed::end() {
-    return { _decision, _decision.size() };
+    return { _decision, _size };
   }
 
   void multi_slot_response_detailed::resize(size_t new_size) {
-    _decision.resize(new_size);
+    // Slots are cleared rather than destroyed so that a reused response keeps their storage
+    for (size_t i = new_size; i < _size; ++i) {
+      _decision[i].clear();
+    }
+    if (new_size > _decision.size()) {
+      _decision.resize(new_size);
+    }
+    _size = new_size;
   }
 }
@@ -0,0 +1,63 @@
+#include "ranking_buffer.h"
+
+namespace reinforcement_learning {
+  void ranking_buffer::clear() {
+    _action_ids.clear();
+    _probabilities.clear();
+    _slot_offsets.clear();
+  }
+
+  void ranking_buffer::reserve(size_t slot_count, size_t action_count) {
+    _slot_offsets.reserve(slot_count);
+    _action_ids.reserve(action_count);
+    _probabilities.reserve(action_count);
+  }
+
+  void ranking_buffer::add_slot() {
+    _slot_offsets.push_back(_action_ids.size());
+  }
+
+  void ranking_buffer::push_back(uint32_t action_id, float probability) {
+    if (_slot_offsets.empty()) {
+      add_slot();
+    }
+    _action_ids.push_back(action_id);
+    _probabilities.push_back(probability);
+  }
+
+  size_t ranking_buffer::slot_count() const {
+    return _slot_offsets.size();
+  }
+
+  size_t ranking_buffer::size() const {
+    return _action_ids.size();
+  }
+
+  size_t ranking_buffer::slot_size(size_t slot) const {
+    return slot_end(slot) - slot_begin(slot);
+  }
+
+  const uint32_t* ranking_buffer::action_ids(size_t slot) const {
+    return _action_ids.data() + slot_begin(slot);
+  }
+
+  uint32_t* ranking_buffer::action_ids(size_t slot) {
+    return _action_ids.data() + slot_begin(slot);
+  }
+
+  const float* ranking_buffer::probabilities(size_t slot) const {
+    return _probabilities.data() + slot_begin(slot);
+  }
+
+  float* ranking_buffer::probabilities(size_t slot) {
+    return _probabilities.data() + slot_begin(slot);
+  }
+
+  size_t ranking_buffer::slot_begin(size_t slot) const {
+    return slot < _slot_offsets.size() ? _slot_offsets[slot] : _action_ids.size();
+  }
+
+  size_t ranking_buffer::slot_end(size_t slot) const {
+    return slot + 1 < _slot_offsets.size() ? _slot_offsets[slot + 1] : _action_ids.size();
+  }
+}
@@ -23,19 +23,19 @@ namespace reinforcement_learning {
     return exploration::uniform_random_merand48(seed);
   }
 
-  ranking_event::ranking_event(const char* event_id, bool deferred_action, float pass_prob, const char* context,
+  ranking_event::ranking_event(const char* event_id, bool deferred_action, float pass_prob, context_buffer&& context,
                                const ranking_response& response, const timestamp& ts, learning_mode learning_mode)
-    : event(event_id, ts, pass_prob), _model_id(response.get_model_id()),
+    : event(event_id, ts, pass_prob), _context(std::move(context)), _model_id(response.get_model_id()),
       _deferred_action(deferred_action), _learning_mode(learning_mode){
+    _action_ids_vector.reserve(response.size());
+    _probilities_vector.reserve(response.size());
     for (auto const& r : response) {
       _action_ids_vector.push_back(r.action_id + 1);
       _probilities_vector.push_back(r.probability);
     }
-    string context_str(context);
-    copy(context_str.begin(), context_str.end(), std::back_inserter(_context));
   }
 
-  const std::vector<unsigned char>& ranking_event::get_context() const { return _context; }
+  const std::vector<unsigned char>& ranking_event::get_context() const { return _context.get(); }
   const std::vector<uint64_t>& ranking_event::get_action_ids() const { return _action_ids_vector; }
   const std::vector<float>& ranking_event::get_probabilities() const { return _probilities_vector; }
   const std::string& ranking_event::get_model_id() const { return _model_id; }
@@ -44,27 +44,32 @@ namespace reinforcement_learning {
 
   ranking_event ranking_event::choose_rank(const char* event_id, const char* context, unsigned int flags,
                                            const ranking_response& resp, const timestamp& ts, float pass_prob, learning_mode learning_mode) {
-    return ranking_event(event_id, flags & action_flags::DEFERRED, pass_prob, context, resp, ts, learning_mode);
+    return ranking_event(event_id, flags & action_flags::DEFERRED, pass_prob, context_buffer(context), resp, ts, learning_mode);
+  }
+
+  ranking_event ranking_event::choose_rank(const char* event_id, context_buffer context, unsigned int flags,
+                                           const ranking_response& resp, const timestamp& ts, float pass_prob, learning_mode learning_mode) {
+    return ranking_event(event_id, flags & action_flags::DEFERRED, pass_prob, std::move(context), resp, ts, learning_mode);
   }
 
   decision_ranking_event::decision_ranking_event() { }
 
-  decision_ranking_event::decision_ranking_event(const std::vector<const char*>& event_ids, bool deferred_action, float pass_prob, const char* context,
-    const std::vector<std::vector<uint32_t>>& action_ids, const std::vector<std::vector<float>>& pdfs, const std::string& model_version, const timestamp& ts)
+  decision_ranking_event::decision_ranking_event(const std::vector<const char*>& event_ids, bool deferred_action, float pass_prob, context_buffer&& context,
+    std::vector<std::vector<uint32_t>>&& action_ids, std::vector<std::vector<float>>&& pdfs, const std::string& model_version, const timestamp& ts)
     : event(event_ids[0], ts, pass_prob)
-    , _deferred_action(deferred_action)
-    , _action_ids_vector(action_ids)
-    , _probilities_vector(pdfs)
-    , _model_id(model_version) {
-    string context_str(context);
+    , _context(std::move(context))
+    , _action_ids_vector(std::move(action_ids))
+    , _probilities_vector(std::move(pdfs))
+    , _model_id(model_version)
+    , _deferred_action(deferred_action) {
+    _event_ids.reserve(event_ids.size());
     for(auto evt : event_ids)
     {
       _event_ids.emplace_back(evt);
     }
-    copy(context_str.begin(), context_str.end(), std::back_inserter(_context));
   }
 
-  const std::vector<unsigned char>& decision_ranking_event::get_context() const { return _context; }
+  const std::vector<unsigned char>& decision_ranking_event::get_context() const { return _context.get(); }
   const std::vector<std::vector<uint32_t>>& decision_ranking_event::get_actions_ids() const { return _action_ids_vector; }
   const std::vector<std::vector<float>>& decision_ranking_event::get_probabilities() const { return _probilities_vector; }
   const std::string& decision_ranking_event::get_model_id() const { return _model_id; }
@@ -72,22 +77,26 @@ namespace reinforcement_learning {
   const std::vector<std::string>& decision_ranking_event::get_event_ids() const { return _event_ids; }
 
   decision_ranking_event decision_ranking_event::request_decision(const std::vector<const char*>& event_ids, const char* context, unsigned int flags, const std::vector<std::vector<uint32_t>>& action_ids, const std::vector<std::vector<float>>& pdfs, const std::string& model_version, const timestamp& ts, float pass_prob) {
-    return decision_ranking_event(event_ids, flags & action_flags::DEFERRED, pass_prob, context, action_ids, pdfs, model_version, ts);
+    auto action_ids_copy = action_ids;
+    auto pdfs_copy = pdfs;
+    return decision_ranking_event(event_ids, flags & action_flags::DEFERRED, pass_prob, context_buffer(context), std::move(action_ids_copy), std::move(pdfs_copy), model_version, ts);
+  }
+
+  decision_ranking_event decision_ranking_event::request_decision(const std::vector<const char*>& event_ids, context_buffer context, unsigned int flags, std::vector<std::vector<uint32_t>>&& action_ids, std::vector<std::vector<float>>&& pdfs, const std::string& model_version, const timestamp& ts, float pass_prob) {
+    return decision_ranking_event(event_ids, flags & action_flags::DEFERRED, pass_prob, std::move(context), std::move(action_ids), std::move(pdfs), model_version, ts);
   }
 
-  multi_slot_decision_event::multi_slot_decision_event(const std::string& event_id, bool deferred_action, float pass_prob, const char* context, const std::vector<std::vector<uint32_t>>& action_ids, const std::vector<std::vector<float>>& pdfs, const std::string& model_version, const timestamp& ts)
+  multi_slot_decision_event::multi_slot_decision_event(const std::string& event_id, bool deferred_action, float pass_prob, context_buffer&& context, std::vector<std::vector<uint32_t>>&& action_ids, std::vector<std::vector<float>>&& pdfs, const std::string& model_version, const timestamp& ts)
   : event(event_id.c_str(), ts, pass_prob),
+  _context(std::move(context)),
+  _action_ids_vector(std::move(action_ids)),
+  _probilities_vector(std::move(pdfs)),
   _event_id(event_id),
-  _deferred_action(deferred_action),
-  _action_ids_vector(action_ids),
-  _probilities_vector(pdfs),
-  _model_id(model_version)
-  {
-    string context_str(context);
-    copy(context_str.begin(), context_str.end(), std::back_inserter(_context));
-  }
+  _model_id(model_version),
+  _deferred_action(deferred_action)
+  {}
 
-  const std::vector<unsigned char>& multi_slot_decision_event::get_context() const  { return _context; }
+  const std::vector<unsigned char>& multi_slot_decision_event::get_context() const  { return _context.get(); }
   const std::vector<std::vector<uint32_t>>& multi_slot_decision_event::get_actions_ids() const { return _action_ids_vector; }
   const std::vector<std::vector<float>>& multi_slot_decision_event::get_probabilities() const { return _probilities_vector; }
   const std::string& multi_slot_decision_event::get_model_id() const { return _model_id; }
@@ -95,7 +104,13 @@ namespace reinforcement_learning {
   const std::string& multi_slot_decision_event::get_event_id() const { return _event_id; }
 
   multi_slot_decision_event multi_slot_decision_event::request_decision(const std::string& event_id, const char* context, unsigned int flags, const std::vector<std::vector<uint32_t>>& action_ids, const std::vector<std::vector<float>>& pdfs, const std::string& model_version, const timestamp& ts, float pass_prob) {
-    return multi_slot_decision_event(event_id, (flags & action_flags::DEFERRED) != 0u, pass_prob, context, action_ids, pdfs, model_version, ts);
+    auto action_ids_copy = action_ids;
+    auto pdfs_copy = pdfs;
+    return multi_slot_decision_event(event_id, (flags & action_flags::DEFERRED) != 0u, pass_prob, context_buffer(context), std::move(action_ids_copy), std::move(pdfs_copy), model_version, ts);
+  }
+
+  multi_slot_decision_event multi_slot_decision_event::request_decision(const std::string& event_id, context_buffer context, unsigned int flags, std::vector<std::vector<uint32_t>>&& action_ids, std::vector<std::vector<float>>&& pdfs, const std::string& model_version, const timestamp& ts, float pass_prob) {
+    return multi_slot_decision_event(event_id, (flags & action_flags::DEFERRED) != 0u, pass_prob, std::move(context), std::move(action_ids), std::move(pdfs), model_version, ts);
   }
 
   outcome_event::outcome_event(const char* event_id, float pass_prob, const char* outcome, bool action_taken, const timestamp& ts)
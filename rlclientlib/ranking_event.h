@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include "context_buffer.h"
 #include "learning_mode.h"
 #include "ranking_response.h"
 #include "time_helper.h"
@@ -58,12 +59,14 @@ namespace reinforcement_learning {
   public:
     static ranking_event choose_rank(const char* event_id, const char* context,
       unsigned int flags, const ranking_response& resp, const timestamp& ts, float pass_prob = 1, learning_mode decision_mode = ONLINE);
+    static ranking_event choose_rank(const char* event_id, context_buffer context,
+      unsigned int flags, const ranking_response& resp, const timestamp& ts, float pass_prob = 1, learning_mode decision_mode = ONLINE);
 
   private:
-    ranking_event(const char* event_id, bool deferred_action, float pass_prob, const char* context,
+    ranking_event(const char* event_id, bool deferred_action, float pass_prob, context_buffer&& context,
     const ranking_response& response,const timestamp& ts, learning_mode decision_mode);
 
-    std::vector<unsigned char> _context;
+    context_buffer _context;
     std::vector<uint64_t> _action_ids_vector;
     std::vector<float> _probilities_vector;
     std::string _model_id;
@@ -88,12 +91,15 @@ namespace reinforcement_learning {
   public:
     static decision_ranking_event request_decision(const std::vector<const char*>& event_ids, const char* context,
       unsigned int flags, const std::vector<std::vector<uint32_t>>& action_ids, const std::vector<std::vector<float>>& pdfs, const std::string& model_version, const timestamp& ts, float pass_prob = 1.f);
+    // action_ids and pdfs are moved into the event
+    static decision_ranking_event request_decision(const std::vector<const char*>& event_ids, context_buffer context,
+      unsigned int flags, std::vector<std::vector<uint32_t>>&& action_ids, std::vector<std::vector<float>>&& pdfs, const std::string& model_version, const timestamp& ts, float pass_prob = 1.f);
 
   private:
-    decision_ranking_event(const std::vector<const char*>& event_ids, bool deferred_action, float pass_prob, const char* context,
-      const std::vector<std::vector<uint32_t>>& action_ids, const std::vector<std::vector<float>>& pdfs, const std::string& model_version, const timestamp& ts);
+    decision_ranking_event(const std::vector<const char*>& event_ids, bool deferred_action, float pass_prob, context_buffer&& context,
+      std::vector<std::vector<uint32_t>>&& action_ids, std::vector<std::vector<float>>&& pdfs, const std::string& model_version, const timestamp& ts);
 
-    std::vector<unsigned char> _context;
+    context_buffer _context;
     std::vector<std::vector<uint32_t>> _action_ids_vector;
     std::vector<std::vector<float>> _probilities_vector;
     std::vector<std::string> _event_ids;
@@ -120,12 +126,15 @@ namespace reinforcement_learning {
   public:
     static multi_slot_decision_event request_decision(const std::string& event_id, const char* context,
       unsigned int flags, const std::vector<std::vector<uint32_t>>& action_ids, const std::vector<std::vector<float>>& pdfs, const std::string& model_version, const timestamp& ts, float pass_prob = 1.f);
+    // action_ids and pdfs are moved into the event
+    static multi_slot_decision_event request_decision(const std::string& event_id, context_buffer context,
+      unsigned int flags, std::vector<std::vector<uint32_t>>&& action_ids, std::vector<std::vector<float>>&& pdfs, const std::string& model_version, const timestamp& ts, float pass_prob = 1.f);
 
   private:
-    multi_slot_decision_event(const std::string& event_id, bool deferred_action, float pass_prob, const char* context,
-      const std::vector<std::vector<uint32_t>>& action_ids, const std::vector<std::vector<float>>& pdfs, const std::string& model_version, const timestamp& ts);
+    multi_slot_decision_event(const std::string& event_id, bool deferred_action, float pass_prob, context_buffer&& context,
+      std::vector<std::vector<uint32_t>>&& action_ids, std::vector<std::vector<float>>&& pdfs, const std::string& model_version, const timestamp& ts);
 
-    std::vector<unsigned char> _context;
+    context_buffer _context;
     std::vector<std::vector<uint32_t>> _action_ids_vector;
     std::vector<std::vector<float>> _probilities_vector;
     std::string _event_id;
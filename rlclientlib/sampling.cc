@@ -3,18 +3,23 @@
 #include "trace_logger.h"
 #include "api_status.h"
 #include "explore.h"
+#include "explore_kernels.h"
 #include <iostream>
 
 namespace e = exploration;
 namespace reinforcement_learning {
 
-int populate_response(size_t chosen_action_index, std::vector<int>& action_ids, std::vector<float>& pdf, std::string&& model_id, ranking_response& response, i_trace* trace_logger, api_status* status) {
-  for ( size_t idx = 0; idx < pdf.size(); ++idx ) {
+int populate_response(size_t chosen_action_index, const ranking_buffer& ranking, const char* model_id, ranking_response& response, i_trace* trace_logger, api_status* status) {
+  const auto size = ranking.slot_size(0);
+  const auto action_ids = ranking.action_ids(0);
+  const auto pdf = ranking.probabilities(0);
+  for ( size_t idx = 0; idx < size; ++idx ) {
     response.push_back(action_ids[idx], pdf[idx]);
   }
 
   RETURN_IF_FAIL(response.set_chosen_action_id(action_ids[chosen_action_index]));
-  response.set_model_id(std::move(model_id));
+  // Copy rather than move so a reused response keeps its model_id capacity
+  response.set_model_id(model_id);
   return error_code::success;
 }
 
@@ -105,17 +110,18 @@ int populate_multi_slot_response_detailed(const std::vector<std::vector<uint32_t
   return error_code::success;
 }
 
-int sample_and_populate_response(uint64_t rnd_seed, std::vector<int>& action_ids, std::vector<float>& pdf, std::string&& model_id, ranking_response& response, i_trace* trace_logger, api_status* status) {
+int sample_and_populate_response(uint64_t rnd_seed, ranking_buffer& ranking, const char* model_id, ranking_response& response, i_trace* trace_logger, api_status* status) {
     try {
       // Pick a slot using the pdf. NOTE: sample_after_normalizing() can change the pdf
       uint32_t chosen_index;
-      auto scode = e::sample_after_normalizing(rnd_seed, std::begin(pdf), std::end(pdf), chosen_index);
+      const auto pdf = ranking.probabilities(0);
+      auto scode = explore_kernels::sample_after_normalizing(rnd_seed, pdf, pdf + ranking.slot_size(0), chosen_index);
 
       if ( S_EXPLORATION_OK != scode ) {
         RETURN_ERROR_LS(trace_logger, status, exploration_error) << scode;
       }
 
-      RETURN_IF_FAIL(populate_response(chosen_index, action_ids, pdf, std::move(model_id), response, trace_logger, status));
+      RETURN_IF_FAIL(populate_response(chosen_index, ranking, model_id, response, trace_logger, status));
 
       // Swap values in first position with values in chosen index
       scode = e::swap_chosen(std::begin(response), std::end(response), chosen_index);
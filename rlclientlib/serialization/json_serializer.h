@@ -6,7 +6,7 @@
 #include "data_buffer.h"
 #include "logger/message_type.h"
 #include "api_status.h"
-#include "utility/data_buffer_streambuf.h"
+#include "utility/data_buffer_writer.h"
 #include "utility/config_helper.h"
 
 namespace reinforcement_learning { namespace logger {
@@ -17,40 +17,39 @@ namespace reinforcement_learning { namespace logger {
   template <>
   struct json_event_serializer<ranking_event> {
 
-    static int serialize(ranking_event& evt, std::ostream& buffer, api_status* status) {
+    static int serialize(ranking_event& evt, utility::data_buffer_writer& buffer, api_status* status) {
       // Add version and eventId
-      buffer << R"({"Version":"1","EventId":")" << evt.get_event_id() << R"(")";
+      buffer.write(R"({"Version":"1","EventId":")").write(evt.get_event_id()).write(R"(")");
       if (evt.get_defered_action()) {
-        buffer << R"(,"DeferredAction":true)";
+        buffer.write(R"(,"DeferredAction":true)");
       }
 
       // Add action ids
-      buffer << R"(,"a":[)";
+      buffer.write(R"(,"a":[)");
       auto delimiter = "";
       for (auto const& action_id : evt.get_action_ids()) {
-        buffer << delimiter << action_id + 1;
+        buffer.write(delimiter).write_uint(action_id + 1);
         delimiter = ",";
       }
 
       // Add context
-      const char* context = reinterpret_cast<const char*>(&(evt.get_context()[0]));
-      //std::string context(evt.get_context().begin(), evt.get_context().end())
-      buffer << R"(],"c":)" << context << R"(,"p":[)";
+      const auto& context = evt.get_context();
+      buffer.write(R"(],"c":)").write(reinterpret_cast<const char*>(context.data()), context.size()).write(R"(,"p":[)");
 
       // Add probabilities
       delimiter = "";
       for (auto const& probability : evt.get_probabilities()) {
-        buffer << delimiter << probability + 1;
+        buffer.write(delimiter).write_float(probability + 1);
         delimiter = ",";
       }
 
       //add model id
-      buffer << R"(],"VWState":{"m":")" << evt.get_model_id() << R"("})";
+      buffer.write(R"(],"VWState":{"m":")").write(evt.get_model_id()).write(R"("})");
 
       if (evt.get_pass_prob() < 1) {
-        buffer << R"(,"pdrop":)" << (1 - evt.get_pass_prob());
+        buffer.write(R"(,"pdrop":)").write_float(1 - evt.get_pass_prob());
       }
-      buffer << R"(})";
+      buffer.write(R"(})");
 
       return error_code::success;
     }
@@ -59,18 +58,18 @@ namespace reinforcement_learning { namespace logger {
   template<>
   struct json_event_serializer<outcome_event> {
 
-    static int serialize(outcome_event& evt, std::ostream& buffer, api_status* status)
+    static int serialize(outcome_event& evt, utility::data_buffer_writer& buffer, api_status* status)
     {
       switch (evt.get_outcome_type())
       {
         case outcome_event::outcome_type_string:
-          buffer << R"({"EventId":")" << evt.get_event_id() << R"(","v":)" << evt.get_outcome() << R"(})";
+          buffer.write(R"({"EventId":")").write(evt.get_event_id()).write(R"(","v":)").write(evt.get_outcome()).write(R"(})");
           break;
         case outcome_event::outcome_type_numeric:
-          buffer << R"({"EventId":")" << evt.get_event_id() << R"(","v":)" << evt.get_numeric_outcome() << R"(})";
+          buffer.write(R"({"EventId":")").write(evt.get_event_id()).write(R"(","v":)").write_float(evt.get_numeric_outcome()).write(R"(})");
           break;
         case outcome_event::outcome_type_action_taken:
-          buffer << R"({"EventId":")" << evt.get_event_id() << R"(","ActionTaken":true})";
+          buffer.write(R"({"EventId":")").write(evt.get_event_id()).write(R"(","ActionTaken":true})");
           break;
         default: {
           RETURN_ERROR(nullptr, status, serialize_unknown_outcome_type);
@@ -84,28 +83,26 @@ namespace reinforcement_learning { namespace logger {
   struct json_collection_serializer {
     using serializer_t = json_event_serializer<event_t>;
     using buffer_t = utility::data_buffer;
-    using streambuf_t = utility::data_buffer_streambuf;
+    using writer_t = utility::data_buffer_writer;
     using shared_state_t = int;
 
     static int message_id() { return 0; }
 
     json_collection_serializer(buffer_t& buffer, const char* content_encoding)
       : _buffer(buffer),
-      _streambuf{&_buffer},
-      _ostream{&_streambuf} {
-      _ostream << std::unitbuf;
+      _writer{&_buffer} {
     }
 
     json_collection_serializer(buffer_t& buffer, const char* content_encoding, int /*dummy*/) : json_collection_serializer(buffer, content_encoding) {}
 
     int add(event_t& evt, api_status* status=nullptr) {
-      RETURN_IF_FAIL(serializer_t::serialize(evt, _ostream, status));
-      _ostream << "\n";
+      RETURN_IF_FAIL(serializer_t::serialize(evt, _writer, status));
+      _writer.write("\n", 1);
       return error_code::success;
     }
 
     uint64_t size() const {
-      return _buffer.body_filled_size();
+      return _writer.size();
     }
 
     void reset() {
@@ -113,13 +110,12 @@ namespace reinforcement_learning { namespace logger {
     }
 
     int finalize(api_status* status) {
-      _streambuf.finalize();
+      _writer.finalize();
       return error_code::success;
     }
 
     buffer_t& _buffer;
-    streambuf_t _streambuf;
-    std::ostream _ostream;
+    writer_t _writer;
   };
 
   template<>
@@ -1,5 +1,7 @@
 #include "trace_logger.h"
 
+#include <cstring>
+
 const char* get_log_level_string(int log_level) {
   switch ( log_level ) {
   case reinforcement_learning::LEVEL_DEBUG:
@@ -14,3 +16,19 @@ const char* get_log_level_string(int log_level) {
     return "LOG";
   }
 }
+
+bool get_log_level(const char* log_level_string, int& log_level) {
+  const int levels[] = {
+    reinforcement_learning::LEVEL_DEBUG,
+    reinforcement_learning::LEVEL_INFO,
+    reinforcement_learning::LEVEL_WARN,
+    reinforcement_learning::LEVEL_ERROR
+  };
+  for (const auto level : levels) {
+    if (std::strcmp(log_level_string, get_log_level_string(level)) == 0) {
+      log_level = level;
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,279 @@
+#include "background_executor.h"
+#include "api_status.h"
+#include "err_constants.h"
+#include "trace_logger.h"
+#include "str_util.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace reinforcement_learning { namespace utility {
+  class background_executor::task {
+  public:
+    enum class state { waiting, ready, running, done };
+
+    explicit task(task_fn fn) : fn(std::move(fn)) {}
+
+    task_fn fn;
+    state current = state::waiting;
+    uint64_t due_tick = 0;
+    bool woken = false;        // Run again as soon as the current run ends
+    bool cancelled = false;
+    bool self_cancelled = false;  // The worker frees it, nobody waits
+    std::thread::id runner;
+  };
+
+  const std::chrono::milliseconds background_executor::TICK(10);
+  const size_t background_executor::WHEEL_SLOTS;
+
+  background_executor::background_executor(size_t thread_count, i_trace* trace)
+    : _thread_count(thread_count)
+    , _trace(trace)
+    , _start(clock_t::now())
+    , _wheel(WHEEL_SLOTS)
+    , _next_due_tick((std::numeric_limits<uint64_t>::max)()) {}
+
+  background_executor::~background_executor() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _running = false;
+    }
+    _cv.notify_all();
+    for (auto& worker : _workers) {
+      worker.join();
+    }
+
+    // Tasks left behind are never run again
+    for (auto& slot : _wheel) {
+      for (auto t : slot) {
+        delete t;
+      }
+    }
+    for (auto t : _ready) {
+      delete t;
+    }
+  }
+
+  int background_executor::init(api_status* status) {
+    if (_thread_count == 0) {
+      RETURN_ERROR_ARG(_trace, status, invalid_argument, "The background executor needs at least one thread");
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_running) {
+      return error_code::success;
+    }
+    _running = true;
+    try {
+      for (size_t i = 0; i < _thread_count; ++i) {
+        _workers.emplace_back(&background_executor::worker_loop, this);
+      }
+    }
+    catch (const std::exception& e) {
+      RETURN_ERROR_LS(_trace, status, background_thread_start) << " (background executor)" << e.what();
+    }
+    return error_code::success;
+  }
+
+  background_executor::task* background_executor::schedule(task_fn fn, std::chrono::milliseconds delay) {
+    auto t = new task(std::move(fn));
+    std::lock_guard<std::mutex> lock(_mutex);
+    insert(t, due_tick(delay));
+    return t;
+  }
+
+  void background_executor::wake(task* t) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (t->current == task::state::waiting) {
+      remove(t);
+      insert(t, _current_tick);
+    }
+    else if (t->current == task::state::running) {
+      t->woken = true;
+    }
+  }
+
+  void background_executor::cancel(task* t) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (t->current == task::state::running) {
+      t->cancelled = true;
+      if (t->runner == std::this_thread::get_id()) {
+        t->self_cancelled = true;
+        return;
+      }
+      _done_cv.wait(lock, [t] { return t->current == task::state::done; });
+    }
+    else if (t->current == task::state::ready) {
+      _ready.erase(std::find(_ready.begin(), _ready.end(), t));
+    }
+    else {
+      remove(t);
+    }
+    lock.unlock();
+    delete t;
+  }
+
+  size_t background_executor::thread_count() const {
+    return _thread_count;
+  }
+
+  int background_executor::get_shared(size_t thread_count, std::shared_ptr<background_executor>& executor, i_trace* trace, api_status* status) {
+    static std::mutex shared_mutex;
+    static std::weak_ptr<background_executor> shared;
+
+    std::lock_guard<std::mutex> lock(shared_mutex);
+    executor = shared.lock();
+    if (executor != nullptr) {
+      if (executor->thread_count() != thread_count) {
+        TRACE_INFO(trace, concat("The background executor already runs ", executor->thread_count(), " threads, ", thread_count, " were requested"));
+      }
+      return error_code::success;
+    }
+
+    std::shared_ptr<background_executor> created(new background_executor(thread_count, trace));
+    RETURN_IF_FAIL(created->init(status));
+    shared = created;
+    executor = std::move(created);
+    return error_code::success;
+  }
+
+  uint64_t background_executor::now_tick() const {
+    return static_cast<uint64_t>((clock_t::now() - _start) / TICK);
+  }
+
+  uint64_t background_executor::due_tick(std::chrono::milliseconds delay) const {
+    if (delay.count() <= 0) {
+      return _current_tick;
+    }
+    // Round up, so that a task never runs before its delay is over
+    const auto due = clock_t::now() - _start + delay;
+    return static_cast<uint64_t>((due + TICK - clock_t::duration(1)) / TICK);
+  }
+
+  void background_executor::insert(task* t, uint64_t tick) {
+    if (tick <= _current_tick) {
+      t->current = task::state::ready;
+      _ready.push_back(t);
+      _cv.notify_one();
+      return;
+    }
+
+    t->current = task::state::waiting;
+    t->due_tick = tick;
+    _wheel[tick % WHEEL_SLOTS].push_back(t);
+    _next_due_tick = (std::min)(_next_due_tick, tick);
+    // The waiting worker has to wake earlier
+    if (_ticking && tick < _wait_tick) {
+      _cv.notify_all();
+    }
+  }
+
+  void background_executor::remove(task* t) {
+    auto& slot = _wheel[t->due_tick % WHEEL_SLOTS];
+    auto it = std::find(slot.begin(), slot.end(), t);
+    *it = slot.back();
+    slot.pop_back();
+  }
+
+  void background_executor::advance(uint64_t to_tick) {
+    if (to_tick <= _current_tick) {
+      return;
+    }
+
+    // Each slot is visited once, even when the workers fell behind by more than a turn of the wheel
+    const auto from_tick = (std::max)(_current_tick + 1, to_tick >= WHEEL_SLOTS ? to_tick - WHEEL_SLOTS + 1 : 0);
+    for (auto tick = from_tick; tick <= to_tick; ++tick) {
+      auto& slot = _wheel[tick % WHEEL_SLOTS];
+      for (size_t i = 0; i < slot.size();) {
+        auto t = slot[i];
+        if (t->due_tick > to_tick) {
+          ++i;
+          continue;
+        }
+        slot[i] = slot.back();
+        slot.pop_back();
+        t->current = task::state::ready;
+        _ready.push_back(t);
+      }
+    }
+    _current_tick = to_tick;
+  }
+
+  uint64_t background_executor::next_due_tick() {
+    if (_next_due_tick > _current_tick) {
+      return _next_due_tick;
+    }
+
+    // The first slot holding a task due on its tick ends the walk. Tasks due on a later turn only count when none is.
+    auto later = (std::numeric_limits<uint64_t>::max)();
+    for (auto tick = _current_tick + 1; tick <= _current_tick + WHEEL_SLOTS; ++tick) {
+      for (auto t : _wheel[tick % WHEEL_SLOTS]) {
+        if (t->due_tick == tick) {
+          return _next_due_tick = tick;
+        }
+        later = (std::min)(later, t->due_tick);
+      }
+    }
+    return _next_due_tick = later;
+  }
+
+  void background_executor::finish(task* t, std::chrono::milliseconds delay) {
+    t->runner = std::thread::id();
+    if (t->cancelled) {
+      if (t->self_cancelled) {
+        delete t;
+      }
+      else {
+        t->current = task::state::done;
+        _done_cv.notify_all();
+      }
+      return;
+    }
+
+    if (t->woken) {
+      t->woken = false;
+      delay = std::chrono::milliseconds(0);
+    }
+    insert(t, due_tick(delay));
+  }
+
+  void background_executor::worker_loop() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (_running) {
+      if (!_ready.empty()) {
+        auto t = _ready.front();
+        _ready.pop_front();
+        t->current = task::state::running;
+        t->runner = std::this_thread::get_id();
+
+        lock.unlock();
+        const auto delay = t->fn();
+        lock.lock();
+
+        finish(t, delay);
+        continue;
+      }
+
+      if (_ticking) {
+        _cv.wait(lock);
+        continue;
+      }
+
+      // Only this worker watches the clock until it has a task to run
+      _ticking = true;
+      _wait_tick = next_due_tick();
+      if (_wait_tick == (std::numeric_limits<uint64_t>::max)()) {
+        _cv.wait(lock);
+      }
+      else {
+        _cv.wait_until(lock, _start + TICK * _wait_tick);
+      }
+      _ticking = false;
+      advance(now_tick());
+      if (!_ready.empty()) {
+        // Someone else watches the clock while this worker runs a task
+        _cv.notify_all();
+      }
+    }
+  }
+}}
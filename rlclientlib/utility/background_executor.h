@@ -0,0 +1,87 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace reinforcement_learning {
+  class api_status;
+  class i_trace;
+  namespace utility {
+    /**
+     * Runs periodic background work on a small pool of worker threads shared by every live_model of the process.
+     *
+     * Due times are kept on a hashed timer wheel, so scheduling, waking and cancelling a task do not depend on the
+     * number of tasks. The earliest due tick is kept as well; once it has passed, the next one is found by walking the
+     * wheel forward from it. One idle worker at a time waits for the next due tick while the others wait for ready tasks.
+     * A task never runs on two workers at once.
+     */
+    class background_executor {
+    public:
+      //! Runs one iteration of a task and returns the delay before the next one
+      using task_fn = std::function<std::chrono::milliseconds()>;
+      class task;
+
+      static const std::chrono::milliseconds TICK;
+      static const size_t WHEEL_SLOTS = 512;
+
+      explicit background_executor(size_t thread_count, i_trace* trace = nullptr);
+      //! Every task must have been cancelled
+      ~background_executor();
+
+      background_executor(const background_executor&) = delete;
+      background_executor& operator=(const background_executor&) = delete;
+
+      int init(api_status* status);
+
+      //! Runs fn after delay, then again after each delay it returns. The task is valid until it is cancelled.
+      task* schedule(task_fn fn, std::chrono::milliseconds delay);
+      //! Runs the task now rather than at its due time. A running task runs again as soon as it is done.
+      void wake(task* t);
+      //! Removes the task and waits for its current run to end. A task cancelling itself does not wait.
+      void cancel(task* t);
+
+      size_t thread_count() const;
+
+      //! Executor of the process. The first caller picks the number of workers, the last reference stops them.
+      static int get_shared(size_t thread_count, std::shared_ptr<background_executor>& executor, i_trace* trace, api_status* status);
+
+    private:
+      using clock_t = std::chrono::steady_clock;
+
+      // All of these expect _mutex to be held
+      uint64_t now_tick() const;
+      uint64_t due_tick(std::chrono::milliseconds delay) const;
+      void insert(task* t, uint64_t tick);
+      void remove(task* t);
+      void advance(uint64_t to_tick);
+      uint64_t next_due_tick();
+      void finish(task* t, std::chrono::milliseconds delay);
+
+      void worker_loop();
+
+      const size_t _thread_count;
+      i_trace* _trace;
+      const clock_t::time_point _start;
+
+      std::mutex _mutex;
+      std::condition_variable _cv;       // Workers wait for ready tasks or due ticks
+      std::condition_variable _done_cv;  // Cancel waits for the current run
+      std::vector<std::vector<task*>> _wheel;
+      std::deque<task*> _ready;
+      uint64_t _current_tick = 0;        // Every task due up to this tick has left the wheel
+      uint64_t _next_due_tick;           // No task on the wheel is due before it, stale once cancelled or woken
+      bool _ticking = false;             // A worker waits for the next due tick
+      uint64_t _wait_tick = 0;           // The tick it waits for
+      bool _running = false;
+
+      std::vector<std::thread> _workers;
+    };
+  }
+}
@@ -1,8 +1,10 @@
 #include "config_helper.h"
 #include "constants.h"
+#include "str_util.h"
 
+#include <algorithm>
 #include <cstring>
-#include <sstream>
+#include <string>
 
 #ifndef _WIN32
 #define _stricmp strcasecmp
@@ -12,21 +14,23 @@
 namespace reinforcement_learning
 {
   queue_mode_enum to_queue_mode_enum(const char *queue_mode) {
-    if (_stricmp(queue_mode, "BLOCK") == 0) {
-      return queue_mode_enum::BLOCK;
-    } else {
-      return queue_mode_enum::DROP;
-    }
+    queue_mode_enum res;
+    return utility::parse_queue_mode(queue_mode, res) ? res : queue_mode_enum::DROP;
   }
 
 namespace utility {
 
-static int get_int(const configuration &config, const char *section, const char *property, int defval)
+static std::string section_key(const char *section, const char *property)
 {
+  std::string key(section);
+  key += '.';
+  key += property;
+  return key;
+}
 
-  std::stringstream ss;
-  ss << section << "." << property;
-  auto tmp = ss.str();
+static int get_int(const configuration &config, const char *section, const char *property, int defval)
+{
+  const auto tmp = section_key(section, property);
   const char *key = tmp.c_str();
   if(config.get(key, NULL) != nullptr) {
     return config.get_int(key, defval);
@@ -35,11 +39,19 @@ static int get_int(const configuration &config, const char *section, const char
 }
 
 
+static float get_float(const configuration &config, const char *section, const char *property, float defval)
+{
+  const auto tmp = section_key(section, property);
+  const char *key = tmp.c_str();
+  if(config.get(key, NULL) != nullptr) {
+    return config.get_float(key, defval);
+  }
+  return config.get_float(property, defval);
+}
+
 static const char* get_str(const configuration &config, const char *section, const char *property, const char* defval)
 {
-  std::stringstream ss;
-  ss << section << "." << property;
-  auto tmp  = ss.str();
+  const auto tmp = section_key(section, property);
   const char *key = tmp.c_str();
   if(config.get(key, NULL) != nullptr) {
     return config.get(key, defval);
@@ -47,21 +59,56 @@ static const char* get_str(const configuration &config, const char *section, con
   return config.get(property, defval);
 }
 
+bool parse_queue_mode(const char *text, queue_mode_enum &queue_mode)
+{
+  std::string value(text);
+  str_util::trim(value);
+  if (_stricmp(value.c_str(), value::QUEUE_MODE_DROP) == 0) {
+    queue_mode = queue_mode_enum::DROP;
+  } else if (_stricmp(value.c_str(), value::QUEUE_MODE_BLOCK) == 0) {
+    queue_mode = queue_mode_enum::BLOCK;
+  } else if (_stricmp(value.c_str(), value::QUEUE_MODE_ADAPTIVE) == 0) {
+    queue_mode = queue_mode_enum::ADAPTIVE;
+  } else {
+    return false;
+  }
+  return true;
+}
+
 async_batcher_config get_batcher_config(const configuration &config, const char *section)
 {
   async_batcher_config res;
-  res.send_high_water_mark = get_int(config, section, name::SEND_HIGH_WATER_MARK, 198 * 1024);
-  res.send_batch_interval_ms = get_int(config, section, name::SEND_BATCH_INTERVAL_MS, 1000);
-  res.send_queue_max_capacity = get_int(config, section, name::SEND_QUEUE_MAX_CAPACITY_KB, 16 * 1024) * 1024;
+  res.section = section;
+  res.send_high_water_mark = get_int(config, section, name::SEND_HIGH_WATER_MARK, value::DEFAULT_SEND_HIGH_WATER_MARK);
+  res.send_batch_interval_ms = get_int(config, section, name::SEND_BATCH_INTERVAL_MS, value::DEFAULT_SEND_BATCH_INTERVAL_MS);
+  res.flush_on_high_water_mark = config.get_bool(section, name::SEND_FLUSH_ON_HIGH_WATER_MARK, value::DEFAULT_SEND_FLUSH_ON_HIGH_WATER_MARK);
+  res.send_queue_max_capacity = get_int(config, section, name::SEND_QUEUE_MAX_CAPACITY_KB, value::DEFAULT_SEND_QUEUE_MAX_CAPACITY_KB) * 1024;
   res.queue_mode = to_queue_mode_enum(get_str(config, section, name::QUEUE_MODE, value::QUEUE_MODE_DROP));
-  res.batch_content_encoding = config.get_bool(section, name::USE_DEDUP, false) ? value::CONTENT_ENCODING_DEDUP : value::CONTENT_ENCODING_IDENTITY;
+  res.queue_block_timeout_ms = get_int(config, section, name::QUEUE_BLOCK_TIMEOUT_MS, default_queue_block_timeout_ms(res.queue_mode));
+  res.adaptive_low_water_mark = get_float(config, section, name::QUEUE_ADAPTIVE_LOW_WATER_MARK, value::DEFAULT_QUEUE_ADAPTIVE_LOW_WATER_MARK);
+  res.adaptive_min_pass_prob = get_float(config, section, name::QUEUE_ADAPTIVE_MIN_PASS_PROB, value::DEFAULT_QUEUE_ADAPTIVE_MIN_PASS_PROB);
+  res.buffer_pool_max_kb = std::max(0, get_int(config, section, name::SEND_BUFFER_POOL_MAX_KB, value::DEFAULT_SEND_BUFFER_POOL_MAX_KB));
+  res.batch_content_encoding = config.get_bool(section, name::USE_DEDUP, value::DEFAULT_USE_DEDUP) ? value::CONTENT_ENCODING_DEDUP : value::CONTENT_ENCODING_IDENTITY;
   return res;
 }
 
+int default_queue_block_timeout_ms(queue_mode_enum queue_mode)
+{
+  return queue_mode == queue_mode_enum::ADAPTIVE ? 0 : -1;
+}
+
 async_batcher_config::async_batcher_config():
-  send_high_water_mark(198 * 1024),
-  send_batch_interval_ms(1000),
-  send_queue_max_capacity(16 * 1024 * 1024),
-  queue_mode(queue_mode_enum::DROP) {}
+  section("batcher"),
+  send_high_water_mark(value::DEFAULT_SEND_HIGH_WATER_MARK),
+  send_batch_interval_ms(value::DEFAULT_SEND_BATCH_INTERVAL_MS),
+  flush_on_high_water_mark(value::DEFAULT_SEND_FLUSH_ON_HIGH_WATER_MARK),
+  send_queue_max_capacity(value::DEFAULT_SEND_QUEUE_MAX_CAPACITY_KB * 1024),
+  queue_mode(queue_mode_enum::DROP),
+  queue_block_timeout_ms(default_queue_block_timeout_ms(queue_mode_enum::DROP)),
+  adaptive_low_water_mark(value::DEFAULT_QUEUE_ADAPTIVE_LOW_WATER_MARK),
+  adaptive_min_pass_prob(value::DEFAULT_QUEUE_ADAPTIVE_MIN_PASS_PROB),
+  buffer_pool_max_kb(value::DEFAULT_SEND_BUFFER_POOL_MAX_KB),
+  batch_content_encoding(value::DEFAULT_USE_DEDUP ? value::CONTENT_ENCODING_DEDUP : value::CONTENT_ENCODING_IDENTITY),
+  snapshot(nullptr) {}
 
 }}
@@ -5,7 +5,8 @@ namespace reinforcement_learning {
   //this enum sets the behavior of the queue managed by the async_batcher
   enum class queue_mode_enum {
     DROP,//queue drops events if it is full (default)
-    BLOCK//queue block if it is full
+    BLOCK,//queue block if it is full
+    ADAPTIVE//queue subsamples events as it fills up, and waits for a bounded time if it is full
   };
 
   // Section constants to be used with get_batcher_config
@@ -13,16 +14,31 @@ namespace reinforcement_learning {
   const char *const INTERACTION_SECTION = "interaction";
 
 namespace utility {
+  class config_snapshot;
+
   struct async_batcher_config {
     async_batcher_config();
+    const char* section; //prefix of the metrics of the batcher
     int send_high_water_mark;
     int send_batch_interval_ms;
+    bool flush_on_high_water_mark; //also flush as soon as queued events reach send_high_water_mark
     int send_queue_max_capacity;
     queue_mode_enum queue_mode;
+    int queue_block_timeout_ms; //negative waits until there is room in the queue
+    float adaptive_low_water_mark; //fraction of send_queue_max_capacity at which ADAPTIVE starts subsampling
+    float adaptive_min_pass_prob; //lowest pass probability ADAPTIVE will use before the queue is full
+    int buffer_pool_max_kb; //capacity of the batch buffers kept for reuse, negative settings are read as 0
     // bool use_compression;
     // bool use_dedup;
     const char *batch_content_encoding;
+    const config_snapshot *snapshot; //reloadable settings are followed from it when set
   };
 
   async_batcher_config get_batcher_config(const configuration& config, const char* section);
+
+  //reads a QUEUE_MODE value, ignoring case and surrounding spaces. Returns false when the mode is unknown
+  bool parse_queue_mode(const char* text, queue_mode_enum& queue_mode);
+
+  //ADAPTIVE never waits by default since it relies on subsampling to keep room in the queue
+  int default_queue_block_timeout_ms(queue_mode_enum queue_mode);
 }}
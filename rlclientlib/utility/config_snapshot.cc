@@ -0,0 +1,310 @@
+#include "config_snapshot.h"
+#include "api_status.h"
+#include "constants.h"
+#include "err_constants.h"
+#include "str_util.h"
+#include "trace_logger.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace reinforcement_learning { namespace utility {
+  namespace {
+    enum class value_type { INT, FLOAT, BOOL, QUEUE_MODE };
+
+    struct key_definition {
+      const char* name;
+      value_type type;
+      bool sectioned;   // Can be overridden per section
+      bool reloadable;
+      int int_default;  // INT, BOOL and QUEUE_MODE
+      float float_default;
+    };
+
+    // Indexed by config_key
+    const key_definition KEY_DEFINITIONS[] = {
+      { name::INITIAL_EPSILON, value_type::FLOAT, false, true, 0, value::DEFAULT_INITIAL_EPSILON },
+      { name::SEND_HIGH_WATER_MARK, value_type::INT, true, false, value::DEFAULT_SEND_HIGH_WATER_MARK, 0.f },
+      { name::SEND_BATCH_INTERVAL_MS, value_type::INT, true, true, value::DEFAULT_SEND_BATCH_INTERVAL_MS, 0.f },
+      { name::SEND_FLUSH_ON_HIGH_WATER_MARK, value_type::BOOL, true, false, value::DEFAULT_SEND_FLUSH_ON_HIGH_WATER_MARK, 0.f },
+      { name::SEND_QUEUE_MAX_CAPACITY_KB, value_type::INT, true, false, value::DEFAULT_SEND_QUEUE_MAX_CAPACITY_KB, 0.f },
+      { name::QUEUE_MODE, value_type::QUEUE_MODE, true, true, static_cast<int>(queue_mode_enum::DROP), 0.f },
+      // Unused, the timeout of a queue mode applies until the key is set
+      { name::QUEUE_BLOCK_TIMEOUT_MS, value_type::INT, true, false, -1, 0.f },
+      { name::QUEUE_ADAPTIVE_LOW_WATER_MARK, value_type::FLOAT, true, false, 0, value::DEFAULT_QUEUE_ADAPTIVE_LOW_WATER_MARK },
+      { name::QUEUE_ADAPTIVE_MIN_PASS_PROB, value_type::FLOAT, true, false, 0, value::DEFAULT_QUEUE_ADAPTIVE_MIN_PASS_PROB },
+      { name::SEND_BUFFER_POOL_MAX_KB, value_type::INT, true, false, value::DEFAULT_SEND_BUFFER_POOL_MAX_KB, 0.f },
+      { name::USE_DEDUP, value_type::BOOL, true, false, value::DEFAULT_USE_DEDUP, 0.f },
+    };
+    static_assert(sizeof(KEY_DEFINITIONS) / sizeof(KEY_DEFINITIONS[0]) == static_cast<size_t>(config_key::COUNT),
+      "KEY_DEFINITIONS must have an entry for each config_key");
+
+    const char* section_name(config_section section) {
+      switch (section) {
+      case config_section::INTERACTION: return INTERACTION_SECTION;
+      case config_section::OBSERVATION: return OBSERVATION_SECTION;
+      default: return nullptr;
+      }
+    }
+
+    uint32_t int_bits(int value) { return static_cast<uint32_t>(value); }
+
+    uint32_t float_bits(float value) {
+      uint32_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+      return bits;
+    }
+
+    uint32_t default_bits(const key_definition& def) {
+      return def.type == value_type::FLOAT ? float_bits(def.float_default) : int_bits(def.int_default);
+    }
+
+    bool only_spaces(const char* text) {
+      while (*text == ' ' || *text == '\t') ++text;
+      return *text == '\0';
+    }
+
+    int parse(const key_definition& def, const std::string& key, const char* text, uint32_t& bits, i_trace* trace, api_status* status) {
+      char* end = nullptr;
+      errno = 0;
+      switch (def.type) {
+      case value_type::INT: {
+        const long value = std::strtol(text, &end, 10);
+        if (end != text && only_spaces(end) && errno == 0 && value >= INT_MIN && value <= INT_MAX) {
+          bits = int_bits(static_cast<int>(value));
+          return error_code::success;
+        }
+        break;
+      }
+      case value_type::FLOAT: {
+        const float value = std::strtof(text, &end);
+        if (end != text && only_spaces(end) && errno == 0 && std::isfinite(value)) {
+          bits = float_bits(value);
+          return error_code::success;
+        }
+        break;
+      }
+      case value_type::BOOL: {
+        std::string value(text);
+        str_util::trim(str_util::to_lower(value));
+        if (value == "true" || value == "false") {
+          bits = int_bits(value == "true" ? 1 : 0);
+          return error_code::success;
+        }
+        break;
+      }
+      case value_type::QUEUE_MODE: {
+        queue_mode_enum mode;
+        if (parse_queue_mode(text, mode)) {
+          bits = int_bits(static_cast<int>(mode));
+          return error_code::success;
+        }
+        break;
+      }
+      }
+      RETURN_ERROR_LS(trace, status, invalid_configuration) << key << " = '" << text << "'";
+    }
+
+    // How configuration::get_int, get_float and get_bool read a value: the number at the start of the text, or the
+    // default when there is none for a bool or a queue mode
+    uint32_t legacy_bits(const key_definition& def, const char* text) {
+      switch (def.type) {
+      case value_type::INT: {
+        const long value = std::strtol(text, nullptr, 10);
+        return int_bits(static_cast<int>((std::min)((std::max)(value, static_cast<long>(INT_MIN)), static_cast<long>(INT_MAX))));
+      }
+      case value_type::FLOAT:
+        return float_bits(std::strtof(text, nullptr));
+      default:
+        return default_bits(def);
+      }
+    }
+
+    // Configurations written before values were checked may hold values like "100ms". They are read as before with a
+    // warning, so that they still initialize.
+    void parse_or_legacy(const key_definition& def, const std::string& key, const char* text, uint32_t& bits, i_trace* trace) {
+      if (parse(def, key, text, bits, nullptr, nullptr) != error_code::success) {
+        bits = legacy_bits(def, text);
+        TRACE_WARN(trace, concat("Invalid configuration value ", key, " = '", text, "', read as in earlier versions"));
+      }
+    }
+
+    std::string section_key(config_section section, const key_definition& def) {
+      std::string key(section_name(section));
+      key += '.';
+      key += def.name;
+      return key;
+    }
+  }
+
+  config_snapshot::config_snapshot() {
+    for (size_t k = 0; k < KEYS; ++k) {
+      for (size_t s = 0; s < SECTIONS; ++s) {
+        _entries[s][k].bits.store(default_bits(KEY_DEFINITIONS[k]), std::memory_order_relaxed);
+      }
+    }
+  }
+
+  int config_snapshot::resolve(const configuration& config, i_trace* trace, api_status* status) {
+    std::lock_guard<std::mutex> lock(_reload_mutex);
+    for (size_t k = 0; k < KEYS; ++k) {
+      const auto& def = KEY_DEFINITIONS[k];
+      auto& global = _entries[0][k];
+      uint32_t bits = default_bits(def);
+      const char* text = config.get(def.name, nullptr);
+      if (text != nullptr) {
+        parse_or_legacy(def, def.name, text, bits, trace);
+      }
+      global.bits.store(bits, std::memory_order_relaxed);
+      global.is_set = text != nullptr;
+      global.from_section = false;
+
+      for (size_t s = 1; s < SECTIONS; ++s) {
+        auto& entry = _entries[s][k];
+        entry.bits.store(bits, std::memory_order_relaxed);
+        entry.is_set = global.is_set;
+        entry.from_section = false;
+        if (!def.sectioned) {
+          continue;
+        }
+
+        const auto key = section_key(static_cast<config_section>(s), def);
+        const char* section_text = config.get(key.c_str(), nullptr);
+        if (section_text != nullptr) {
+          uint32_t section_bits;
+          parse_or_legacy(def, key, section_text, section_bits, trace);
+          entry.bits.store(section_bits, std::memory_order_relaxed);
+          entry.is_set = true;
+          entry.from_section = true;
+        }
+      }
+    }
+    _version.fetch_add(1, std::memory_order_release);
+    return error_code::success;
+  }
+
+  int config_snapshot::reload(const configuration& changes, i_trace* trace, api_status* status) {
+    struct update {
+      size_t key;
+      config_section section;
+      uint32_t bits;
+    };
+
+    std::lock_guard<std::mutex> lock(_reload_mutex);
+
+    // Validate everything before changing anything. Global values go first, so a section value in the same changes wins.
+    std::vector<update> updates;
+    for (size_t s = 0; s < SECTIONS; ++s) {
+      const auto section = static_cast<config_section>(s);
+      for (size_t k = 0; k < KEYS; ++k) {
+        const auto& def = KEY_DEFINITIONS[k];
+        if (section != config_section::GLOBAL && !def.sectioned) {
+          continue;
+        }
+        const auto key = section == config_section::GLOBAL ? std::string(def.name) : section_key(section, def);
+        const char* text = changes.get(key.c_str(), nullptr);
+        if (text == nullptr) {
+          continue;
+        }
+        if (!def.reloadable) {
+          RETURN_ERROR_LS(trace, status, configuration_not_reloadable) << key;
+        }
+        uint32_t bits;
+        RETURN_IF_FAIL(parse(def, key, text, bits, trace, status));
+        updates.push_back({ k, section, bits });
+      }
+    }
+
+    for (const auto& u : updates) {
+      if (u.section != config_section::GLOBAL) {
+        auto& entry = _entries[static_cast<size_t>(u.section)][u.key];
+        entry.bits.store(u.bits, std::memory_order_relaxed);
+        entry.from_section = true;
+        continue;
+      }
+      for (size_t s = 0; s < SECTIONS; ++s) {
+        auto& entry = _entries[s][u.key];
+        if (!entry.from_section) {
+          entry.bits.store(u.bits, std::memory_order_relaxed);
+        }
+      }
+    }
+
+    if (!updates.empty()) {
+      _version.fetch_add(1, std::memory_order_release);
+    }
+    return error_code::success;
+  }
+
+  int config_snapshot::get_int(config_key key, config_section section) const {
+    return static_cast<int>(at(key, section).bits.load(std::memory_order_relaxed));
+  }
+
+  float config_snapshot::get_float(config_key key, config_section section) const {
+    const uint32_t bits = at(key, section).bits.load(std::memory_order_relaxed);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  bool config_snapshot::get_bool(config_key key, config_section section) const {
+    return at(key, section).bits.load(std::memory_order_relaxed) != 0;
+  }
+
+  queue_mode_enum config_snapshot::get_queue_mode(config_section section) const {
+    return static_cast<queue_mode_enum>(get_int(config_key::QUEUE_MODE, section));
+  }
+
+  bool config_snapshot::is_set(config_key key, config_section section) const {
+    return at(key, section).is_set;
+  }
+
+  uint64_t config_snapshot::version() const {
+    return _version.load(std::memory_order_acquire);
+  }
+
+  config_snapshot::entry& config_snapshot::at(config_key key, config_section section) {
+    return _entries[static_cast<size_t>(section)][static_cast<size_t>(key)];
+  }
+
+  const config_snapshot::entry& config_snapshot::at(config_key key, config_section section) const {
+    return _entries[static_cast<size_t>(section)][static_cast<size_t>(key)];
+  }
+
+  config_section to_config_section(const char* section) {
+    if (std::strcmp(section, INTERACTION_SECTION) == 0) {
+      return config_section::INTERACTION;
+    }
+    if (std::strcmp(section, OBSERVATION_SECTION) == 0) {
+      return config_section::OBSERVATION;
+    }
+    return config_section::GLOBAL;
+  }
+
+  async_batcher_config get_batcher_config(const config_snapshot& config, const char* section) {
+    const auto s = to_config_section(section);
+    async_batcher_config res;
+    res.section = section;
+    res.send_high_water_mark = config.get_int(config_key::SEND_HIGH_WATER_MARK, s);
+    res.send_batch_interval_ms = config.get_int(config_key::SEND_BATCH_INTERVAL_MS, s);
+    res.flush_on_high_water_mark = config.get_bool(config_key::SEND_FLUSH_ON_HIGH_WATER_MARK, s);
+    res.send_queue_max_capacity = config.get_int(config_key::SEND_QUEUE_MAX_CAPACITY_KB, s) * 1024;
+    res.queue_mode = config.get_queue_mode(s);
+    res.queue_block_timeout_ms = default_queue_block_timeout_ms(res.queue_mode);
+    if (config.is_set(config_key::QUEUE_BLOCK_TIMEOUT_MS, s)) {
+      res.queue_block_timeout_ms = config.get_int(config_key::QUEUE_BLOCK_TIMEOUT_MS, s);
+    }
+    res.adaptive_low_water_mark = config.get_float(config_key::QUEUE_ADAPTIVE_LOW_WATER_MARK, s);
+    res.adaptive_min_pass_prob = config.get_float(config_key::QUEUE_ADAPTIVE_MIN_PASS_PROB, s);
+    res.buffer_pool_max_kb = std::max(0, config.get_int(config_key::SEND_BUFFER_POOL_MAX_KB, s));
+    res.batch_content_encoding = config.get_bool(config_key::USE_DEDUP, s) ? value::CONTENT_ENCODING_DEDUP : value::CONTENT_ENCODING_IDENTITY;
+    res.snapshot = &config;
+    return res;
+  }
+}}
@@ -0,0 +1,91 @@
+#pragma once
+#include "configuration.h"
+#include "config_helper.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace reinforcement_learning {
+  class api_status;
+  class i_trace;
+
+namespace utility {
+  //! Settings resolved by a config_snapshot
+  enum class config_key {
+    INITIAL_EPSILON,
+    // Async batcher settings. A value set for the section (e.g. interaction.queue.mode) overrides the global one.
+    SEND_HIGH_WATER_MARK,
+    SEND_BATCH_INTERVAL_MS,
+    SEND_FLUSH_ON_HIGH_WATER_MARK,
+    SEND_QUEUE_MAX_CAPACITY_KB,
+    QUEUE_MODE,
+    QUEUE_BLOCK_TIMEOUT_MS,
+    QUEUE_ADAPTIVE_LOW_WATER_MARK,
+    QUEUE_ADAPTIVE_MIN_PASS_PROB,
+    SEND_BUFFER_POOL_MAX_KB,
+    USE_DEDUP,
+    COUNT
+  };
+
+  enum class config_section {
+    GLOBAL,
+    INTERACTION,  // INTERACTION_SECTION
+    OBSERVATION,  // OBSERVATION_SECTION
+    COUNT
+  };
+
+  /**
+   * Typed view of a configuration, parsed and validated once so that reading a setting is an array access.
+   *
+   * INITIAL_EPSILON, SEND_BATCH_INTERVAL_MS and QUEUE_MODE can be reloaded while the snapshot is in use: each value
+   * is replaced atomically and version() changes once a reload is complete.
+   */
+  class config_snapshot {
+  public:
+    config_snapshot();
+
+    //! Parse every key of the configuration. A value of the wrong type is read like configuration::get_int and the
+    //! other getters read it, with a warning.
+    int resolve(const configuration& config, i_trace* trace, api_status* status);
+
+    //! Replace the reloadable keys set in changes. Fails with invalid_configuration on a value of the wrong type, and
+    //! nothing is changed if a value is invalid or not reloadable.
+    int reload(const configuration& changes, i_trace* trace, api_status* status);
+
+    int get_int(config_key key, config_section section = config_section::GLOBAL) const;
+    float get_float(config_key key, config_section section = config_section::GLOBAL) const;
+    bool get_bool(config_key key, config_section section = config_section::GLOBAL) const;
+    queue_mode_enum get_queue_mode(config_section section = config_section::GLOBAL) const;
+    //! Whether the configuration given to resolve set the key, for settings defaulting on others
+    bool is_set(config_key key, config_section section = config_section::GLOBAL) const;
+
+    //! Changes after each reload
+    uint64_t version() const;
+
+    config_snapshot(const config_snapshot&) = delete;
+    config_snapshot& operator=(const config_snapshot&) = delete;
+
+  private:
+    static const size_t KEYS = static_cast<size_t>(config_key::COUNT);
+    static const size_t SECTIONS = static_cast<size_t>(config_section::COUNT);
+
+    struct entry {
+      std::atomic<uint32_t> bits{ 0 };  // int, bool and queue_mode_enum as int32, float by its representation
+      bool is_set = false;
+      bool from_section = false;        // Set by the section key, a reload of the global key leaves it alone
+    };
+
+    entry& at(config_key key, config_section section);
+    const entry& at(config_key key, config_section section) const;
+
+    std::mutex _reload_mutex;
+    entry _entries[SECTIONS][KEYS];
+    std::atomic<uint64_t> _version{ 0 };
+  };
+
+  //! Section of a batcher from its name (INTERACTION_SECTION or OBSERVATION_SECTION)
+  config_section to_config_section(const char* section);
+
+  async_batcher_config get_batcher_config(const config_snapshot& config, const char* section);
+}}
@@ -103,8 +103,8 @@ namespace reinforcement_learning { namespace utility { namespace config {
       { "initialExplorationEpsilon" , name::INITIAL_EPSILON },
       { "ModelRefreshIntervalMs"    , name::MODEL_REFRESH_INTERVAL_MS },
       { "modelRefreshIntervalMs"    , name::MODEL_REFRESH_INTERVAL_MS },
-      { "QueueMode"                 , name::QUEUE_MODE }, // expect either DROP or BLOCK, default is DROP
-      { "queueMode"                 , name::QUEUE_MODE }, // expect either DROP or BLOCK, default is DROP
+      { "QueueMode"                 , name::QUEUE_MODE }, // expect DROP, BLOCK or ADAPTIVE, default is DROP
+      { "queueMode"                 , name::QUEUE_MODE }, // expect DROP, BLOCK or ADAPTIVE, default is DROP
       { "LearningMode"              , name::LEARNING_MODE},
       { "learningMode"              , name::LEARNING_MODE},
       { "InitialCommandLine"        , name::MODEL_VW_INITIAL_COMMAND_LINE},
@@ -67,9 +67,9 @@ namespace reinforcement_learning { namespace utility {
   }
 
   bool configuration::get_bool(const char *section, const char *name, bool defval) const {
-    std::stringstream ss;
-    ss << section << "." << name;
-    auto tmp = ss.str();
+    std::string tmp(section);
+    tmp += '.';
+    tmp += name;
     const char *key = tmp.c_str();
     if(get(key, NULL) != nullptr) {
       return get_bool(key, defval);
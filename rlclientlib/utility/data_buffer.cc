@@ -14,7 +14,7 @@ namespace reinforcement_learning {
     }
 
     void data_buffer::reset() {
-      _buffer.resize(_preamble_size + 1);
+      // Keep the body region so a reused buffer does not grow again to the size it had
       _body_beginoffset = _preamble_size;
       _body_endoffset = _preamble_size;
     }
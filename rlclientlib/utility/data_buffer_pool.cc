@@ -0,0 +1,109 @@
+#include "data_buffer_pool.h"
+
+#include <mutex>
+#include <vector>
+
+namespace reinforcement_learning { namespace utility {
+  namespace {
+    // Class k holds buffers with a body capacity in [2^k, 2^(k+1)), larger buffers are not pooled
+    const size_t SIZE_CLASSES = 32;
+
+    size_t floor_log2(size_t value) {
+      size_t log = 0;
+      while (value >>= 1) {
+        ++log;
+      }
+      return log;
+    }
+
+    size_t ceil_log2(size_t value) {
+      return value <= 1 ? 0 : floor_log2(value - 1) + 1;
+    }
+  }
+
+  struct data_buffer_pool::state {
+    explicit state(size_t max_pooled_bytes) : max_pooled_bytes(max_pooled_bytes) {}
+
+    ~state() {
+      for (auto& size_class : classes) {
+        for (auto buffer : size_class) {
+          delete buffer;
+        }
+      }
+    }
+
+    std::mutex mutex;
+    std::vector<data_buffer*> classes[SIZE_CLASSES];
+    const size_t max_pooled_bytes;
+    bool closed = false;
+    data_buffer_pool_stats stats;
+  };
+
+  data_buffer_pool::data_buffer_pool(size_t initial_body_size, size_t max_pooled_bytes)
+    : _initial_body_size(initial_body_size == 0 ? 1 : initial_body_size), _state(std::make_shared<state>(max_pooled_bytes))
+  {}
+
+  data_buffer_pool::~data_buffer_pool() {
+    // Buffers still in use are freed when they are released
+    std::lock_guard<std::mutex> lock(_state->mutex);
+    _state->closed = true;
+  }
+
+  std::shared_ptr<data_buffer> data_buffer_pool::acquire(size_t body_size) {
+    const size_t size = body_size == 0 ? _initial_body_size : body_size;
+    const size_t size_class = ceil_log2(size);
+
+    data_buffer* buffer = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(_state->mutex);
+      for (size_t i = size_class; i < SIZE_CLASSES && buffer == nullptr; ++i) {
+        auto& pooled = _state->classes[i];
+        if (!pooled.empty()) {
+          buffer = pooled.back();
+          pooled.pop_back();
+          _state->stats.pooled_bytes -= buffer->body_capacity();
+          --_state->stats.pooled_buffers;
+          ++_state->stats.reused;
+        }
+      }
+      if (buffer == nullptr) {
+        ++_state->stats.allocated;
+      }
+    }
+
+    if (buffer == nullptr) {
+      buffer = new data_buffer(size_class < SIZE_CLASSES ? size_t(1) << size_class : size);
+    }
+    else {
+      buffer->reset();
+    }
+
+    const auto pool = _state;
+    return std::shared_ptr<data_buffer>(buffer, [pool](data_buffer* released) {
+      release(pool, released);
+    });
+  }
+
+  void data_buffer_pool::release(const std::shared_ptr<state>& pool, data_buffer* buffer) {
+    const size_t capacity = buffer->body_capacity();
+    const size_t size_class = floor_log2(capacity);
+    {
+      std::lock_guard<std::mutex> lock(pool->mutex);
+      if (!pool->closed) {
+        if (size_class < SIZE_CLASSES && pool->stats.pooled_bytes + capacity <= pool->max_pooled_bytes) {
+          pool->classes[size_class].push_back(buffer);
+          pool->stats.pooled_bytes += capacity;
+          ++pool->stats.pooled_buffers;
+          return;
+        }
+        ++pool->stats.discarded;
+      }
+    }
+    delete buffer;
+  }
+
+  void data_buffer_pool::get_stats(data_buffer_pool_stats& stats) const {
+    std::lock_guard<std::mutex> lock(_state->mutex);
+    stats = _state->stats;
+  }
+}}
@@ -0,0 +1,53 @@
+#pragma once
+#include "data_buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace reinforcement_learning { namespace utility {
+
+  struct data_buffer_pool_stats {
+    //! Buffers waiting to be reused
+    size_t pooled_buffers = 0;
+    //! Body capacity in bytes of the buffers waiting to be reused
+    size_t pooled_bytes = 0;
+    //! Buffers created because no pooled buffer was large enough
+    uint64_t allocated = 0;
+    //! Buffers handed out again
+    uint64_t reused = 0;
+    //! Buffers freed when released because the pool was full
+    uint64_t discarded = 0;
+  };
+
+  /**
+   * Pool of data_buffer which keeps the capacity of buffers across reuse.
+   *
+   * Released buffers are kept in size classes, by the power of two below their body capacity, so acquire hands out the
+   * smallest pooled buffer which holds the size asked for. New buffers reserve that size rounded up to its size class.
+   * Buffers released while the pool already holds max_pooled_bytes are freed.
+   *
+   * Buffers may outlive the pool, they are freed when released.
+   */
+  class data_buffer_pool {
+  public:
+    //! initial_body_size is reserved when no size is given to acquire, usually the size of a full batch
+    data_buffer_pool(size_t initial_body_size, size_t max_pooled_bytes);
+    ~data_buffer_pool();
+
+    data_buffer_pool(const data_buffer_pool&) = delete;
+    data_buffer_pool& operator=(const data_buffer_pool&) = delete;
+
+    //! Empty buffer whose body can hold body_size bytes without growing, initial_body_size when 0
+    std::shared_ptr<data_buffer> acquire(size_t body_size = 0);
+
+    void get_stats(data_buffer_pool_stats& stats) const;
+
+  private:
+    struct state;
+    static void release(const std::shared_ptr<state>& pool, data_buffer* buffer);
+
+    const size_t _initial_body_size;
+    std::shared_ptr<state> _state;
+  };
+}}
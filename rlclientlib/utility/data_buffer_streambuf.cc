@@ -5,8 +5,10 @@
 namespace reinforcement_learning { namespace utility {
   data_buffer_streambuf::data_buffer_streambuf(data_buffer* db) 
   : _db(db) {
-    // Start the buffer with some minimum size
-    _db->resize_body_region(GROW_BY);
+    // Start the buffer with some minimum size, keeping the capacity of reused buffers
+    if (_db->body_capacity() < INITIAL_BODY_SIZE) {
+      _db->resize_body_region(INITIAL_BODY_SIZE);
+    }
     // Set buffer body to start at the beginning of body region
     _db->set_body_beginoffset(_db->preamble_size());
     // Set buffer body to end at the end of filled body which is 
@@ -15,32 +17,35 @@ namespace reinforcement_learning { namespace utility {
     // Sanity check body capacity
     assert(db->body_capacity() > 1);
     // Setup streambuf to write from beginning to end of body region
-    // Reserve one byte for overflow
+    // Reserve one byte for the null terminator written by finalize
     setp( reinterpret_cast<char *>(_db->body_begin()),
           reinterpret_cast<char *>(_db->body_begin() + _db->body_capacity() - 1));
   }
 
   std::streambuf::int_type data_buffer_streambuf::overflow(int_type ch)
   {
-    // save the overflow character
-    char* loc = pptr();
-    *loc = ch;
-    const auto old_body_size = _db->body_filled_size() + _db->body_capacity();
-    _db->set_body_endoffset(_db->preamble_size() + old_body_size);
-    
-    // We are at the end of buffer, increase size
-    try {
-      _db->resize_body_region(old_body_size + GROW_BY);
+    if (traits_type::eq_int_type(ch, traits_type::eof())) {
+      return traits_type::not_eof(ch);
+    }
 
-      setp(
-        reinterpret_cast<char*> (_db->body_begin() + old_body_size),
-        reinterpret_cast<char*> (_db->body_begin() + old_body_size + GROW_BY));
+    const auto used = pptr() - pbase();
 
-      return ch;
+    // We are at the end of buffer, double its size so writing n bytes copies O(n) bytes
+    try {
+      _db->resize_body_region(_db->body_capacity() * 2);
     }
     catch(...) {
-      return EOF;
+      return traits_type::eof();
     }
+
+    // Reserve one byte for the null terminator written by finalize
+    setp( reinterpret_cast<char *>(_db->body_begin()),
+          reinterpret_cast<char *>(_db->body_begin() + _db->body_capacity() - 1));
+    pbump(static_cast<int>(used));
+
+    *pptr() = traits_type::to_char_type(ch);
+    pbump(1);
+    return ch;
   }
 
   std::basic_streambuf<char>::int_type data_buffer_streambuf::sync() {
@@ -18,7 +18,7 @@ namespace reinforcement_learning { namespace utility {
     ~data_buffer_streambuf();
   private:
     data_buffer* _db;
-    const size_t GROW_BY = 2048;
+    const size_t INITIAL_BODY_SIZE = 2048;
     bool _finalized = false;
   };
 }}
@@ -0,0 +1,138 @@
+#include "data_buffer_writer.h"
+#include "data_buffer.h"
+
+#include <cmath>
+#include <cstdio>
+
+namespace reinforcement_learning { namespace utility {
+  namespace {
+    const size_t INITIAL_BODY_SIZE = 4096;
+
+    const double POW10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10 };
+
+    // Writes the digits of value backwards ending at end, returns the first digit.
+    char* format_uint_backwards(uint64_t value, char* end) {
+      do {
+        *--end = static_cast<char>('0' + value % 10);
+        value /= 10;
+      } while (value != 0);
+      return end;
+    }
+
+    // Formats value like printf("%g") using integer arithmetic for the fixed notation range.
+    // Returns false when the value should go through printf instead: exponent notation, non finite values
+    // and values which are too close to a rounding tie to be decided exactly in double precision.
+    bool try_format_g6(float value, char* out, size_t& len) {
+      double x = value;
+      if (!std::isfinite(x) || x == 0.0) return false;
+
+      size_t pos = 0;
+      if (x < 0) {
+        out[pos++] = '-';
+        x = -x;
+      }
+
+      // Decimal exponent of the leading digit, %g uses fixed notation for -4 <= exp < 6
+      int exp = static_cast<int>(std::floor(std::log10(x)));
+      if (exp < -5 || exp > 5) return false;
+
+      double scaled = x * POW10[5 - exp];
+      // log10 can be off by one around powers of 10
+      if (scaled >= 1e6) {
+        if (--exp < -5) return false;
+        scaled = x * POW10[5 - exp];
+      }
+      else if (scaled < 1e5) {
+        if (++exp > 5) return false;
+        scaled = x * POW10[5 - exp];
+      }
+
+      auto digits = static_cast<uint64_t>(scaled);
+      const double frac = scaled - static_cast<double>(digits);
+      if (std::fabs(frac - 0.5) < 1e-9) return false;
+      if (frac > 0.5 && ++digits == 1000000) {
+        digits = 100000;
+        ++exp;
+      }
+      if (exp < -4 || exp > 5) return false;
+
+      // Drop trailing zeros
+      int significant = 6;
+      while (digits % 10 == 0) {
+        digits /= 10;
+        --significant;
+      }
+
+      char buf[8];
+      const char* d = format_uint_backwards(digits, buf + sizeof(buf));
+      if (exp < 0) {
+        out[pos++] = '0';
+        out[pos++] = '.';
+        for (int i = -1; i > exp; --i) out[pos++] = '0';
+        for (int i = 0; i < significant; ++i) out[pos++] = d[i];
+      }
+      else {
+        for (int i = 0; i < significant || i <= exp; ++i) {
+          if (i == exp + 1) out[pos++] = '.';
+          out[pos++] = i < significant ? d[i] : '0';
+        }
+      }
+
+      len = pos;
+      return true;
+    }
+  }
+
+  data_buffer_writer::data_buffer_writer(data_buffer* db)
+    : _db(db), _pos(0) {
+    // Keep whatever capacity the buffer already has
+    if (_db->body_capacity() < INITIAL_BODY_SIZE) {
+      _db->resize_body_region(INITIAL_BODY_SIZE);
+    }
+    _db->set_body_beginoffset(_db->preamble_size());
+    _db->set_body_endoffset(_db->preamble_size());
+    _begin = reinterpret_cast<char*>(_db->body_begin());
+    _capacity = _db->body_capacity();
+  }
+
+  data_buffer_writer::~data_buffer_writer() {
+    finalize();
+  }
+
+  char* data_buffer_writer::grow(size_t len) {
+    auto new_capacity = _capacity * 2;
+    while (_pos + len >= new_capacity) {
+      new_capacity *= 2;
+    }
+    _db->resize_body_region(new_capacity);
+    _begin = reinterpret_cast<char*>(_db->body_begin());
+    _capacity = _db->body_capacity();
+    return _begin + _pos;
+  }
+
+  data_buffer_writer& data_buffer_writer::write_uint(uint64_t value) {
+    char buf[20];
+    char* end = buf + sizeof(buf);
+    const char* begin = format_uint_backwards(value, end);
+    return write(begin, end - begin);
+  }
+
+  data_buffer_writer& data_buffer_writer::write_float(float value) {
+    // Longest fixed notation output is "-0.0000123456" or "-123456", %g exponent notation fits in 16 bytes
+    char buf[32];
+    size_t len = 0;
+    if (!try_format_g6(value, buf, len)) {
+      len = static_cast<size_t>(snprintf(buf, sizeof(buf), "%g", static_cast<double>(value)));
+    }
+    return write(buf, len);
+  }
+
+  void data_buffer_writer::finalize() {
+    if (!_finalized) {
+      _finalized = true;
+      //Null terminate but don't include that in the size
+      *reserve(1) = '\0';
+      _db->set_body_endoffset(_db->preamble_size() + _pos);
+    }
+  }
+}}
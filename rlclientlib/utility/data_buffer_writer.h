@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace reinforcement_learning { namespace utility {
+  class data_buffer;
+  /**
+   * \brief Appends text directly to the body of a data_buffer.
+   * This is used while serializing json into data_buffer and replaces std::ostream over
+   * data_buffer_streambuf: there is no locale lookup or stream sync per write, and the
+   * body grows geometrically instead of by a fixed amount.
+   *
+   * Numbers are formatted exactly as a default-constructed std::ostream formats them.
+   */
+  class data_buffer_writer {
+  public:
+    explicit data_buffer_writer(data_buffer* db);
+    ~data_buffer_writer();
+
+    data_buffer_writer(const data_buffer_writer&) = delete;
+    data_buffer_writer& operator=(const data_buffer_writer&) = delete;
+
+    data_buffer_writer& write(const char* str, size_t len) {
+      memcpy(reserve(len), str, len);
+      _pos += len;
+      return *this;
+    }
+
+    data_buffer_writer& write(const char* str) { return write(str, strlen(str)); }
+    data_buffer_writer& write(const std::string& str) { return write(str.data(), str.size()); }
+
+    // Same output as std::ostream << value
+    data_buffer_writer& write_uint(uint64_t value);
+    // Same output as std::ostream << value with the default precision of 6 (printf "%g")
+    data_buffer_writer& write_float(float value);
+
+    // Number of bytes written so far
+    size_t size() const { return _pos; }
+
+    // Null terminate (not included in the size) and set the body end of the data_buffer
+    void finalize();
+
+  private:
+    char* reserve(size_t len) {
+      return _pos + len < _capacity ? _begin + _pos : grow(len);
+    }
+
+    char* grow(size_t len);
+
+    data_buffer* _db;
+    char* _begin;
+    size_t _pos;
+    size_t _capacity;
+    bool _finalized = false;
+  };
+}}
@@ -0,0 +1,120 @@
+#include "event_id_generator.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <thread>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+namespace reinforcement_learning { namespace utility {
+  namespace {
+    uint64_t splitmix64(uint64_t& x) {
+      uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      return z ^ (z >> 31);
+    }
+
+    uint64_t rotl(uint64_t x, int k) {
+      return (x << k) | (x >> (64 - k));
+    }
+
+    // Forks so far, a forked child would otherwise draw the same ids as its parent from the copied state
+    std::atomic<uint64_t> fork_count(0);
+
+    void on_fork_child() {
+      fork_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // xoshiro256** (Blackman and Vigna), 256 bits of state are plenty for the 122 random bits of a uuid
+    class xoshiro256 {
+    public:
+      xoshiro256() {
+#ifndef _WIN32
+        static const int registered = pthread_atfork(nullptr, nullptr, on_fork_child);
+        (void)registered;
+#endif
+        seed();
+      }
+
+      void reseed_after_fork() {
+        if (_forks != fork_count.load(std::memory_order_relaxed)) {
+          seed();
+        }
+      }
+
+      uint64_t next() {
+        const uint64_t result = rotl(_state[1] * 5, 7) * 9;
+        const uint64_t t = _state[1] << 17;
+        _state[2] ^= _state[0];
+        _state[3] ^= _state[1];
+        _state[1] ^= _state[2];
+        _state[0] ^= _state[3];
+        _state[2] ^= t;
+        _state[3] = rotl(_state[3], 45);
+        return result;
+      }
+
+    private:
+      void seed() {
+        _forks = fork_count.load(std::memory_order_relaxed);
+        uint64_t seed = 0;
+        try {
+          std::random_device device;
+          seed = (static_cast<uint64_t>(device()) << 32) ^ device();
+        }
+        catch (const std::exception&) {
+          // No entropy source, the clock and thread still tell generators apart
+        }
+        seed ^= static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+        seed ^= static_cast<uint64_t>(std::hash<std::thread::id>()(std::this_thread::get_id())) << 1;
+        for (auto& s : _state) {
+          s = splitmix64(seed);
+        }
+      }
+
+      uint64_t _state[4];
+      uint64_t _forks = 0;
+    };
+
+    const char HEX_DIGITS[] = "0123456789abcdef";
+
+    char* write_hex(char* out, uint64_t value, int digits) {
+      for (int shift = (digits - 1) * 4; shift >= 0; shift -= 4) {
+        *out++ = HEX_DIGITS[(value >> shift) & 0xf];
+      }
+      return out;
+    }
+  }
+
+  void generate_uuid(char* buffer) {
+    static thread_local xoshiro256 generator;
+    generator.reseed_after_fork();
+    // Version 4 in the high nibble of the 7th byte, variant 10 in the high bits of the 9th byte (RFC 4122)
+    const uint64_t high = (generator.next() & 0xffffffffffff0fffULL) | 0x0000000000004000ULL;
+    const uint64_t low = (generator.next() & 0x3fffffffffffffffULL) | 0x8000000000000000ULL;
+
+    char* out = buffer;
+    out = write_hex(out, high >> 32, 8);
+    *out++ = '-';
+    out = write_hex(out, high >> 16, 4);
+    *out++ = '-';
+    out = write_hex(out, high, 4);
+    *out++ = '-';
+    out = write_hex(out, low >> 48, 4);
+    *out++ = '-';
+    out = write_hex(out, low, 12);
+    *out = '\0';
+  }
+
+  std::string generate_uuid() {
+    char buffer[UUID_STRING_LENGTH + 1];
+    generate_uuid(buffer);
+    return std::string(buffer, UUID_STRING_LENGTH);
+  }
+}}
@@ -0,0 +1,20 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace reinforcement_learning { namespace utility {
+  //! Length of a formatted uuid, xxxxxxxx-xxxx-4xxx-yxxx-xxxxxxxxxxxx, without the null terminator
+  const size_t UUID_STRING_LENGTH = 36;
+
+  /**
+   * Random (version 4) uuids for auto-generated event ids, formatted like boost::uuids::to_string.
+   *
+   * Each thread draws from its own xoshiro256** generator, seeded from std::random_device the first time the thread
+   * asks for an id, and again in a child process after fork(). An id then costs a few multiplies and a table lookup
+   * per digit, instead of seeding a new boost::uuids::random_generator from the OS entropy source.
+   *
+   * The buffer overload writes a null terminated uuid and must be given UUID_STRING_LENGTH + 1 chars.
+   */
+  void generate_uuid(char* buffer);
+  std::string generate_uuid();
+}}
@@ -4,18 +4,21 @@
 #include <condition_variable>
 
 namespace reinforcement_learning { namespace utility {
-  // one use wakable sleeping class
+  // one use interruptable sleeping class, which can also be woken early any number of times
   class interruptable_sleeper {
     std::condition_variable _cv;
     std::mutex _mutex;
     bool _interrupt = false;
+    bool _wake = false;
   public:
-    // waits until wake is called or the specified time passes
+    // waits until interrupt or wake is called or the specified time passes
     template< class Rep, class Period >
-    // returns true if timeout expired.  false if sleep was interrupted
+    // returns true if timeout expired or sleep was woken.  false if sleep was interrupted
     bool sleep(const std::chrono::duration<Rep, Period>& timeout_duration);
     // unblock sleeping thread
     void interrupt();
+    // end the current or next sleep early, as if its timeout expired
+    void wake();
   };
 
   inline void interruptable_sleeper::interrupt() {
@@ -26,12 +29,22 @@ namespace reinforcement_learning { namespace utility {
     _cv.notify_one();
   }
 
+  inline void interruptable_sleeper::wake() {
+    {
+      std::unique_lock <std::mutex> lock(_mutex);
+      _wake = true;
+    }
+    _cv.notify_one();
+  }
+
   /*
-   * Sleep returns true if timeout expires and returns false if sleep was interrupted.
+   * Sleep returns true if timeout expires or sleep was woken, and returns false if sleep was interrupted.
    */
   template <class Rep, class Period>
   bool interruptable_sleeper::sleep(const std::chrono::duration<Rep, Period>& timeout_duration) {
     std::unique_lock <std::mutex> lock(_mutex);
-    return ! ( _cv.wait_for(lock, timeout_duration, [this]() { return _interrupt; }) );
+    _cv.wait_for(lock, timeout_duration, [this]() { return _interrupt || _wake; });
+    _wake = false;
+    return !_interrupt;
   }
 }}
\ No newline at end of file
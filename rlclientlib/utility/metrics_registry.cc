@@ -0,0 +1,239 @@
+#include "metrics_registry.h"
+#include "api_status.h"
+#include "err_constants.h"
+#include "trace_logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace reinforcement_learning { namespace utility {
+  namespace {
+    size_t floor_log2(uint64_t value) {
+#ifdef _MSC_VER
+      unsigned long index;
+      _BitScanReverse64(&index, value);
+      return index;
+#else
+      return 63 - __builtin_clzll(value);
+#endif
+    }
+
+    uint64_t value_at_percentile(const std::vector<uint64_t>& counts, uint64_t total, double percentile) {
+      const auto rank = (std::max)(static_cast<uint64_t>(std::ceil(percentile * total)), uint64_t(1));
+      uint64_t seen = 0;
+      for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+          return metrics_histogram::bucket_upper_bound(i);
+        }
+      }
+      return 0;
+    }
+
+    template<typename TMetric>
+    TMetric& get_or_add(std::map<std::string, std::unique_ptr<TMetric>>& metrics, const std::string& name) {
+      auto& metric = metrics[name];
+      if (!metric) {
+        metric.reset(new TMetric());
+      }
+      return *metric;
+    }
+  }
+
+  size_t next_metrics_shard() {
+    static std::atomic<size_t> next(0);
+    return next.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  uint64_t metrics_counter::value() const {
+    uint64_t total = 0;
+    for (const auto& shard : _shards) {
+      total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+  const size_t metrics_histogram::SUB_BUCKET_BITS;
+  const size_t metrics_histogram::SUB_BUCKETS;
+  const size_t metrics_histogram::BUCKETS;
+
+  metrics_histogram::metrics_histogram()
+    : _min((std::numeric_limits<uint64_t>::max)())
+    , _max(0) {
+    for (auto& bucket : _buckets) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  size_t metrics_histogram::bucket_index(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+      return static_cast<size_t>(value);
+    }
+    const size_t exponent = floor_log2(value);
+    const size_t shift = exponent - SUB_BUCKET_BITS;
+    return ((exponent - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS) | static_cast<size_t>((value >> shift) & (SUB_BUCKETS - 1));
+  }
+
+  uint64_t metrics_histogram::bucket_lower_bound(size_t index) {
+    if (index < SUB_BUCKETS) {
+      return index;
+    }
+    const size_t shift = (index >> SUB_BUCKET_BITS) - 1;
+    return static_cast<uint64_t>(SUB_BUCKETS + (index & (SUB_BUCKETS - 1))) << shift;
+  }
+
+  uint64_t metrics_histogram::bucket_upper_bound(size_t index) {
+    if (index < SUB_BUCKETS) {
+      return index;
+    }
+    const size_t shift = (index >> SUB_BUCKET_BITS) - 1;
+    return bucket_lower_bound(index) + ((uint64_t(1) << shift) - 1);
+  }
+
+  void metrics_histogram::get(histogram_value& value) const {
+    // Buckets are read one by one while other threads record, so the totals may lag slightly behind each other
+    std::vector<uint64_t> counts(BUCKETS);
+    uint64_t total = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+      counts[i] = _buckets[i].load(std::memory_order_relaxed);
+      total += counts[i];
+    }
+
+    value.count = total;
+    value.sum = _sum.value();
+    if (total == 0) {
+      value.min = value.max = value.p50 = value.p90 = value.p99 = value.p999 = 0;
+      return;
+    }
+
+    value.min = _min.load(std::memory_order_relaxed);
+    value.max = _max.load(std::memory_order_relaxed);
+    const auto clamp = [&value](uint64_t v) { return (std::max)(value.min, (std::min)(v, value.max)); };
+    value.p50 = clamp(value_at_percentile(counts, total, 0.5));
+    value.p90 = clamp(value_at_percentile(counts, total, 0.9));
+    value.p99 = clamp(value_at_percentile(counts, total, 0.99));
+    value.p999 = clamp(value_at_percentile(counts, total, 0.999));
+  }
+
+  metrics_registry& metrics_registry::instance() {
+    static metrics_registry* registry = new metrics_registry();
+    return *registry;
+  }
+
+  metrics_counter& metrics_registry::counter(const std::string& name) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return get_or_add(_counters, name);
+  }
+
+  metrics_gauge& metrics_registry::gauge(const std::string& name) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return get_or_add(_gauges, name);
+  }
+
+  metrics_histogram& metrics_registry::histogram(const std::string& name) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return get_or_add(_histograms, name);
+  }
+
+  void metrics_registry::get(metrics_snapshot& snapshot) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    snapshot.counters.resize(_counters.size());
+    size_t i = 0;
+    for (const auto& counter : _counters) {
+      snapshot.counters[i].name = counter.first;
+      snapshot.counters[i++].value = counter.second->value();
+    }
+
+    snapshot.gauges.resize(_gauges.size());
+    i = 0;
+    for (const auto& gauge : _gauges) {
+      snapshot.gauges[i].name = gauge.first;
+      snapshot.gauges[i++].value = gauge.second->value();
+    }
+
+    snapshot.histograms.resize(_histograms.size());
+    i = 0;
+    for (const auto& histogram : _histograms) {
+      snapshot.histograms[i].name = histogram.first;
+      histogram.second->get(snapshot.histograms[i++]);
+    }
+  }
+
+  // Metric names are identifiers chosen by the library, so they are written without escaping
+  void metrics_to_json(const metrics_snapshot& snapshot, std::string& json) {
+    std::ostringstream out;
+    out << "{\"counters\":{";
+    for (size_t i = 0; i < snapshot.counters.size(); ++i) {
+      out << (i == 0 ? "" : ",") << '"' << snapshot.counters[i].name << "\":" << snapshot.counters[i].value;
+    }
+    out << "},\"gauges\":{";
+    for (size_t i = 0; i < snapshot.gauges.size(); ++i) {
+      out << (i == 0 ? "" : ",") << '"' << snapshot.gauges[i].name << "\":" << snapshot.gauges[i].value;
+    }
+    out << "},\"histograms\":{";
+    for (size_t i = 0; i < snapshot.histograms.size(); ++i) {
+      const auto& h = snapshot.histograms[i];
+      out << (i == 0 ? "" : ",") << '"' << h.name << "\":{"
+        << "\"count\":" << h.count << ",\"sum\":" << h.sum << ",\"min\":" << h.min << ",\"max\":" << h.max
+        << ",\"p50\":" << h.p50 << ",\"p90\":" << h.p90 << ",\"p99\":" << h.p99 << ",\"p999\":" << h.p999 << "}";
+    }
+    out << "}}";
+    json = out.str();
+  }
+
+  metrics_dumper::metrics_dumper(const metrics_registry& registry, const char* file_name, i_trace* trace)
+    : _registry(registry)
+    , _file_name(file_name == nullptr ? "" : file_name)
+    , _trace(trace)
+  {}
+
+  int metrics_dumper::init(api_status* status) {
+    if (_file_name.empty()) {
+      return error_code::success;
+    }
+
+    _file.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+    try {
+      _file.open(_file_name, std::ios::app);
+    }
+    catch (const std::ios_base::failure& e) {
+      RETURN_ERROR_LS(_trace, status, file_open_error) << " File:" << _file_name << " Error:" << e.what();
+    }
+    return error_code::success;
+  }
+
+  int metrics_dumper::run_iteration(api_status* status) {
+    metrics_snapshot snapshot;
+    _registry.get(snapshot);
+    std::string json;
+    metrics_to_json(snapshot, json);
+
+    const auto time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+    std::ostringstream line;
+    line << "{\"time_ms\":" << time_ms << ",\"metrics\":" << json << "}";
+
+    if (!_file.is_open()) {
+      TRACE_INFO(_trace, line.str());
+      return error_code::success;
+    }
+
+    try {
+      _file << line.str() << '\n';
+      _file.flush();
+    }
+    catch (const std::ios_base::failure& e) {
+      RETURN_ERROR_LS(_trace, status, file_open_error) << " File:" << _file_name << " Error:" << e.what();
+    }
+    return error_code::success;
+  }
+}}
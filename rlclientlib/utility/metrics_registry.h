@@ -0,0 +1,151 @@
+#pragma once
+#include "metrics.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace reinforcement_learning {
+  class api_status;
+  class i_trace;
+  namespace utility {
+
+  const size_t METRICS_SHARDS = 16;
+
+  size_t next_metrics_shard();
+
+  //! Shard used by the calling thread, assigned round robin the first time the thread updates a metric
+  inline size_t metrics_shard_index() {
+    static thread_local const size_t index = next_metrics_shard() % METRICS_SHARDS;
+    return index;
+  }
+
+  //! Monotonic count sharded per thread, so that threads counting concurrently do not share a cache line
+  class metrics_counter {
+  public:
+    void add(uint64_t n = 1) {
+      _shards[metrics_shard_index()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t value() const;
+
+  private:
+    struct shard {
+      std::atomic<uint64_t> value{ 0 };
+      char padding[64 - sizeof(std::atomic<uint64_t>)];
+    };
+    shard _shards[METRICS_SHARDS];
+  };
+
+  //! Level which goes up and down. Components report changes with add so that gauges sum over instances.
+  class metrics_gauge {
+  public:
+    void add(int64_t delta) { _value.fetch_add(delta, std::memory_order_relaxed); }
+    void set(int64_t value) { _value.store(value, std::memory_order_relaxed); }
+    int64_t value() const { return _value.load(std::memory_order_relaxed); }
+
+  private:
+    std::atomic<int64_t> _value{ 0 };
+  };
+
+  /**
+   * Log-linear histogram of unsigned values, in the style of HdrHistogram.
+   *
+   * Values below 16 have their own bucket, larger values share a bucket with the values which have the same 5 highest
+   * bits, so each bucket spans at most 1/16 of its lower bound. Recording is a few relaxed atomic increments.
+   */
+  class metrics_histogram {
+  public:
+    static const size_t SUB_BUCKET_BITS = 4;
+    static const size_t SUB_BUCKETS = size_t(1) << SUB_BUCKET_BITS;
+    static const size_t BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    metrics_histogram();
+
+    void record(uint64_t value) {
+      _buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+      _sum.add(value);
+      update_min(value);
+      update_max(value);
+    }
+
+    void get(histogram_value& value) const;
+
+    static size_t bucket_index(uint64_t value);
+    static uint64_t bucket_lower_bound(size_t index);
+    static uint64_t bucket_upper_bound(size_t index);
+
+  private:
+    void update_min(uint64_t value) {
+      auto current = _min.load(std::memory_order_relaxed);
+      while (value < current && !_min.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+
+    void update_max(uint64_t value) {
+      auto current = _max.load(std::memory_order_relaxed);
+      while (value > current && !_max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+
+    std::atomic<uint64_t> _buckets[BUCKETS];
+    metrics_counter _sum;
+    std::atomic<uint64_t> _min;
+    std::atomic<uint64_t> _max;
+  };
+
+  /**
+   * Named metrics of the client library.
+   *
+   * Looking up a metric takes a lock, so components look their metrics up once and keep the reference: metrics live
+   * as long as the registry. Updating a metric never locks.
+   */
+  class metrics_registry {
+  public:
+    //! Registry shared by the whole process, never destroyed so that background threads can update it while exiting
+    static metrics_registry& instance();
+
+    metrics_registry() = default;
+    metrics_registry(const metrics_registry&) = delete;
+    metrics_registry& operator=(const metrics_registry&) = delete;
+
+    metrics_counter& counter(const std::string& name);
+    metrics_gauge& gauge(const std::string& name);
+    metrics_histogram& histogram(const std::string& name);
+
+    void get(metrics_snapshot& snapshot) const;
+
+  private:
+    mutable std::mutex _mutex;
+    std::map<std::string, std::unique_ptr<metrics_counter>> _counters;
+    std::map<std::string, std::unique_ptr<metrics_gauge>> _gauges;
+    std::map<std::string, std::unique_ptr<metrics_histogram>> _histograms;
+  };
+
+  //! Microseconds elapsed since start, for latency histograms
+  inline uint64_t microseconds_since(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+  }
+
+  //! One line JSON object with every metric of the snapshot, keyed by name
+  void metrics_to_json(const metrics_snapshot& snapshot, std::string& json);
+
+  //! Appends a snapshot of the registry as a JSON line to a file, or to the trace logger when there is no file
+  class metrics_dumper {
+  public:
+    metrics_dumper(const metrics_registry& registry, const char* file_name, i_trace* trace);
+
+    int init(api_status* status);
+    int run_iteration(api_status* status);
+
+  private:
+    const metrics_registry& _registry;
+    const std::string _file_name;
+    std::ofstream _file;
+    i_trace* _trace;
+  };
+}}
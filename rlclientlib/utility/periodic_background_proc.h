@@ -4,8 +4,11 @@
 #include "api_status.h"
 #include "interruptable_sleeper.h"
 
+#include "utility/background_executor.h"
 #include "utility/watchdog.h"
 
+#include <atomic>
+#include <chrono>
 #include <thread>
 #include <string>
 
@@ -30,6 +33,12 @@ namespace reinforcement_learning {
       ~periodic_background_proc();
       void stop();
 
+      // Run the next iteration now rather than at the end of the interval
+      void wake();
+
+      // Change the interval from the next iteration on. Called from the iterations of the proc.
+      void set_interval(int interval_ms);
+
       // Cannot copy, assign
       periodic_background_proc(const periodic_background_proc&) = delete;
       periodic_background_proc(periodic_background_proc&&) = delete;
@@ -39,15 +48,21 @@ namespace reinforcement_learning {
     private:
       // Implementation methods
       void time_loop();
+      void run_once();
 
     private:
       // Internal state
       bool _thread_is_running;
-      int _interval_ms;
+      std::atomic<int> _interval_ms;
       std::thread _background_thread;
       interruptable_sleeper _sleeper;
 
+      // Set instead of the thread when the watchdog has a shared executor
+      background_executor* _executor;
+      background_executor::task* _task;
+
       watchdog& _watchdog;
+      watchdog::check_in_slot* _check_in_slot;
       std::string _proc_name;
 
       // Pointers not owned by this class.  Lifetime is managed externally
@@ -60,7 +75,10 @@ namespace reinforcement_learning {
       std::string const& proc_name, error_callback_fn* perror_cb)
       : _thread_is_running {false},
         _interval_ms{interval_ms},
+        _executor(nullptr),
+        _task(nullptr),
         _watchdog(watchdog),
+        _check_in_slot(nullptr),
         _proc_name(proc_name),
         _proc(nullptr),
         _perror_cb(perror_cb)
@@ -74,6 +92,19 @@ namespace reinforcement_learning {
 
       _proc = bgproc;
 
+      if (_task != nullptr) {
+        return error_code::success;
+      }
+      _executor = _watchdog.get_executor();
+      if (_executor != nullptr) {
+        _check_in_slot = _watchdog.register_task(this, _proc_name, static_cast<long long>(_interval_ms.load() * timeout_grace_multiplier_c));
+        _task = _executor->schedule([this] {
+          run_once();
+          return std::chrono::milliseconds(_interval_ms.load());
+        }, std::chrono::milliseconds(0));
+        return error_code::success;
+      }
+
       if (!_thread_is_running) {
         try {
           _thread_is_running = true;
@@ -89,6 +120,13 @@ namespace reinforcement_learning {
 
     template <typename BgProc>
     void periodic_background_proc<BgProc>::stop() {
+      if (_task != nullptr) {
+        _executor->cancel(_task);
+        _task = nullptr;
+        _watchdog.unregister_task(this);
+        _check_in_slot = nullptr;
+      }
+
       if (_thread_is_running) {
         _thread_is_running = false;
         _sleeper.interrupt();
@@ -100,6 +138,21 @@ namespace reinforcement_learning {
       }
     }
 
+    template <typename BgProc>
+    void periodic_background_proc<BgProc>::wake() {
+      if (_task != nullptr) {
+        _executor->wake(_task);
+        return;
+      }
+      _sleeper.wake();
+    }
+
+    template <typename BgProc>
+    void periodic_background_proc<BgProc>::set_interval(const int interval_ms) {
+      _interval_ms.store(interval_ms);
+      _watchdog.set_timeout(_check_in_slot, static_cast<long long>(interval_ms * timeout_grace_multiplier_c));
+    }
+
     template <typename BGProc>
     periodic_background_proc<BGProc>::~periodic_background_proc() {
       stop();
@@ -108,20 +161,32 @@ namespace reinforcement_learning {
     template <typename BGProc>
     void periodic_background_proc<BGProc>::time_loop() {
       // The first action of the thread should be registering itself with the watchdog.
-      _watchdog.register_thread(std::this_thread::get_id(), _proc_name, static_cast<long long>(_interval_ms * timeout_grace_multiplier_c));
+      _check_in_slot = _watchdog.register_thread(std::this_thread::get_id(), _proc_name, static_cast<long long>(_interval_ms.load() * timeout_grace_multiplier_c));
 
       do {
         api_status status;
 
         // Check in to the watchdog to report this thread is still alive.
-        _watchdog.check_in(std::this_thread::get_id());
+        _watchdog.check_in(_check_in_slot);
 
         // Run the background task once
         if (_proc->run_iteration(&status) != error_code::success) {
           ERROR_CALLBACK(_perror_cb, status);
         }
         // Cancelable sleep for interval
-      } while (_sleeper.sleep(std::chrono::milliseconds(_interval_ms)));
+      } while (_sleeper.sleep(std::chrono::milliseconds(_interval_ms.load())));
+    }
+
+    template <typename BGProc>
+    void periodic_background_proc<BGProc>::run_once() {
+      api_status status;
+
+      // Late check-ins also catch a task waiting for a busy executor
+      _watchdog.check_in(_check_in_slot);
+
+      if (_proc->run_iteration(&status) != error_code::success) {
+        ERROR_CALLBACK(_perror_cb, status);
+      }
     }
   }
 }
@@ -0,0 +1,88 @@
+#include "utility/shared_context_registry.h"
+#include "err_constants.h"
+#include "trace_logger.h"
+
+#include <rapidjson/document.h>
+#include <rapidjson/error/en.h>
+
+#include <cstring>
+
+namespace reinforcement_learning { namespace utility {
+  namespace rj = rapidjson;
+
+  namespace {
+    bool is_json_space(char c) {
+      return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+  }
+
+  int shared_context_registry::add(const char* shared_json, uint64_t& handle, i_trace* trace, api_status* status) {
+    rj::Document obj;
+    obj.Parse(shared_json);
+
+    if (obj.HasParseError()) {
+      RETURN_ERROR_LS(trace, status, json_parse_error) << "JSON parse error: " << rj::GetParseError_En(obj.GetParseError()) << " (" << obj.GetErrorOffset() << ")";
+    }
+
+    if (!obj.IsObject() || obj.ObjectEmpty()) {
+      RETURN_ERROR_ARG(trace, status, invalid_argument, "Shared context must be a JSON object with at least one feature");
+    }
+
+    if (obj.HasMember("_multi") || obj.HasMember("_slots")) {
+      RETURN_ERROR_ARG(trace, status, invalid_argument, "Shared context must not hold actions or slots");
+    }
+
+    // Keep the text as given, without surrounding whitespace, so the logged context matches what the caller sent
+    const char* first = shared_json;
+    const char* last = shared_json + strlen(shared_json);
+    while (is_json_space(*first)) { ++first; }
+    while (is_json_space(*(last - 1))) { --last; }
+    std::shared_ptr<const std::string> features = std::make_shared<const std::string>(first, last);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    handle = _next_handle++;
+    _contexts.emplace(handle, std::move(features));
+    return error_code::success;
+  }
+
+  int shared_context_registry::remove(uint64_t handle, i_trace* trace, api_status* status) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_contexts.erase(handle) == 0) {
+      RETURN_ERROR_LS(trace, status, shared_context_not_found) << handle;
+    }
+    return error_code::success;
+  }
+
+  int shared_context_registry::get(uint64_t handle, model_management::shared_context& shared, i_trace* trace, api_status* status) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto found = _contexts.find(handle);
+    if (found == _contexts.end()) {
+      RETURN_ERROR_LS(trace, status, shared_context_not_found) << handle;
+    }
+
+    shared.id = handle;
+    shared.features = found->second;
+    return error_code::success;
+  }
+
+  int shared_context_registry::join(const std::string& shared_json, const char* actions_json, std::string& context, i_trace* trace, api_status* status) {
+    const char* actions = actions_json;
+    while (is_json_space(*actions)) { ++actions; }
+    if (*actions != '{') {
+      RETURN_ERROR_LS(trace, status, json_parse_error) << "Actions must be a JSON object";
+    }
+
+    // Skip the opening brace and check whether the object has members
+    ++actions;
+    const char* members = actions;
+    while (is_json_space(*members)) { ++members; }
+
+    // Shared features are a non empty object: everything up to their closing brace, then the members of the actions
+    context.assign(shared_json, 0, shared_json.size() - 1);
+    if (*members != '}') {
+      context.push_back(',');
+    }
+    context.append(actions);
+    return error_code::success;
+  }
+}}
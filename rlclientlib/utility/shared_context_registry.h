@@ -0,0 +1,36 @@
+#pragma once
+#include "api_status.h"
+#include "model_mgmt.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace reinforcement_learning {
+  class i_trace;
+  namespace utility {
+
+  /**
+   * Shared features registered once and referenced by handle from later requests.
+   *
+   * Requests carry only their actions. The registry joins them with the shared features into the context which is
+   * logged, while models may rank from a parsed copy of the shared features kept under the handle.
+   */
+  class shared_context_registry {
+  public:
+    //! Keep a copy of shared_json, which must be a JSON object without _multi or _slots
+    int add(const char* shared_json, uint64_t& handle, i_trace* trace, api_status* status);
+    int remove(uint64_t handle, i_trace* trace, api_status* status);
+    int get(uint64_t handle, model_management::shared_context& shared, i_trace* trace, api_status* status) const;
+
+    //! Join the shared features and the actions of a request, both JSON objects, into one context
+    static int join(const std::string& shared_json, const char* actions_json, std::string& context, i_trace* trace, api_status* status);
+
+  private:
+    mutable std::mutex _mutex;
+    std::unordered_map<uint64_t, std::shared_ptr<const std::string>> _contexts;
+    uint64_t _next_handle = 1;
+  };
+}}
@@ -0,0 +1,172 @@
+#include "span_tracer.h"
+#include "api_status.h"
+#include "err_constants.h"
+#include "trace_logger.h"
+
+#include <cstring>
+#include <sstream>
+
+namespace reinforcement_learning { namespace utility {
+  namespace {
+    uint32_t next_thread_id() {
+      static std::atomic<uint32_t> next(1);
+      return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Chrome traces count in microseconds, fractions keep the nanoseconds
+    void write_microseconds(std::ostream& out, uint64_t ns) {
+      const auto fraction = ns % 1000;
+      out << ns / 1000 << '.' << (fraction < 100 ? "0" : "") << (fraction < 10 ? "0" : "") << fraction;
+    }
+
+    void write_json_string(std::ostream& out, const char* value) {
+      out << '"';
+      for (const char* c = value; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\') {
+          out << '\\' << *c;
+        }
+        else if (static_cast<unsigned char>(*c) < 0x20) {
+          out << ' ';
+        }
+        else {
+          out << *c;
+        }
+      }
+      out << '"';
+    }
+  }
+
+  const size_t request_trace::MAX_SPANS;
+  const size_t request_trace::MAX_EVENT_ID;
+
+  span_tracer::span_tracer(uint64_t sample_rate, uint64_t threshold_us, size_t max_pending, const char* file_name, i_trace* trace)
+    : _sample_rate(sample_rate)
+    , _threshold_ns(threshold_us * 1000)
+    , _file_name(file_name == nullptr ? "" : file_name)
+    , _trace(trace)
+    , _first_event(true)
+    , _kept(metrics_registry::instance().counter("trace.spans.kept_requests"))
+    , _dropped(metrics_registry::instance().counter("trace.spans.dropped_requests")) {
+    _pending.reserve(max_pending);
+    _writing.reserve(max_pending);
+  }
+
+  span_tracer::~span_tracer() {
+    if (!_file.is_open()) {
+      return;
+    }
+    run_iteration(nullptr);
+    try {
+      _file << "\n]\n";
+    }
+    catch (const std::ios_base::failure&) {}
+  }
+
+  int span_tracer::init(api_status* status) {
+    if (_file_name.empty()) {
+      RETURN_ERROR_ARG(_trace, status, invalid_argument, "A file name is required to trace spans");
+    }
+
+    _file.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+    try {
+      _file.open(_file_name, std::ios::trunc);
+      // The closing bracket is written on shutdown, trace viewers open the file without it
+      _file << "[\n";
+      _file.flush();
+    }
+    catch (const std::ios_base::failure& e) {
+      RETURN_ERROR_LS(_trace, status, file_open_error) << " File:" << _file_name << " Error:" << e.what();
+    }
+    return error_code::success;
+  }
+
+  void span_tracer::begin(request_trace& trace, const char* name, const char* event_id) {
+    if (trace.thread_id == 0) {
+      trace.thread_id = next_thread_id();
+    }
+    trace.sampled = _sample_rate > 0 && trace.sequence++ % _sample_rate == 0;
+    if (!trace.sampled && _threshold_ns == 0) {
+      return;
+    }
+
+    trace.tracer = this;
+    if (event_id == nullptr) {
+      trace.event_id[0] = '\0';
+    }
+    else {
+      std::strncpy(trace.event_id, event_id, request_trace::MAX_EVENT_ID - 1);
+      trace.event_id[request_trace::MAX_EVENT_ID - 1] = '\0';
+    }
+    trace.count = 1;
+    trace.spans[0].name = name;
+    trace.spans[0].end_ns = 0;
+    trace.spans[0].start_ns = span_clock_ns();
+  }
+
+  void span_tracer::end(request_trace& trace) {
+    trace.spans[0].end_ns = span_clock_ns();
+    trace.tracer = nullptr;
+
+    const bool slow = _threshold_ns > 0 && trace.spans[0].end_ns - trace.spans[0].start_ns >= _threshold_ns;
+    if (!trace.sampled && !slow) {
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_pending.size() < _pending.capacity()) {
+        _pending.push_back(trace);
+        _kept.add();
+        return;
+      }
+    }
+    _dropped.add();
+  }
+
+  int span_tracer::run_iteration(api_status* status) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _pending.swap(_writing);
+    }
+    const int scode = write(_writing, status);
+    _writing.clear();
+    return scode;
+  }
+
+  int span_tracer::write(const std::vector<request_trace>& requests, api_status* status) {
+    if (requests.empty() || !_file.is_open()) {
+      return error_code::success;
+    }
+
+    std::ostringstream out;
+    for (const auto& request : requests) {
+      for (size_t i = 0; i < request.count; ++i) {
+        const auto& s = request.spans[i];
+        if (s.end_ns < s.start_ns) {
+          continue;
+        }
+        out << (_first_event ? "" : ",\n") << "{\"name\":\"" << s.name << "\",\"cat\":\"rl\",\"ph\":\"X\",\"ts\":";
+        write_microseconds(out, s.start_ns);
+        out << ",\"dur\":";
+        write_microseconds(out, s.end_ns - s.start_ns);
+        out << ",\"pid\":1,\"tid\":" << request.thread_id;
+        if (i == 0) {
+          out << ",\"args\":{\"event_id\":";
+          write_json_string(out, request.event_id);
+          out << "}";
+        }
+        out << "}";
+        _first_event = false;
+      }
+    }
+
+    try {
+      _file << out.str();
+      _file.flush();
+    }
+    catch (const std::ios_base::failure& e) {
+      RETURN_ERROR_LS(_trace, status, file_open_error) << " File:" << _file_name << " Error:" << e.what();
+    }
+    return error_code::success;
+  }
+}}
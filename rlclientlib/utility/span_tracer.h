@@ -0,0 +1,148 @@
+#pragma once
+#include "metrics_registry.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace reinforcement_learning {
+  class api_status;
+  class i_trace;
+  namespace utility {
+
+  //! Stage of a request. Names are string literals: spans keep the pointer.
+  struct span {
+    const char* name;
+    uint64_t start_ns;
+    uint64_t end_ns;
+  };
+
+  class span_tracer;
+
+  //! Spans of the request in flight on a thread, preallocated once per thread and reused by every request
+  struct request_trace {
+    static const size_t MAX_SPANS = 32;
+    static const size_t MAX_EVENT_ID = 64;
+
+    span_tracer* tracer;  // Null when the request in flight is not recorded
+    size_t depth;         // Requests made from within a request are part of it
+    bool sampled;
+    uint32_t thread_id;
+    uint64_t sequence;
+    size_t count;
+    char event_id[MAX_EVENT_ID];  // Truncated copy, event ids are usually uuids
+    span spans[MAX_SPANS];        // spans[0] covers the whole request
+  };
+
+  inline request_trace& current_request_trace() {
+    // Zero initialized, so that threads which never trace pay nothing for it
+    static thread_local request_trace trace;
+    return trace;
+  }
+
+  inline uint64_t span_clock_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+  }
+
+  /**
+   * Per-request latency breakdown, written as a Chrome trace (JSON array format) that chrome://tracing and Perfetto
+   * open directly.
+   *
+   * A request is recorded when it is one of every sample_rate requests of its thread, or, when threshold_us is set,
+   * always: it is then kept only if it took at least threshold_us. Recording a stage costs two clock reads. Kept
+   * requests wait in a bounded buffer until run_iteration writes them, and are dropped when it is full.
+   */
+  class span_tracer {
+  public:
+    span_tracer(uint64_t sample_rate, uint64_t threshold_us, size_t max_pending, const char* file_name, i_trace* trace);
+    ~span_tracer();
+
+    span_tracer(const span_tracer&) = delete;
+    span_tracer& operator=(const span_tracer&) = delete;
+
+    int init(api_status* status);
+    int run_iteration(api_status* status);
+
+    //! Starts recording the request of the calling thread when it is sampled or a threshold is set
+    void begin(request_trace& trace, const char* name, const char* event_id);
+    //! Ends the request and keeps it if it was sampled or slower than the threshold
+    void end(request_trace& trace);
+
+  private:
+    int write(const std::vector<request_trace>& requests, api_status* status);
+
+    const uint64_t _sample_rate;
+    const uint64_t _threshold_ns;
+    const std::string _file_name;
+    i_trace* _trace;
+
+    std::mutex _mutex;
+    std::vector<request_trace> _pending;  // Capacity reserved up front, so keeping a request does not allocate
+    std::vector<request_trace> _writing;
+
+    std::ofstream _file;
+    bool _first_event;
+
+    metrics_counter& _kept;
+    metrics_counter& _dropped;
+  };
+
+  //! Records the request which runs in this scope if the tracer selects it. Nested requests are part of the outer one.
+  class request_span {
+  public:
+    request_span(span_tracer* tracer, const char* name, const char* event_id)
+      : _trace(nullptr) {
+      if (tracer != nullptr) {
+        _trace = &current_request_trace();
+        if (_trace->depth++ == 0) {
+          tracer->begin(*_trace, name, event_id);
+        }
+      }
+    }
+
+    ~request_span() {
+      if (_trace != nullptr && --_trace->depth == 0 && _trace->tracer != nullptr) {
+        _trace->tracer->end(*_trace);
+      }
+    }
+
+    request_span(const request_span&) = delete;
+    request_span& operator=(const request_span&) = delete;
+
+  private:
+    request_trace* _trace;
+  };
+
+  //! Records a stage of the request recorded on this thread, if any. Stages past MAX_SPANS are not recorded.
+  class stage_span {
+  public:
+    explicit stage_span(const char* name)
+      : _span(nullptr) {
+      auto& trace = current_request_trace();
+      if (trace.tracer != nullptr && trace.count < request_trace::MAX_SPANS) {
+        _span = &trace.spans[trace.count++];
+        _span->name = name;
+        _span->end_ns = 0;
+        _span->start_ns = span_clock_ns();
+      }
+    }
+
+    ~stage_span() {
+      if (_span != nullptr) {
+        _span->end_ns = span_clock_ns();
+      }
+    }
+
+    stage_span(const stage_span&) = delete;
+    stage_span& operator=(const stage_span&) = delete;
+
+  private:
+    span* _span;
+  };
+}}
@@ -0,0 +1,54 @@
+#pragma once
+#include "trace_logger.h"
+#include "str_util.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace reinforcement_learning { namespace utility {
+  //! Lets one message through per interval and counts the ones held back in between. Never blocks.
+  class trace_rate_limiter {
+  public:
+    explicit trace_rate_limiter(int64_t interval_ms)
+      : _interval_ns(interval_ms * 1000000)
+    {}
+
+    //! True when the message can be traced. suppressed is then the number of messages held back since the last one.
+    bool allow(uint64_t& suppressed) {
+      const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+      auto next = _next_ns.load(std::memory_order_relaxed);
+      if (now >= next && _next_ns.compare_exchange_strong(next, now + _interval_ns, std::memory_order_relaxed)) {
+        suppressed = _suppressed.exchange(0, std::memory_order_relaxed);
+        return true;
+      }
+      _suppressed.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+  private:
+    const int64_t _interval_ns;
+    std::atomic<int64_t> _next_ns{ 0 };
+    std::atomic<uint64_t> _suppressed{ 0 };
+  };
+}}
+
+// Traces at most one message per interval from this call site, across every logger and thread
+#define TRACE_LOG_RATE_LIMITED( logger, level, interval_ms, msg ) do{                                        \
+    if(logger != nullptr && logger->is_enabled(level)) {                                                     \
+      static reinforcement_learning::utility::trace_rate_limiter rate_limiter__(interval_ms);                \
+      uint64_t suppressed__ = 0;                                                                             \
+      if(rate_limiter__.allow(suppressed__)) {                                                               \
+        if(suppressed__ == 0) {                                                                              \
+          logger->log(level, msg);                                                                           \
+        }                                                                                                    \
+        else {                                                                                               \
+          logger->log(level, reinforcement_learning::utility::concat(msg, " (", suppressed__, " similar messages suppressed)")); \
+        }                                                                                                    \
+      }                                                                                                      \
+    }                                                                                                        \
+  } while(0)
+
+#define TRACE_ERROR_RATE_LIMITED( logger, interval_ms, msg ) TRACE_LOG_RATE_LIMITED(logger, reinforcement_learning::LEVEL_ERROR, interval_ms, msg)
@@ -1,5 +1,8 @@
 #pragma once
+#include "metrics_registry.h"
+
 #include <mutex>
+#include <string>
 #include <vector>
 
 namespace reinforcement_learning { namespace utility {
@@ -121,6 +124,10 @@ namespace reinforcement_learning { namespace utility {
       return _objects_count;
     }
 
+    int idle() const {
+      return static_cast<int>(_pool.size());
+    }
+
     int version() const {
       return _version;
     }
@@ -131,11 +138,25 @@ namespace reinforcement_learning { namespace utility {
     std::mutex _mutex;
     using impl_type = versioned_object_pool_unsafe<TObject, TFactory>;
     std::unique_ptr<impl_type> _impl;
+    // Process wide metrics, only when the pool is given a metrics name
+    metrics_gauge* _idle_metric;
+    metrics_counter* _created_metric;
+
+    void report_idle(int before) {
+      if (_idle_metric != nullptr) {
+        _idle_metric->add(_impl->idle() - before);
+      }
+    }
 
   public:
-    versioned_object_pool(TFactory* factory, int init_size = 0)
+    // metrics_name prefixes the <name>.idle gauge and the <name>.created counter of objects created because the pool was empty
+    versioned_object_pool(TFactory* factory, int init_size = 0, const char* metrics_name = nullptr)
     : _impl(new impl_type(factory, init_size, 0))
-    { }
+    , _idle_metric(metrics_name == nullptr ? nullptr : &metrics_registry::instance().gauge(std::string(metrics_name) + ".idle"))
+    , _created_metric(metrics_name == nullptr ? nullptr : &metrics_registry::instance().counter(std::string(metrics_name) + ".created"))
+    {
+      report_idle(0);
+    }
 
     versioned_object_pool(const versioned_object_pool&) = delete;
     versioned_object_pool& operator=(const versioned_object_pool& other) = delete;
@@ -143,17 +164,28 @@ namespace reinforcement_learning { namespace utility {
 
     ~versioned_object_pool() {
       std::lock_guard<std::mutex> lock(_mutex);
+      if (_idle_metric != nullptr) {
+        _idle_metric->add(-_impl->idle());
+      }
       _impl.reset();
     }
 
     pooled_object<TObject>* get_or_create() {
       std::lock_guard<std::mutex> lock(_mutex);
-      return _impl->get_or_create();
+      const int idle = _impl->idle();
+      if (idle == 0 && _created_metric != nullptr) {
+        _created_metric->add();
+      }
+      auto obj = _impl->get_or_create();
+      report_idle(idle);
+      return obj;
     }
 
     void return_to_pool(pooled_object<TObject>* obj) {
       std::lock_guard<std::mutex> lock(_mutex);
+      const int idle = _impl->idle();
       _impl->return_to_pool(obj);
+      report_idle(idle);
     }
 
     // takes owner-ship of factory (and will free using delete) - !!!!THREAD-UNSAFE!!!!
@@ -168,6 +200,7 @@ namespace reinforcement_learning { namespace utility {
       std::unique_ptr<impl_type> new_impl(new impl_type(new_factory, objects_count, version));
       std::lock_guard<std::mutex> lock(_mutex);
       _impl.swap(new_impl);
+      report_idle(new_impl->idle());
     }
   };
 }}
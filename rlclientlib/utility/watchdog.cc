@@ -1,4 +1,5 @@
 #include "watchdog.h"
+#include "background_executor.h"
 
 #include "str_util.h"
 #include <utility>
@@ -9,51 +10,134 @@
 using namespace reinforcement_learning;
 using namespace reinforcement_learning::utility;
 
+struct watchdog::slot_block {
+  static const size_t SIZE = 32;
+
+  check_in_slot slots[SIZE];
+  //! Set before the block is published, never changed afterwards
+  slot_block* next = nullptr;
+};
+
 watchdog::watchdog(error_callback_fn* error_callback)
   : _error_callback(error_callback), _trace_logger(nullptr) {}
 
 watchdog::~watchdog() {
   stop();
+
+  auto block = _slots.load();
+  while (block != nullptr) {
+    auto const next = block->next;
+    delete block;
+    block = next;
+  }
 }
 
-void watchdog::register_thread(std::thread::id const& thread_id, std::string const& thread_name, long long const timeout) {
-  std::lock_guard<std::mutex> lock(_watchdog_mutex);
+watchdog::check_in_slot* watchdog::register_thread(std::thread::id const& thread_id, std::string const& thread_name, long long const timeout) {
+  return register_slot(thread_id, nullptr, thread_name, timeout);
+}
 
-  // Watchdog timeout should reflect the thread with the tightest time requirement.
-  auto const long_long_duration = std::chrono::duration_cast<std::chrono::duration<long long>>(_timeout_in_ms);
-  _timeout_in_ms = std::chrono::milliseconds(std::min(timeout, long_long_duration.count()));
-
-  _thread_infos.emplace(thread_id, thread_info{
-    thread_id,
-    thread_name,
-    clock_t::now(),
-    clock_t::now(),
-    std::chrono::milliseconds{ timeout }
+void watchdog::unregister_thread(std::thread::id const& thread_id) {
+  std::lock_guard<std::mutex> lock(_registration_mutex);
+  unregister_slot(find_slot([&thread_id](check_in_slot const& slot) {
+    return slot._thread_id.load(std::memory_order_relaxed) == thread_id;
+  }));
+}
+
+void watchdog::check_in(std::thread::id const& thread_id) {
+  auto const slot = find_slot([&thread_id](check_in_slot const& slot) {
+    return slot._thread_id.load(std::memory_order_relaxed) == thread_id;
   });
+  if (slot == nullptr) {
+    throw std::runtime_error(concat("Thread ", thread_id, " must be registered before being used."));
+  }
+  check_in(slot);
+}
 
-  // Wake the sleeper so that the new timeout can take effect.
-  _sleeper.interrupt();
+watchdog::check_in_slot* watchdog::register_task(void const* task, std::string const& task_name, long long const timeout) {
+  return register_slot(std::thread::id(), task, task_name, timeout);
 }
 
-void watchdog::unregister_thread(std::thread::id const& thread_id) {
-  std::lock_guard<std::mutex> lock(_watchdog_mutex);
+void watchdog::unregister_task(void const* task) {
+  std::lock_guard<std::mutex> lock(_registration_mutex);
+  unregister_slot(find_slot([task](check_in_slot const& slot) {
+    return slot._task.load(std::memory_order_relaxed) == task;
+  }));
+}
 
-  auto const iterator = _thread_infos.find(thread_id);
-  if (iterator != _thread_infos.end()) {
-    _thread_infos.erase(iterator);
+void watchdog::check_in(void const* task) {
+  auto const slot = find_slot([task](check_in_slot const& slot) {
+    return slot._task.load(std::memory_order_relaxed) == task;
+  });
+  if (slot == nullptr) {
+    throw std::runtime_error("Background tasks must be registered before being used.");
   }
+  check_in(slot);
 }
 
-void watchdog::check_in(std::thread::id const& thread_id) {
-  std::lock_guard<std::mutex> lock(_watchdog_mutex);
+watchdog::check_in_slot* watchdog::register_slot(std::thread::id const& thread_id, void const* task, std::string const& name, long long const timeout) {
+  std::lock_guard<std::mutex> lock(_registration_mutex);
+  update_timeout(timeout);
 
-  auto const it = _thread_infos.find(thread_id);
-  if (it == _thread_infos.end()) {
-    throw std::runtime_error(concat("Thread ", thread_id, " must be registered before being used."));
+  auto slot = find_slot([](check_in_slot const&) { return true; }, false);
+  if (slot == nullptr) {
+    auto const block = new slot_block();
+    block->next = _slots.load(std::memory_order_relaxed);
+    _slots.store(block, std::memory_order_release);
+    slot = &block->slots[0];
   }
 
-  auto& thread_info = it->second;
-  thread_info.last_check_in_time = clock_t::now();
+  // Filled in while free, then published by the release of the odd generation
+  slot->_name = name;
+  slot->_thread_id.store(thread_id, std::memory_order_relaxed);
+  slot->_task.store(task, std::memory_order_relaxed);
+  slot->_timeout.store(std::chrono::duration_cast<clock_t::duration>(std::chrono::milliseconds(timeout)).count(), std::memory_order_relaxed);
+  slot->_last_check_in.store(clock_t::now().time_since_epoch().count(), std::memory_order_relaxed);
+  slot->_generation.store(slot->_generation.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+  // Wake the sleeper so that the new timeout can take effect.
+  _sleeper.wake();
+  return slot;
+}
+
+void watchdog::set_timeout(check_in_slot* slot, long long const timeout) {
+  if (slot == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(_registration_mutex);
+  update_timeout(timeout);
+  slot->_timeout.store(std::chrono::duration_cast<clock_t::duration>(std::chrono::milliseconds(timeout)).count(), std::memory_order_relaxed);
+  _sleeper.wake();
+}
+
+void watchdog::unregister_slot(check_in_slot* slot) {
+  if (slot == nullptr) {
+    return;
+  }
+  slot->_thread_id.store(std::thread::id(), std::memory_order_relaxed);
+  slot->_task.store(nullptr, std::memory_order_relaxed);
+  slot->_generation.store(slot->_generation.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+template<typename Match>
+watchdog::check_in_slot* watchdog::find_slot(Match const& match, bool registered) const {
+  for (auto block = _slots.load(std::memory_order_acquire); block != nullptr; block = block->next) {
+    for (auto& slot : block->slots) {
+      auto const is_registered = (slot._generation.load(std::memory_order_acquire) & 1) != 0;
+      if (is_registered == registered && match(slot)) {
+        return &slot;
+      }
+    }
+  }
+  return nullptr;
+}
+
+void watchdog::set_executor(std::shared_ptr<background_executor> executor) { _executor = std::move(executor); }
+
+background_executor* watchdog::get_executor() const { return _executor.get(); }
+
+void watchdog::update_timeout(long long const timeout) {
+  // Watchdog timeout should reflect the thread with the tightest time requirement.
+  _timeout_in_ms.store(std::min(timeout, _timeout_in_ms.load()));
 }
 
 void watchdog::set_trace_log(i_trace* trace_logger) { _trace_logger = trace_logger; }
@@ -87,35 +171,49 @@ void watchdog::loop() {
   while (_running.load()) {
     // If enough time has passed to be beyond the timeout, check the state of all registered threads.
     // If a thread hasn't checking in during this timeout period it is assumed to be unresponsive and an error is generated.
-    std::vector<std::string> failed_thread_names;
-
-    {
-      std::unique_lock<std::mutex> lock(_watchdog_mutex);
-      for (auto& kv : _thread_infos) {
-        auto& thread_info = kv.second;
-
-        thread_info.last_verify_time = clock_t::now();
+    std::vector<std::pair<check_in_slot*, uint64_t>> failed_slots;
+
+    auto const now = clock_t::now().time_since_epoch().count();
+    for (auto block = _slots.load(std::memory_order_acquire); block != nullptr; block = block->next) {
+      for (auto& slot : block->slots) {
+        auto const generation = slot._generation.load(std::memory_order_acquire);
+        if ((generation & 1) == 0) {
+          continue;
+        }
+        auto const late = now - slot._last_check_in.load(std::memory_order_relaxed) > slot._timeout.load(std::memory_order_relaxed);
+        // Ignore a slot unregistered or reused while it was being read
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (late && slot._generation.load(std::memory_order_relaxed) == generation) {
+          failed_slots.emplace_back(&slot, generation);
+        }
+      }
+    }
 
-        if(thread_info.last_verify_time - thread_info.last_check_in_time > thread_info.timeout) {
-          if (_error_callback) {
-            failed_thread_names.push_back(thread_info.thread_name);
-          }
-          else {
-            set_unhandled_background_error(true);
+    if (!failed_slots.empty() && _error_callback == nullptr) {
+      set_unhandled_background_error(true);
+    }
+    else if (!failed_slots.empty()) {
+      std::vector<std::string> failed_thread_names;
+      {
+        // Names are only needed to report a failure, they are read under the lock guarding their reuse.
+        std::lock_guard<std::mutex> lock(_registration_mutex);
+        for (auto const& failed : failed_slots) {
+          if (failed.first->_generation.load(std::memory_order_relaxed) == failed.second) {
+            failed_thread_names.push_back(failed.first->_name);
           }
         }
       }
-    }
 
-    api_status status;
-    for (auto const& failed_thread_name : failed_thread_names) {
-      auto message = concat(error_code::thread_unresponsive_timeout, ", ", failed_thread_name, " is unresponsive.");
-      TRACE_ERROR(_trace_logger, message);
-      api_status::try_update(&status, error_code::thread_unresponsive_timeout, message.c_str());
-      _error_callback->report_error(status);
+      api_status status;
+      for (auto const& failed_thread_name : failed_thread_names) {
+        auto message = concat(error_code::thread_unresponsive_timeout, ", ", failed_thread_name, " is unresponsive.");
+        TRACE_ERROR(_trace_logger, message);
+        api_status::try_update(&status, error_code::thread_unresponsive_timeout, message.c_str());
+        _error_callback->report_error(status);
+      }
     }
 
-    _sleeper.sleep(std::chrono::milliseconds{ _timeout_in_ms });
+    _sleeper.sleep(std::chrono::milliseconds{ _timeout_in_ms.load() });
   }
 }
 
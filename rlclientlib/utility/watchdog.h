@@ -1,28 +1,70 @@
 #pragma once
 #include <thread>
-#include <map>
 #include <mutex>
 
 #include "api_status.h"
 #include "error_callback_fn.h"
 
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
 #include "interruptable_sleeper.h"
 
 namespace reinforcement_learning {
   class i_trace;
   namespace utility {
-
+    class background_executor;
 
     class watchdog {
+      using clock_t = std::chrono::steady_clock;
+
     public:
+      //! Registration of one thread or task. Slots are reused once unregistered and freed with the watchdog.
+      class check_in_slot {
+      public:
+        check_in_slot() = default;
+        check_in_slot(check_in_slot const&) = delete;
+        check_in_slot& operator=(check_in_slot const&) = delete;
+
+      private:
+        friend class watchdog;
+
+        //! Odd while registered, bumped by every registration and unregistration so a scan can tell a reused slot.
+        std::atomic<uint64_t> _generation{ 0 };
+        std::atomic<std::thread::id> _thread_id{ std::thread::id() };
+        std::atomic<void const*> _task{ nullptr };
+        std::atomic<clock_t::rep> _last_check_in{ 0 };
+        std::atomic<clock_t::rep> _timeout{ 0 };
+        //! Only read or written under the registration mutex
+        std::string _name;
+      };
+
       explicit watchdog(error_callback_fn* error_callback = nullptr);
       ~watchdog();
 
-      void register_thread(std::thread::id const& thread_id, std::string const& thread_name, long long const timeout);
+      check_in_slot* register_thread(std::thread::id const& thread_id, std::string const& thread_name, long long const timeout);
       void unregister_thread(std::thread::id const& thread_id);
       void check_in(std::thread::id const& thread_id);
 
+      // Tasks of a shared executor run on any worker, so they are watched by their own key instead of a thread id
+      check_in_slot* register_task(void const* task, std::string const& task_name, long long const timeout);
+      void unregister_task(void const* task);
+      void check_in(void const* task);
+
+      //! Check in through the slot returned at registration, without looking it up
+      void check_in(check_in_slot* slot) {
+        slot->_last_check_in.store(clock_t::now().time_since_epoch().count(), std::memory_order_relaxed);
+      }
+
+      //! Change the timeout of a registered thread or task, ignores a null slot
+      void set_timeout(check_in_slot* slot, long long const timeout);
+
+      //! Background procs watched by this watchdog run on the executor when set, each on its own thread otherwise
+      void set_executor(std::shared_ptr<background_executor> executor);
+      background_executor* get_executor() const;
+
       void set_trace_log(i_trace* trace_logger);
       int start(api_status* status);
       void stop();
@@ -36,25 +78,24 @@ namespace reinforcement_learning {
       watchdog& operator=(watchdog const& other) = delete;
       watchdog& operator=(watchdog&& other) = delete;
     private:
-      using clock_t = std::chrono::system_clock;
-
-      struct thread_info {
-        std::thread::id thread_id;
-        std::string thread_name;
-        //! Last time the watchdog verified this thread was still active.
-        clock_t::time_point last_verify_time;
-        //! Last time the thread checked in.
-        clock_t::time_point last_check_in_time;
-        std::chrono::milliseconds timeout;
-      };
+      struct slot_block;
+
+      check_in_slot* register_slot(std::thread::id const& thread_id, void const* task, std::string const& name, long long const timeout);
+      void unregister_slot(check_in_slot* slot);
+      template<typename Match>
+      check_in_slot* find_slot(Match const& match, bool registered = true) const;
+      void update_timeout(long long const timeout);
 
-      std::mutex _watchdog_mutex;
+      //! Serializes registrations. Check-ins and the watchdog loop do not take it.
+      std::mutex _registration_mutex;
       interruptable_sleeper _sleeper;
       std::thread _watchdog_thread;
       std::atomic<bool> _running{ false };
 
-      std::chrono::milliseconds _timeout_in_ms{10000};
-      std::map<std::thread::id, thread_info> _thread_infos;
+      std::atomic<long long> _timeout_in_ms{ 10000 };
+      //! Blocks are only prepended, and live as long as the watchdog
+      std::atomic<slot_block*> _slots{ nullptr };
+      std::shared_ptr<background_executor> _executor;
 
       error_callback_fn* _error_callback;
       std::atomic<bool> _unhandled_background_error_occurred{false};
@@ -44,7 +44,28 @@ namespace reinforcement_learning { namespace model_management {
     }
   }
 
-  int pdf_model::choose_continuous_action(const char* features, float& action, float& pdf_value, std::string& model_version, api_status* status)
+  int pdf_model::choose_rank_flat(uint64_t rnd_seed, const char* features, ranking_buffer& ranking, std::string& model_version, api_status* status)
+  {
+    try
+    {
+      // Get a ranked list of action_ids and corresponding pdf
+      _vw->parse_context_with_pdf(features, ranking);
+
+      model_version = _model_version;
+
+      return error_code::success;
+    }
+    catch ( const std::exception& e)
+    {
+      RETURN_ERROR_LS(_trace_logger, status, model_rank_error) << e.what();
+    }
+    catch ( ... )
+    {
+      RETURN_ERROR_LS(_trace_logger, status, model_rank_error) << "Unknown error";
+    }
+  }
+
+  int pdf_model::choose_continuous_action(uint64_t rnd_seed, const char* features, float& action, float& pdf_value, std::string& model_version, api_status* status)
   {
     return error_code::not_supported;
   }
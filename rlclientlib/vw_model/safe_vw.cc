@@ -1,4 +1,5 @@
 #include "safe_vw.h"
+#include "span_tracer.h"
 
 // VW headers
 #include "example.h"
@@ -6,12 +7,17 @@
 #include "parser.h"
 #include "v_array.h"
 
+#include <algorithm>
+#include <stdexcept>
 #include <iostream>
 namespace mm = reinforcement_learning::model_management;
 
 namespace reinforcement_learning {
   static const std::string SEED_TAG = "seed=";
 
+  // Parsed shared features kept per instance. Past this, entries of unregistered contexts are released first.
+  static const size_t MAX_SHARED_EXAMPLES = 1024;
+
   safe_vw::safe_vw(const std::shared_ptr<safe_vw>& master) : _master(master)
   {
     _vw = VW::seed_vw_model(_master->_vw, "", nullptr, nullptr);
@@ -44,6 +50,9 @@ namespace reinforcement_learning {
     for (auto&& ex : _example_pool) {
       VW::dealloc_examples(ex, 1);
     }
+    for (auto&& shared : _shared_examples) {
+      VW::dealloc_examples(shared.second.ex, 1);
+    }
 
     // cleanup VW instance
     reset_source(*_vw, _vw->num_bits);
@@ -73,26 +82,46 @@ namespace reinforcement_learning {
 
   example& safe_vw::get_or_create_example_f(void* vw) { return *(((safe_vw*)vw)->get_or_create_example()); }
 
+  void safe_vw::copy_slot(const ranking_buffer& ranking, std::vector<int>& actions, std::vector<float>& scores)
+  {
+    const auto size = ranking.slot_size(0);
+    actions.assign(ranking.action_ids(0), ranking.action_ids(0) + size);
+    scores.assign(ranking.probabilities(0), ranking.probabilities(0) + size);
+  }
+
+  std::vector<char>& safe_vw::copy_to_parse_buffer(const char* context)
+  {
+    // VW parses json in-situ so it needs a mutable copy. Reuse the buffer so steady state calls don't allocate.
+    _parse_buffer.assign(context, context + strlen(context) + 1);
+    return _parse_buffer;
+  }
+
   void safe_vw::parse_context_with_pdf(const char* context, std::vector<int>& actions, std::vector<float>& scores)
+  {
+    ranking_buffer ranking;
+    parse_context_with_pdf(context, ranking);
+    copy_slot(ranking, actions, scores);
+  }
+
+  void safe_vw::parse_context_with_pdf(const char* context, ranking_buffer& ranking)
   {
     DecisionServiceInteraction interaction;
 
     auto examples = v_init<example*>();
     examples.push_back(get_or_create_example());
 
-    std::vector<char> line_vec(context, context + strlen(context) + 1);
+    auto& line_vec = copy_to_parse_buffer(context);
 
     VW::read_line_decision_service_json<false>(*_vw, examples, &line_vec[0], line_vec.size(), false, get_or_create_example_f, this, &interaction);
 
     // finalize example
     VW::setup_examples(*_vw, examples);
 
-    actions.resize(interaction.probabilities.size());
-    scores.resize(interaction.probabilities.size());
-    for (int i = 0; i < interaction.probabilities.size(); i++)
+    ranking.clear();
+    ranking.add_slot();
+    for (size_t i = 0; i < interaction.probabilities.size(); i++)
     {
-      actions[i] = i;
-      scores[i] = interaction.probabilities[i];
+      ranking.push_back(static_cast<uint32_t>(i), interaction.probabilities[i]);
     }
 
     // clean up examples and push examples back into pool for re-use
@@ -105,29 +134,63 @@ namespace reinforcement_learning {
   }
 
   void safe_vw::rank(const char* context, std::vector<int>& actions, std::vector<float>& scores)
+  {
+    ranking_buffer ranking;
+    rank(context, ranking);
+    copy_slot(ranking, actions, scores);
+  }
+
+  void safe_vw::rank(const char* context, ranking_buffer& ranking)
   {
     auto examples = v_init<example*>();
     examples.push_back(get_or_create_example());
 
-    std::vector<char> line_vec(context, context + strlen(context) + 1);
+    {
+      utility::stage_span span("vw_parse");
+      auto& line_vec = copy_to_parse_buffer(context);
+      VW::read_line_json<false>(*_vw, examples, &line_vec[0], get_or_create_example_f, this);
+    }
 
-    VW::read_line_json<false>(*_vw, examples, &line_vec[0], get_or_create_example_f, this);
+    predict_ranking(examples, ranking);
+  }
 
-    // finalize example
-    VW::setup_examples(*_vw, examples);
+  void safe_vw::rank(const mm::shared_context& shared, const char* actions, ranking_buffer& ranking)
+  {
+    example* shared_ex = get_or_create_shared_example(shared);
+
+    auto examples = v_init<example*>();
+    examples.push_back(get_or_create_example());
+
+    {
+      utility::stage_span span("vw_parse");
+      auto& line_vec = copy_to_parse_buffer(actions);
+      VW::read_line_json<false>(*_vw, examples, &line_vec[0], get_or_create_example_f, this);
+
+      // The parser labelled the first example as the shared one: it only lacks the features parsed ahead of time
+      append_features(*examples[0], *shared_ex);
+    }
+
+    predict_ranking(examples, ranking);
+  }
 
+  void safe_vw::predict_ranking(v_array<example*>& examples, ranking_buffer& ranking)
+  {
     // TODO: refactor setup_examples/read_line_json to take in multi_ex
     multi_ex examples2(examples.begin(), examples.end());
 
-    _vw->predict(examples2);
+    {
+      utility::stage_span span("vw_predict");
+      // finalize example
+      VW::setup_examples(*_vw, examples);
+      _vw->predict(examples2);
+    }
 
     // prediction are in the first-example
     const auto& predictions = examples2[0]->pred.a_s;
-    actions.resize(predictions.size());
-    scores.resize(predictions.size());
+    ranking.clear();
+    ranking.add_slot();
     for (size_t i = 0; i < predictions.size(); ++i) {
-      actions[i] = predictions[i].action;
-      scores[i] = predictions[i].score;
+      ranking.push_back(predictions[i].action, predictions[i].score);
     }
 
     // clean up examples and push examples back into pool for re-use
@@ -140,19 +203,94 @@ namespace reinforcement_learning {
     examples.delete_v();
   }
 
-  void safe_vw::choose_continuous_action(const char* context, float& action, float& pdf_value)
+  example* safe_vw::get_or_create_shared_example(const mm::shared_context& shared)
   {
+    // Identifiers are never reused, so an entry stays valid for as long as it is kept
+    const auto found = _shared_examples.find(shared.id);
+    if (found != _shared_examples.end()) {
+      return found->second.ex;
+    }
+
+    if (_shared_examples.size() >= MAX_SHARED_EXAMPLES) {
+      release_shared_examples();
+    }
+
     auto examples = v_init<example*>();
     examples.push_back(get_or_create_example());
 
-    std::vector<char> line_vec(context, context + strlen(context) + 1);
+    _parse_buffer.assign(shared.features->begin(), shared.features->end());
+    _parse_buffer.push_back('\0');
 
-    VW::read_line_json<false>(*_vw, examples, &line_vec[0], get_or_create_example_f, this);
+    VW::read_line_json<false>(*_vw, examples, &_parse_buffer[0], get_or_create_example_f, this);
 
-    // finalize example
-    VW::setup_examples(*_vw, examples);
+    // Shared features hold no actions, so everything was parsed into the first example
+    example* ex = examples[0];
+    for (size_t i = 1; i < examples.size(); ++i) {
+      _example_pool.emplace_back(examples[i]);
+    }
+    examples.delete_v();
+
+    _shared_examples.emplace(shared.id, shared_example{ shared.features, ex });
+    return ex;
+  }
+
+  void safe_vw::release_shared_examples()
+  {
+    // Examples go back to the pool, which empties them before they are handed out again
+    for (auto it = _shared_examples.begin(); it != _shared_examples.end();) {
+      if (it->second.features.expired()) {
+        _example_pool.emplace_back(it->second.ex);
+        it = _shared_examples.erase(it);
+      }
+      else {
+        ++it;
+      }
+    }
+
+    // Every context is still registered: make room by dropping any of them, it will be parsed again if used
+    if (_shared_examples.size() >= MAX_SHARED_EXAMPLES) {
+      const auto victim = _shared_examples.begin();
+      _example_pool.emplace_back(victim->second.ex);
+      _shared_examples.erase(victim);
+    }
+  }
+
+  void safe_vw::append_features(example& target, example& source)
+  {
+    for (const namespace_index ns : source.indices) {
+      features& from = source.feature_space[ns];
+      features& to = target.feature_space[ns];
+
+      if (std::find(target.indices.begin(), target.indices.end(), ns) == target.indices.end()) {
+        target.indices.push_back(ns);
+      }
+
+      for (size_t i = 0; i < from.size(); ++i) {
+        to.push_back(from.values[i], from.indicies[i]);
+      }
+      for (size_t i = 0; i < from.space_names.size(); ++i) {
+        to.space_names.push_back(from.space_names[i]);
+      }
+    }
+  }
+
+  void safe_vw::choose_continuous_action(const char* context, float& action, float& pdf_value)
+  {
+    auto examples = v_init<example*>();
+    examples.push_back(get_or_create_example());
 
-    _vw->predict(*examples[0]);
+    {
+      utility::stage_span span("vw_parse");
+      auto& line_vec = copy_to_parse_buffer(context);
+      VW::read_line_json<false>(*_vw, examples, &line_vec[0], get_or_create_example_f, this);
+    }
+
+    {
+      utility::stage_span span("vw_predict");
+      // finalize example
+      VW::setup_examples(*_vw, examples);
+      _vw->predict(*examples[0]);
+    }
 
     action = examples[0]->pred.pdf_value.action;
     pdf_value = examples[0]->pred.pdf_value.pdf_value;
@@ -171,9 +309,11 @@ namespace reinforcement_learning {
     auto examples = v_init<example*>();
     examples.push_back(get_or_create_example());
 
-    std::vector<char> line_vec(context, context + strlen(context) + 1);
-
-    VW::read_line_json<false>(*_vw, examples, &line_vec[0], get_or_create_example_f, this);
+    {
+      utility::stage_span span("vw_parse");
+      auto& line_vec = copy_to_parse_buffer(context);
+      VW::read_line_json<false>(*_vw, examples, &line_vec[0], get_or_create_example_f, this);
+    }
 
     // In order to control the seed for the sampling of each slot the event id + app id is passed in as the seed using the example tag.
     for(int i = 0; i < event_ids.size(); i++)
@@ -183,13 +323,15 @@ namespace reinforcement_learning {
       push_many(examples[slot_example_indx]->tag, event_ids[i], strlen(event_ids[i]));
     }
 
-    // finalize example
-    VW::setup_examples(*_vw, examples);
-
     // TODO: refactor setup_examples/read_line_json to take in multi_ex
     multi_ex examples2(examples.begin(), examples.end());
 
-    _vw->predict(examples2);
+    {
+      utility::stage_span span("vw_predict");
+      // finalize example
+      VW::setup_examples(*_vw, examples);
+      _vw->predict(examples2);
+    }
 
     // prediction are in the first-example
     auto& predictions = examples2[0]->pred.decision_scores;
@@ -219,9 +361,11 @@ namespace reinforcement_learning {
     auto examples = v_init<example*>();
     examples.push_back(get_or_create_example());
 
-    std::vector<char> line_vec(context, context + strlen(context) + 1);
-
-    VW::read_line_json<false>(*_vw, examples, &line_vec[0], get_or_create_example_f, this);
+    {
+      utility::stage_span span("vw_parse");
+      auto& line_vec = copy_to_parse_buffer(context);
+      VW::read_line_json<false>(*_vw, examples, &line_vec[0], get_or_create_example_f, this);
+    }
     // In order to control the seed for the sampling of each slot the event id + app id is passed in as the seed using the example tag.
     for(uint32_t i = 0; i < slot_ids.size(); i++)
     {
@@ -231,13 +375,15 @@ namespace reinforcement_learning {
       push_many(examples[slot_example_indx]->tag, slot_ids[i].c_str(), slot_ids[i].size());
     }
 
-    // finalize example
-    VW::setup_examples(*_vw, examples);
-
     // TODO: refactor setup_examples/read_line_json to take in multi_ex
     multi_ex examples2(examples.begin(), examples.end());
 
-    _vw->predict(examples2);
+    {
+      utility::stage_span span("vw_predict");
+      // finalize example
+      VW::setup_examples(*_vw, examples);
+      _vw->predict(examples2);
+    }
 
     // prediction are in the first-example
     auto& predictions = examples2[0]->pred.decision_scores;
@@ -266,6 +412,25 @@ const char* safe_vw::id() const {
   return _vw->id.c_str();
 }
 
+uint64_t safe_vw::weight_mask() const {
+  return _vw->weights.mask();
+}
+
+void safe_vw::apply_weight_patches(const std::vector<mm::weight_patch>& patches, const std::string& version)
+{
+  // The weight array masks indexes, so an index beyond it would silently overwrite an unrelated weight
+  const auto mask = weight_mask();
+  for (const auto& patch : patches) {
+    if (patch.index > mask) {
+      throw std::out_of_range("Model delta weight index " + std::to_string(patch.index) + " is beyond the weights of the model");
+    }
+  }
+  for (const auto& patch : patches) {
+    _vw->weights[patch.index] = patch.value;
+  }
+  _vw->id = version;
+}
+
 mm::model_type_t safe_vw::get_model_type(const std::string& args)
 {
   // slates == slates
@@ -364,7 +529,22 @@ safe_vw_factory::safe_vw_factory(const model_management::model_data&& master_dat
   : _master_data(master_data), _command_line(command_line)
   {}
 
+safe_vw_factory::safe_vw_factory(const model_management::model_data& master_data, const std::string& command_line,
+  std::shared_ptr<const std::vector<model_management::weight_patch>> patches, const std::string& version)
+  : _master_data(master_data), _command_line(command_line), _patches(std::move(patches)), _version(version)
+  {}
+
 safe_vw* safe_vw_factory::operator()() 
+{
+    safe_vw* vw = create_from_master_data();
+    if (_patches)
+    {
+      vw->apply_weight_patches(*_patches, _version);
+    }
+    return vw;
+}
+
+safe_vw* safe_vw_factory::create_from_master_data()
 {
     if (_master_data.data() && _command_line.size() > 0)
     {
@@ -2,8 +2,11 @@
 
 #include <vector>
 #include <memory>
+#include <unordered_map>
 #include "vw.h"
 #include "model_mgmt.h"
+#include "ranking_buffer.h"
+#include "../model_mgmt/model_delta.h"
 
 namespace reinforcement_learning {
 
@@ -12,9 +15,24 @@ namespace reinforcement_learning {
     std::shared_ptr<safe_vw> _master;
     vw* _vw;
     std::vector<example*> _example_pool;
+    std::vector<char> _parse_buffer;
+
+    // Shared features parsed and hashed once, by shared context id. The examples are never set up, so they can be
+    // appended to the first example of any request before it is.
+    struct shared_example {
+      std::weak_ptr<const std::string> features;
+      example* ex;
+    };
+    std::unordered_map<uint64_t, shared_example> _shared_examples;
 
     example* get_or_create_example();
     static example& get_or_create_example_f(void* vw);
+    std::vector<char>& copy_to_parse_buffer(const char* context);
+    static void copy_slot(const ranking_buffer& ranking, std::vector<int>& actions, std::vector<float>& scores);
+    example* get_or_create_shared_example(const model_management::shared_context& shared);
+    void release_shared_examples();
+    static void append_features(example& target, example& source);
+    void predict_ranking(v_array<example*>& examples, ranking_buffer& ranking);
 
   public:
     safe_vw(const std::shared_ptr<safe_vw>& master);
@@ -25,7 +43,12 @@ namespace reinforcement_learning {
     ~safe_vw();
 
     void parse_context_with_pdf(const char* context, std::vector<int>& actions, std::vector<float>& scores);
+    void parse_context_with_pdf(const char* context, ranking_buffer& ranking);
     void rank(const char* context, std::vector<int>& actions, std::vector<float>& scores);
+    // Writes the ranking as a single slot, reusing the capacity of the buffer
+    void rank(const char* context, ranking_buffer& ranking);
+    // Same as rank() on the shared features joined with actions, without parsing the shared features again
+    void rank(const model_management::shared_context& shared, const char* actions, ranking_buffer& ranking);
     void choose_continuous_action(const char* context, float& action, float& pdf_value);
     // Used for CCB
     void rank_decisions(const std::vector<const char*>& event_ids, const char* context, std::vector<std::vector<uint32_t>>& actions, std::vector<std::vector<float>>& scores);
@@ -34,6 +57,12 @@ namespace reinforcement_learning {
 
     const char* id() const;
 
+    // Largest index of the weight array
+    uint64_t weight_mask() const;
+    // Overwrite weights of the model and report version as its id. Throws std::out_of_range, before writing
+    // anything, when an index is beyond weight_mask().
+    void apply_weight_patches(const std::vector<model_management::weight_patch>& patches, const std::string& version);
+
     bool is_compatible(const std::string& args) const;
     bool is_CB_to_CCB_model_upgrade(const std::string& args) const;
 
@@ -46,6 +75,10 @@ namespace reinforcement_learning {
   class safe_vw_factory {
     model_management::model_data _master_data;
     std::string _command_line;
+    std::shared_ptr<const std::vector<model_management::weight_patch>> _patches;
+    std::string _version;
+
+    safe_vw* create_from_master_data();
 
   public:
     // model_data is copied and stored in the factory object.
@@ -54,6 +87,9 @@ namespace reinforcement_learning {
     safe_vw_factory(const model_management::model_data&& master_data);
     safe_vw_factory(const model_management::model_data& master_data, const std::string& command_line);
     safe_vw_factory(const model_management::model_data&& master_data, const std::string& command_line);
+    // Objects are loaded from master_data, then patched to version. The patches are shared by every object.
+    safe_vw_factory(const model_management::model_data& master_data, const std::string& command_line,
+      std::shared_ptr<const std::vector<model_management::weight_patch>> patches, const std::string& version);
 
     safe_vw* operator()();
   };
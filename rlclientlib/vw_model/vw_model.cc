@@ -5,12 +5,27 @@
 #include "ranking_response.h"
 #include "trace_logger.h"
 #include "str_util.h"
+#include "span_tracer.h"
+
+#include <algorithm>
+#include <memory>
 
 namespace reinforcement_learning { namespace model_management {
+  namespace {
+    // Taking an instance locks the pool, and creates one when the pool is empty
+    template<typename TPool>
+    auto acquire(TPool& pool) -> decltype(pool.get_or_create()) {
+      utility::stage_span span("pool_acquire");
+      return pool.get_or_create();
+    }
+  }
 
   vw_model::vw_model(i_trace* trace_logger, const utility::configuration& config)
     : _initial_command_line(config.get(name::MODEL_VW_INITIAL_COMMAND_LINE, "--cb_explore_adf --json --quiet --epsilon 0.0 --first_only --id N/A"))
-    , _vw_pool(new safe_vw_factory(_initial_command_line), config.get_int(name::VW_POOL_INIT_SIZE, value::DEFAULT_VW_POOL_INIT_SIZE))
+    , _vw_pool(new safe_vw_factory(_initial_command_line), config.get_int(name::VW_POOL_INIT_SIZE, value::DEFAULT_VW_POOL_INIT_SIZE), "model.vw_pool")
+    , _prediction_cache(
+        static_cast<size_t>((std::max)(0, config.get_int(name::MODEL_CACHE_MAX_ENTRIES, value::DEFAULT_MODEL_CACHE_MAX_ENTRIES))),
+        std::chrono::milliseconds((std::max)(0, config.get_int(name::MODEL_CACHE_TTL_MS, value::DEFAULT_MODEL_CACHE_TTL_MS))))
     , _trace_logger(trace_logger) {
   }
 
@@ -18,14 +33,21 @@ namespace reinforcement_learning { namespace model_management {
     try {
       TRACE_INFO(_trace_logger, utility::concat("Received new model data. With size ", data.data_sz()));
 
+      if (model_delta::is_delta(data.data(), data.data_sz()))
+      {
+        return apply_delta(data, model_ready, status);
+      }
+
       if (data.data_sz() > 0)
       {
         std::unique_ptr<safe_vw> init_vw(new safe_vw(data.data(), data.data_sz()));
 
-        std::unique_ptr<safe_vw_factory> factory;		  
+        std::unique_ptr<safe_vw_factory> factory;
+        std::string command_line;
         if (init_vw->is_CB_to_CCB_model_upgrade(_initial_command_line))
         {
-          factory.reset(new safe_vw_factory(std::move(data), _upgrade_to_CCB_vw_commandline_options));
+          command_line = _upgrade_to_CCB_vw_commandline_options;
+          factory.reset(new safe_vw_factory(std::move(data), command_line));
         }
         else
         {
@@ -34,8 +56,16 @@ namespace reinforcement_learning { namespace model_management {
 
         std::unique_ptr<safe_vw> test_vw((*factory)());
         if (test_vw->is_compatible(_initial_command_line)) {
+          // Deltas received later are applied on top of this model
+          _base_model = data;
+          _base_command_line = command_line;
+          _patches.clear();
+          _model_version = test_vw->id();
+          _weight_mask = test_vw->weight_mask();
+
           // safe_vw_factory will create a copy of the model data to use for vw object construction.
           _vw_pool.update_factory(factory.release());
+          _prediction_cache.clear();
           model_ready = true;
         }
         else {
@@ -54,6 +84,50 @@ namespace reinforcement_learning { namespace model_management {
     return error_code::success;
   }
 
+  int vw_model::apply_delta(const model_data& data, bool& model_ready, api_status* status) {
+    model_delta delta;
+    RETURN_IF_FAIL(model_delta::parse(data.data(), data.data_sz(), delta, _trace_logger, status));
+
+    if (_base_model.data_sz() > 0 && delta.version == _model_version) {
+      TRACE_INFO(_trace_logger, utility::concat("Model delta to ", delta.version, " is already applied"));
+      model_ready = true;
+      return error_code::success;
+    }
+
+    if (_base_model.data_sz() == 0 || delta.base_version != _model_version) {
+      RETURN_ERROR_LS(_trace_logger, status, model_delta_base_mismatch)
+        << "delta from " << delta.base_version << " to " << delta.version << ", current model " << _model_version;
+    }
+
+    // A delta built for a model with fewer weights would overwrite unrelated ones, so it is rejected as a whole
+    for (const auto& patch : delta.patches) {
+      if (patch.index > _weight_mask) {
+        RETURN_ERROR_LS(_trace_logger, status, model_delta_format_error)
+          << "weight index " << patch.index << " is beyond the weights of model " << _model_version;
+      }
+    }
+
+    for (const auto& patch : delta.patches) {
+      _patches[patch.index] = patch.value;
+    }
+
+    auto patches = std::make_shared<std::vector<weight_patch>>();
+    patches->reserve(_patches.size());
+    for (const auto& patch : _patches) {
+      patches->push_back(weight_patch{ patch.first, patch.second });
+    }
+
+    // The new generation gets its own patched copy of the base model. Objects handed out before keep predicting with
+    // the previous generation, and are released when they return to the pool.
+    _vw_pool.update_factory(new safe_vw_factory(_base_model, _base_command_line, std::move(patches), delta.version));
+    _prediction_cache.clear();
+    _model_version = delta.version;
+    model_ready = true;
+
+    TRACE_INFO(_trace_logger, utility::concat("Applied model delta to ", delta.version, " with ", delta.patches.size(), " patches"));
+    return error_code::success;
+  }
+
   int vw_model::choose_rank(
     uint64_t rnd_seed,
     const char* features,
@@ -62,7 +136,7 @@ namespace reinforcement_learning { namespace model_management {
     std::string& model_version,
     api_status* status) {
     try {
-      pooled_vw vw(_vw_pool, _vw_pool.get_or_create());
+      pooled_vw vw(_vw_pool, acquire(_vw_pool));
 
       // Get a ranked list of action_ids and corresponding pdf
       vw->rank(features, action_ids, action_pdf);
@@ -79,11 +153,68 @@ namespace reinforcement_learning { namespace model_management {
     }
   }
 
-  int vw_model::choose_continuous_action(const char* features, float& action, float& pdf_value, std::string& model_version, api_status* status)
+  int vw_model::choose_rank_flat(uint64_t rnd_seed, const char* features, ranking_buffer& ranking, std::string& model_version, api_status* status) {
+    try {
+      // The ranking does not depend on rnd_seed: exploration samples from it afterwards
+      prediction_cache::ticket ticket;
+      {
+        utility::stage_span span("prediction_cache_lookup");
+        if (_prediction_cache.lookup(features, ranking, model_version, ticket)) {
+          return error_code::success;
+        }
+      }
+
+      pooled_vw vw(_vw_pool, acquire(_vw_pool));
+
+      // Get a ranked list of action_ids and corresponding pdf
+      vw->rank(features, ranking);
+
+      model_version = vw->id();
+      _prediction_cache.store(ticket, ranking, model_version);
+
+      return error_code::success;
+    }
+    catch ( const std::exception& e) {
+      RETURN_ERROR_LS(_trace_logger, status, model_rank_error) << e.what();
+    }
+    catch ( ... ) {
+      RETURN_ERROR_LS(_trace_logger, status, model_rank_error) << "Unknown error";
+    }
+  }
+
+  int vw_model::choose_rank_shared(uint64_t rnd_seed, const shared_context& shared, const char* actions, const char* context, ranking_buffer& ranking, std::string& model_version, api_status* status) {
+    try {
+      prediction_cache::ticket ticket;
+      {
+        utility::stage_span span("prediction_cache_lookup");
+        if (_prediction_cache.lookup(context, ranking, model_version, ticket)) {
+          return error_code::success;
+        }
+      }
+
+      pooled_vw vw(_vw_pool, acquire(_vw_pool));
+
+      // Each pooled instance parses the shared features once and keeps them until the model is replaced
+      vw->rank(shared, actions, ranking);
+
+      model_version = vw->id();
+      _prediction_cache.store(ticket, ranking, model_version);
+
+      return error_code::success;
+    }
+    catch ( const std::exception& e) {
+      RETURN_ERROR_LS(_trace_logger, status, model_rank_error) << e.what();
+    }
+    catch ( ... ) {
+      RETURN_ERROR_LS(_trace_logger, status, model_rank_error) << "Unknown error";
+    }
+  }
+
+  int vw_model::choose_continuous_action(uint64_t rnd_seed, const char* features, float& action, float& pdf_value, std::string& model_version, api_status* status)
   {
     try
     {
-      pooled_vw vw(_vw_pool, _vw_pool.get_or_create());
+      pooled_vw vw(_vw_pool, acquire(_vw_pool));
 
       vw->choose_continuous_action(features, action, pdf_value);
 
@@ -102,7 +233,7 @@ namespace reinforcement_learning { namespace model_management {
   int vw_model::request_decision(const std::vector<const char*>& event_ids, const char* features, std::vector<std::vector<uint32_t>>& actions_ids, std::vector<std::vector<float>>& action_pdfs, std::string& model_version, api_status* status)
   {
     try {
-      pooled_vw vw(_vw_pool, _vw_pool.get_or_create());
+      pooled_vw vw(_vw_pool, acquire(_vw_pool));
 
       // Get a ranked list of action_ids and corresponding pdf
       vw->rank_decisions(event_ids, features, actions_ids, action_pdfs);
@@ -123,7 +254,7 @@ namespace reinforcement_learning { namespace model_management {
   int vw_model::request_multi_slot_decision(const char *event_id, const std::vector<std::string>& slot_ids, const char* features, std::vector<std::vector<uint32_t>>& actions_ids, std::vector<std::vector<float>>& action_pdfs, std::string& model_version, api_status* status)
   {
     try {
-      pooled_vw vw(_vw_pool, _vw_pool.get_or_create());
+      pooled_vw vw(_vw_pool, acquire(_vw_pool));
 
       // Get a ranked list of action_ids and corresponding pdf
       vw->rank_multi_slot_decisions(event_id, slot_ids, features, actions_ids, action_pdfs);
@@ -145,5 +276,11 @@ namespace reinforcement_learning { namespace model_management {
     return safe_vw::get_model_type(_initial_command_line);
   }
 
+  int vw_model::get_prediction_cache_stats(prediction_cache_stats& stats, api_status* status) const
+  {
+    _prediction_cache.get_stats(stats);
+    return error_code::success;
+  }
+
 
 }}
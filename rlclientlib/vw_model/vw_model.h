@@ -1,6 +1,11 @@
 #pragma once
+#include <map>
+#include <string>
+
 #include "model_mgmt.h"
 #include "safe_vw.h"
+#include "../model_mgmt/model_delta.h"
+#include "../model_mgmt/prediction_cache.h"
 #include "../utility/versioned_object_pool.h"
 
 namespace reinforcement_learning {
@@ -17,18 +22,31 @@ namespace reinforcement_learning { namespace model_management {
 
     int update(const model_data& data, bool& model_ready, api_status* status = nullptr) override;
     int choose_rank(uint64_t rnd_seed, const char* features, std::vector<int>& action_ids, std::vector<float>& action_pdf, std::string& model_version, api_status* status = nullptr) override;
-    int choose_continuous_action(const char* features, float& action, float& pdf_value, std::string& model_version, api_status* status = nullptr) override;
+    int choose_rank_flat(uint64_t rnd_seed, const char* features, ranking_buffer& ranking, std::string& model_version, api_status* status = nullptr) override;
+    int choose_rank_shared(uint64_t rnd_seed, const shared_context& shared, const char* actions, const char* context, ranking_buffer& ranking, std::string& model_version, api_status* status = nullptr) override;
+    int choose_continuous_action(uint64_t rnd_seed, const char* features, float& action, float& pdf_value, std::string& model_version, api_status* status = nullptr) override;
     int request_decision(const std::vector<const char*>& event_ids, const char* features, std::vector<std::vector<uint32_t>>& actions_ids, std::vector<std::vector<float>>& action_pdfs, std::string& model_version, api_status* status = nullptr) override;
     int request_multi_slot_decision(const char *event_id, const std::vector<std::string>& slot_ids, const char* features, std::vector<std::vector<uint32_t>>& actions_ids, std::vector<std::vector<float>>& action_pdfs, std::string& model_version, api_status* status = nullptr) override;
     model_type_t model_type() const override;
+    int get_prediction_cache_stats(prediction_cache_stats& stats, api_status* status = nullptr) const override;
 
   private:
+    int apply_delta(const model_data& data, bool& model_ready, api_status* status);
+
     const std::string _initial_command_line;
 	const std::string _upgrade_to_CCB_vw_commandline_options{ "--ccb_explore_adf --json --quiet" };
 
     using vw_ptr = std::shared_ptr<safe_vw>;
     using pooled_vw = utility::pooled_object_guard<safe_vw, safe_vw_factory>;
     utility::versioned_object_pool<safe_vw, safe_vw_factory> _vw_pool;
+    prediction_cache _prediction_cache;
     i_trace* _trace_logger;
+
+    // Last full model and the patches of the deltas applied to it since, ordered by weight index
+    model_data _base_model;
+    std::string _base_command_line;
+    std::map<uint64_t, float> _patches;
+    std::string _model_version;
+    uint64_t _weight_mask = 0;
   };
 }}
@@ -127,6 +127,7 @@ setup(
     long_description="",
     license = 'MIT',
     ext_modules=[CMakeExtension("rl_client")],
+    install_requires=["numpy"],
     cmdclass={"build_ext": CMakeBuild},
     zip_safe=False,
     distclass=CMakeDistribution
@@ -0,0 +1,84 @@
+#include "utility/event_id_generator.h"
+
+#include <boost/uuid/random_generator.hpp>
+#include <boost/uuid/uuid_io.hpp>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace u = reinforcement_learning::utility;
+
+namespace {
+  using clock_type = std::chrono::steady_clock;
+
+  // Ids for one request: one event id, or one per slot for a multi slot decision
+  template <typename Fn>
+  double ns_per_request(size_t ids_per_request, size_t requests, Fn make_id, size_t& checksum) {
+    std::vector<std::string> ids(ids_per_request);
+    const auto start = clock_type::now();
+    for (size_t r = 0; r < requests; ++r) {
+      for (auto& id : ids) {
+        make_id(id);
+        checksum += static_cast<unsigned char>(id[0]);
+      }
+    }
+    return std::chrono::duration<double, std::nano>(clock_type::now() - start).count() / requests;
+  }
+
+  void boost_id(std::string& id) {
+    // The path every auto-generated id took: a new generator, seeded from the OS, per id
+    id = boost::uuids::to_string(boost::uuids::random_generator()());
+  }
+
+  void generator_id(std::string& id) {
+    char uuid[u::UUID_STRING_LENGTH + 1];
+    u::generate_uuid(uuid);
+    id.assign(uuid, u::UUID_STRING_LENGTH);
+  }
+
+  void run(size_t threads, size_t ids_per_request, size_t requests) {
+    const auto time_threads = [&](void (*make_id)(std::string&)) {
+      std::vector<std::thread> workers;
+      std::vector<double> ns(threads);
+      std::vector<size_t> checksums(threads);
+      for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] { ns[t] = ns_per_request(ids_per_request, requests, make_id, checksums[t]); });
+      }
+      double total = 0;
+      for (size_t t = 0; t < threads; ++t) {
+        workers[t].join();
+        total += ns[t];
+      }
+      return total / threads;
+    };
+
+    const auto boost_ns = time_threads(boost_id);
+    const auto generator_ns = time_threads(generator_id);
+    std::cout << std::fixed << std::setprecision(1) << std::setw(8) << threads << std::setw(8) << ids_per_request
+      << std::setw(16) << boost_ns << std::setw(16) << generator_ns << std::setw(11) << boost_ns / generator_ns << "x"
+      << std::endl;
+  }
+}
+
+int main(int argc, char** argv) {
+  const size_t total_ids = argc > 1 ? std::stoul(argv[1]) : 200000;
+  std::vector<size_t> thread_counts{ 1 };
+  if (std::thread::hardware_concurrency() > 1) {
+    thread_counts.push_back(std::thread::hardware_concurrency());
+  }
+
+  std::cout << std::setw(8) << "threads" << std::setw(8) << "ids" << std::setw(16) << "boost ns" << std::setw(16)
+    << "generator ns" << std::setw(12) << "speedup" << std::endl;
+
+  // A single decision, then a multi slot decision with 20 slots missing their id
+  for (const size_t ids_per_request : { 1, 20 }) {
+    for (const auto threads : thread_counts) {
+      run(threads, ids_per_request, total_ids / ids_per_request);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,80 @@
+#include "explore_kernels.h"
+#include "explore.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace ek = reinforcement_learning::explore_kernels;
+
+namespace {
+  using clock_type = std::chrono::steady_clock;
+
+  double ns_per_call(clock_type::time_point start, size_t calls) {
+    return std::chrono::duration<double, std::nano>(clock_type::now() - start).count() / calls;
+  }
+
+  // Epsilon greedy followed by sampling, the work done for every explore only decision
+  template <typename Fn>
+  double time_decisions(size_t size, size_t calls, Fn decide, uint64_t& checksum) {
+    std::vector<float> pdf(size);
+    const auto start = clock_type::now();
+    for (size_t i = 0; i < calls; ++i) {
+      checksum += decide(i, pdf);
+    }
+    return ns_per_call(start, calls);
+  }
+}
+
+int main(int argc, char** argv) {
+  const size_t sizes[] = { 10, 100, 1000, 10000 };
+  const size_t total_actions = argc > 1 ? std::stoul(argv[1]) : 20000000;
+
+  std::cout << "simd level: " << ek::simd_level() << std::endl;
+  std::cout << std::setw(8) << "actions" << std::setw(16) << "reference ns" << std::setw(16) << "kernel ns"
+    << std::setw(12) << "speedup" << std::setw(16) << "top_k(10) ns" << std::endl;
+
+  std::mt19937 gen(1);
+  for (const auto size : sizes) {
+    const auto calls = total_actions / size;
+
+    uint64_t reference_checksum = 0;
+    const auto reference_ns = time_decisions(size, calls, [](size_t seed, std::vector<float>& pdf) {
+      uint32_t chosen = 0;
+      exploration::generate_epsilon_greedy(0.2f, static_cast<uint32_t>(seed % pdf.size()), std::begin(pdf), std::end(pdf));
+      exploration::sample_after_normalizing(seed, std::begin(pdf), std::end(pdf), chosen);
+      return chosen;
+    }, reference_checksum);
+
+    uint64_t kernel_checksum = 0;
+    const auto kernel_ns = time_decisions(size, calls, [](size_t seed, std::vector<float>& pdf) {
+      uint32_t chosen = 0;
+      ek::generate_epsilon_greedy(0.2f, static_cast<uint32_t>(seed % pdf.size()), pdf.data(), pdf.data() + pdf.size());
+      ek::sample_after_normalizing(seed, pdf.data(), pdf.data() + pdf.size(), chosen);
+      return chosen;
+    }, kernel_checksum);
+
+    if (reference_checksum != kernel_checksum) {
+      std::cerr << "kernel results differ from the exploration library for " << size << " actions" << std::endl;
+      return 1;
+    }
+
+    std::uniform_real_distribution<float> value(0.f, 1.f);
+    std::vector<float> scores(size);
+    for (auto& s : scores) s = value(gen);
+    uint32_t indices[10];
+    const auto start = clock_type::now();
+    for (size_t i = 0; i < calls; ++i) {
+      scores[i % size] = value(gen);
+      ek::top_k(scores.data(), scores.data() + size, 10, indices);
+    }
+    const auto top_k_ns = ns_per_call(start, calls);
+
+    std::cout << std::fixed << std::setprecision(1) << std::setw(8) << size << std::setw(16) << reference_ns
+      << std::setw(16) << kernel_ns << std::setw(11) << reference_ns / kernel_ns << "x" << std::setw(16) << top_k_ns
+      << std::endl;
+  }
+  return 0;
+}
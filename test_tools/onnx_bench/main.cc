@@ -0,0 +1,121 @@
+#include "onnx_scoring_context.h"
+
+#include "api_status.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace o = reinforcement_learning::onnx;
+
+namespace {
+  std::atomic<size_t> allocation_count{0};
+
+  using clock_type = std::chrono::steady_clock;
+
+  std::string to_base64(const void* data, size_t size) {
+    const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+    std::string result;
+    for (size_t i = 0; i < size; i += 3) {
+      uint32_t group = bytes[i] << 16;
+      if (i + 1 < size) group |= bytes[i + 1] << 8;
+      if (i + 2 < size) group |= bytes[i + 2];
+
+      result.push_back(alphabet[(group >> 18) & 0x3F]);
+      result.push_back(alphabet[(group >> 12) & 0x3F]);
+      result.push_back(i + 1 < size ? alphabet[(group >> 6) & 0x3F] : '=');
+      result.push_back(i + 2 < size ? alphabet[group & 0x3F] : '=');
+    }
+    return result;
+  }
+
+  // A 1x1x28x28 input, the shape of the MNIST model used by the extension tests
+  std::string make_notation(const std::string& input_name) {
+    const std::vector<int64_t> dims = { 1, 1, 28, 28 };
+    std::vector<float> values(28 * 28);
+    for (size_t i = 0; i < values.size(); ++i) {
+      values[i] = static_cast<float>(i % 256) / 255.f;
+    }
+
+    return "{\"" + input_name + "\":\"" + to_base64(dims.data(), dims.size() * sizeof(int64_t)) + ";" +
+      to_base64(values.data(), values.size() * sizeof(float)) + "\"}";
+  }
+
+  bool run(o::onnx_scoring_context& context, const std::string& notation, size_t calls, double& ns_per_call, double& allocations_per_call) {
+    reinforcement_learning::ranking_buffer ranking;
+    reinforcement_learning::api_status status;
+
+    // Warm up so that buffers reach their steady-state size
+    if (context.score(notation.c_str(), ranking, &status) != 0) {
+      std::cerr << status.get_error_msg() << std::endl;
+      return false;
+    }
+
+    const size_t allocations_before = allocation_count.load();
+    const auto start = clock_type::now();
+    for (size_t i = 0; i < calls; ++i) {
+      context.score(notation.c_str(), ranking, nullptr);
+    }
+    ns_per_call = std::chrono::duration<double, std::nano>(clock_type::now() - start).count() / calls;
+    allocations_per_call = static_cast<double>(allocation_count.load() - allocations_before) / calls;
+    return true;
+  }
+}
+
+// Count every allocation of the process, including the ones done inside onnxruntime
+void* operator new(size_t size) {
+  ++allocation_count;
+  if (void* p = std::malloc(size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::cerr << "usage: onnx_bench <model.onnx> <output name> [input name] [calls]" << std::endl;
+    return 1;
+  }
+
+  const std::string input_name = argc > 3 ? argv[3] : "Input3";
+  const size_t calls = argc > 4 ? std::stoul(argv[4]) : 10000;
+
+  std::ifstream file(argv[1], std::ios::binary);
+  const std::vector<char> model_data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+  Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "onnx_bench");
+  Ort::SessionOptions options;
+  options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
+  auto session = std::make_shared<Ort::Session>(env, model_data.data(), model_data.size(), options);
+
+  const std::string notation = make_notation(input_name);
+
+  std::cout << std::setw(12) << "path" << std::setw(16) << "ns/call" << std::setw(20) << "allocations/call" << std::endl;
+  for (const bool use_io_binding : { false, true }) {
+    o::onnx_scoring_context context(session, argv[2], use_io_binding, nullptr);
+
+    double ns_per_call = 0;
+    double allocations_per_call = 0;
+    if (!run(context, notation, calls, ns_per_call, allocations_per_call)) {
+      return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(1) << std::setw(12) << (use_io_binding ? "io_binding" : "session_run")
+      << std::setw(16) << ns_per_call << std::setw(20) << allocations_per_call << std::endl;
+  }
+  return 0;
+}
@@ -3,6 +3,8 @@
 #   define BOOST_TEST_MODULE Main
 #endif
 #include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <atomic>
 #include <string>
 #include <vector>
 #include "data_buffer.h"
@@ -66,8 +68,8 @@ namespace reinforcement_learning { namespace logger {
   struct json_event_serializer<test_droppable_event> {
     using serializer_t = json_event_serializer<test_droppable_event>;
 
-    static int serialize(test_droppable_event& evt, std::ostream& out, api_status* status) {
-      out << evt.get_seed_id();
+    static int serialize(test_droppable_event& evt, utility::data_buffer_writer& out, api_status* status) {
+      out.write(evt.get_seed_id());
       return error_code::success;
     }
 
@@ -77,8 +79,8 @@ namespace reinforcement_learning { namespace logger {
   struct json_event_serializer<test_undroppable_event> {
     using serializer_t = json_event_serializer<test_undroppable_event>;
 
-    static int serialize(test_undroppable_event& evt, std::ostream& out, api_status* status) {
-      out << evt.get_event_id();
+    static int serialize(test_undroppable_event& evt, utility::data_buffer_writer& out, api_status* status) {
+      out.write(evt.get_event_id());
       return error_code::success;
     }
 
@@ -149,6 +151,72 @@ BOOST_AUTO_TEST_CASE(flush_batches) {
   BOOST_REQUIRE_EQUAL(items.size(), 2);
   BOOST_CHECK_EQUAL(items[0], expected_batch_0);
   BOOST_CHECK_EQUAL(items[1], expected_batch_1);
+} //test that the batcher reports its activity to the process wide metrics of its section
+BOOST_AUTO_TEST_CASE(flush_updates_metrics) {
+  std::vector<std::string> items;
+  error_callback_fn error_fn(expect_no_error, nullptr);
+  utility::watchdog watchdog(nullptr);
+  utility::async_batcher_config config;
+  config.section = "async_batcher_metrics_test";
+  config.send_high_water_mark = 10;
+  config.send_batch_interval_ms = 100000;
+  config.send_queue_max_capacity = 2;
+  int dummy = 0;
+
+  auto& registry = utility::metrics_registry::instance();
+  auto& sent = registry.counter("async_batcher_metrics_test.sent_events");
+  auto& dropped = registry.counter("async_batcher_metrics_test.queue.dropped_events");
+  auto& batch_events = registry.histogram("async_batcher_metrics_test.batch.events");
+  auto& depth = registry.gauge("async_batcher_metrics_test.queue.depth");
+  const auto sent_before = sent.value();
+  const auto dropped_before = dropped.value();
+
+  auto batcher = new logger::async_batcher<test_undroppable_event>(new message_sender(items), watchdog, dummy, &error_fn, config);
+  batcher->init(nullptr);
+  batcher->append(test_undroppable_event("foo"));
+  batcher->append(test_undroppable_event("bar-yyy"));
+  batcher->append(test_undroppable_event("hello"));
+  delete batcher;
+
+  BOOST_REQUIRE_EQUAL(items.size(), 2);
+  BOOST_CHECK_EQUAL(sent.value() - sent_before, 3);
+  histogram_value batches;
+  batch_events.get(batches);
+  BOOST_CHECK_GE(batches.count, 2);
+  BOOST_CHECK_EQUAL(depth.value(), 0);
+
+  logger::async_batcher<test_droppable_event> dropping(new message_sender(items), watchdog, dummy, &error_fn, config);
+  dropping.append(test_droppable_event("foo"));
+  dropping.append(test_droppable_event("bar"));
+  queue_stats stats;
+  dropping.get_stats(stats);
+  BOOST_CHECK_EQUAL(stats.dropped_events, 2);
+  BOOST_CHECK_EQUAL(dropped.value() - dropped_before, 2);
+} //test that batches reuse the buffers of the batches sent before them
+BOOST_AUTO_TEST_CASE(flush_reuses_batch_buffers) {
+  std::vector<std::string> items;
+  auto s = new message_sender(items);
+  error_callback_fn error_fn(expect_no_error, nullptr);
+  utility::watchdog watchdog(nullptr);
+  utility::async_batcher_config config;
+  config.send_high_water_mark = 10;
+  config.send_batch_interval_ms = 100;
+  int dummy = 0;
+  logger::async_batcher<test_undroppable_event> batcher(s, watchdog, dummy, &error_fn, config);
+  batcher.init(nullptr);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  batcher.append(test_undroppable_event("foo-xxx"));
+  batcher.append(test_undroppable_event("bar-yyy"));
+  batcher.append(test_undroppable_event("hello"));
+  std::this_thread::sleep_for(std::chrono::milliseconds(150));
+  BOOST_REQUIRE_EQUAL(items.size(), 2);
+
+  queue_stats stats;
+  batcher.get_stats(stats);
+  BOOST_CHECK_EQUAL(stats.buffers_allocated, 1);
+  BOOST_CHECK_EQUAL(stats.buffers_reused, 1);
+  BOOST_CHECK_EQUAL(stats.pooled_buffers, 1);
+  BOOST_CHECK(stats.pooled_buffer_bytes > 0);
 } //test that the batcher flushes everything before deletion
 BOOST_AUTO_TEST_CASE(flush_after_deletion) {
   std::vector<std::string> items;
@@ -201,3 +269,202 @@ BOOST_AUTO_TEST_CASE(queue_overflow_do_not_drop_event) {
   for (const auto& item : items) { actual_output.append(item); }
   BOOST_CHECK_EQUAL(expected_output, actual_output);
 }
+
+//test that a full BLOCK queue gives up waiting once the timeout expires
+BOOST_AUTO_TEST_CASE(queue_overflow_block_timeout) {
+  std::vector<std::string> items;
+  auto s = new message_sender(items);
+  error_callback_fn error_fn(expect_no_error, nullptr);
+  utility::watchdog watchdog(nullptr);
+  utility::async_batcher_config config;
+  config.send_high_water_mark = 262143;
+  config.send_batch_interval_ms = 100000; //the queue is never drained by the background thread
+  config.send_queue_max_capacity = 3;
+  config.queue_mode = queue_mode_enum::BLOCK;
+  config.queue_block_timeout_ms = 10;
+  int dummy = 0;
+  auto batcher = new logger::async_batcher<test_undroppable_event>(s, watchdog, dummy, &error_fn, config);
+  batcher->init(nullptr);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 5; ++i) { batcher->append(test_undroppable_event(std::to_string(i))); }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  BOOST_CHECK(elapsed < std::chrono::seconds(10));
+
+  queue_stats stats;
+  batcher->get_stats(stats);
+  BOOST_CHECK_EQUAL(stats.block_timeouts, 3);
+  BOOST_CHECK_EQUAL(stats.dropped_events, 0);
+  BOOST_CHECK_EQUAL(stats.queue_depth, 5);
+  delete batcher;
+  BOOST_REQUIRE(!items.empty());
+}
+
+//test that ADAPTIVE subsamples before the queue is full and reports it in the stats
+BOOST_AUTO_TEST_CASE(queue_adaptive_subsampling) {
+  std::vector<std::string> items;
+  auto s = new message_sender(items);
+  error_callback_fn error_fn(expect_no_error, nullptr);
+  utility::watchdog watchdog(nullptr);
+  utility::async_batcher_config config;
+  config.send_high_water_mark = 262143;
+  config.send_batch_interval_ms = 100000;
+  config.send_queue_max_capacity = 10;
+  config.queue_mode = queue_mode_enum::ADAPTIVE;
+  config.queue_block_timeout_ms = 0;
+  config.adaptive_low_water_mark = 0.2f;
+  config.adaptive_min_pass_prob = 0.1f;
+  int dummy = 0;
+  auto batcher = new logger::async_batcher<test_droppable_event>(s, watchdog, dummy, &error_fn, config);
+  batcher->init(nullptr);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  //up to the low water mark every event is admitted
+  for (int i = 0; i < 3; ++i) { batcher->append(test_droppable_event(std::to_string(i))); }
+  queue_stats stats;
+  batcher->get_stats(stats);
+  BOOST_CHECK_EQUAL(stats.queue_depth, 3);
+  BOOST_CHECK_EQUAL(stats.dropped_events, 0);
+  //past the low water mark the admission probability decreases with the fill ratio
+  BOOST_CHECK(stats.admission_pass_prob < 1.f);
+  BOOST_CHECK(stats.admission_pass_prob > config.adaptive_min_pass_prob);
+
+  batcher->append(test_droppable_event("3"));
+  batcher->get_stats(stats);
+  BOOST_CHECK_EQUAL(stats.queue_depth, 3);
+  BOOST_CHECK_EQUAL(stats.dropped_events, 1);
+  delete batcher;
+  BOOST_REQUIRE_EQUAL(items.size(), 1);
+  BOOST_CHECK_EQUAL(items[0], "0\n1\n2\n");
+}
+
+//Sender counting batches and events, which the test thread reads while the background thread sends
+class counting_sender : public logger::i_message_sender {
+public:
+  int send(const uint16_t msg_type, const buffer& db, api_status* status = nullptr) override {
+    const std::string body(reinterpret_cast<char*>(db->body_begin()), db->body_filled_size());
+    events += std::count(body.begin(), body.end(), '\n');
+    ++batches;
+    return error_code::success;
+  }
+  int init(api_status* status) override { return error_code::success; }
+
+  std::atomic<size_t> batches{ 0 };
+  std::atomic<size_t> events{ 0 };
+};
+
+//sends a burst of events in steps of 10, returns the number of events dropped
+uint64_t send_burst(bool flush_on_high_water_mark) {
+  error_callback_fn error_fn(expect_no_error, nullptr);
+  utility::watchdog watchdog(nullptr);
+  utility::async_batcher_config config;
+  config.send_high_water_mark = 10; //each event is estimated to 1 byte
+  config.send_batch_interval_ms = 100000;
+  config.send_queue_max_capacity = 50;
+  config.flush_on_high_water_mark = flush_on_high_water_mark;
+  int dummy = 0;
+  logger::async_batcher<test_droppable_event> batcher(new counting_sender(), watchdog, dummy, &error_fn, config);
+  batcher.init(nullptr);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  for (int i = 0; i < 500; ++i) {
+    batcher.append(test_droppable_event(std::to_string(i)));
+    if (i % 10 == 9) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+  }
+
+  queue_stats stats;
+  batcher.get_stats(stats);
+  return stats.dropped_events;
+}
+
+//waits until the sender got count events, returns how long it took
+std::chrono::milliseconds wait_for_events(const counting_sender& sender, size_t count) {
+  const auto start = std::chrono::steady_clock::now();
+  while (sender.events < count && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+}
+
+//test that batches are sent as soon as they are full, long before the batch interval
+BOOST_AUTO_TEST_CASE(flush_on_high_water_mark_latency) {
+  auto s = new counting_sender();
+  error_callback_fn error_fn(expect_no_error, nullptr);
+  utility::watchdog watchdog(nullptr);
+  utility::async_batcher_config config;
+  config.send_high_water_mark = 10; //each event is estimated to 1 byte
+  config.send_batch_interval_ms = 100000;
+  config.flush_on_high_water_mark = true;
+  int dummy = 0;
+  logger::async_batcher<test_undroppable_event> batcher(s, watchdog, dummy, &error_fn, config);
+  batcher.init(nullptr);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  //below the high water mark events wait for the interval
+  for (int i = 0; i < 9; ++i) { batcher.append(test_undroppable_event(std::to_string(i))); }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  BOOST_CHECK_EQUAL(s->batches, 0);
+
+  batcher.append(test_undroppable_event("9"));
+  auto latency = wait_for_events(*s, 10);
+  BOOST_CHECK_EQUAL(s->events, 10);
+  BOOST_CHECK_LT(latency.count(), 1000);
+  BOOST_TEST_MESSAGE("Latency of a full batch: " << latency.count() << " ms");
+
+  //the next batch wakes the background thread again
+  for (int i = 0; i < 10; ++i) { batcher.append(test_undroppable_event(std::to_string(i))); }
+  latency = wait_for_events(*s, 20);
+  BOOST_CHECK_EQUAL(s->events, 20);
+  BOOST_CHECK_LT(latency.count(), 1000);
+}
+
+//test that flushing full batches right away keeps bursts from filling the queue
+BOOST_AUTO_TEST_CASE(flush_on_high_water_mark_burst) {
+  const auto periodic_dropped = send_burst(false);
+  const auto flush_dropped = send_burst(true);
+  BOOST_TEST_MESSAGE("Events dropped from a burst of 500: " << periodic_dropped << " with periodic flushes, "
+    << flush_dropped << " with flushes at the high water mark");
+
+  BOOST_CHECK_GT(periodic_dropped, 0);
+  BOOST_CHECK_LT(flush_dropped, periodic_dropped);
+}
+
+//test that a batcher created from a config snapshot follows its reloaded interval and queue mode
+BOOST_AUTO_TEST_CASE(batcher_follows_reloaded_config) {
+  utility::configuration initial;
+  initial.set(name::INTERACTION_SEND_BATCH_INTERVAL_MS, "100000");
+  initial.set(name::INTERACTION_QUEUE_MODE, "BLOCK");
+  initial.set(name::INTERACTION_SEND_QUEUE_MAX_CAPACITY_KB, "1");
+  utility::config_snapshot snapshot;
+  BOOST_REQUIRE_EQUAL(snapshot.resolve(initial, nullptr, nullptr), error_code::success);
+
+  auto s = new counting_sender();
+  error_callback_fn error_fn(expect_no_error, nullptr);
+  utility::watchdog watchdog(nullptr);
+  auto config = utility::get_batcher_config(snapshot, INTERACTION_SECTION);
+  int dummy = 0;
+  logger::async_batcher<test_droppable_event> batcher(s, watchdog, dummy, &error_fn, config);
+  batcher.init(nullptr);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  utility::configuration changes;
+  changes.set(name::INTERACTION_SEND_BATCH_INTERVAL_MS, "10");
+  changes.set(name::INTERACTION_QUEUE_MODE, "DROP");
+  BOOST_REQUIRE_EQUAL(snapshot.reload(changes, nullptr, nullptr), error_code::success);
+
+  //the first append applies the reload, the next batches follow the short interval
+  batcher.append(test_droppable_event("0"));
+  BOOST_CHECK_LT(wait_for_events(*s, 1).count(), 1000);
+  batcher.append(test_droppable_event("1"));
+  BOOST_CHECK_LT(wait_for_events(*s, 2).count(), 1000);
+  BOOST_CHECK_EQUAL(s->events, 2);
+
+  //a full queue drops events instead of blocking the producer
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 5000; ++i) {
+    batcher.append(test_droppable_event(std::to_string(i)));
+  }
+  BOOST_CHECK_LT(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start).count(), 5);
+}
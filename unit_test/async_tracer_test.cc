@@ -0,0 +1,192 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include "api_status.h"
+#include "async_tracer.h"
+#include "err_constants.h"
+#include "level_filter_tracer.h"
+#include "utility/trace_rate_limiter.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace r = reinforcement_learning;
+namespace err = reinforcement_learning::error_code;
+
+namespace {
+  // Outlives the tracers, which own their inner logger
+  struct trace_record {
+    std::vector<std::string> messages;
+    std::vector<int> levels;
+    std::thread::id writer;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool blocked = false;
+    bool writer_waiting = false;  // A log() call is held by block()
+
+    size_t size() {
+      std::lock_guard<std::mutex> lock(mutex);
+      return messages.size();
+    }
+
+    void block() {
+      std::lock_guard<std::mutex> lock(mutex);
+      blocked = true;
+    }
+
+    // Returns once a writer is stuck in log()
+    void wait_for_blocked_writer() {
+      std::unique_lock<std::mutex> lock(mutex);
+      cv.wait(lock, [this] { return writer_waiting; });
+    }
+
+    void unblock() {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        blocked = false;
+      }
+      cv.notify_all();
+    }
+  };
+
+  class recording_tracer : public r::i_trace {
+  public:
+    explicit recording_tracer(trace_record& record) : _record(record) {}
+
+    void log(int log_level, const std::string& msg) override {
+      std::unique_lock<std::mutex> lock(_record.mutex);
+      if (_record.blocked) {
+        _record.writer_waiting = true;
+        _record.cv.notify_all();
+        _record.cv.wait(lock, [this] { return !_record.blocked; });
+        _record.writer_waiting = false;
+      }
+      _record.messages.push_back(msg);
+      _record.levels.push_back(log_level);
+      _record.writer = std::this_thread::get_id();
+    }
+
+  private:
+    trace_record& _record;
+  };
+
+  std::string formatted(int& count) {
+    ++count;
+    return "formatted";
+  }
+
+  // Rate limits are per call site
+  void trace_failure(r::i_trace* logger) {
+    TRACE_ERROR_RATE_LIMITED(logger, 100, "request failed");
+  }
+}
+
+BOOST_AUTO_TEST_CASE(trace_level_filters_before_formatting) {
+  trace_record record;
+  int count = 0;
+
+  recording_tracer tracer(record);
+  r::i_trace* logger = &tracer;
+  TRACE_DEBUG(logger, formatted(count));
+  BOOST_CHECK_EQUAL(count, 1);
+
+  r::level_filter_tracer filter(new recording_tracer(record), r::LEVEL_WARN);
+  logger = &filter;
+  TRACE_DEBUG(logger, formatted(count));
+  TRACE_INFO(logger, formatted(count));
+  BOOST_CHECK_EQUAL(count, 1);
+  TRACE_WARN(logger, formatted(count));
+  TRACE_ERROR(logger, formatted(count));
+  BOOST_CHECK_EQUAL(count, 3);
+  BOOST_CHECK_EQUAL(record.messages.size(), 3);
+
+  int level;
+  BOOST_CHECK(get_log_level("WARN", level));
+  BOOST_CHECK_EQUAL(level, r::LEVEL_WARN);
+  BOOST_CHECK(!get_log_level("VERBOSE", level));
+}
+
+BOOST_AUTO_TEST_CASE(error_status_passes_trace_level_filter) {
+  trace_record record;
+  r::level_filter_tracer filter(new recording_tracer(record), r::LEVEL_WARN);
+  r::api_status status;
+
+  // Error statuses are traced at the error level, so a WARN filter keeps them
+  const int scode = [&]() -> int { RETURN_ERROR_LS(&filter, &status, invalid_argument) << "bad value"; }();
+  BOOST_CHECK_EQUAL(scode, err::invalid_argument);
+  BOOST_REQUIRE_EQUAL(record.messages.size(), 1);
+  BOOST_CHECK_EQUAL(record.levels[0], r::LEVEL_ERROR);
+}
+
+BOOST_AUTO_TEST_CASE(async_tracer_writes_in_order_on_background_thread) {
+  trace_record record;
+  {
+    r::async_tracer tracer(new recording_tracer(record), 64);
+    BOOST_CHECK_EQUAL(tracer.init(nullptr), err::success);
+    for (int i = 0; i < 20; ++i) {
+      tracer.log(r::LEVEL_INFO, std::to_string(i));
+    }
+    tracer.log(r::LEVEL_ERROR, "last");
+
+    while (record.size() == 0) {
+      std::this_thread::yield();
+    }
+  }
+
+  // Destroying the tracer writes what is left
+  BOOST_REQUIRE_EQUAL(record.messages.size(), 21);
+  for (int i = 0; i < 20; ++i) {
+    BOOST_CHECK_EQUAL(record.messages[i], std::to_string(i));
+  }
+  BOOST_CHECK_EQUAL(record.levels[20], r::LEVEL_ERROR);
+  BOOST_CHECK(record.writer != std::this_thread::get_id());
+}
+
+BOOST_AUTO_TEST_CASE(async_tracer_drops_when_full) {
+  trace_record record;
+  {
+    r::async_tracer tracer(new recording_tracer(record), 4);
+    BOOST_CHECK_EQUAL(tracer.init(nullptr), err::success);
+
+    // The writer is stuck on the first message while the others fill the ring
+    record.block();
+    tracer.log(r::LEVEL_INFO, "first");
+    record.wait_for_blocked_writer();
+    for (int i = 0; i < 10; ++i) {
+      tracer.log(r::LEVEL_INFO, std::to_string(i));
+    }
+    record.unblock();
+  }
+
+  BOOST_REQUIRE_EQUAL(record.messages.size(), 6);
+  BOOST_CHECK_EQUAL(record.messages[0], "first");
+  BOOST_CHECK_EQUAL(record.messages[1], "0");
+  BOOST_CHECK_EQUAL(record.messages[4], "3");
+  BOOST_CHECK_EQUAL(record.messages[5], "6 trace messages were dropped because the trace logger could not keep up");
+  BOOST_CHECK_EQUAL(record.levels[5], r::LEVEL_WARN);
+}
+
+BOOST_AUTO_TEST_CASE(trace_rate_limiter_suppresses_repeats) {
+  trace_record record;
+  recording_tracer tracer(record);
+  r::i_trace* logger = &tracer;
+  for (int i = 0; i < 5; ++i) {
+    trace_failure(logger);
+  }
+  BOOST_REQUIRE_EQUAL(record.messages.size(), 1);
+  BOOST_CHECK_EQUAL(record.messages[0], "request failed");
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(150));
+  for (int i = 0; i < 5; ++i) {
+    trace_failure(logger);
+  }
+  BOOST_REQUIRE_EQUAL(record.messages.size(), 2);
+  BOOST_CHECK_EQUAL(record.messages[1], "request failed (4 similar messages suppressed)");
+}
@@ -0,0 +1,240 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include "utility/background_executor.h"
+#include "utility/periodic_background_proc.h"
+#include "err_constants.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace err = reinforcement_learning::error_code;
+using namespace reinforcement_learning;
+using namespace reinforcement_learning::utility;
+
+namespace {
+  template<typename TPred>
+  bool wait_for(TPred pred, int timeout_ms = 2000) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!pred()) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        return false;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+  }
+
+  class counting_proc {
+  public:
+    int run_iteration(api_status*) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _threads.insert(std::this_thread::get_id());
+      ++_runs;
+      return err::success;
+    }
+
+    int runs() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _runs;
+    }
+
+    std::set<std::thread::id> threads() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _threads;
+    }
+
+  private:
+    std::mutex _mutex;
+    int _runs = 0;
+    std::set<std::thread::id> _threads;
+  };
+}
+
+BOOST_AUTO_TEST_CASE(background_executor_runs_many_tasks_on_few_threads) {
+  background_executor executor(2);
+  BOOST_CHECK_EQUAL(executor.init(nullptr), err::success);
+
+  const size_t task_count = 50;
+  std::vector<std::atomic<int>> runs(task_count);
+  std::vector<background_executor::task*> tasks;
+  for (size_t i = 0; i < task_count; ++i) {
+    runs[i] = 0;
+    auto& count = runs[i];
+    tasks.push_back(executor.schedule([&count] {
+      ++count;
+      return std::chrono::milliseconds(20);
+    }, std::chrono::milliseconds(i % 5 * 10)));
+  }
+
+  BOOST_CHECK(wait_for([&runs] {
+    for (auto& count : runs) {
+      if (count < 3) {
+        return false;
+      }
+    }
+    return true;
+  }));
+  for (auto t : tasks) {
+    executor.cancel(t);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(background_executor_respects_delay) {
+  background_executor executor(1);
+  BOOST_CHECK_EQUAL(executor.init(nullptr), err::success);
+
+  std::atomic<int> runs(0);
+  const auto start = std::chrono::steady_clock::now();
+  std::atomic<long long> first_run_ms(-1);
+  auto t = executor.schedule([&] {
+    if (runs++ == 0) {
+      first_run_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+    return std::chrono::milliseconds(1000);
+  }, std::chrono::milliseconds(50));
+
+  BOOST_CHECK(wait_for([&runs] { return runs == 1; }));
+  BOOST_CHECK_GE(first_run_ms, 50);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  BOOST_CHECK_EQUAL(runs, 1);
+  executor.cancel(t);
+}
+
+BOOST_AUTO_TEST_CASE(background_executor_finds_next_due_task) {
+  background_executor executor(1);
+  BOOST_CHECK_EQUAL(executor.init(nullptr), err::success);
+
+  // Due after more than a turn of the wheel, so it shares slots with the periodic task
+  std::atomic<int> late_runs(0);
+  auto late = executor.schedule([&late_runs] {
+    ++late_runs;
+    return std::chrono::milliseconds(0);
+  }, background_executor::TICK * (background_executor::WHEEL_SLOTS + 100));
+
+  std::atomic<int> cancelled_runs(0);
+  auto cancelled = executor.schedule([&cancelled_runs] {
+    ++cancelled_runs;
+    return std::chrono::milliseconds(0);
+  }, std::chrono::milliseconds(30));
+  executor.cancel(cancelled);
+
+  std::atomic<int> runs(0);
+  auto periodic = executor.schedule([&runs] {
+    ++runs;
+    return std::chrono::milliseconds(20);
+  }, std::chrono::milliseconds(60));
+
+  BOOST_CHECK(wait_for([&runs] { return runs >= 5; }));
+  BOOST_CHECK_EQUAL(cancelled_runs, 0);
+  BOOST_CHECK_EQUAL(late_runs, 0);
+  executor.cancel(periodic);
+  executor.cancel(late);
+}
+
+BOOST_AUTO_TEST_CASE(background_executor_wake_runs_now) {
+  background_executor executor(1);
+  BOOST_CHECK_EQUAL(executor.init(nullptr), err::success);
+
+  std::atomic<int> runs(0);
+  auto t = executor.schedule([&runs] {
+    ++runs;
+    return std::chrono::milliseconds(60 * 1000);
+  }, std::chrono::milliseconds(0));
+  BOOST_CHECK(wait_for([&runs] { return runs == 1; }));
+
+  executor.wake(t);
+  BOOST_CHECK(wait_for([&runs] { return runs == 2; }, 500));
+  executor.cancel(t);
+}
+
+BOOST_AUTO_TEST_CASE(background_executor_cancel_waits_for_run) {
+  background_executor executor(2);
+  BOOST_CHECK_EQUAL(executor.init(nullptr), err::success);
+
+  std::atomic<bool> started(false);
+  std::atomic<bool> finished(false);
+  std::atomic<int> runs(0);
+  auto t = executor.schedule([&] {
+    ++runs;
+    started = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    finished = true;
+    return std::chrono::milliseconds(0);
+  }, std::chrono::milliseconds(0));
+
+  BOOST_CHECK(wait_for([&started] { return started.load(); }));
+  executor.cancel(t);
+  BOOST_CHECK(finished);
+  const int runs_after_cancel = runs;
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  BOOST_CHECK_EQUAL(runs, runs_after_cancel);
+
+  // A task may cancel itself
+  std::atomic<int> self_runs(0);
+  background_executor::task* self = nullptr;
+  std::atomic<bool> scheduled(false);
+  self = executor.schedule([&] {
+    while (!scheduled) {
+      std::this_thread::yield();
+    }
+    ++self_runs;
+    executor.cancel(self);
+    return std::chrono::milliseconds(0);
+  }, std::chrono::milliseconds(0));
+  scheduled = true;
+  BOOST_CHECK(wait_for([&self_runs] { return self_runs == 1; }));
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  BOOST_CHECK_EQUAL(self_runs, 1);
+}
+
+BOOST_AUTO_TEST_CASE(background_executor_is_shared) {
+  std::shared_ptr<background_executor> first;
+  std::shared_ptr<background_executor> second;
+  BOOST_CHECK_EQUAL(background_executor::get_shared(2, first, nullptr, nullptr), err::success);
+  BOOST_CHECK_EQUAL(background_executor::get_shared(4, second, nullptr, nullptr), err::success);
+  BOOST_CHECK_EQUAL(first.get(), second.get());
+  BOOST_CHECK_EQUAL(first->thread_count(), 2);
+
+  background_executor empty(0);
+  BOOST_CHECK_EQUAL(empty.init(nullptr), err::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(periodic_background_proc_runs_on_shared_executor) {
+  std::shared_ptr<background_executor> executor;
+  BOOST_CHECK_EQUAL(background_executor::get_shared(1, executor, nullptr, nullptr), err::success);
+
+  utility::watchdog watchdog(nullptr);
+  watchdog.set_executor(executor);
+
+  counting_proc first_proc;
+  counting_proc second_proc;
+  {
+    periodic_background_proc<counting_proc> first(10, watchdog, "first");
+    periodic_background_proc<counting_proc> second(60 * 1000, watchdog, "second");
+    BOOST_CHECK_EQUAL(first.init(&first_proc), err::success);
+    BOOST_CHECK_EQUAL(second.init(&second_proc), err::success);
+
+    BOOST_CHECK(wait_for([&first_proc] { return first_proc.runs() >= 3; }));
+    BOOST_CHECK(wait_for([&second_proc] { return second_proc.runs() == 1; }));
+    second.wake();
+    BOOST_CHECK(wait_for([&second_proc] { return second_proc.runs() == 2; }));
+  }
+
+  // Both procs ran on the single worker, and stopped with their owner
+  const auto runs = first_proc.runs();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  BOOST_CHECK_EQUAL(first_proc.runs(), runs);
+  BOOST_CHECK(first_proc.threads() == second_proc.threads());
+  BOOST_CHECK_EQUAL(first_proc.threads().size(), 1);
+  BOOST_CHECK(first_proc.threads().count(std::this_thread::get_id()) == 0);
+  BOOST_CHECK_EQUAL(watchdog.has_background_error_been_reported(), false);
+}
@@ -0,0 +1,203 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include "utility/config_snapshot.h"
+#include "api_status.h"
+#include "constants.h"
+#include "err_constants.h"
+#include "trace_logger.h"
+
+#include <cstring>
+
+namespace r = reinforcement_learning;
+namespace u = reinforcement_learning::utility;
+namespace err = reinforcement_learning::error_code;
+
+using u::config_key;
+using u::config_section;
+
+namespace {
+  void check_same_settings(const u::async_batcher_config& actual, const u::async_batcher_config& expected) {
+    BOOST_CHECK_EQUAL(actual.send_high_water_mark, expected.send_high_water_mark);
+    BOOST_CHECK_EQUAL(actual.send_batch_interval_ms, expected.send_batch_interval_ms);
+    BOOST_CHECK_EQUAL(actual.flush_on_high_water_mark, expected.flush_on_high_water_mark);
+    BOOST_CHECK_EQUAL(actual.send_queue_max_capacity, expected.send_queue_max_capacity);
+    BOOST_CHECK(actual.queue_mode == expected.queue_mode);
+    BOOST_CHECK_EQUAL(actual.queue_block_timeout_ms, expected.queue_block_timeout_ms);
+    BOOST_CHECK_EQUAL(actual.adaptive_low_water_mark, expected.adaptive_low_water_mark);
+    BOOST_CHECK_EQUAL(actual.adaptive_min_pass_prob, expected.adaptive_min_pass_prob);
+    BOOST_CHECK_EQUAL(actual.buffer_pool_max_kb, expected.buffer_pool_max_kb);
+    BOOST_CHECK_EQUAL(std::strcmp(actual.batch_content_encoding, expected.batch_content_encoding), 0);
+  }
+
+  struct warning_counter : r::i_trace {
+    int count = 0;
+    void log(int log_level, const std::string&) override {
+      if (log_level == r::LEVEL_WARN) ++count;
+    }
+  };
+}
+
+BOOST_AUTO_TEST_CASE(config_snapshot_defaults) {
+  u::config_snapshot snapshot;
+  BOOST_REQUIRE_EQUAL(snapshot.resolve(u::configuration(), nullptr, nullptr), err::success);
+
+  BOOST_CHECK_CLOSE(snapshot.get_float(config_key::INITIAL_EPSILON), 0.2f, 0.0001f);
+  BOOST_CHECK_EQUAL(snapshot.get_int(config_key::SEND_BATCH_INTERVAL_MS, config_section::INTERACTION), 1000);
+  BOOST_CHECK_EQUAL(snapshot.get_int(config_key::QUEUE_BLOCK_TIMEOUT_MS, config_section::OBSERVATION), -1);
+  BOOST_CHECK_EQUAL(snapshot.get_bool(config_key::USE_DEDUP, config_section::INTERACTION), false);
+  BOOST_CHECK(snapshot.get_queue_mode(config_section::INTERACTION) == r::queue_mode_enum::DROP);
+  BOOST_CHECK(!snapshot.is_set(config_key::QUEUE_BLOCK_TIMEOUT_MS, config_section::INTERACTION));
+}
+
+BOOST_AUTO_TEST_CASE(config_snapshot_section_overrides_global) {
+  u::configuration config;
+  config.set(r::name::INITIAL_EPSILON, "0.5");
+  config.set(r::name::SEND_BATCH_INTERVAL_MS, "200");
+  config.set(r::name::OBSERVATION_SEND_BATCH_INTERVAL_MS, "300");
+  config.set(r::name::INTERACTION_QUEUE_MODE, " adaptive ");
+  config.set(r::name::INTERACTION_USE_DEDUP, "True");
+
+  u::config_snapshot snapshot;
+  BOOST_REQUIRE_EQUAL(snapshot.resolve(config, nullptr, nullptr), err::success);
+
+  BOOST_CHECK_CLOSE(snapshot.get_float(config_key::INITIAL_EPSILON, config_section::OBSERVATION), 0.5f, 0.0001f);
+  BOOST_CHECK_EQUAL(snapshot.get_int(config_key::SEND_BATCH_INTERVAL_MS), 200);
+  BOOST_CHECK_EQUAL(snapshot.get_int(config_key::SEND_BATCH_INTERVAL_MS, config_section::INTERACTION), 200);
+  BOOST_CHECK_EQUAL(snapshot.get_int(config_key::SEND_BATCH_INTERVAL_MS, config_section::OBSERVATION), 300);
+  BOOST_CHECK(snapshot.get_queue_mode(config_section::INTERACTION) == r::queue_mode_enum::ADAPTIVE);
+  BOOST_CHECK(snapshot.get_queue_mode(config_section::OBSERVATION) == r::queue_mode_enum::DROP);
+  BOOST_CHECK_EQUAL(snapshot.get_bool(config_key::USE_DEDUP, config_section::INTERACTION), true);
+  BOOST_CHECK_EQUAL(snapshot.get_bool(config_key::USE_DEDUP, config_section::OBSERVATION), false);
+}
+
+BOOST_AUTO_TEST_CASE(config_snapshot_batcher_config_matches_configuration) {
+  u::configuration config;
+  config.set(r::name::SEND_HIGH_WATER_MARK, "1024");
+  config.set(r::name::INTERACTION_SEND_QUEUE_MAX_CAPACITY_KB, "64");
+  config.set(r::name::OBSERVATION_QUEUE_MODE, " adaptive ");
+  config.set(r::name::QUEUE_ADAPTIVE_MIN_PASS_PROB, "0.25");
+  config.set("observation.send.use_dedup", "true");
+
+  u::config_snapshot snapshot;
+  BOOST_REQUIRE_EQUAL(snapshot.resolve(config, nullptr, nullptr), err::success);
+
+  for (const auto section : { r::INTERACTION_SECTION, r::OBSERVATION_SECTION }) {
+    const auto expected = u::get_batcher_config(config, section);
+    const auto resolved = u::get_batcher_config(snapshot, section);
+    check_same_settings(resolved, expected);
+    BOOST_CHECK(resolved.snapshot == &snapshot);
+  }
+  BOOST_CHECK(u::get_batcher_config(config, r::OBSERVATION_SECTION).queue_mode == r::queue_mode_enum::ADAPTIVE);
+}
+
+BOOST_AUTO_TEST_CASE(config_snapshot_batcher_config_defaults) {
+  u::config_snapshot snapshot;
+  BOOST_REQUIRE_EQUAL(snapshot.resolve(u::configuration(), nullptr, nullptr), err::success);
+
+  const u::async_batcher_config constructed;
+  for (const auto section : { r::INTERACTION_SECTION, r::OBSERVATION_SECTION }) {
+    check_same_settings(u::get_batcher_config(u::configuration(), section), constructed);
+    check_same_settings(u::get_batcher_config(snapshot, section), constructed);
+  }
+  BOOST_CHECK_EQUAL(constructed.buffer_pool_max_kb, r::value::DEFAULT_SEND_BUFFER_POOL_MAX_KB);
+}
+
+BOOST_AUTO_TEST_CASE(config_snapshot_negative_buffer_pool_keeps_no_buffers) {
+  u::configuration config;
+  config.set(r::name::SEND_BUFFER_POOL_MAX_KB, "-1");
+  u::config_snapshot snapshot;
+  BOOST_REQUIRE_EQUAL(snapshot.resolve(config, nullptr, nullptr), err::success);
+
+  // Read as a size, -1 would lift the limit
+  BOOST_CHECK_EQUAL(u::get_batcher_config(config, r::INTERACTION_SECTION).buffer_pool_max_kb, 0);
+  BOOST_CHECK_EQUAL(u::get_batcher_config(snapshot, r::INTERACTION_SECTION).buffer_pool_max_kb, 0);
+}
+
+BOOST_AUTO_TEST_CASE(config_snapshot_reads_legacy_values_like_configuration) {
+  u::configuration config;
+  config.set(r::name::SEND_BATCH_INTERVAL_MS, "100ms");
+  config.set(r::name::INTERACTION_SEND_HIGH_WATER_MARK, " 2048 messages");
+  config.set(r::name::INITIAL_EPSILON, "0.3 or so");
+  config.set(r::name::QUEUE_ADAPTIVE_MIN_PASS_PROB, "a lot");
+  config.set("observation.send.use_dedup", "yes");
+  config.set(r::name::OBSERVATION_QUEUE_MODE, "FAST");
+
+  warning_counter warnings;
+  u::config_snapshot snapshot;
+  BOOST_REQUIRE_EQUAL(snapshot.resolve(config, &warnings, nullptr), err::success);
+  BOOST_CHECK_EQUAL(warnings.count, 6);
+
+  for (const auto section : { r::INTERACTION_SECTION, r::OBSERVATION_SECTION }) {
+    check_same_settings(u::get_batcher_config(snapshot, section), u::get_batcher_config(config, section));
+  }
+  BOOST_CHECK_EQUAL(snapshot.get_int(config_key::SEND_BATCH_INTERVAL_MS), 100);
+  BOOST_CHECK_EQUAL(snapshot.get_int(config_key::SEND_HIGH_WATER_MARK, config_section::INTERACTION), 2048);
+  BOOST_CHECK_CLOSE(snapshot.get_float(config_key::INITIAL_EPSILON), 0.3f, 0.0001f);
+  BOOST_CHECK_EQUAL(snapshot.get_bool(config_key::USE_DEDUP, config_section::OBSERVATION),
+    config.get_bool(r::OBSERVATION_SECTION, r::name::USE_DEDUP, r::value::DEFAULT_USE_DEDUP));
+}
+
+BOOST_AUTO_TEST_CASE(config_snapshot_reload_rejects_invalid_values) {
+  const char* const invalid[][2] = {
+    { r::name::SEND_BATCH_INTERVAL_MS, "100ms" },
+    { r::name::INTERACTION_SEND_BATCH_INTERVAL_MS, "99999999999" },
+    { r::name::INITIAL_EPSILON, "a lot" },
+    { r::name::QUEUE_MODE, "FAST" },
+  };
+  for (const auto& setting : invalid) {
+    u::config_snapshot snapshot;
+    BOOST_REQUIRE_EQUAL(snapshot.resolve(u::configuration(), nullptr, nullptr), err::success);
+
+    u::configuration changes;
+    changes.set(setting[0], setting[1]);
+    r::api_status status;
+    BOOST_CHECK_EQUAL(snapshot.reload(changes, nullptr, &status), err::invalid_configuration);
+    BOOST_CHECK(std::strstr(status.get_error_msg(), setting[0]) != nullptr);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(config_snapshot_reload) {
+  u::configuration config;
+  config.set(r::name::OBSERVATION_SEND_BATCH_INTERVAL_MS, "300");
+  u::config_snapshot snapshot;
+  BOOST_REQUIRE_EQUAL(snapshot.resolve(config, nullptr, nullptr), err::success);
+  const auto version = snapshot.version();
+
+  u::configuration changes;
+  changes.set(r::name::INITIAL_EPSILON, "0.05");
+  changes.set(r::name::SEND_BATCH_INTERVAL_MS, "50");
+  changes.set(r::name::INTERACTION_QUEUE_MODE, "BLOCK");
+  BOOST_CHECK_EQUAL(snapshot.reload(changes, nullptr, nullptr), err::success);
+  BOOST_CHECK_NE(snapshot.version(), version);
+
+  BOOST_CHECK_CLOSE(snapshot.get_float(config_key::INITIAL_EPSILON), 0.05f, 0.0001f);
+  BOOST_CHECK_EQUAL(snapshot.get_int(config_key::SEND_BATCH_INTERVAL_MS, config_section::INTERACTION), 50);
+  // The value set for the section still overrides the global one
+  BOOST_CHECK_EQUAL(snapshot.get_int(config_key::SEND_BATCH_INTERVAL_MS, config_section::OBSERVATION), 300);
+  BOOST_CHECK(snapshot.get_queue_mode(config_section::INTERACTION) == r::queue_mode_enum::BLOCK);
+  BOOST_CHECK(snapshot.get_queue_mode(config_section::OBSERVATION) == r::queue_mode_enum::DROP);
+}
+
+BOOST_AUTO_TEST_CASE(config_snapshot_reload_changes_nothing_on_error) {
+  u::config_snapshot snapshot;
+  BOOST_REQUIRE_EQUAL(snapshot.resolve(u::configuration(), nullptr, nullptr), err::success);
+  const auto version = snapshot.version();
+
+  u::configuration not_reloadable;
+  not_reloadable.set(r::name::INITIAL_EPSILON, "0.05");
+  not_reloadable.set(r::name::INTERACTION_SEND_QUEUE_MAX_CAPACITY_KB, "1");
+  BOOST_CHECK_EQUAL(snapshot.reload(not_reloadable, nullptr, nullptr), err::configuration_not_reloadable);
+
+  u::configuration invalid;
+  invalid.set(r::name::INITIAL_EPSILON, "0.05");
+  invalid.set(r::name::QUEUE_MODE, "FAST");
+  BOOST_CHECK_EQUAL(snapshot.reload(invalid, nullptr, nullptr), err::invalid_configuration);
+
+  BOOST_CHECK_EQUAL(snapshot.version(), version);
+  BOOST_CHECK_CLOSE(snapshot.get_float(config_key::INITIAL_EPSILON), 0.2f, 0.0001f);
+}
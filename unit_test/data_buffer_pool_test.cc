@@ -0,0 +1,94 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include "utility/data_buffer_pool.h"
+
+#include <memory>
+
+using namespace reinforcement_learning::utility;
+
+BOOST_AUTO_TEST_CASE(data_buffer_pool_keeps_capacity) {
+  data_buffer_pool pool(1000, 1024 * 1024);
+
+  auto buffer = pool.acquire();
+  // Rounded up to the size class
+  BOOST_CHECK_EQUAL(buffer->body_capacity(), 1024);
+  buffer->resize_body_region(5000);
+  buffer->set_body_endoffset(buffer->preamble_size() + 10);
+  const auto raw = buffer->raw_begin();
+  buffer.reset();
+
+  data_buffer_pool_stats stats;
+  pool.get_stats(stats);
+  BOOST_CHECK_EQUAL(stats.pooled_buffers, 1);
+  BOOST_CHECK_EQUAL(stats.pooled_bytes, 5000);
+
+  buffer = pool.acquire();
+  BOOST_CHECK_EQUAL(buffer->raw_begin(), raw);
+  BOOST_CHECK_EQUAL(buffer->body_capacity(), 5000);
+  BOOST_CHECK_EQUAL(buffer->body_filled_size(), 0);
+
+  pool.get_stats(stats);
+  BOOST_CHECK_EQUAL(stats.allocated, 1);
+  BOOST_CHECK_EQUAL(stats.reused, 1);
+  BOOST_CHECK_EQUAL(stats.pooled_buffers, 0);
+  BOOST_CHECK_EQUAL(stats.pooled_bytes, 0);
+}
+
+BOOST_AUTO_TEST_CASE(data_buffer_pool_size_classes) {
+  data_buffer_pool pool(100, 1024 * 1024);
+
+  auto small = pool.acquire();
+  auto large = pool.acquire(10000);
+  BOOST_CHECK_EQUAL(small->body_capacity(), 128);
+  BOOST_CHECK_EQUAL(large->body_capacity(), 16384);
+  const auto small_raw = small->raw_begin();
+  const auto large_raw = large->raw_begin();
+  small.reset();
+  large.reset();
+
+  // Too small buffers are not handed out, the smallest which fits is
+  auto buffer = pool.acquire(5000);
+  BOOST_CHECK_EQUAL(buffer->raw_begin(), large_raw);
+  auto other = pool.acquire(5000);
+  BOOST_CHECK(other->raw_begin() != small_raw);
+  BOOST_CHECK_EQUAL(other->body_capacity(), 8192);
+  auto last = pool.acquire(64);
+  BOOST_CHECK_EQUAL(last->raw_begin(), small_raw);
+
+  data_buffer_pool_stats stats;
+  pool.get_stats(stats);
+  BOOST_CHECK_EQUAL(stats.allocated, 3);
+  BOOST_CHECK_EQUAL(stats.reused, 2);
+}
+
+BOOST_AUTO_TEST_CASE(data_buffer_pool_caps_pooled_memory) {
+  data_buffer_pool pool(4096, 10000);
+
+  auto first = pool.acquire();
+  auto second = pool.acquire();
+  auto third = pool.acquire();
+  first.reset();
+  second.reset();
+  third.reset();
+
+  data_buffer_pool_stats stats;
+  pool.get_stats(stats);
+  BOOST_CHECK_EQUAL(stats.pooled_buffers, 2);
+  BOOST_CHECK_EQUAL(stats.pooled_bytes, 8192);
+  BOOST_CHECK_EQUAL(stats.discarded, 1);
+}
+
+BOOST_AUTO_TEST_CASE(data_buffer_outlives_pool) {
+  std::shared_ptr<data_buffer> buffer;
+  {
+    data_buffer_pool pool(1024, 1024 * 1024);
+    buffer = pool.acquire();
+  }
+  BOOST_CHECK_EQUAL(buffer->body_capacity(), 1024);
+  buffer.reset();
+}
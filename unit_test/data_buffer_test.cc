@@ -118,4 +118,41 @@ BOOST_AUTO_TEST_CASE(data_buffer_back_fill) {
   BOOST_CHECK_EQUAL(db.get_body_endoffset(), 18);
   BOOST_CHECK_EQUAL(db.raw_begin() + 6, db.preamble_begin());
   BOOST_CHECK_EQUAL(db.raw_begin() + 14, db.body_begin());
-}
\ No newline at end of file
+}
+
+BOOST_AUTO_TEST_CASE(data_buffer_reset_keeps_capacity) {
+  data_buffer db(10);
+  db.resize_body_region(5000);
+  db.set_body_endoffset(db.preamble_size() + 100);
+  db.reset();
+  BOOST_CHECK_EQUAL(db.body_capacity(), 5000);
+  BOOST_CHECK_EQUAL(db.body_filled_size(), 0);
+  BOOST_CHECK_EQUAL(db.get_body_beginoffset(), 8);
+}
+
+BOOST_AUTO_TEST_CASE(large_output_to_data_buffer) {
+  data_buffer buffer;
+  string expected;
+  {
+    data_buffer_streambuf sbuff(&buffer);
+    ostream out(&sbuff);
+    for (int i = 0; i < 10000; ++i) {
+      out << i << ',';
+      expected += to_string(i) + ',';
+    }
+  }
+  BOOST_CHECK_EQUAL(buffer.body_filled_size(), expected.size());
+  const string body(reinterpret_cast<char *>(buffer.body_begin()));
+  BOOST_CHECK_EQUAL(body, expected);
+  // Grown by doubling from the initial size
+  BOOST_CHECK_EQUAL(buffer.body_capacity(), 65536);
+
+  // A reused buffer keeps its capacity
+  buffer.reset();
+  data_buffer_streambuf sbuff(&buffer);
+  ostream out(&sbuff);
+  out << "test";
+  sbuff.finalize();
+  BOOST_CHECK_EQUAL(string(reinterpret_cast<char *>(buffer.body_begin())), "test");
+  BOOST_CHECK_EQUAL(buffer.body_capacity(), 65536);
+}
@@ -0,0 +1,104 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <boost/uuid/string_generator.hpp>
+#include <boost/uuid/uuid.hpp>
+
+#include "utility/event_id_generator.h"
+
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace reinforcement_learning::utility;
+
+BOOST_AUTO_TEST_CASE(generated_uuid_is_version_4) {
+  char buffer[UUID_STRING_LENGTH + 1];
+  generate_uuid(buffer);
+  BOOST_REQUIRE_EQUAL(std::strlen(buffer), UUID_STRING_LENGTH);
+
+  const auto uuid = boost::uuids::string_generator()(buffer);
+  BOOST_CHECK(uuid.version() == boost::uuids::uuid::version_random_number_based);
+  BOOST_CHECK(uuid.variant() == boost::uuids::uuid::variant_rfc_4122);
+
+  // Formatted like boost::uuids::to_string
+  for (size_t i = 0; i < UUID_STRING_LENGTH; ++i) {
+    if (i == 8 || i == 13 || i == 18 || i == 23) {
+      BOOST_CHECK_EQUAL(buffer[i], '-');
+    }
+    else {
+      BOOST_CHECK(std::strchr("0123456789abcdef", buffer[i]) != nullptr);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(generated_uuids_are_unique_across_threads) {
+  const size_t THREADS = 4;
+  const size_t IDS_PER_THREAD = 10000;
+
+  std::mutex m;
+  std::set<std::string> ids;
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < THREADS; ++t) {
+    threads.emplace_back([&] {
+      std::vector<std::string> local;
+      for (size_t i = 0; i < IDS_PER_THREAD; ++i) {
+        local.push_back(generate_uuid());
+      }
+      std::lock_guard<std::mutex> lock(m);
+      ids.insert(local.begin(), local.end());
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  BOOST_CHECK_EQUAL(ids.size(), THREADS * IDS_PER_THREAD);
+}
+
+#ifndef _WIN32
+BOOST_AUTO_TEST_CASE(forked_child_does_not_repeat_parent_uuids) {
+  // The generator of this thread exists before the fork, its state is copied into the child
+  generate_uuid();
+
+  int fds[2];
+  BOOST_REQUIRE_EQUAL(pipe(fds), 0);
+  const pid_t pid = fork();
+  BOOST_REQUIRE(pid >= 0);
+  if (pid == 0) {
+    char child_uuid[UUID_STRING_LENGTH + 1];
+    generate_uuid(child_uuid);
+    const auto written = write(fds[1], child_uuid, UUID_STRING_LENGTH);
+    _exit(written == static_cast<ssize_t>(UUID_STRING_LENGTH) ? 0 : 1);
+  }
+  close(fds[1]);
+
+  const auto parent_uuid = generate_uuid();
+  char child_uuid[UUID_STRING_LENGTH];
+  size_t read_size = 0;
+  while (read_size < UUID_STRING_LENGTH) {
+    const auto n = read(fds[0], child_uuid + read_size, UUID_STRING_LENGTH - read_size);
+    if (n <= 0) {
+      break;
+    }
+    read_size += static_cast<size_t>(n);
+  }
+  close(fds[0]);
+
+  int child_status = 0;
+  BOOST_REQUIRE_EQUAL(waitpid(pid, &child_status, 0), pid);
+  BOOST_CHECK(WIFEXITED(child_status) && WEXITSTATUS(child_status) == 0);
+  BOOST_REQUIRE_EQUAL(read_size, UUID_STRING_LENGTH);
+  BOOST_CHECK_NE(std::string(child_uuid, UUID_STRING_LENGTH), parent_uuid);
+}
+#endif
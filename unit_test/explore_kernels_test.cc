@@ -0,0 +1,148 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+
+#include "explore_kernels.h"
+#include "explore.h"
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace reinforcement_learning;
+using namespace std;
+
+namespace {
+  const size_t sizes[] = { 1, 2, 3, 7, 8, 9, 63, 64, 65, 100, 129, 1000, 4099, 10000 };
+
+  // Mostly positive values with some negatives and zeros, which sampling clamps
+  vector<float> random_pdf(size_t size, std::mt19937& gen) {
+    std::uniform_real_distribution<float> value(-0.25f, 1.f);
+    std::uniform_int_distribution<int> kind(0, 9);
+    vector<float> pdf(size);
+    for (auto& p : pdf) {
+      const auto k = kind(gen);
+      p = k == 0 ? 0.f : value(gen);
+    }
+    return pdf;
+  }
+
+  bool same_bits(const vector<float>& a, const vector<float>& b) {
+    return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+  }
+
+  void check_sampling(uint64_t seed, const vector<float>& input) {
+    auto expected = input;
+    uint32_t expected_index = 0;
+    const auto expected_code = exploration::sample_after_normalizing(seed, begin(expected), end(expected), expected_index);
+
+    auto actual = input;
+    uint32_t actual_index = 0;
+    BOOST_CHECK_EQUAL(explore_kernels::sample_after_normalizing(seed, actual.data(), actual.data() + actual.size(), actual_index), expected_code);
+    BOOST_CHECK_EQUAL(actual_index, expected_index);
+    BOOST_CHECK(same_bits(actual, expected));
+
+    auto scalar = input;
+    uint32_t scalar_index = 0;
+    BOOST_CHECK_EQUAL(explore_kernels::scalar::sample_after_normalizing(seed, scalar.data(), scalar.data() + scalar.size(), scalar_index), expected_code);
+    BOOST_CHECK_EQUAL(scalar_index, expected_index);
+    BOOST_CHECK(same_bits(scalar, expected));
+  }
+
+  vector<uint32_t> reference_top_k(const vector<float>& pdf, size_t k) {
+    vector<uint32_t> indices(pdf.size());
+    for (size_t i = 0; i < indices.size(); ++i) indices[i] = static_cast<uint32_t>(i);
+    const auto key = [](float p) { return std::isnan(p) ? -std::numeric_limits<float>::infinity() : p; };
+    std::stable_sort(indices.begin(), indices.end(), [&](uint32_t a, uint32_t b) { return key(pdf[a]) > key(pdf[b]); });
+    indices.resize(std::min(k, pdf.size()));
+    return indices;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(explore_kernels_epsilon_greedy_matches_reference) {
+  const float epsilons[] = { 0.f, 0.2f, 0.5f, 1.f };
+  for (const auto size : sizes) {
+    for (const auto epsilon : epsilons) {
+      for (const uint32_t top_action : { 0u, 5u, static_cast<uint32_t>(size) }) {
+        vector<float> expected(size);
+        BOOST_CHECK_EQUAL(exploration::generate_epsilon_greedy(epsilon, top_action, begin(expected), end(expected)), S_EXPLORATION_OK);
+
+        vector<float> actual(size);
+        BOOST_CHECK_EQUAL(explore_kernels::generate_epsilon_greedy(epsilon, top_action, actual.data(), actual.data() + size), S_EXPLORATION_OK);
+        BOOST_CHECK(same_bits(actual, expected));
+
+        vector<float> scalar(size);
+        BOOST_CHECK_EQUAL(explore_kernels::scalar::generate_epsilon_greedy(epsilon, top_action, scalar.data(), scalar.data() + size), S_EXPLORATION_OK);
+        BOOST_CHECK(same_bits(scalar, expected));
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(explore_kernels_sampling_matches_reference) {
+  std::mt19937 gen(42);
+  for (const auto size : sizes) {
+    for (uint64_t seed = 0; seed < 50; ++seed) {
+      check_sampling(seed * 7919 + size, random_pdf(size, gen));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(explore_kernels_sampling_edge_cases) {
+  // All zero or negative pdfs pick the first action
+  check_sampling(17, vector<float>(100, 0.f));
+  check_sampling(17, vector<float>(100, -1.f));
+
+  // Mass concentrated at either end
+  vector<float> last(1000, 0.f);
+  last.back() = 1.f;
+  check_sampling(3, last);
+  vector<float> first(1000, 0.f);
+  first.front() = 1.f;
+  check_sampling(3, first);
+
+  // Negative zero is kept as is
+  vector<float> signed_zero(70, 0.5f);
+  signed_zero[66] = -0.f;
+  check_sampling(5, signed_zero);
+}
+
+BOOST_AUTO_TEST_CASE(explore_kernels_empty_range) {
+  float pdf[1] = { 1.f };
+  uint32_t chosen_index = 0;
+  BOOST_CHECK_EQUAL(explore_kernels::generate_epsilon_greedy(0.2f, 0, pdf, pdf), E_EXPLORATION_BAD_RANGE);
+  BOOST_CHECK_EQUAL(explore_kernels::sample_after_normalizing(1, pdf, pdf, chosen_index), E_EXPLORATION_BAD_RANGE);
+  uint32_t indices[1];
+  BOOST_CHECK_EQUAL(explore_kernels::top_k(pdf, pdf, 1, indices), S_EXPLORATION_OK);
+}
+
+BOOST_AUTO_TEST_CASE(explore_kernels_top_k) {
+  std::mt19937 gen(7);
+  std::uniform_int_distribution<int> bucket(0, 20);
+  for (const auto size : sizes) {
+    // Few distinct values so that ties are common
+    vector<float> pdf(size);
+    for (auto& p : pdf) p = static_cast<float>(bucket(gen)) / 20.f;
+    if (size > 3) pdf[size / 2] = std::numeric_limits<float>::quiet_NaN();
+
+    for (const size_t k : { size_t(1), size_t(3), size_t(10), size }) {
+      const auto expected = reference_top_k(pdf, k);
+      vector<uint32_t> actual(expected.size());
+      BOOST_CHECK_EQUAL(explore_kernels::top_k(pdf.data(), pdf.data() + size, k, actual.data()), S_EXPLORATION_OK);
+      BOOST_CHECK(actual == expected);
+
+      vector<uint32_t> scalar(expected.size());
+      BOOST_CHECK_EQUAL(explore_kernels::scalar::top_k(pdf.data(), pdf.data() + size, k, scalar.data()), S_EXPLORATION_OK);
+      BOOST_CHECK(scalar == expected);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(explore_kernels_simd_level) {
+  const string level = explore_kernels::simd_level();
+  BOOST_CHECK(level == "avx2" || level == "neon" || level == "scalar");
+}
@@ -0,0 +1,119 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include "test_helpers.h"
+
+#include "identity_model.h"
+#include "onnx_batch_scheduler.h"
+
+#include <atomic>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <thread>
+
+namespace
+{
+  std::shared_ptr<Ort::Session> load_identity_session(Ort::Env& env)
+  {
+    Ort::SessionOptions options;
+    return std::make_shared<Ort::Session>(env, IdentityModel, sizeof(IdentityModel), options);
+  }
+
+  std::string identity_notation(int64_t rows, float first_value)
+  {
+    tensor_raw values(static_cast<size_t>(rows) * 3);
+    for (size_t i = 0; i < values.size(); i++)
+    {
+      values[i] = first_value + i;
+    }
+
+    expectations<std::string> inputs{ expectation_t<std::string>{"X", dimensions{rows, 3}, values} };
+    return create_tensor_notation(inputs);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(batching_requires_dynamic_first_dimension)
+{
+  Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "batch_scheduler_test");
+  BOOST_REQUIRE(o::onnx_batch_scheduler::supports_batching(*load_identity_session(env), "Y"));
+  BOOST_REQUIRE(!o::onnx_batch_scheduler::supports_batching(*load_identity_session(env), "Z"));
+
+  std::ifstream file("./mnist_data/mnist_model.onnx", std::ios::binary);
+  std::vector<char> model_data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  Ort::SessionOptions options;
+  Ort::Session mnist_session(env, model_data.data(), model_data.size(), options);
+
+  // The MNIST model has a fixed batch size of 1
+  BOOST_REQUIRE(!o::onnx_batch_scheduler::supports_batching(mnist_session, "Plus214_Output_0"));
+}
+
+BOOST_AUTO_TEST_CASE(batched_requests_receive_their_own_rows)
+{
+  Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "batch_scheduler_test");
+  o::onnx_batch_scheduler scheduler(load_identity_session(env), "Y", 8, std::chrono::microseconds(2000), nullptr);
+
+  std::atomic<int> failures{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; t++)
+  {
+    threads.emplace_back([&scheduler, &failures, t]
+    {
+      for (int i = 0; i < 50; i++)
+      {
+        // Mix requests of one and two rows in the same batches
+        const int64_t rows = 1 + (t % 2);
+        const float first_value = static_cast<float>(t * 1000 + i);
+        const std::string notation = identity_notation(rows, first_value);
+
+        r::ranking_buffer ranking;
+        r::api_status status;
+        if (scheduler.score(notation.c_str(), ranking, &status) != r::error_code::success ||
+            ranking.size() != static_cast<size_t>(rows) * 3)
+        {
+          failures++;
+          continue;
+        }
+
+        for (size_t k = 0; k < ranking.size(); k++)
+        {
+          if (ranking.action_ids(0)[k] != k || ranking.probabilities(0)[k] != first_value + k)
+          {
+            failures++;
+            break;
+          }
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  BOOST_REQUIRE_EQUAL(failures.load(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(batched_request_validation)
+{
+  Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "batch_scheduler_test");
+  o::onnx_batch_scheduler scheduler(load_identity_session(env), "Y", 4, std::chrono::microseconds(100), nullptr);
+
+  r::ranking_buffer ranking;
+  r::api_status status;
+
+  scheduler.score("{}", ranking, &status);
+  require_status(status, r::error_code::extension_error);
+
+  std::string unknown = identity_notation(1, 0.f);
+  unknown.replace(unknown.find("\"X\""), 3, "\"Z\"");
+  scheduler.score(unknown.c_str(), ranking, &status);
+  require_status(status, r::error_code::extension_error);
+
+  scheduler.score(identity_notation(1, 0.f).c_str(), ranking, &status);
+  require_success(status);
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+// ONNX model with a single Identity node from input X to output Y, both float tensors of shape [N, 3]
+static const unsigned char IdentityModel[] = {
+  0x08, 0x06, 0x42, 0x04, 0x0a, 0x00, 0x10, 0x0b, 0x3a, 0x48, 0x0a, 0x10, 0x0a, 0x01, 0x58, 0x12,
+  0x01, 0x59, 0x22, 0x08, 0x49, 0x64, 0x65, 0x6e, 0x74, 0x69, 0x74, 0x79, 0x12, 0x08, 0x69, 0x64,
+  0x65, 0x6e, 0x74, 0x69, 0x74, 0x79, 0x5a, 0x14, 0x0a, 0x01, 0x58, 0x12, 0x0f, 0x0a, 0x0d, 0x08,
+  0x01, 0x12, 0x09, 0x0a, 0x03, 0x12, 0x01, 0x4e, 0x0a, 0x02, 0x08, 0x03, 0x62, 0x14, 0x0a, 0x01,
+  0x59, 0x12, 0x0f, 0x0a, 0x0d, 0x08, 0x01, 0x12, 0x09, 0x0a, 0x03, 0x12, 0x01, 0x4e, 0x0a, 0x02,
+  0x08, 0x03,
+};
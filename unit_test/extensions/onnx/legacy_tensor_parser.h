@@ -0,0 +1,345 @@
+#pragma once
+
+#include "onnx_input.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// The tensor notation parser as it was before the base64 runs were scanned and decoded with vector instructions,
+// kept as the oracle of tensor_parser_fuzz_test. It consumes one character at a time through the same frames and
+// base64 state machine; only the error messages were dropped.
+namespace legacy_tensor_parser
+{
+  namespace o = reinforcement_learning::onnx;
+
+  using parsed_input = std::pair<std::string, o::tensor_data_t>;
+
+  enum CONSUME_TYPE : bool { EXCLUSIVE = false, INCLUSIVE = true };
+  enum KNOWN_CHARS : char { END = '\0', DOUBLE_QUOTE = '\"', SEMICOLON = ';', COMMA = ',', OPEN_BRACE = '{', CLOSE_BRACE = '}', OPEN_BRACKET = '[', CLOSE_BRACKET = ']', BACKSLASH = '\\', COLON = ':' };
+
+  struct parse_result
+  {
+    bool accepted = false;
+    // The old parser ignored what followed a '=' in the last group ("AQ=D"), which the current one rejects
+    bool data_after_padding = false;
+    std::vector<parsed_input> inputs;
+  };
+
+  namespace primitives
+  {
+    template <typename parse_context_t, const char ch>
+    struct until
+    {
+      inline static bool invoke(const char c, parse_context_t&)
+      {
+        return (ch == c);
+      }
+    };
+
+    template <typename parse_context_t>
+    struct routing_action
+    {
+      inline static bool invoke(const char c, parse_context_t& context)
+      {
+        return context.invoke(c);
+      }
+
+      inline static bool end(parse_context_t& context)
+      {
+        return context.end();
+      }
+    };
+
+    template <bool inclusive, typename until_t, typename parse_context_t>
+    inline bool consume(const char*& reading_head, parse_context_t& context)
+    {
+      while (reading_head != nullptr && *reading_head != END)
+      {
+        const char& curr_c = *reading_head;
+        if (until_t::invoke(curr_c, context))
+        {
+          if (inclusive) reading_head++;
+
+          return routing_action<parse_context_t>::end(context);
+        }
+
+        if (!routing_action<parse_context_t>::invoke(curr_c, context))
+        {
+          return false;
+        }
+
+        reading_head++;
+      }
+
+      return false;
+    }
+
+    template <char ch>
+    inline bool consume_exact(const char*& reading_head)
+    {
+      if (reading_head == nullptr || *reading_head != ch)
+      {
+        return false;
+      }
+
+      reading_head++;
+      return true;
+    }
+  }
+
+  namespace base64
+  {
+    struct parse_context
+    {
+    private:
+      size_t _count;
+      uint32_t _running;
+      size_t _padding_count;
+      o::bytes_t& _bytes;
+      bool& _data_after_padding;
+
+    public:
+      inline parse_context(o::bytes_t& target, bool& data_after_padding)
+        : _count(0), _running(0), _padding_count(0), _bytes(target), _data_after_padding(data_after_padding)
+      {
+      }
+
+      inline bool invoke(const char c)
+      {
+        _running = _running << 6;
+        _count++;
+
+        if (_padding_count || c == '=')
+        {
+          if (_padding_count && c != '=')
+          {
+            _data_after_padding = true;
+          }
+          _padding_count++;
+        }
+        else
+        {
+          if (c >= 'A' && c <= 'Z')
+          {
+            _running = _running | (c - 'A' + 0);
+          }
+          else if (c >= 'a' && c <= 'z')
+          {
+            _running = _running | (c - 'a' + 26);
+          }
+          else if (c >= '0' && c <= '9')
+          {
+            _running = _running | (c - '0' + 52);
+          }
+          else if (c == '+')
+          {
+            _running = _running | 62;
+          }
+          else if (c == '/')
+          {
+            _running = _running | 63;
+          }
+          else
+          {
+            return false;
+          }
+
+          if (_count % 4 == 0)
+          {
+            _bytes.push_back((_running >> 16) & 0xFF);
+            _bytes.push_back((_running >> 8) & 0xFF);
+            _bytes.push_back(_running & 0xFF);
+
+            _running = 0;
+          }
+        }
+
+        return true;
+      }
+
+      inline bool end()
+      {
+        if (_count % 4 != 0)
+        {
+          return false;
+        }
+
+        switch (_padding_count)
+        {
+        case 0:
+          break;
+        case 1:
+          _bytes.push_back((_running >> 16) & 0xFF);
+          _bytes.push_back((_running >> 8) & 0xFF);
+          break;
+        case 2:
+          _bytes.push_back((_running >> 16) & 0xFF);
+          break;
+        default:
+          return false;
+        }
+
+        return true;
+      }
+    };
+  }
+
+  struct escaped_string_context
+  {
+    bool _in_escape;
+    std::string& _value;
+
+    escaped_string_context(std::string& target) : _in_escape(false), _value(target)
+    {
+    }
+
+    inline bool invoke(const char c)
+    {
+      if (c != BACKSLASH || _in_escape)
+      {
+        _value.push_back(c);
+        _in_escape = false;
+      }
+      else
+      {
+        _in_escape = true;
+      }
+
+      return true;
+    }
+
+    inline bool end()
+    {
+      return true;
+    }
+  };
+
+  using primitives::consume;
+  using primitives::consume_exact;
+
+  template <char ch, typename parse_context_t>
+  using until = primitives::until<parse_context_t, ch>;
+
+  inline bool parse_tensor_value(const char*& reading_head, o::bytes_t& dims, o::bytes_t& data, bool& data_after_padding)
+  {
+    auto dims_context = base64::parse_context(dims, data_after_padding);
+    auto data_context = base64::parse_context(data, data_after_padding);
+
+    // " <base64 dimensions> ; <base64 data> "
+    return consume_exact<DOUBLE_QUOTE>(reading_head) &&
+      consume<INCLUSIVE, until<SEMICOLON, base64::parse_context>>(reading_head, dims_context) &&
+      consume<INCLUSIVE, until<DOUBLE_QUOTE, base64::parse_context>>(reading_head, data_context);
+  }
+
+  inline bool parse_tensor_name(const char*& reading_head, std::string& name)
+  {
+    auto name_context = escaped_string_context(name);
+
+    // " <escaped_name> " :
+    return
+      consume_exact<DOUBLE_QUOTE>(reading_head) &&
+      consume<INCLUSIVE, until<DOUBLE_QUOTE, escaped_string_context>>(reading_head, name_context) &&
+      consume_exact<COLON>(reading_head);
+  }
+
+  inline bool skip_json_value(const char*& reading_head)
+  {
+    int depth = 0;
+    while (*reading_head != END)
+    {
+      const char c = *reading_head;
+      if (depth == 0 && (c == COMMA || c == CLOSE_BRACE))
+      {
+        return true;
+      }
+
+      if (c == DOUBLE_QUOTE)
+      {
+        for (reading_head++; *reading_head != DOUBLE_QUOTE; reading_head++)
+        {
+          if (*reading_head == END || (*reading_head == BACKSLASH && *++reading_head == END))
+          {
+            return false;
+          }
+        }
+      }
+      else if (c == OPEN_BRACE || c == OPEN_BRACKET)
+      {
+        depth++;
+      }
+      else if (c == CLOSE_BRACE || c == CLOSE_BRACKET)
+      {
+        if (depth == 0)
+        {
+          return false;
+        }
+        depth--;
+      }
+
+      reading_head++;
+    }
+
+    return false;
+  }
+
+  inline bool parse_inputs(const std::string& line, bool& data_after_padding, std::vector<parsed_input>& inputs)
+  {
+    // Treat empty lines as empty examples, similar to VW
+    if (line.empty())
+    {
+      return true;
+    }
+
+    const char* reading_head = line.c_str();
+
+    // '{' <tensor_name_value> [ ',' <tensor_name_value> ]*
+    if (!consume_exact<OPEN_BRACE>(reading_head))
+    {
+      return false;
+    }
+
+    // Empty objects are valid, empty examples (match VWJSON parser behaviour)
+    if (consume_exact<CLOSE_BRACE>(reading_head))
+    {
+      return true;
+    }
+
+    do
+    {
+      std::string name;
+      o::bytes_t tensor_shape_bytes;
+      o::bytes_t tensor_data_bytes;
+
+      if (!parse_tensor_name(reading_head, name))
+      {
+        return false;
+      }
+
+      if (name[0] == '_')
+      {
+        if (!skip_json_value(reading_head))
+        {
+          return false;
+        }
+        continue;
+      }
+
+      if (!parse_tensor_value(reading_head, tensor_shape_bytes, tensor_data_bytes, data_after_padding))
+      {
+        return false;
+      }
+
+      inputs.emplace_back(std::move(name), std::make_pair(std::move(tensor_shape_bytes), std::move(tensor_data_bytes)));
+    } while (consume_exact<COMMA>(reading_head));
+
+    return consume_exact<CLOSE_BRACE>(reading_head);
+  }
+
+  inline parse_result parse(const std::string& line)
+  {
+    parse_result result;
+    result.accepted = parse_inputs(line, result.data_after_padding, result.inputs);
+    return result;
+  }
+}
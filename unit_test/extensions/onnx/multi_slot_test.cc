@@ -0,0 +1,180 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include "test_helpers.h"
+
+#include "identity_model.h"
+#include "onnx_model.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <numeric>
+
+namespace m = reinforcement_learning::model_management;
+
+namespace
+{
+  // The identity model returns its input, so the tensor values are the action scores of each slot
+  std::unique_ptr<o::onnx_model> load_identity_model(m::model_type_t model_type)
+  {
+    std::unique_ptr<o::onnx_model> model(new o::onnx_model(nullptr, "multi_slot_test", "Y", true, true, 0, 0, 1, std::chrono::microseconds(0), model_type, 0, std::chrono::milliseconds(0)));
+
+    m::model_data data;
+    memcpy(data.alloc(sizeof(IdentityModel)), IdentityModel, sizeof(IdentityModel));
+
+    bool model_ready = false;
+    r::api_status status;
+    model->update(data, model_ready, &status);
+    require_success(status);
+    BOOST_REQUIRE(model_ready);
+
+    return model;
+  }
+
+  // One row of three values per slot, preceded by the fields live_model reads to count actions and slots
+  std::string multi_slot_context(const tensor_raw& values)
+  {
+    const int64_t rows = static_cast<int64_t>(values.size() / 3);
+    expectations<std::string> inputs{ expectation_t<std::string>{"X", dimensions{rows, 3}, values} };
+    const std::string notation = create_tensor_notation(inputs);
+    return R"({"_multi":[{"a":1},{"a":2},{"a":3}],"_slots":[{"_id":"s1"},{"_id":"s2"}],)" + notation.substr(1);
+  }
+
+  float sum(const std::vector<float>& values)
+  {
+    return std::accumulate(values.begin(), values.end(), 0.f);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ccb_slots_exclude_chosen_actions)
+{
+  auto model = load_identity_model(m::model_type_t::CCB);
+  BOOST_REQUIRE(model->model_type() == m::model_type_t::CCB);
+
+  const std::string context = multi_slot_context({ 0.2f, 0.5f, 0.3f, 0.2f, 0.5f, 0.3f });
+  const std::vector<const char*> event_ids{ "event-1", "event-2" };
+
+  std::vector<std::vector<uint32_t>> actions_ids;
+  std::vector<std::vector<float>> action_pdfs;
+  std::string model_version;
+  r::api_status status;
+  model->request_decision(event_ids, context.c_str(), actions_ids, action_pdfs, model_version, &status);
+  require_success(status);
+
+  BOOST_REQUIRE_EQUAL(actions_ids.size(), 2);
+  BOOST_REQUIRE_EQUAL(actions_ids[0].size(), 3);
+  BOOST_REQUIRE_EQUAL(actions_ids[1].size(), 2);
+  BOOST_REQUIRE(std::find(actions_ids[1].begin(), actions_ids[1].end(), actions_ids[0][0]) == actions_ids[1].end());
+  BOOST_REQUIRE_CLOSE(sum(action_pdfs[0]), 1.f, 0.001f);
+  BOOST_REQUIRE_CLOSE(sum(action_pdfs[1]), 1.f, 0.001f);
+
+  // Sampling is seeded by the event ids
+  std::vector<std::vector<uint32_t>> repeated_ids;
+  std::vector<std::vector<float>> repeated_pdfs;
+  model->request_decision(event_ids, context.c_str(), repeated_ids, repeated_pdfs, model_version, &status);
+  require_success(status);
+  BOOST_REQUIRE(repeated_ids == actions_ids);
+  BOOST_REQUIRE(repeated_pdfs == action_pdfs);
+}
+
+BOOST_AUTO_TEST_CASE(ccb_slots_past_the_action_count_are_empty)
+{
+  auto model = load_identity_model(m::model_type_t::CCB);
+
+  // A single action shared by two slots
+  expectations<std::string> inputs{ expectation_t<std::string>{"X", dimensions{1, 3}, tensor_raw{1.f, 0.f, 0.f}} };
+  const std::string context = create_tensor_notation(inputs);
+  const std::vector<const char*> event_ids{ "a", "b", "c" };
+
+  std::vector<std::vector<uint32_t>> actions_ids;
+  std::vector<std::vector<float>> action_pdfs;
+  std::string model_version;
+  r::api_status status;
+  model->request_decision(event_ids, context.c_str(), actions_ids, action_pdfs, model_version, &status);
+  require_success(status);
+
+  BOOST_REQUIRE_EQUAL(actions_ids.size(), 3);
+  BOOST_REQUIRE_EQUAL(actions_ids[0].size(), 1);
+  BOOST_REQUIRE_EQUAL(actions_ids[1].size(), 0);
+  BOOST_REQUIRE_EQUAL(actions_ids[2].size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(slates_slots_keep_all_actions)
+{
+  auto model = load_identity_model(m::model_type_t::SLATES);
+
+  const std::string context = multi_slot_context({ 0.f, 1.f, 0.f, 0.f, 1.f, 0.f });
+  const std::vector<std::string> slot_ids{ "s1", "s2" };
+
+  std::vector<std::vector<uint32_t>> actions_ids;
+  std::vector<std::vector<float>> action_pdfs;
+  std::string model_version;
+  r::api_status status;
+  model->request_multi_slot_decision("event", slot_ids, context.c_str(), actions_ids, action_pdfs, model_version, &status);
+  require_success(status);
+
+  // Every slot picks its only action with mass, which is listed first
+  BOOST_REQUIRE_EQUAL(actions_ids.size(), 2);
+  for (size_t slot = 0; slot < 2; slot++)
+  {
+    BOOST_REQUIRE_EQUAL(actions_ids[slot].size(), 3);
+    BOOST_REQUIRE_EQUAL(actions_ids[slot][0], 1);
+    BOOST_REQUIRE_EQUAL(action_pdfs[slot][0], 1.f);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(multi_slot_output_must_split_across_slots)
+{
+  auto model = load_identity_model(m::model_type_t::CCB);
+
+  const std::string context = multi_slot_context({ 0.2f, 0.5f, 0.3f, 0.2f, 0.5f, 0.3f });
+  const std::vector<std::string> slot_ids{ "s1", "s2", "s3", "s4" };
+
+  std::vector<std::vector<uint32_t>> actions_ids;
+  std::vector<std::vector<float>> action_pdfs;
+  std::string model_version;
+  r::api_status status;
+  model->request_multi_slot_decision("event", slot_ids, context.c_str(), actions_ids, action_pdfs, model_version, &status);
+  require_status(status, r::error_code::model_rank_error);
+}
+
+BOOST_AUTO_TEST_CASE(continuous_action_samples_output_pdf)
+{
+  auto model = load_identity_model(m::model_type_t::CA);
+
+  // Rows of (left, right, density): a quarter of the mass on [0, 1) and three quarters on [1, 2)
+  expectations<std::string> inputs{ expectation_t<std::string>{"X", dimensions{2, 3}, tensor_raw{0.f, 1.f, 0.5f, 1.f, 2.f, 1.5f}} };
+  const std::string context = create_tensor_notation(inputs);
+
+  for (int i = 0; i < 20; i++)
+  {
+    float action = -1.f;
+    float pdf_value = -1.f;
+    std::string model_version;
+    r::api_status status;
+    model->choose_continuous_action(i, context.c_str(), action, pdf_value, model_version, &status);
+    require_success(status);
+
+    BOOST_REQUIRE(action >= 0.f && action <= 2.f);
+    BOOST_REQUIRE_CLOSE(pdf_value, action < 1.f ? 0.25f : 0.75f, 0.001f);
+
+    // The draw only depends on the seed, so an event is replayed with the same action
+    float replayed_action = -1.f;
+    model->choose_continuous_action(i, context.c_str(), replayed_action, pdf_value, model_version, &status);
+    require_success(status);
+    BOOST_REQUIRE_EQUAL(replayed_action, action);
+  }
+
+  // The pdf rows must hold three values
+  expectations<std::string> bad_inputs{ expectation_t<std::string>{"X", dimensions{1, 3}, tensor_raw{1.f, 0.f, 1.f}} };
+  float action;
+  float pdf_value;
+  std::string model_version;
+  r::api_status status;
+  model->choose_continuous_action(0, create_tensor_notation(bad_inputs).c_str(), action, pdf_value, model_version, &status);
+  require_status(status, r::error_code::model_rank_error);
+}
@@ -0,0 +1,141 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include "test_helpers.h"
+
+#include "base64.h"
+#include "onnx_scoring_context.h"
+
+#include <fstream>
+#include <iterator>
+#include <memory>
+
+namespace
+{
+  std::shared_ptr<Ort::Session> load_mnist_session(Ort::Env& env)
+  {
+    std::ifstream file("./mnist_data/mnist_model.onnx", std::ios::binary);
+    std::vector<char> model_data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    BOOST_REQUIRE(!model_data.empty());
+
+    Ort::SessionOptions options;
+    return std::make_shared<Ort::Session>(env, model_data.data(), model_data.size(), options);
+  }
+
+  std::string mnist_notation(float seed)
+  {
+    tensor_raw values(28 * 28);
+    for (size_t i = 0; i < values.size(); i++)
+    {
+      values[i] = static_cast<float>((i * 7 + static_cast<size_t>(seed * 13)) % 256) / 255.f;
+    }
+
+    expectations<std::string> inputs{ expectation_t<std::string>{"Input3", dimensions{1, 1, 28, 28}, values} };
+    return create_tensor_notation(inputs);
+  }
+
+  void require_same_ranking(const r::ranking_buffer& expected, const r::ranking_buffer& actual)
+  {
+    BOOST_REQUIRE_EQUAL(expected.slot_count(), actual.slot_count());
+    BOOST_REQUIRE_EQUAL_COLLECTIONS(expected.action_ids(0), expected.action_ids(0) + expected.size(), actual.action_ids(0), actual.action_ids(0) + actual.size());
+    BOOST_REQUIRE_EQUAL_COLLECTIONS(expected.probabilities(0), expected.probabilities(0) + expected.size(), actual.probabilities(0), actual.probabilities(0) + actual.size());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(base64_decode_padding)
+{
+  const std::string encoded[] = { "", "AQ==", "AQI=", "AQID", "AQIDBA==" };
+  for (const auto& text : encoded)
+  {
+    const o::bytes_t expected = from_base64(text);
+
+    size_t size = 0;
+    BOOST_REQUIRE(o::base64::decoded_size(text.data(), text.data() + text.size(), size));
+    BOOST_REQUIRE_EQUAL(size, expected.size());
+
+    o::bytes_t actual(size);
+    BOOST_REQUIRE(o::base64::decode(text.data(), text.data() + text.size(), actual.data()));
+    BOOST_REQUIRE_EQUAL_COLLECTIONS(actual.cbegin(), actual.cend(), expected.cbegin(), expected.cend());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(base64_decode_invalid)
+{
+  unsigned char out[8];
+  size_t size = 0;
+
+  const std::string bad_length = "AQI";
+  BOOST_REQUIRE(!o::base64::decoded_size(bad_length.data(), bad_length.data() + bad_length.size(), size));
+
+  const std::string bad_character = "AQ*D";
+  BOOST_REQUIRE(!o::base64::decode(bad_character.data(), bad_character.data() + bad_character.size(), out));
+
+  const std::string bad_padding = "A===";
+  BOOST_REQUIRE(!o::base64::decode(bad_padding.data(), bad_padding.data() + bad_padding.size(), out));
+
+  const std::string inner_padding = "AQ==AQID";
+  BOOST_REQUIRE(!o::base64::decode(inner_padding.data(), inner_padding.data() + inner_padding.size(), out));
+}
+
+BOOST_AUTO_TEST_CASE(io_binding_matches_session_run)
+{
+  Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "scoring_context_test");
+  auto session = load_mnist_session(env);
+
+  o::onnx_scoring_context bound(session, "Plus214_Output_0", true, nullptr);
+  o::onnx_scoring_context unbound(session, "Plus214_Output_0", false, nullptr);
+  BOOST_REQUIRE(bound.uses_io_binding());
+  BOOST_REQUIRE(!unbound.uses_io_binding());
+
+  r::ranking_buffer expected;
+  r::ranking_buffer actual;
+
+  // Scoring several inputs in a row checks that bound buffers are refilled on every call
+  for (float seed = 0; seed < 5; seed++)
+  {
+    const std::string notation = mnist_notation(seed);
+
+    r::api_status status;
+    unbound.score(notation.c_str(), expected, &status);
+    require_success(status);
+
+    bound.score(notation.c_str(), actual, &status);
+    require_success(status);
+
+    BOOST_REQUIRE_EQUAL(actual.size(), 10);
+    require_same_ranking(expected, actual);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(io_binding_rejects_missing_and_unknown_inputs)
+{
+  Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "scoring_context_test");
+  auto session = load_mnist_session(env);
+  o::onnx_scoring_context bound(session, "Plus214_Output_0", true, nullptr);
+
+  r::ranking_buffer ranking;
+  const std::string notation = mnist_notation(1);
+
+  r::api_status status;
+  bound.score(notation.c_str(), ranking, &status);
+  require_success(status);
+
+  // The previous values are still bound, so an empty example must not be scored with them
+  bound.score("{}", ranking, &status);
+  require_status(status, r::error_code::extension_error);
+
+  std::string unknown = notation;
+  unknown.replace(unknown.find("Input3"), 6, "Input4");
+  bound.score(unknown.c_str(), ranking, &status);
+  require_status(status, r::error_code::extension_error);
+
+  const std::string duplicate = "{" + notation.substr(1, notation.size() - 2) + "," + notation.substr(1);
+  bound.score(duplicate.c_str(), ranking, &status);
+  require_status(status, r::error_code::extension_error);
+
+  bound.score("{\"Input3\":\"AQ*D;\"}", ranking, &status);
+  require_status(status, r::error_code::extension_error);
+}
@@ -0,0 +1,298 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include "test_helpers.h"
+
+#include "base64.h"
+#include "onnx_input.h"
+#include "tensor_parser.h"
+
+#include "legacy_tensor_parser.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  // Characters that are meaningful to the notation or to base64, used to corrupt valid text
+  const std::string MutationCharacters = "AZaz09+/=;\",{}:_[]\\ x\x01\x80";
+
+  o::bytes_t random_bytes(size_t size, std::mt19937& gen)
+  {
+    std::uniform_int_distribution<int> byte(0, 255);
+    o::bytes_t bytes(size);
+    for (auto& b : bytes)
+    {
+      b = static_cast<unsigned char>(byte(gen));
+    }
+    return bytes;
+  }
+
+  void mutate(std::string& text, std::mt19937& gen)
+  {
+    if (text.empty())
+    {
+      return;
+    }
+
+    std::uniform_int_distribution<size_t> position(0, text.size() - 1);
+    std::uniform_int_distribution<size_t> character(0, MutationCharacters.size() - 1);
+    std::uniform_int_distribution<int> count(1, 3);
+    for (int i = count(gen); i > 0; i--)
+    {
+      text[position(gen)] = MutationCharacters[character(gen)];
+    }
+  }
+
+  struct decoder
+  {
+    const char* name;
+    bool (*decode)(const char* first, const char* last, unsigned char* out);
+  };
+
+  // Every decoder this CPU can run, not only the one base64::decode picks
+  std::vector<decoder> decoders()
+  {
+    std::vector<decoder> result{ { "scalar", o::base64::scalar::decode }, { "decode", o::base64::decode } };
+    if (o::base64::ssse3::supported())
+    {
+      result.push_back({ "ssse3", o::base64::ssse3::decode });
+    }
+    if (o::base64::avx2::supported())
+    {
+      result.push_back({ "avx2", o::base64::avx2::decode });
+    }
+    return result;
+  }
+
+  o::bytes_t hex_bytes(const std::string& hex)
+  {
+    o::bytes_t bytes;
+    for (size_t i = 0; i + 1 < hex.size(); i += 2)
+    {
+      bytes.push_back(static_cast<unsigned char>(std::stoi(hex.substr(i, 2), nullptr, 16)));
+    }
+    return bytes;
+  }
+
+  // Every byte value, long enough for several vector blocks before the padded tail
+  const std::string AllBytesBase64 =
+    "AAECAwQFBgcICQoLDA0ODxAREhMUFRYXGBkaGxwdHh8gISIjJCUmJygpKissLS4vMDEyMzQ1Njc4OTo7PD0+P0BBQkNERUZHSElKS0xNTk9Q"
+    "UVJTVFVWV1hZWltcXV5fYGFiY2RlZmdoaWprbG1ub3BxcnN0dXZ3eHl6e3x9fn+AgYKDhIWGh4iJiouMjY6PkJGSk5SVlpeYmZqbnJ2en6Ch"
+    "oqOkpaanqKmqq6ytrq+wsbKztLW2t7i5uru8vb6/wMHCw8TFxsfIycrLzM3Oz9DR0tPU1dbX2Nna29zd3t/g4eLj5OXm5+jp6uvs7e7v8PHy"
+    "8/T19vf4+fr7/P3+/w==";
+
+  // Every character of the alphabet, in order
+  const std::string AlphabetBase64 = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  const std::string AlphabetHex = "00108310518720928b30d38f41149351559761969b71d79f8218a39259a7a29aabb2dbafc31cb3d35db7e39ebbf3dfbf";
+
+  std::string random_notation(std::mt19937& gen)
+  {
+    std::uniform_int_distribution<int> input_count(0, 3);
+    std::uniform_int_distribution<int64_t> value_count(0, 120);
+
+    std::string notation = "{";
+    if (std::bernoulli_distribution(0.2)(gen))
+    {
+      notation += R"("_multi":[{"a":1},{"b":"x"}],)";
+    }
+
+    for (int i = input_count(gen); i > 0; i--)
+    {
+      const int64_t count = value_count(gen);
+      const unsigned char* dims = reinterpret_cast<const unsigned char*>(&count);
+
+      notation += "\"input" + std::to_string(i) + "\":\"";
+      notation += to_base64(o::bytes_t(dims, dims + sizeof(count)));
+      notation += ";";
+      notation += to_base64(random_bytes(static_cast<size_t>(count) * sizeof(float), gen));
+      notation += "\",";
+    }
+
+    if (notation.back() == ',')
+    {
+      notation.pop_back();
+    }
+    return notation + "}";
+  }
+}
+
+BOOST_AUTO_TEST_CASE(base64_decoders_known_answers)
+{
+  o::bytes_t all_bytes(256);
+  for (size_t i = 0; i < all_bytes.size(); i++)
+  {
+    all_bytes[i] = static_cast<unsigned char>(i);
+  }
+  const o::bytes_t alphabet = hex_bytes(AlphabetHex);
+  o::bytes_t alphabet_twice(alphabet);
+  alphabet_twice.insert(alphabet_twice.end(), alphabet.cbegin(), alphabet.cend());
+
+  // RFC 4648 test vectors, then inputs long enough for the vector decoders
+  const std::vector<std::pair<std::string, o::bytes_t>> known_answers{
+    { "", {} },
+    { "Zg==", { 'f' } },
+    { "Zm8=", { 'f', 'o' } },
+    { "Zm9v", { 'f', 'o', 'o' } },
+    { "Zm9vYg==", { 'f', 'o', 'o', 'b' } },
+    { "Zm9vYmE=", { 'f', 'o', 'o', 'b', 'a' } },
+    { "Zm9vYmFy", { 'f', 'o', 'o', 'b', 'a', 'r' } },
+    { AlphabetBase64, alphabet },
+    { AlphabetBase64 + AlphabetBase64, alphabet_twice },
+    { AllBytesBase64, all_bytes },
+  };
+
+  for (const auto& d : decoders())
+  {
+    BOOST_TEST_CONTEXT("decoder " << d.name)
+    {
+      for (const auto& known_answer : known_answers)
+      {
+        const std::string& text = known_answer.first;
+        size_t size = 0;
+        BOOST_REQUIRE(o::base64::decoded_size(text.data(), text.data() + text.size(), size));
+        BOOST_REQUIRE_EQUAL(size, known_answer.second.size());
+
+        o::bytes_t actual(size + 1, 0xAB);
+        BOOST_REQUIRE_MESSAGE(d.decode(text.data(), text.data() + text.size(), actual.data()), text);
+        BOOST_REQUIRE_EQUAL(actual.back(), 0xAB);
+        BOOST_REQUIRE_EQUAL_COLLECTIONS(known_answer.second.cbegin(), known_answer.second.cend(), actual.cbegin(), actual.cend() - 1);
+      }
+
+      // A character outside of the alphabet is found in a vector block, in the scalar tail and in the padded group
+      for (const size_t position : { size_t(0), size_t(31), size_t(47), size_t(200), size_t(339), size_t(341) })
+      {
+        for (const char invalid : { '*', '-', '_', '\0', '\x80' })
+        {
+          std::string text = AllBytesBase64;
+          text[position] = invalid;
+          o::bytes_t actual(all_bytes.size());
+          BOOST_REQUIRE_MESSAGE(!d.decode(text.data(), text.data() + text.size(), actual.data()), position);
+        }
+      }
+
+      // Data after the padding
+      const std::string padded = "AQ=D";
+      o::bytes_t actual(2);
+      BOOST_REQUIRE(!d.decode(padded.data(), padded.data() + padded.size(), actual.data()));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(base64_decode_matches_scalar)
+{
+  BOOST_TEST_MESSAGE("base64 vector unit: " << o::base64::simd_level());
+
+  std::mt19937 gen(13);
+  std::uniform_int_distribution<size_t> size(0, 400);
+  const auto vector_decoders = decoders();
+
+  for (int i = 0; i < 20000; i++)
+  {
+    const o::bytes_t bytes = random_bytes(size(gen), gen);
+    std::string text = to_base64(bytes);
+
+    const bool mutated = i % 2 == 1;
+    if (mutated)
+    {
+      mutate(text, gen);
+    }
+
+    size_t decoded_size = 0;
+    if (!o::base64::decoded_size(text.data(), text.data() + text.size(), decoded_size))
+    {
+      continue;
+    }
+
+    // One extra byte checks that nothing is written past the decoded bytes
+    o::bytes_t expected(decoded_size + 1, 0xAB);
+    o::bytes_t actual(decoded_size + 1, 0xAB);
+    const bool expected_result = o::base64::scalar::decode(text.data(), text.data() + text.size(), expected.data());
+    for (const auto& d : vector_decoders)
+    {
+      std::fill(actual.begin(), actual.end(), 0xAB);
+      const bool actual_result = d.decode(text.data(), text.data() + text.size(), actual.data());
+
+      BOOST_REQUIRE_MESSAGE(expected_result == actual_result, d.name << ": " << text);
+      BOOST_REQUIRE_EQUAL(actual.back(), 0xAB);
+      if (actual_result)
+      {
+        BOOST_REQUIRE_EQUAL_COLLECTIONS(expected.cbegin(), expected.cend(), actual.cbegin(), actual.cend());
+      }
+
+      if (!mutated)
+      {
+        BOOST_REQUIRE(actual_result);
+        BOOST_REQUIRE_EQUAL_COLLECTIONS(bytes.cbegin(), bytes.cend(), actual.cbegin(), actual.cend() - 1);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(find_value_delimiter_at_every_position)
+{
+  const char delimiters[] = { ';', '"', '\0' };
+  for (const char delimiter : delimiters)
+  {
+    for (size_t position = 0; position < 70; position++)
+    {
+      std::string text(70, 'A');
+      text[position] = delimiter;
+
+      const char* found = o::tensor_parser::find_value_delimiter(text.data(), text.data() + text.size());
+      BOOST_REQUIRE_EQUAL(found - text.data(), position);
+
+      // Delimiters past the end of the range are not found
+      found = o::tensor_parser::find_value_delimiter(text.data(), text.data() + position);
+      BOOST_REQUIRE_EQUAL(found - text.data(), position);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(tensor_notation_matches_legacy_parser)
+{
+  std::mt19937 gen(7);
+
+  for (int i = 0; i < 5000; i++)
+  {
+    std::string notation = random_notation(gen);
+    const bool mutated = i % 2 == 1;
+    if (mutated)
+    {
+      mutate(notation, gen);
+    }
+
+    const auto legacy = legacy_tensor_parser::parse(notation);
+    const auto& expected = legacy.inputs;
+    // The one intended difference: data after the padding of a base64 run is rejected now
+    const bool expected_result = legacy.accepted && !legacy.data_after_padding;
+
+    o::onnx_input_builder actual{nullptr};
+    r::api_status status;
+    const bool actual_result = o::read_tensor_notation(notation.c_str(), actual, &status) == r::error_code::success;
+
+    BOOST_REQUIRE_MESSAGE(expected_result == actual_result, notation);
+    if (!mutated)
+    {
+      BOOST_REQUIRE(actual_result);
+    }
+
+    if (actual_result)
+    {
+      BOOST_REQUIRE_EQUAL(actual.input_count(), expected.size());
+      for (size_t input = 0; input < expected.size(); input++)
+      {
+        const auto& tensor = actual.input(input);
+        BOOST_REQUIRE_EQUAL(actual.input_name(input), expected[input].first);
+        BOOST_REQUIRE_EQUAL_COLLECTIONS(tensor.first.cbegin(), tensor.first.cend(), expected[input].second.first.cbegin(), expected[input].second.first.cend());
+        BOOST_REQUIRE_EQUAL_COLLECTIONS(tensor.second.cbegin(), tensor.second.cend(), expected[input].second.second.cbegin(), expected[input].second.second.cend());
+      }
+    }
+  }
+}
@@ -4,14 +4,215 @@
 #endif
 
 #include <boost/test/unit_test.hpp>
+#include "action_flags.h"
+#include "ranking_event.h"
+#include "api_status.h"
+#include "constants.h"
+#include "serialization/json_serializer.h"
 
-BOOST_AUTO_TEST_CASE(json_serializer_ranking_event_single) {}
+#include <cstring>
+#include <limits>
+#include <random>
+#include <sstream>
 
-BOOST_AUTO_TEST_CASE(json_serializer_outcome_event_single_string) {}
-BOOST_AUTO_TEST_CASE(json_serializer_outcome_event_single_numeric) {}
-BOOST_AUTO_TEST_CASE(json_serializer_outcome_event_single_action_taken) {}
+using namespace reinforcement_learning;
+using namespace reinforcement_learning::logger;
+using namespace reinforcement_learning::utility;
+using namespace std;
 
-BOOST_AUTO_TEST_CASE(json_serializer_ranking_event_collection) {}
-BOOST_AUTO_TEST_CASE(json_serializer_outcome_event_collection) {}
+namespace {
+  // The std::ostream based serialization the json serializers used to implement.
+  // Output of the data_buffer_writer based serializers must match it byte for byte.
+  void legacy_serialize(ranking_event& evt, std::ostream& buffer) {
+    buffer << R"({"Version":"1","EventId":")" << evt.get_event_id() << R"(")";
+    if (evt.get_defered_action()) {
+      buffer << R"(,"DeferredAction":true)";
+    }
+    buffer << R"(,"a":[)";
+    auto delimiter = "";
+    for (auto const& action_id : evt.get_action_ids()) {
+      buffer << delimiter << action_id + 1;
+      delimiter = ",";
+    }
+    const std::string context(evt.get_context().begin(), evt.get_context().end());
+    buffer << R"(],"c":)" << context << R"(,"p":[)";
+    delimiter = "";
+    for (auto const& probability : evt.get_probabilities()) {
+      buffer << delimiter << probability + 1;
+      delimiter = ",";
+    }
+    buffer << R"(],"VWState":{"m":")" << evt.get_model_id() << R"("})";
+    if (evt.get_pass_prob() < 1) {
+      buffer << R"(,"pdrop":)" << (1 - evt.get_pass_prob());
+    }
+    buffer << R"(})";
+  }
 
-BOOST_AUTO_TEST_CASE(json_serializer_outcome_event_collection_mixed_types) {}
\ No newline at end of file
+  void legacy_serialize(outcome_event& evt, std::ostream& buffer) {
+    switch (evt.get_outcome_type()) {
+      case outcome_event::outcome_type_string:
+        buffer << R"({"EventId":")" << evt.get_event_id() << R"(","v":)" << evt.get_outcome() << R"(})";
+        break;
+      case outcome_event::outcome_type_numeric:
+        buffer << R"({"EventId":")" << evt.get_event_id() << R"(","v":)" << evt.get_numeric_outcome() << R"(})";
+        break;
+      case outcome_event::outcome_type_action_taken:
+        buffer << R"({"EventId":")" << evt.get_event_id() << R"(","ActionTaken":true})";
+        break;
+    }
+  }
+
+  template<typename TEvent>
+  std::string legacy_serialize_collection(std::vector<TEvent>& events) {
+    std::ostringstream out;
+    for (auto& evt : events) {
+      legacy_serialize(evt, out);
+      out << "\n";
+    }
+    return out.str();
+  }
+
+  template<typename TEvent>
+  std::string serialize_collection(std::vector<TEvent>& events) {
+    data_buffer db;
+    json_collection_serializer<TEvent> serializer(db, value::CONTENT_ENCODING_IDENTITY);
+    for (auto& evt : events) {
+      BOOST_REQUIRE_EQUAL(serializer.add(evt), error_code::success);
+    }
+    BOOST_REQUIRE_EQUAL(serializer.finalize(nullptr), error_code::success);
+    BOOST_CHECK_EQUAL(serializer.size(), db.body_filled_size());
+    // The body is null terminated for consumers reading it as a C string
+    BOOST_CHECK_EQUAL(db.body_begin()[db.body_filled_size()], '\0');
+    return std::string(reinterpret_cast<char*>(db.body_begin()), db.body_filled_size());
+  }
+
+  ranking_event make_ranking_event(const char* event_id, const char* context, unsigned int flags, float pass_prob, size_t num_actions) {
+    ranking_response resp;
+    resp.set_model_id("a_model_id");
+    for (size_t i = 0; i < num_actions; ++i) {
+      resp.push_back((i + 2) % num_actions, 1.f / (i + 3));
+    }
+    return ranking_event::choose_rank(event_id, context, flags, resp, timestamp(), pass_prob);
+  }
+
+  std::string format_float(float value) {
+    data_buffer db;
+    {
+      data_buffer_writer writer(&db);
+      writer.write_float(value);
+    }
+    return std::string(reinterpret_cast<char*>(db.body_begin()), db.body_filled_size());
+  }
+
+  std::string ostream_float(float value) {
+    std::ostringstream out;
+    out << value;
+    return out.str();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(json_serializer_ranking_event_single) {
+  std::vector<ranking_event> events;
+  events.push_back(make_ranking_event("an_event_id", R"({"a":1,"_multi":[{},{},{}]})", 0, 0.33f, 3));
+  const auto result = serialize_collection(events);
+  BOOST_CHECK_EQUAL(result, R"({"Version":"1","EventId":"an_event_id","a":[4,2,3],"c":{"a":1,"_multi":[{},{},{}]},"p":[1.33333,1.25,1.2],"VWState":{"m":"a_model_id"},"pdrop":0.67})" "\n");
+  BOOST_CHECK_EQUAL(result, legacy_serialize_collection(events));
+}
+
+BOOST_AUTO_TEST_CASE(json_serializer_ranking_event_deferred) {
+  std::vector<ranking_event> events;
+  events.push_back(make_ranking_event("an_event_id", "{}", action_flags::DEFERRED, 1.f, 1));
+  const auto result = serialize_collection(events);
+  BOOST_CHECK_EQUAL(result, R"({"Version":"1","EventId":"an_event_id","DeferredAction":true,"a":[2],"c":{},"p":[1.33333],"VWState":{"m":"a_model_id"}})" "\n");
+  BOOST_CHECK_EQUAL(result, legacy_serialize_collection(events));
+}
+
+BOOST_AUTO_TEST_CASE(json_serializer_outcome_event_single_string) {
+  std::vector<outcome_event> events;
+  events.push_back(outcome_event::report_outcome("an_event_id", R"({"reward":1})", timestamp()));
+  const auto result = serialize_collection(events);
+  BOOST_CHECK_EQUAL(result, R"({"EventId":"an_event_id","v":{"reward":1}})" "\n");
+  BOOST_CHECK_EQUAL(result, legacy_serialize_collection(events));
+}
+
+BOOST_AUTO_TEST_CASE(json_serializer_outcome_event_single_numeric) {
+  std::vector<outcome_event> events;
+  events.push_back(outcome_event::report_outcome("an_event_id", 0.75f, timestamp()));
+  const auto result = serialize_collection(events);
+  BOOST_CHECK_EQUAL(result, R"({"EventId":"an_event_id","v":0.75})" "\n");
+  BOOST_CHECK_EQUAL(result, legacy_serialize_collection(events));
+}
+
+BOOST_AUTO_TEST_CASE(json_serializer_outcome_event_single_action_taken) {
+  std::vector<outcome_event> events;
+  events.push_back(outcome_event::report_action_taken("an_event_id", timestamp()));
+  const auto result = serialize_collection(events);
+  BOOST_CHECK_EQUAL(result, R"({"EventId":"an_event_id","ActionTaken":true})" "\n");
+  BOOST_CHECK_EQUAL(result, legacy_serialize_collection(events));
+}
+
+BOOST_AUTO_TEST_CASE(json_serializer_ranking_event_collection) {
+  // Large enough to grow the data_buffer several times
+  const std::string context = R"({"shared":")" + std::string(10000, 'x') + R"(","_multi":[]})";
+  std::vector<ranking_event> events;
+  for (size_t i = 0; i < 50; ++i) {
+    const auto event_id = "event_" + std::to_string(i);
+    events.push_back(make_ranking_event(event_id.c_str(), context.c_str(), i % 2, 1.f - i / 100.f, 1 + i * 3));
+  }
+  BOOST_CHECK_EQUAL(serialize_collection(events), legacy_serialize_collection(events));
+}
+
+BOOST_AUTO_TEST_CASE(json_serializer_outcome_event_collection) {
+  std::vector<outcome_event> events;
+  for (int i = 0; i < 100; ++i) {
+    const auto event_id = "event_" + std::to_string(i);
+    events.push_back(outcome_event::report_outcome(event_id.c_str(), i / 7.f - 5.f, timestamp()));
+  }
+  BOOST_CHECK_EQUAL(serialize_collection(events), legacy_serialize_collection(events));
+}
+
+BOOST_AUTO_TEST_CASE(json_serializer_outcome_event_collection_mixed_types) {
+  std::vector<outcome_event> events;
+  events.push_back(outcome_event::report_outcome("event_1", "1", timestamp()));
+  events.push_back(outcome_event::report_outcome("event_2", 1e-7f, timestamp()));
+  events.push_back(outcome_event::report_action_taken("event_3", timestamp()));
+  events.push_back(outcome_event::report_outcome("event_4", 1234567.f, timestamp()));
+  events.push_back(outcome_event::report_outcome("event_5", -0.f, timestamp()));
+  BOOST_CHECK_EQUAL(serialize_collection(events), legacy_serialize_collection(events));
+}
+
+BOOST_AUTO_TEST_CASE(data_buffer_writer_float_matches_ostream) {
+  const float values[] = {
+    0.f, -0.f, 1.f, -1.f, 0.5f, 0.1f, 0.2f / 3, 1.f / 3, 2.f / 3, 100000.f, 999999.f, 999999.5f, 1000000.f,
+    0.0001f, 0.00009999996f, 0.0000999999f, 0.0009765625f, 123456.5f, 1.0000005f, 1e-5f, 1e10f, -3.4e38f,
+    std::numeric_limits<float>::min(), std::numeric_limits<float>::denorm_min(), std::numeric_limits<float>::max(),
+    std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::quiet_NaN()
+  };
+  for (const auto value : values) {
+    BOOST_CHECK_EQUAL(format_float(value), ostream_float(value));
+  }
+
+  // Random bit patterns cover every exponent, random values in [0, 2] cover probabilities
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> probability(0.f, 2.f);
+  for (int i = 0; i < 200000; ++i) {
+    const uint32_t bits = rng();
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    BOOST_REQUIRE_EQUAL(format_float(value), ostream_float(value));
+    value = probability(rng);
+    BOOST_REQUIRE_EQUAL(format_float(value), ostream_float(value));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(data_buffer_writer_uint_matches_ostream) {
+  const uint64_t values[] = { 0, 1, 9, 10, 99, 100, 12345678901234567890ull, std::numeric_limits<uint64_t>::max() };
+  for (const auto value : values) {
+    data_buffer db;
+    {
+      data_buffer_writer writer(&db);
+      writer.write_uint(value);
+    }
+    BOOST_CHECK_EQUAL(std::string(reinterpret_cast<char*>(db.body_begin()), db.body_filled_size()), std::to_string(value));
+  }
+}
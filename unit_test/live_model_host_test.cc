@@ -0,0 +1,386 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include "live_model_host_impl.h"
+#include "configuration.h"
+#include "constants.h"
+#include "err_constants.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace r = reinforcement_learning;
+namespace m = reinforcement_learning::model_management;
+namespace u = reinforcement_learning::utility;
+namespace err = reinforcement_learning::error_code;
+
+namespace {
+  struct created_objects {
+    int models = 0;
+    int model_updates = 0;
+    int transports = 0;
+    int downloads = 0;
+    int full_model_requests = 0;
+    int senders = 0;
+    int sender_inits = 0;
+    int sends = 0;
+    // Model data published at the source, and the version each transport last returned
+    std::string published;
+    int published_version = 0;
+  };
+
+  class counting_model : public m::i_model {
+  public:
+    explicit counting_model(created_objects& created) : _created(created) {}
+
+    int update(const m::model_data& data, bool& model_ready, r::api_status*) override {
+      ++_created.model_updates;
+      _version.assign(data.data(), data.data_sz());
+      model_ready = true;
+      return err::success;
+    }
+    int choose_rank(uint64_t, const char*, std::vector<int>&, std::vector<float>&, std::string& model_version, r::api_status*) override {
+      model_version = _version;
+      return err::success;
+    }
+    int choose_continuous_action(uint64_t, const char*, float&, float&, std::string&, r::api_status*) override { return err::success; }
+    int request_decision(const std::vector<const char*>&, const char*, std::vector<std::vector<uint32_t>>&, std::vector<std::vector<float>>&, std::string&, r::api_status*) override { return err::success; }
+    int request_multi_slot_decision(const char*, const std::vector<std::string>&, const char*, std::vector<std::vector<uint32_t>>&, std::vector<std::vector<float>>&, std::string&, r::api_status*) override { return err::success; }
+    m::model_type_t model_type() const override { return m::model_type_t::CB; }
+
+  private:
+    created_objects& _created;
+    std::string _version;
+  };
+
+  // Returns the published data once per version, like a transport checking Last-Modified
+  class publishing_transport : public m::i_data_transport {
+  public:
+    explicit publishing_transport(created_objects& created) : _created(created) {}
+
+    int get_data(m::model_data& data, r::api_status*) override {
+      ++_created.downloads;
+      if (_returned == _created.published_version) {
+        return err::success;
+      }
+      _returned = _created.published_version;
+      std::memcpy(data.alloc(_created.published.size()), _created.published.data(), _created.published.size());
+      data.increment_refresh_count();
+      return err::success;
+    }
+
+    void request_full_model() override {
+      ++_created.full_model_requests;
+    }
+
+  private:
+    created_objects& _created;
+    int _returned = 0;
+  };
+
+  class counting_sender : public r::i_sender {
+  public:
+    explicit counting_sender(created_objects& created) : _created(created) {}
+
+    int init(r::api_status*) override {
+      ++_created.sender_inits;
+      return err::success;
+    }
+
+  protected:
+    int v_send(const buffer&, r::api_status*) override {
+      ++_created.sends;
+      return err::success;
+    }
+
+  private:
+    created_objects& _created;
+  };
+
+  struct test_factories {
+    explicit test_factories(created_objects& created) {
+      models.register_type(r::value::VW, [&created](m::i_model** retval, const u::configuration&, r::i_trace*, r::api_status*) {
+        ++created.models;
+        *retval = new counting_model(created);
+        return err::success;
+      });
+      transports.register_type(r::value::AZURE_STORAGE_BLOB, [&created](m::i_data_transport** retval, const u::configuration&, r::i_trace*, r::api_status*) {
+        ++created.transports;
+        *retval = new publishing_transport(created);
+        return err::success;
+      });
+      const auto create_sender = [&created](r::i_sender** retval, const u::configuration&, r::error_callback_fn*, r::i_trace*, r::api_status*) {
+        ++created.senders;
+        *retval = new counting_sender(created);
+        return err::success;
+      };
+      senders.register_type(r::value::INTERACTION_EH_SENDER, create_sender);
+      senders.register_type(r::value::OBSERVATION_EH_SENDER, create_sender);
+    }
+
+    std::shared_ptr<r::live_model_host_impl> create_host(int threads) {
+      u::configuration config;
+      config.set(r::name::BACKGROUND_EXECUTOR_THREADS, std::to_string(threads).c_str());
+      std::shared_ptr<r::live_model_host_impl> host(new r::live_model_host_impl(config, nullptr, nullptr,
+        &r::trace_logger_factory, &transports, &models, &senders, &r::time_provider_factory));
+      BOOST_REQUIRE_EQUAL(host->init(nullptr), err::success);
+      return host;
+    }
+
+    r::model_factory_t models;
+    r::data_transport_factory_t transports;
+    r::sender_factory_t senders;
+  };
+
+  u::configuration app_config(const char* app_id, const char* blob_uri) {
+    u::configuration config;
+    config.set(r::name::APP_ID, app_id);
+    config.set(r::name::MODEL_BLOB_URI, blob_uri);
+    config.set(r::name::INTERACTION_EH_HOST, "hub.servicebus.windows.net");
+    config.set(r::name::INTERACTION_EH_NAME, "interaction");
+    config.set(r::name::OBSERVATION_EH_HOST, "hub.servicebus.windows.net");
+    config.set(r::name::OBSERVATION_EH_NAME, "observation");
+    return config;
+  }
+
+  void publish(created_objects& created, const std::string& data) {
+    created.published = data;
+    ++created.published_version;
+  }
+
+  std::string get_data(m::i_data_transport& transport) {
+    m::model_data data;
+    BOOST_CHECK_EQUAL(transport.get_data(data, nullptr), err::success);
+    return data.refresh_count() == 0 ? "" : std::string(data.data(), data.data_sz());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(live_model_host_loads_identical_models_once) {
+  created_objects created;
+  test_factories factories(created);
+  auto host = factories.create_host(0);
+
+  m::i_model* first;
+  m::i_model* second;
+  m::i_model* other_source;
+  BOOST_CHECK_EQUAL(host->create_model(r::value::VW, app_config("first", "http://models/a"), &first, nullptr), err::success);
+  BOOST_CHECK_EQUAL(host->create_model(r::value::VW, app_config("second", "http://models/a"), &second, nullptr), err::success);
+  BOOST_CHECK_EQUAL(host->create_model(r::value::VW, app_config("other", "http://models/b"), &other_source, nullptr), err::success);
+  std::unique_ptr<m::i_model> first_owner(first), second_owner(second), other_owner(other_source);
+  BOOST_CHECK_EQUAL(created.models, 2);
+
+  m::model_data data;
+  std::memcpy(data.alloc(2), "v1", 2);
+  bool ready = false;
+  BOOST_CHECK_EQUAL(first->update(data, ready, nullptr), err::success);
+  BOOST_CHECK(ready);
+  ready = false;
+  BOOST_CHECK_EQUAL(second->update(data, ready, nullptr), err::success);
+  BOOST_CHECK(ready);
+  BOOST_CHECK_EQUAL(created.model_updates, 1);
+
+  std::vector<int> actions;
+  std::vector<float> pdf;
+  std::string version;
+  BOOST_CHECK_EQUAL(second->choose_rank(0, "{}", actions, pdf, version, nullptr), err::success);
+  BOOST_CHECK_EQUAL(version, "v1");
+
+  // Models are released with the last app using them
+  first_owner.reset();
+  second_owner.reset();
+  m::i_model* recreated;
+  BOOST_CHECK_EQUAL(host->create_model(r::value::VW, app_config("first", "http://models/a"), &recreated, nullptr), err::success);
+  delete recreated;
+  BOOST_CHECK_EQUAL(created.models, 3);
+
+  // Only VW models are shared, the settings of other implementations are not known to the host
+  m::i_model* not_shared = first;
+  BOOST_CHECK_EQUAL(host->create_model(r::value::PASSTHROUGH_PDF_MODEL, app_config("first", "http://models/a"), &not_shared, nullptr), err::success);
+  BOOST_CHECK(not_shared == nullptr);
+  BOOST_CHECK_EQUAL(created.models, 3);
+}
+
+BOOST_AUTO_TEST_CASE(live_model_host_hands_each_download_to_every_app) {
+  created_objects created;
+  test_factories factories(created);
+  auto host = factories.create_host(0);
+
+  m::i_data_transport* first;
+  m::i_data_transport* second;
+  BOOST_CHECK_EQUAL(host->create_data_transport(r::value::AZURE_STORAGE_BLOB, app_config("first", "http://models/a"), &first, nullptr), err::success);
+  BOOST_CHECK_EQUAL(host->create_data_transport(r::value::AZURE_STORAGE_BLOB, app_config("second", "http://models/a"), &second, nullptr), err::success);
+  std::unique_ptr<m::i_data_transport> first_owner(first), second_owner(second);
+  BOOST_CHECK_EQUAL(created.transports, 1);
+
+  publish(created, "v1");
+  BOOST_CHECK_EQUAL(get_data(*first), "v1");
+  BOOST_CHECK_EQUAL(get_data(*first), "");
+  BOOST_CHECK_EQUAL(get_data(*second), "v1");
+  BOOST_CHECK_EQUAL(get_data(*second), "");
+
+  publish(created, "v2");
+  BOOST_CHECK_EQUAL(get_data(*second), "v2");
+  BOOST_CHECK_EQUAL(get_data(*first), "v2");
+}
+
+BOOST_AUTO_TEST_CASE(live_model_host_gives_full_model_before_deltas) {
+  created_objects created;
+  test_factories factories(created);
+  auto host = factories.create_host(0);
+
+  m::i_data_transport* first;
+  BOOST_CHECK_EQUAL(host->create_data_transport(r::value::AZURE_STORAGE_BLOB, app_config("first", "http://models/a"), &first, nullptr), err::success);
+  std::unique_ptr<m::i_data_transport> first_owner(first);
+  publish(created, "full");
+  BOOST_CHECK_EQUAL(get_data(*first), "full");
+  const std::string delta("RLDELTA1 patches");
+  publish(created, delta);
+  BOOST_CHECK_EQUAL(get_data(*first), delta);
+
+  // An app joining later cannot apply the delta alone, the full model it was built on is kept for it
+  m::i_data_transport* late;
+  BOOST_CHECK_EQUAL(host->create_data_transport(r::value::AZURE_STORAGE_BLOB, app_config("late", "http://models/a"), &late, nullptr), err::success);
+  std::unique_ptr<m::i_data_transport> late_owner(late);
+  BOOST_CHECK_EQUAL(get_data(*late), "full");
+  BOOST_CHECK_EQUAL(get_data(*late), delta);
+  BOOST_CHECK_EQUAL(get_data(*late), "");
+
+  // A model which lost track of its base gets the full model again, without another download
+  late->request_full_model();
+  BOOST_CHECK_EQUAL(created.full_model_requests, 0);
+  BOOST_CHECK_EQUAL(get_data(*late), "full");
+  BOOST_CHECK_EQUAL(get_data(*late), delta);
+  BOOST_CHECK_EQUAL(get_data(*late), "");
+}
+
+BOOST_AUTO_TEST_CASE(live_model_host_keeps_deltas_for_apps_polling_less_often) {
+  created_objects created;
+  test_factories factories(created);
+  auto host = factories.create_host(0);
+
+  // The apps load their models differently, so they share the transport but not the model
+  auto frequent_config = app_config("frequent", "http://models/a");
+  auto seldom_config = app_config("seldom", "http://models/a");
+  seldom_config.set(r::name::VW_CMDLINE, "--cb_explore_adf --epsilon 0.3");
+  m::i_model* frequent_model;
+  m::i_model* seldom_model;
+  BOOST_CHECK_EQUAL(host->create_model(r::value::VW, frequent_config, &frequent_model, nullptr), err::success);
+  BOOST_CHECK_EQUAL(host->create_model(r::value::VW, seldom_config, &seldom_model, nullptr), err::success);
+  std::unique_ptr<m::i_model> frequent_model_owner(frequent_model), seldom_model_owner(seldom_model);
+  BOOST_CHECK_EQUAL(created.models, 2);
+
+  m::i_data_transport* frequent;
+  m::i_data_transport* seldom;
+  BOOST_CHECK_EQUAL(host->create_data_transport(r::value::AZURE_STORAGE_BLOB, frequent_config, &frequent, nullptr), err::success);
+  BOOST_CHECK_EQUAL(host->create_data_transport(r::value::AZURE_STORAGE_BLOB, seldom_config, &seldom, nullptr), err::success);
+  std::unique_ptr<m::i_data_transport> frequent_owner(frequent), seldom_owner(seldom);
+  BOOST_CHECK_EQUAL(created.transports, 1);
+
+  publish(created, "full");
+  BOOST_CHECK_EQUAL(get_data(*frequent), "full");
+  BOOST_CHECK_EQUAL(get_data(*seldom), "full");
+
+  // Both deltas are downloaded while the other app is not polling
+  const std::string first_delta("RLDELTA1 first");
+  const std::string second_delta("RLDELTA1 second");
+  publish(created, first_delta);
+  BOOST_CHECK_EQUAL(get_data(*frequent), first_delta);
+  publish(created, second_delta);
+  BOOST_CHECK_EQUAL(get_data(*frequent), second_delta);
+
+  // Each delta applies on top of the previous one, so none may be skipped
+  BOOST_CHECK_EQUAL(get_data(*seldom), first_delta);
+  BOOST_CHECK_EQUAL(get_data(*seldom), second_delta);
+  BOOST_CHECK_EQUAL(get_data(*seldom), "");
+  BOOST_CHECK_EQUAL(created.full_model_requests, 0);
+
+  // A new full model replaces the deltas
+  publish(created, "full 2");
+  BOOST_CHECK_EQUAL(get_data(*seldom), "full 2");
+  BOOST_CHECK_EQUAL(get_data(*frequent), "full 2");
+  BOOST_CHECK_EQUAL(get_data(*frequent), "");
+}
+
+BOOST_AUTO_TEST_CASE(live_model_host_requests_full_model_when_deltas_pile_up) {
+  created_objects created;
+  test_factories factories(created);
+  auto host = factories.create_host(0);
+
+  m::i_data_transport* frequent;
+  m::i_data_transport* seldom;
+  BOOST_CHECK_EQUAL(host->create_data_transport(r::value::AZURE_STORAGE_BLOB, app_config("frequent", "http://models/a"), &frequent, nullptr), err::success);
+  BOOST_CHECK_EQUAL(host->create_data_transport(r::value::AZURE_STORAGE_BLOB, app_config("seldom", "http://models/a"), &seldom, nullptr), err::success);
+  std::unique_ptr<m::i_data_transport> frequent_owner(frequent), seldom_owner(seldom);
+
+  publish(created, "full");
+  BOOST_CHECK_EQUAL(get_data(*frequent), "full");
+  BOOST_CHECK_EQUAL(get_data(*seldom), "full");
+
+  // The source only publishes deltas, one more than are kept
+  for (size_t i = 0; i <= r::live_model_host_impl::DELTA_HISTORY; ++i) {
+    const auto delta = "RLDELTA1 " + std::to_string(i);
+    publish(created, delta);
+    BOOST_CHECK_EQUAL(get_data(*frequent), delta);
+  }
+  BOOST_CHECK_EQUAL(created.full_model_requests, 1);
+
+  // The first delta is gone, so the app behind it cannot catch up with the others
+  BOOST_CHECK_EQUAL(get_data(*seldom), "");
+
+  // The app keeping up is not held back while the full model is downloaded
+  publish(created, "RLDELTA1 next");
+  BOOST_CHECK_EQUAL(get_data(*frequent), "RLDELTA1 next");
+  BOOST_CHECK_EQUAL(created.full_model_requests, 1);
+
+  publish(created, "full 2");
+  BOOST_CHECK_EQUAL(get_data(*seldom), "full 2");
+  BOOST_CHECK_EQUAL(get_data(*frequent), "full 2");
+  BOOST_CHECK_EQUAL(get_data(*seldom), "");
+}
+
+BOOST_AUTO_TEST_CASE(live_model_host_shares_senders_by_hub) {
+  created_objects created;
+  test_factories factories(created);
+  auto host = factories.create_host(0);
+
+  auto other_hub = app_config("other", "http://models/a");
+  other_hub.set(r::name::INTERACTION_EH_NAME, "other_interaction");
+
+  std::vector<std::unique_ptr<r::i_sender>> senders;
+  for (const auto& config : { app_config("first", "http://models/a"), app_config("second", "http://models/b"), other_hub }) {
+    for (const auto impl : { r::value::INTERACTION_EH_SENDER, r::value::OBSERVATION_EH_SENDER }) {
+      r::i_sender* sender;
+      BOOST_CHECK_EQUAL(host->create_sender(impl, config, &sender, nullptr), err::success);
+      BOOST_REQUIRE(sender != nullptr);
+      BOOST_CHECK_EQUAL(sender->init(nullptr), err::success);
+      senders.emplace_back(sender);
+    }
+  }
+  BOOST_CHECK_EQUAL(created.senders, 3);
+  BOOST_CHECK_EQUAL(created.sender_inits, 3);
+
+  for (auto& sender : senders) {
+    BOOST_CHECK_EQUAL(sender->send(nullptr, nullptr), err::success);
+  }
+  BOOST_CHECK_EQUAL(created.sends, 6);
+
+  // Other senders belong to the app
+  r::i_sender* file_sender;
+  BOOST_CHECK_EQUAL(host->create_sender(r::value::INTERACTION_FILE_SENDER, other_hub, &file_sender, nullptr), err::success);
+  BOOST_CHECK(file_sender == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(live_model_host_executor) {
+  created_objects created;
+  test_factories factories(created);
+  BOOST_CHECK(factories.create_host(0)->executor() == nullptr);
+  auto host = factories.create_host(1);
+  BOOST_REQUIRE(host->executor() != nullptr);
+  BOOST_CHECK_EQUAL(host->executor()->thread_count(), 1);
+}
@@ -6,6 +6,9 @@
 
 #include <thread>
 #include <boost/test/unit_test.hpp>
+#include <cstring>
+#include <functional>
+#include <string>
 #include <vector>
 
 #include "live_model.h"
@@ -192,6 +195,34 @@ BOOST_AUTO_TEST_CASE(live_model_ranking_request) {
   BOOST_CHECK_EQUAL(status.get_error_msg(), "");
 }
 
+BOOST_AUTO_TEST_CASE(live_model_ranking_request_with_shared_context) {
+  u::configuration config;
+  cfg::create_from_json(JSON_CFG, config);
+  config.set(r::name::EH_TEST, "true");
+
+  r::api_status status;
+  r::live_model ds = create_mock_live_model(config, nullptr, nullptr, nullptr, r::model_management::model_type_t::CB);
+  BOOST_CHECK_EQUAL(ds.init(&status), err::success);
+
+  uint64_t shared_context = 0;
+  BOOST_CHECK_EQUAL(ds.register_shared_context(R"({"Shared":{"t":"abc"}})", shared_context, &status), err::success);
+
+  const auto event_id = "event_id";
+  r::ranking_response response;
+  BOOST_CHECK_EQUAL(ds.choose_rank(event_id, shared_context, JSON_CONTEXT, response, &status), err::success);
+  BOOST_CHECK_EQUAL(ds.choose_rank(event_id, shared_context, "", response), err::invalid_argument);
+  BOOST_CHECK_EQUAL(ds.choose_rank(event_id, shared_context, "[]", response), err::json_parse_error);
+
+  BOOST_CHECK_EQUAL(ds.unregister_shared_context(shared_context, &status), err::success);
+  BOOST_CHECK_EQUAL(ds.choose_rank(event_id, shared_context, JSON_CONTEXT, response, &status), err::shared_context_not_found);
+  BOOST_CHECK_EQUAL(ds.unregister_shared_context(shared_context, &status), err::shared_context_not_found);
+
+  // Shared features must be a non empty object without actions
+  BOOST_CHECK_EQUAL(ds.register_shared_context("{", shared_context), err::json_parse_error);
+  BOOST_CHECK_EQUAL(ds.register_shared_context("{}", shared_context), err::invalid_argument);
+  BOOST_CHECK_EQUAL(ds.register_shared_context(JSON_CONTEXT, shared_context), err::invalid_argument);
+}
+
 BOOST_AUTO_TEST_CASE(live_model_ranking_request_online_mode) {
   //create a simple ds configuration
   u::configuration config;
@@ -706,6 +737,53 @@ BOOST_AUTO_TEST_CASE(live_model_no_background_refresh_failure) {
     BOOST_CHECK_NE(model.init(&status), err::success);
 }
 
+BOOST_AUTO_TEST_CASE(live_model_loads_full_model_when_delta_does_not_apply) {
+  u::configuration config;
+  cfg::create_from_json(JSON_CFG, config);
+  config.set(r::name::EH_TEST, "true");
+  config.set(r::name::MODEL_BACKGROUND_REFRESH, "false");
+
+  // The transport returns a delta until the full model is requested, the model only accepts the full model
+  bool full_model_requested = false;
+  int full_models_loaded = 0;
+  auto mock_data_transport = get_mock_data_transport();
+  const std::function<int(m::model_data&, r::api_status*)> get_data_fn =
+    [&full_model_requested](m::model_data& data, r::api_status*) {
+    const std::string content = full_model_requested ? "full model" : "RLDELTA1 for another model";
+    std::memcpy(data.alloc(content.size()), content.data(), content.size());
+    data.increment_refresh_count();
+    return err::success;
+  };
+  const std::function<void()> request_full_model_fn = [&full_model_requested]() { full_model_requested = true; };
+  When(Method((*mock_data_transport), get_data)).AlwaysDo(get_data_fn);
+  When(Method((*mock_data_transport), request_full_model)).AlwaysDo(request_full_model_fn);
+
+  auto mock_model = get_mock_model(r::model_management::model_type_t::CB);
+  const std::function<int(const m::model_data&, bool&, r::api_status*)> update_fn =
+    [&full_models_loaded](const m::model_data& data, bool& model_ready, r::api_status* status) -> int {
+    if (std::string(data.data(), data.data_sz()) != "full model") {
+      RETURN_ERROR_LS(nullptr, status, model_delta_base_mismatch);
+    }
+    ++full_models_loaded;
+    model_ready = true;
+    return err::success;
+  };
+  When(Method((*mock_model), update)).AlwaysDo(update_fn);
+
+  auto data_transport_factory = get_mock_data_transport_factory(mock_data_transport.get());
+  auto model_factory = get_mock_model_factory(mock_model.get());
+  r::live_model model = create_mock_live_model(config, data_transport_factory.get(), model_factory.get());
+
+  r::api_status status;
+  BOOST_CHECK_EQUAL(model.init(&status), err::success);
+  BOOST_CHECK(full_model_requested);
+  BOOST_CHECK_EQUAL(full_models_loaded, 1);
+  Verify(Method((*mock_data_transport), request_full_model)).Once();
+
+  r::ranking_response response;
+  BOOST_CHECK_EQUAL(model.choose_rank("event_id", JSON_CONTEXT, response, &status), err::success);
+}
+
 BOOST_AUTO_TEST_CASE(live_model_logger_receive_data) {
   std::vector<buffer_data_t> recorded_observations;
   auto mock_observation_sender = get_mock_sender(recorded_observations);
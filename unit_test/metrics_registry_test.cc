@@ -0,0 +1,113 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include "utility/metrics_registry.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace reinforcement_learning;
+using namespace reinforcement_learning::utility;
+
+BOOST_AUTO_TEST_CASE(metrics_counter_sums_threads) {
+  metrics_counter counter;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&counter] {
+      for (int i = 0; i < 100000; ++i) {
+        counter.add();
+      }
+      counter.add(5);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  BOOST_CHECK_EQUAL(counter.value(), 8 * 100005);
+}
+
+BOOST_AUTO_TEST_CASE(metrics_gauge_add_and_set) {
+  metrics_gauge gauge;
+  gauge.add(10);
+  gauge.add(-3);
+  BOOST_CHECK_EQUAL(gauge.value(), 7);
+  gauge.set(-2);
+  BOOST_CHECK_EQUAL(gauge.value(), -2);
+}
+
+BOOST_AUTO_TEST_CASE(metrics_histogram_buckets) {
+  size_t previous = 0;
+  for (uint64_t value = 0; value < (1ULL << 20); value += 1 + value / 100) {
+    const auto index = metrics_histogram::bucket_index(value);
+    BOOST_REQUIRE_LT(index, metrics_histogram::BUCKETS);
+    BOOST_CHECK_GE(index, previous);
+    BOOST_CHECK_LE(metrics_histogram::bucket_lower_bound(index), value);
+    BOOST_CHECK_GE(metrics_histogram::bucket_upper_bound(index), value);
+    // Relative error bounded by the sub buckets
+    BOOST_CHECK_LE(metrics_histogram::bucket_upper_bound(index) - metrics_histogram::bucket_lower_bound(index),
+      metrics_histogram::bucket_lower_bound(index) / metrics_histogram::SUB_BUCKETS);
+    previous = index;
+  }
+
+  const uint64_t largest = ~0ULL;
+  BOOST_CHECK_EQUAL(metrics_histogram::bucket_index(largest), metrics_histogram::BUCKETS - 1);
+  BOOST_CHECK_EQUAL(metrics_histogram::bucket_upper_bound(metrics_histogram::BUCKETS - 1), largest);
+}
+
+BOOST_AUTO_TEST_CASE(metrics_histogram_percentiles) {
+  metrics_histogram histogram;
+  histogram_value value;
+  histogram.get(value);
+  BOOST_CHECK_EQUAL(value.count, 0);
+  BOOST_CHECK_EQUAL(value.max, 0);
+
+  for (uint64_t i = 1; i <= 1000; ++i) {
+    histogram.record(i);
+  }
+  histogram.get(value);
+  BOOST_CHECK_EQUAL(value.count, 1000);
+  BOOST_CHECK_EQUAL(value.sum, 500500);
+  BOOST_CHECK_EQUAL(value.min, 1);
+  BOOST_CHECK_EQUAL(value.max, 1000);
+
+  const uint64_t expected[] = { 500, 900, 990, 999 };
+  const uint64_t actual[] = { value.p50, value.p90, value.p99, value.p999 };
+  for (size_t i = 0; i < 4; ++i) {
+    BOOST_CHECK_GE(actual[i], expected[i]);
+    BOOST_CHECK_LE(actual[i], expected[i] + expected[i] / 16);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(metrics_registry_snapshot) {
+  metrics_registry registry;
+  auto& sent = registry.counter("b.sent");
+  BOOST_CHECK_EQUAL(&sent, &registry.counter("b.sent"));
+  sent.add(3);
+  registry.counter("a.dropped").add(1);
+  registry.gauge("a.depth").add(4);
+  registry.histogram("a.latency_us").record(20);
+
+  metrics_snapshot snapshot;
+  registry.get(snapshot);
+  BOOST_REQUIRE_EQUAL(snapshot.counters.size(), 2);
+  BOOST_CHECK_EQUAL(snapshot.counters[0].name, "a.dropped");
+  BOOST_CHECK_EQUAL(snapshot.counters[0].value, 1);
+  BOOST_CHECK_EQUAL(snapshot.counters[1].name, "b.sent");
+  BOOST_CHECK_EQUAL(snapshot.counters[1].value, 3);
+  BOOST_REQUIRE_EQUAL(snapshot.gauges.size(), 1);
+  BOOST_CHECK_EQUAL(snapshot.gauges[0].value, 4);
+  BOOST_REQUIRE_EQUAL(snapshot.histograms.size(), 1);
+  BOOST_CHECK_EQUAL(snapshot.histograms[0].count, 1);
+  BOOST_CHECK_EQUAL(snapshot.histograms[0].p99, 20);
+
+  std::string json;
+  metrics_to_json(snapshot, json);
+  BOOST_CHECK_EQUAL(json,
+    "{\"counters\":{\"a.dropped\":1,\"b.sent\":3},\"gauges\":{\"a.depth\":4},\"histograms\":{\"a.latency_us\":"
+    "{\"count\":1,\"sum\":20,\"min\":20,\"max\":20,\"p50\":20,\"p90\":20,\"p99\":20,\"p999\":20}}}");
+}
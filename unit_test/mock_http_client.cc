@@ -3,6 +3,12 @@
 using namespace std;
 using namespace utility;
 
+namespace {
+  const auto GET_RESPONSE_BODY = U("Http GET response");
+  // HEAD and GET describe the same blob, which never changes
+  const auto LAST_MODIFIED = U("Mon, 01 Jan 2024 00:00:00 GMT");
+}
+
 mock_http_client::mock_http_client(const std::string& url)
   : _url(url)
   , _responders{
@@ -39,8 +45,8 @@ void mock_http_client::set_responder(http::method method, std::function<response
 
 void mock_http_client::handle_get(const http_request& message, http_response& resp) {
   resp.set_status_code(status_codes::OK);
-  resp.headers().add(U("Last-Modified"), datetime::utc_now().to_string());
-  resp.set_body(U("Http GET response"));
+  resp.headers().add(U("Last-Modified"), LAST_MODIFIED);
+  resp.set_body(GET_RESPONSE_BODY);
 }
 
 void mock_http_client::handle_post(const http_request& message, http_response& resp) {
@@ -49,8 +55,9 @@ void mock_http_client::handle_post(const http_request& message, http_response& r
 
 void mock_http_client::handle_head(const http_request& message, http_response& resp) {
   resp.set_status_code(status_codes::OK);
-  resp.headers().add(U("Last-Modified"), datetime::utc_now().to_string());
-  resp.set_body(U("Http HEAD response"));
+  resp.headers().add(U("Last-Modified"), LAST_MODIFIED);
+  // Describe the blob returned by GET
+  resp.headers().set_content_length(string_t(GET_RESPONSE_BODY).size());
 }
 
 void mock_http_client::handle_delete(const http_request& message, http_response& resp) {
@@ -4,6 +4,7 @@
 
 #include "constants.h"
 #include "err_constants.h"
+#include "ranking_buffer.h"
 #include "ranking_response.h"
 #include "model_mgmt.h"
 
@@ -72,8 +73,22 @@ std::unique_ptr<fakeit::Mock<m::i_model>> get_mock_model(m::model_type_t model_t
     return r::error_code::success;
   };
 
-  const std::function<int(const char*, float&, float&, std::string&, r::api_status*)> choose_continuous_action_fn =
-    [](const char*, float&, float&, std::string& model_version, r::api_status*) {
+  const std::function<int(uint64_t, const char*, r::ranking_buffer&, std::string&, r::api_status*)> choose_rank_flat_fn =
+    [](uint64_t, const char*, r::ranking_buffer& ranking, std::string& model_version, r::api_status*) {
+    ranking.clear();
+    model_version = "model_id";
+    return r::error_code::success;
+  };
+
+  const std::function<int(uint64_t, const m::shared_context&, const char*, const char*, r::ranking_buffer&, std::string&, r::api_status*)> choose_rank_shared_fn =
+    [](uint64_t, const m::shared_context&, const char*, const char*, r::ranking_buffer& ranking, std::string& model_version, r::api_status*) {
+    ranking.clear();
+    model_version = "model_id";
+    return r::error_code::success;
+  };
+
+  const std::function<int(uint64_t, const char*, float&, float&, std::string&, r::api_status*)> choose_continuous_action_fn =
+    [](uint64_t, const char*, float&, float&, std::string& model_version, r::api_status*) {
     model_version = "model_id";
     return r::error_code::success;
   };
@@ -97,6 +112,8 @@ std::unique_ptr<fakeit::Mock<m::i_model>> get_mock_model(m::model_type_t model_t
 
   When(Method((*mock), update)).AlwaysReturn(r::error_code::success);
   When(Method((*mock), choose_rank)).AlwaysDo(choose_rank_fn);
+  When(Method((*mock), choose_rank_flat)).AlwaysDo(choose_rank_flat_fn);
+  When(Method((*mock), choose_rank_shared)).AlwaysDo(choose_rank_shared_fn);
   When(Method((*mock), choose_continuous_action)).AlwaysDo(choose_continuous_action_fn);
   When(Method((*mock), request_decision)).AlwaysDo(request_decision_fn);
   When(Method((*mock), request_multi_slot_decision)).AlwaysDo(request_multi_slot_decision_fn);
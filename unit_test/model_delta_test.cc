@@ -0,0 +1,107 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include "model_mgmt/model_delta.h"
+#include "api_status.h"
+#include "err_constants.h"
+
+#include <cstring>
+#include <string>
+
+using namespace reinforcement_learning;
+using namespace reinforcement_learning::model_management;
+namespace err = reinforcement_learning::error_code;
+
+namespace {
+  void append(std::string& buffer, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+      buffer.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+  }
+
+  void append(std::string& buffer, const std::string& value) {
+    append(buffer, value.size(), sizeof(uint32_t));
+    buffer.append(value);
+  }
+
+  void append(std::string& buffer, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    append(buffer, bits, sizeof(bits));
+  }
+
+  std::string delta_header(const std::string& base_version, const std::string& version, uint64_t count) {
+    std::string buffer("RLDELTA1");
+    append(buffer, base_version);
+    append(buffer, version);
+    append(buffer, count, sizeof(uint64_t));
+    return buffer;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(model_delta_parse) {
+  std::string buffer = delta_header("v1", "v2", 2);
+  append(buffer, 7, sizeof(uint64_t));
+  append(buffer, 0.5f);
+  append(buffer, 1ULL << 40, sizeof(uint64_t));
+  append(buffer, -2.25f);
+
+  BOOST_CHECK(model_delta::is_delta(buffer.data(), buffer.size()));
+
+  model_delta delta;
+  BOOST_CHECK_EQUAL(model_delta::parse(buffer.data(), buffer.size(), delta, nullptr, nullptr), err::success);
+  BOOST_CHECK_EQUAL(delta.base_version, "v1");
+  BOOST_CHECK_EQUAL(delta.version, "v2");
+  BOOST_REQUIRE_EQUAL(delta.patches.size(), 2);
+  BOOST_CHECK_EQUAL(delta.patches[0].index, 7);
+  BOOST_CHECK_EQUAL(delta.patches[0].value, 0.5f);
+  BOOST_CHECK_EQUAL(delta.patches[1].index, 1ULL << 40);
+  BOOST_CHECK_EQUAL(delta.patches[1].value, -2.25f);
+}
+
+BOOST_AUTO_TEST_CASE(model_delta_empty) {
+  const std::string buffer = delta_header("v1", "v1", 0);
+  model_delta delta;
+  BOOST_CHECK_EQUAL(model_delta::parse(buffer.data(), buffer.size(), delta, nullptr, nullptr), err::success);
+  BOOST_CHECK(delta.patches.empty());
+}
+
+BOOST_AUTO_TEST_CASE(model_delta_rejects_full_model) {
+  const std::string buffer = "not a delta, maybe a vw model";
+  BOOST_CHECK(!model_delta::is_delta(buffer.data(), buffer.size()));
+  BOOST_CHECK(!model_delta::is_delta(nullptr, 0));
+
+  model_delta delta;
+  api_status status;
+  BOOST_CHECK_EQUAL(model_delta::parse(buffer.data(), buffer.size(), delta, nullptr, &status), err::model_delta_format_error);
+}
+
+BOOST_AUTO_TEST_CASE(model_delta_rejects_truncated_data) {
+  model_delta delta;
+
+  const std::string header = delta_header("v1", "v2", 0);
+  for (size_t size = 8; size < header.size(); ++size) {
+    BOOST_CHECK_EQUAL(model_delta::parse(header.data(), size, delta, nullptr, nullptr), err::model_delta_format_error);
+  }
+
+  // Count which does not match the patches that follow
+  std::string buffer = delta_header("v1", "v2", 2);
+  append(buffer, 7, sizeof(uint64_t));
+  append(buffer, 0.5f);
+  BOOST_CHECK_EQUAL(model_delta::parse(buffer.data(), buffer.size(), delta, nullptr, nullptr), err::model_delta_format_error);
+
+  // Trailing bytes after the last patch
+  buffer = delta_header("v1", "v2", 1);
+  append(buffer, 7, sizeof(uint64_t));
+  append(buffer, 0.5f);
+  buffer.push_back('x');
+  BOOST_CHECK_EQUAL(model_delta::parse(buffer.data(), buffer.size(), delta, nullptr, nullptr), err::model_delta_format_error);
+
+  // Count too large to fit in memory must not be trusted
+  buffer = delta_header("v1", "v2", ~0ULL);
+  BOOST_CHECK_EQUAL(model_delta::parse(buffer.data(), buffer.size(), delta, nullptr, nullptr), err::model_delta_format_error);
+}
@@ -12,6 +12,10 @@
 #include "api_status.h"
 #include "err_constants.h"
 #include <regex>
+#include <atomic>
+#include <cstring>
+#include <sstream>
+#include <thread>
 #include "utility/periodic_background_proc.h"
 #include "model_mgmt/model_downloader.h"
 #include "model_mgmt/data_callback_fn.h"
@@ -132,12 +136,247 @@ BOOST_AUTO_TEST_CASE(mock_azure_storage_model_data)
   scode = data_transport->get_data(md, &status);
   BOOST_CHECK_EQUAL(scode, r::error_code::success);
   BOOST_CHECK_EQUAL(md.refresh_count(), 1);
+  // The blob did not change, so it is not downloaded again
   scode = data_transport->get_data(md, &status);
-  BOOST_CHECK_EQUAL(md.refresh_count(), 2);
+  BOOST_CHECK_EQUAL(scode, r::error_code::success);
+  BOOST_CHECK_EQUAL(md.refresh_count(), 1);
 }
 #endif // USE_AZURE_FACTORIES
 #endif //_WIN32 (http_server http protocol issues in linux)
 
+#ifdef USE_AZURE_FACTORIES
+namespace {
+  const std::string BLOB = "The quick brown fox jumps over the lazy dog";
+  const auto BLOB_MD5 = U("nhB9nTcrtoJr2B01QqQZ1g==");
+
+  // Blob served by a mock http client which throttles GETs, and drops or fails some of them
+  struct blob_server {
+    ::utility::string_t last_modified = ::utility::datetime::utc_now().to_string();
+    ::utility::string_t content_md5 = BLOB_MD5;
+    std::chrono::milliseconds delay{ 0 };
+    size_t drop_after = 0;          // Bytes sent by a dropped connection
+    std::atomic<int> drops{ 0 };    // GETs which stop after drop_after bytes
+    std::atomic<int> failures{ 0 }; // GETs which fail without a response
+    std::atomic<int> gets{ 0 };
+
+    void serve(mock_http_client& client) {
+      client.set_responder(methods::HEAD, [this](const http_request&, http_response& resp) {
+        resp.set_status_code(status_codes::OK);
+        resp.headers().add(U("Last-Modified"), last_modified);
+        resp.headers().add(U("Content-MD5"), content_md5);
+        resp.headers().set_content_length(BLOB.size());
+      });
+      client.set_responder(methods::GET, [this](const http_request& message, http_response& resp) {
+        ++gets;
+        std::this_thread::sleep_for(delay);
+        if (failures-- > 0) {
+          throw std::runtime_error("Connection reset");
+        }
+
+        size_t first = 0;
+        size_t last = BLOB.size() - 1;
+        const auto range = message.headers().find(U("Range"));
+        if (range != message.headers().end()) {
+          std::istringstream spec(::utility::conversions::to_utf8string(range->second).substr(strlen("bytes=")));
+          char dash;
+          spec >> first >> dash >> last;
+          resp.set_status_code(status_codes::PartialContent);
+        }
+        else {
+          resp.set_status_code(status_codes::OK);
+        }
+
+        size_t end = last + 1;
+        if (end - first > drop_after && drops-- > 0) {
+          end = first + drop_after;
+        }
+        resp.headers().add(U("Last-Modified"), last_modified);
+        resp.set_body(std::vector<unsigned char>(BLOB.begin() + first, BLOB.begin() + end));
+      });
+    }
+  };
+
+  std::unique_ptr<m::i_data_transport> create_transport(blob_server& server, const m::download_options& options) {
+    auto http_client = new mock_http_client("http://test.com");
+    server.serve(*http_client);
+    return std::unique_ptr<m::i_data_transport>(new m::restapi_data_transport(http_client, nullptr, options, nullptr));
+  }
+
+  std::string to_string(const m::model_data& md) {
+    return std::string(md.data(), md.data_sz());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(restapi_download_resumes_dropped_connection) {
+  blob_server server;
+  server.drop_after = 10;
+  server.drops = 2;
+  m::download_options options;
+  options.max_retries = 1;
+  const auto transport = create_transport(server, options);
+
+  r::api_status status;
+  m::model_data md;
+  BOOST_CHECK_EQUAL(transport->get_data(md, &status), r::error_code::success);
+  BOOST_CHECK_EQUAL(to_string(md), BLOB);
+  BOOST_CHECK_EQUAL(md.refresh_count(), 1);
+  // One GET for the whole blob, then ranges from the first byte missing
+  BOOST_CHECK_EQUAL(server.gets, 3);
+}
+
+BOOST_AUTO_TEST_CASE(restapi_download_chunks) {
+  for (const int parallel_chunks : { 1, 4 }) {
+    blob_server server;
+    server.delay = std::chrono::milliseconds(10);
+    server.drop_after = 2;
+    server.drops = 3;
+    m::download_options options;
+    options.chunk_size = 5;
+    options.parallel_chunks = parallel_chunks;
+    options.max_retries = 1;
+    const auto transport = create_transport(server, options);
+
+    r::api_status status;
+    m::model_data md;
+    BOOST_CHECK_EQUAL(transport->get_data(md, &status), r::error_code::success);
+    BOOST_CHECK_EQUAL(to_string(md), BLOB);
+    // 9 chunks, 3 of them resumed once
+    BOOST_CHECK_EQUAL(server.gets, 12);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(restapi_download_gives_up_after_retries) {
+  blob_server server;
+  server.failures = 2;
+  m::download_options options;
+  options.chunk_size = 5;
+  options.max_retries = 1;
+  const auto transport = create_transport(server, options);
+
+  r::api_status status;
+  m::model_data md;
+  BOOST_CHECK_EQUAL(transport->get_data(md, &status), r::error_code::exception_during_http_req);
+  BOOST_CHECK_EQUAL(md.refresh_count(), 0);
+
+  // The next poll downloads the model again
+  BOOST_CHECK_EQUAL(transport->get_data(md, &status), r::error_code::success);
+  BOOST_CHECK_EQUAL(to_string(md), BLOB);
+}
+
+BOOST_AUTO_TEST_CASE(restapi_download_checks_content_md5) {
+  blob_server server;
+  server.content_md5 = U("EFXT5pjSifKvhmNyUSe9Sw==");
+  for (const uint64_t chunk_size : { 0, 5 }) {
+    m::download_options options;
+    options.chunk_size = chunk_size;
+    options.parallel_chunks = 2;
+    const auto transport = create_transport(server, options);
+
+    r::api_status status;
+    m::model_data md;
+    BOOST_CHECK_EQUAL(transport->get_data(md, &status), r::error_code::model_checksum_mismatch);
+    BOOST_CHECK_EQUAL(md.refresh_count(), 0);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(restapi_download_rejects_changed_model) {
+  blob_server server;
+  m::download_options options;
+  options.chunk_size = 5;
+  options.max_retries = 3;
+  auto http_client = new mock_http_client("http://test.com");
+  server.serve(*http_client);
+  m::restapi_data_transport transport(http_client, nullptr, options, nullptr);
+
+  // GETs see a newer blob than the HEAD request
+  const auto head_last_modified = server.last_modified;
+  http_client->set_responder(methods::HEAD, [&](const http_request&, http_response& resp) {
+    resp.set_status_code(status_codes::OK);
+    resp.headers().add(U("Last-Modified"), head_last_modified);
+    resp.headers().set_content_length(BLOB.size());
+  });
+  server.last_modified = U("Thu, 01 Jan 1970 00:00:00 GMT");
+
+  r::api_status status;
+  m::model_data md;
+  BOOST_CHECK_EQUAL(transport.get_data(md, &status), r::error_code::model_changed_during_download);
+  BOOST_CHECK_EQUAL(server.gets, 1);
+}
+
+namespace {
+  // Blob which is replaced by every publish, with a Last-Modified one second later each time
+  struct published_blob {
+    std::string content;
+    ::utility::string_t last_modified;
+    int published = 0;
+
+    void publish(const std::string& data) {
+      content = data;
+      ++published;
+      last_modified = ::utility::conversions::to_string_t(
+        std::string("Mon, 01 Jan 2024 00:00:") + (published < 10 ? "0" : "") + std::to_string(published) + " GMT");
+    }
+
+    mock_http_client* serve() {
+      auto client = new mock_http_client("http://test.com");
+      client->set_responder(methods::HEAD, [this](const http_request&, http_response& resp) {
+        if (published == 0) {
+          resp.set_status_code(status_codes::NotFound);
+          return;
+        }
+        resp.set_status_code(status_codes::OK);
+        resp.headers().add(U("Last-Modified"), last_modified);
+        resp.headers().set_content_length(content.size());
+      });
+      client->set_responder(methods::GET, [this](const http_request&, http_response& resp) {
+        resp.set_status_code(status_codes::OK);
+        resp.headers().add(U("Last-Modified"), last_modified);
+        resp.set_body(std::vector<unsigned char>(content.begin(), content.end()));
+      });
+      return client;
+    }
+  };
+
+  // Content of the model returned by the transport, empty when it did not return a new one
+  std::string poll(m::i_data_transport& transport) {
+    r::api_status status;
+    m::model_data md;
+    BOOST_CHECK_EQUAL(transport.get_data(md, &status), r::error_code::success);
+    return md.refresh_count() == 0 ? "" : to_string(md);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(restapi_polls_model_deltas) {
+  published_blob model;
+  published_blob delta;
+  model.publish("full 1");
+  m::restapi_data_transport transport(model.serve(), delta.serve(), nullptr);
+
+  // The full model comes first, even with no delta published
+  BOOST_CHECK_EQUAL(poll(transport), "full 1");
+  BOOST_CHECK_EQUAL(poll(transport), "");
+
+  // Deltas are returned as they are published
+  delta.publish("delta 1");
+  BOOST_CHECK_EQUAL(poll(transport), "delta 1");
+  BOOST_CHECK_EQUAL(poll(transport), "");
+  delta.publish("delta 2");
+  BOOST_CHECK_EQUAL(poll(transport), "delta 2");
+
+  // A new full model is returned when no new delta is published, and the delta is checked again after it
+  model.publish("full 2");
+  BOOST_CHECK_EQUAL(poll(transport), "full 2");
+  BOOST_CHECK_EQUAL(poll(transport), "delta 2");
+  BOOST_CHECK_EQUAL(poll(transport), "");
+
+  // Once the full model is requested, the next poll only checks it
+  delta.publish("delta 3");
+  transport.request_full_model();
+  BOOST_CHECK_EQUAL(poll(transport), "");
+  BOOST_CHECK_EQUAL(poll(transport), "delta 3");
+}
+#endif // USE_AZURE_FACTORIES
+
 void register_local_file_factory();
 const char * const DUMMY_DATA_TRANSPORT = "DUMMY_DATA_TRANSPORT";
 const char * const CFG_PARAM = "model.local.file";
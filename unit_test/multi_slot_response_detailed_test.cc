@@ -7,6 +7,7 @@
 #include "multi_slot_response_detailed.h"
 #include <boost/test/unit_test.hpp>
 #include "api_status.h"
+#include "err_constants.h"
 #include <string>
 
 using namespace reinforcement_learning;
@@ -75,3 +76,34 @@ BOOST_AUTO_TEST_CASE(multi_slot_response_detailed_write_read_iterator) {
   }
 }
 
+
+BOOST_AUTO_TEST_CASE(multi_slot_response_detailed_reuse_keeps_slots) {
+  multi_slot_response_detailed multi;
+  auto test_data = get_slot_ranking_test_data1();
+
+  multi.resize(2);
+  for (auto& slot : multi) {
+    for (auto& p : test_data) {
+      slot.push_back(p.first, p.second);
+    }
+  }
+  const auto* first_action = &(*(*multi.begin()).begin());
+
+  multi.clear();
+  BOOST_CHECK_EQUAL(multi.size(), 0);
+  BOOST_CHECK(!(multi.begin() != multi.end()));
+
+  multi.resize(1);
+  BOOST_CHECK_EQUAL(multi.size(), 1);
+  auto& slot = *multi.begin();
+  BOOST_CHECK_EQUAL(slot.size(), 0);
+  slot.push_back(1, 1.f);
+  // The slot storage from the previous use is reused
+  BOOST_CHECK_EQUAL(&(*slot.begin()), first_action);
+
+  slot_ranking other;
+  BOOST_CHECK_EQUAL(multi.set_slot_at_index(1, std::move(other)), error_code::slot_index_out_of_bounds_error);
+
+  multi.resize(2);
+  BOOST_CHECK_EQUAL((*(multi.begin() + 1)).size(), 0);
+}
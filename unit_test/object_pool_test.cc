@@ -126,4 +126,32 @@ BOOST_AUTO_TEST_CASE(object_pool_init_size_test)
   BOOST_CHECK_EQUAL(guard3->_id, 2);
   BOOST_CHECK_EQUAL(new_factory->_count, 3);
 
-}
\ No newline at end of file
+}
+
+BOOST_AUTO_TEST_CASE(object_pool_metrics_test)
+{
+  auto& idle = metrics_registry::instance().gauge("object_pool_metrics_test.idle");
+  auto& created = metrics_registry::instance().counter("object_pool_metrics_test.created");
+  const auto created_before = created.value();
+  {
+    versioned_object_pool<my_object, my_object_factory> pool(new my_object_factory, 2, "object_pool_metrics_test");
+    BOOST_CHECK_EQUAL(idle.value(), 2);
+
+    auto obj1 = pool.get_or_create();
+    auto obj2 = pool.get_or_create();
+    auto obj3 = pool.get_or_create();
+    BOOST_CHECK_EQUAL(idle.value(), 0);
+    BOOST_CHECK_EQUAL(created.value() - created_before, 1);
+
+    pool.return_to_pool(obj1);
+    BOOST_CHECK_EQUAL(idle.value(), 1);
+
+    // Objects of the previous version are deleted rather than pooled
+    pool.update_factory(new my_object_factory);
+    BOOST_CHECK_EQUAL(idle.value(), 3);
+    pool.return_to_pool(obj2);
+    pool.return_to_pool(obj3);
+    BOOST_CHECK_EQUAL(idle.value(), 3);
+  }
+  BOOST_CHECK_EQUAL(idle.value(), 0);
+}
@@ -0,0 +1,199 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include "model_mgmt/prediction_cache.h"
+#include "prediction_cache_stats.h"
+#include "ranking_buffer.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace reinforcement_learning;
+using namespace reinforcement_learning::model_management;
+
+namespace {
+  ranking_buffer make_ranking(uint32_t first_action) {
+    ranking_buffer ranking;
+    ranking.add_slot();
+    ranking.push_back(first_action, 0.75f);
+    ranking.push_back(first_action + 1, 0.25f);
+    return ranking;
+  }
+
+  // Run the model stand-in on a miss, as the models do
+  bool rank(prediction_cache& cache, const std::string& context, uint32_t first_action, ranking_buffer& ranking, std::string& version) {
+    prediction_cache::ticket ticket;
+    if (cache.lookup(context.c_str(), ranking, version, ticket)) {
+      return true;
+    }
+
+    ranking = make_ranking(first_action);
+    version = "v" + std::to_string(first_action);
+    cache.store(ticket, ranking, version);
+    return false;
+  }
+
+  prediction_cache_stats stats_of(const prediction_cache& cache) {
+    prediction_cache_stats stats;
+    cache.get_stats(stats);
+    return stats;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(prediction_cache_hit_returns_stored_ranking) {
+  // Shards of 4 entries, so the two contexts fit whichever shards they hash to
+  prediction_cache cache(64, std::chrono::milliseconds(0));
+  ranking_buffer ranking;
+  std::string version;
+
+  BOOST_CHECK(!rank(cache, R"({"a":1})", 3, ranking, version));
+  BOOST_CHECK(rank(cache, R"({"a":1})", 7, ranking, version));
+  BOOST_CHECK_EQUAL(version, "v3");
+  BOOST_CHECK_EQUAL(ranking.size(), 2);
+  BOOST_CHECK_EQUAL(ranking.action_ids(0)[0], 3);
+  BOOST_CHECK_EQUAL(ranking.probabilities(0)[0], 0.75f);
+
+  // A different context misses
+  BOOST_CHECK(!rank(cache, R"({"a":2})", 7, ranking, version));
+
+  const auto stats = stats_of(cache);
+  BOOST_CHECK_EQUAL(stats.hits, 1);
+  BOOST_CHECK_EQUAL(stats.misses, 2);
+  BOOST_CHECK_EQUAL(stats.entries, 2);
+  BOOST_CHECK_EQUAL(stats.capacity, 64);
+}
+
+BOOST_AUTO_TEST_CASE(prediction_cache_disabled) {
+  prediction_cache cache(0, std::chrono::milliseconds(0));
+  ranking_buffer ranking;
+  std::string version;
+
+  BOOST_CHECK(!rank(cache, "{}", 1, ranking, version));
+  BOOST_CHECK(!rank(cache, "{}", 1, ranking, version));
+
+  const auto stats = stats_of(cache);
+  BOOST_CHECK_EQUAL(stats.hits, 0);
+  BOOST_CHECK_EQUAL(stats.misses, 0);
+  BOOST_CHECK_EQUAL(stats.entries, 0);
+  BOOST_CHECK_EQUAL(stats.capacity, 0);
+}
+
+BOOST_AUTO_TEST_CASE(prediction_cache_clear_drops_entries_and_stale_stores) {
+  prediction_cache cache(8, std::chrono::milliseconds(0));
+  ranking_buffer ranking;
+  std::string version;
+
+  rank(cache, "{}", 1, ranking, version);
+  cache.clear();
+  BOOST_CHECK(!rank(cache, "{}", 2, ranking, version));
+  BOOST_CHECK(rank(cache, "{}", 3, ranking, version));
+  BOOST_CHECK_EQUAL(version, "v2");
+
+  // A ranking computed before an update is not stored after it
+  prediction_cache::ticket ticket;
+  BOOST_CHECK(!cache.lookup("{\"stale\":1}", ranking, version, ticket));
+  cache.clear();
+  cache.store(ticket, make_ranking(4), "v4");
+  BOOST_CHECK(!cache.lookup("{\"stale\":1}", ranking, version, ticket));
+
+  const auto stats = stats_of(cache);
+  BOOST_CHECK_EQUAL(stats.invalidations, 2);
+  BOOST_CHECK_EQUAL(stats.entries, 0);
+}
+
+BOOST_AUTO_TEST_CASE(prediction_cache_evicts_unreferenced_entries_first) {
+  // A single shard holds every entry
+  prediction_cache cache(1, std::chrono::milliseconds(0));
+  ranking_buffer ranking;
+  std::string version;
+
+  rank(cache, "first", 1, ranking, version);
+  rank(cache, "second", 2, ranking, version);
+  BOOST_CHECK(!rank(cache, "first", 1, ranking, version));
+  BOOST_CHECK_EQUAL(stats_of(cache).evictions, 2);
+  BOOST_CHECK_EQUAL(stats_of(cache).entries, 1);
+}
+
+BOOST_AUTO_TEST_CASE(prediction_cache_clock_keeps_referenced_entries) {
+  // The entries are spread over 16 shards of 2 entries, so the hot context competes with cold ones in its shard
+  prediction_cache cache(32, std::chrono::milliseconds(0));
+  ranking_buffer ranking;
+  std::string version;
+
+  // Fill the cache well past its capacity while hitting one context in between
+  rank(cache, "hot", 1, ranking, version);
+  for (uint32_t i = 0; i < 1000; ++i) {
+    rank(cache, "cold" + std::to_string(i), i, ranking, version);
+    BOOST_REQUIRE(rank(cache, "hot", 1, ranking, version));
+  }
+
+  const auto stats = stats_of(cache);
+  BOOST_CHECK_EQUAL(stats.entries, 32);
+  BOOST_CHECK(stats.evictions > 0);
+}
+
+BOOST_AUTO_TEST_CASE(prediction_cache_entries_expire) {
+  prediction_cache cache(8, std::chrono::milliseconds(1));
+  ranking_buffer ranking;
+  std::string version;
+
+  rank(cache, "{}", 1, ranking, version);
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  BOOST_CHECK(!rank(cache, "{}", 2, ranking, version));
+  BOOST_CHECK_EQUAL(version, "v2");
+  BOOST_CHECK_EQUAL(stats_of(cache).expirations, 1);
+}
+
+BOOST_AUTO_TEST_CASE(prediction_cache_hash_depends_on_every_byte) {
+  const std::string base = "{\"features\":\"0123456789abcdefghijklmnopqrstuvwxyz\"}";
+  const auto base_key = prediction_cache::hash(base.data(), base.size());
+
+  for (size_t length = 0; length < base.size(); ++length) {
+    const auto prefix_key = prediction_cache::hash(base.data(), length);
+    BOOST_CHECK(!(prefix_key == base_key));
+  }
+
+  for (size_t i = 0; i < base.size(); ++i) {
+    std::string changed = base;
+    changed[i] ^= 1;
+    BOOST_CHECK(!(prediction_cache::hash(changed.data(), changed.size()) == base_key));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(prediction_cache_concurrent_use) {
+  prediction_cache cache(64, std::chrono::milliseconds(0));
+  std::atomic<bool> wrong_result{false};
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&cache, &wrong_result, t]() {
+      ranking_buffer ranking;
+      std::string version;
+      for (uint32_t i = 0; i < 2000; ++i) {
+        const uint32_t id = (i * 7 + t) % 100;
+        rank(cache, "context" + std::to_string(id), id, ranking, version);
+        if (ranking.action_ids(0)[0] != id || version != "v" + std::to_string(id)) {
+          wrong_result = true;
+        }
+        if (i % 500 == 0) {
+          cache.clear();
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  BOOST_CHECK(!wrong_result);
+  const auto stats = stats_of(cache);
+  BOOST_CHECK_EQUAL(stats.hits + stats.misses, 8000);
+  BOOST_CHECK(stats.entries <= 64);
+}
@@ -0,0 +1,70 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+
+#include "ranking_buffer.h"
+#include <boost/test/unit_test.hpp>
+
+using namespace reinforcement_learning;
+using namespace std;
+
+BOOST_AUTO_TEST_CASE(ranking_buffer_single_slot) {
+  ranking_buffer ranking;
+  BOOST_CHECK_EQUAL(ranking.slot_count(), 0);
+  BOOST_CHECK_EQUAL(ranking.slot_size(0), 0);
+
+  ranking.push_back(3, 0.5f);
+  ranking.push_back(1, 0.25f);
+  ranking.push_back(2, 0.25f);
+
+  BOOST_CHECK_EQUAL(ranking.slot_count(), 1);
+  BOOST_CHECK_EQUAL(ranking.size(), 3);
+  BOOST_CHECK_EQUAL(ranking.slot_size(0), 3);
+  BOOST_CHECK_EQUAL(ranking.action_ids(0)[0], 3);
+  BOOST_CHECK_EQUAL(ranking.action_ids(0)[2], 2);
+  BOOST_CHECK_EQUAL(ranking.probabilities(0)[1], 0.25f);
+}
+
+BOOST_AUTO_TEST_CASE(ranking_buffer_multiple_slots) {
+  ranking_buffer ranking;
+  ranking.add_slot();
+  ranking.push_back(0, 0.9f);
+  ranking.push_back(1, 0.1f);
+  ranking.add_slot();
+  ranking.add_slot();
+  ranking.push_back(1, 1.f);
+
+  BOOST_CHECK_EQUAL(ranking.slot_count(), 3);
+  BOOST_CHECK_EQUAL(ranking.size(), 3);
+  BOOST_CHECK_EQUAL(ranking.slot_size(0), 2);
+  BOOST_CHECK_EQUAL(ranking.slot_size(1), 0);
+  BOOST_CHECK_EQUAL(ranking.slot_size(2), 1);
+  BOOST_CHECK_EQUAL(ranking.action_ids(2)[0], 1);
+  BOOST_CHECK_EQUAL(ranking.probabilities(0)[0], 0.9f);
+
+  // The buffer is flat: slots are consecutive ranges of the same arrays
+  BOOST_CHECK_EQUAL(ranking.action_ids(2), ranking.action_ids(0) + 2);
+  BOOST_CHECK_EQUAL(ranking.probabilities(2), ranking.probabilities(0) + 2);
+}
+
+BOOST_AUTO_TEST_CASE(ranking_buffer_clear_keeps_storage) {
+  ranking_buffer ranking;
+  ranking.reserve(1, 16);
+  for (uint32_t i = 0; i < 16; ++i) {
+    ranking.push_back(i, 1.f / 16);
+  }
+  const auto* action_ids = ranking.action_ids(0);
+  const auto* probabilities = ranking.probabilities(0);
+
+  ranking.clear();
+  BOOST_CHECK_EQUAL(ranking.slot_count(), 0);
+  BOOST_CHECK_EQUAL(ranking.size(), 0);
+
+  for (uint32_t i = 0; i < 8; ++i) {
+    ranking.push_back(i, 1.f / 8);
+  }
+  BOOST_CHECK_EQUAL(ranking.action_ids(0), action_ids);
+  BOOST_CHECK_EQUAL(ranking.probabilities(0), probabilities);
+  BOOST_CHECK_EQUAL(ranking.slot_size(0), 8);
+}
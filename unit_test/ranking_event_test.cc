@@ -0,0 +1,81 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include "action_flags.h"
+#include "ranking_event.h"
+
+#include <cstring>
+
+using namespace reinforcement_learning;
+using namespace std;
+
+BOOST_AUTO_TEST_CASE(context_buffer_copy_shares_storage) {
+  const char* context = R"({"a":1})";
+  context_buffer buffer(context);
+  BOOST_CHECK_EQUAL(buffer.size(), strlen(context));
+  BOOST_CHECK_EQUAL(string(buffer.data(), buffer.size()), context);
+
+  const auto copy = buffer;
+  BOOST_CHECK_EQUAL(copy.data(), buffer.data());
+
+  context_buffer empty;
+  BOOST_CHECK(empty.empty());
+  BOOST_CHECK_EQUAL(empty.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ranking_event_context_buffer_matches_raw_context) {
+  const char* context = R"({"shared":{"f":1},"_multi":[{"a":1},{"a":2}]})";
+  ranking_response resp("event_id");
+  resp.push_back(1, 0.6f);
+  resp.push_back(0, 0.4f);
+
+  const auto from_raw = ranking_event::choose_rank("event_id", context, action_flags::DEFAULT, resp, timestamp());
+  const context_buffer buffer(context);
+  const auto from_buffer = ranking_event::choose_rank("event_id", buffer, action_flags::DEFERRED, resp, timestamp());
+
+  BOOST_CHECK(from_raw.get_context() == from_buffer.get_context());
+  BOOST_CHECK_EQUAL(from_buffer.get_defered_action(), true);
+  // The event references the buffer instead of copying the context again.
+  BOOST_CHECK_EQUAL(from_buffer.get_context().data(), buffer.get().data());
+  BOOST_CHECK_EQUAL(from_buffer.get_action_ids().size(), 2);
+  BOOST_CHECK_EQUAL(from_buffer.get_action_ids()[0], 2);
+}
+
+BOOST_AUTO_TEST_CASE(decision_ranking_event_moves_actions_and_pdfs) {
+  const char* context = R"({"_multi":[{"a":1}],"_slots":[{"s":1}]})";
+  std::vector<const char*> event_ids = { "slot_0", "slot_1" };
+  std::vector<std::vector<uint32_t>> action_ids = { { 0, 1 }, { 1 } };
+  std::vector<std::vector<float>> pdfs = { { 0.8f, 0.2f }, { 1.f } };
+  const auto* action_data = action_ids[0].data();
+  const auto* pdf_data = pdfs[0].data();
+
+  const auto copied = decision_ranking_event::request_decision(event_ids, context, action_flags::DEFAULT, action_ids, pdfs, "model", timestamp());
+  BOOST_CHECK_EQUAL(action_ids.size(), 2);
+
+  const auto moved = decision_ranking_event::request_decision(event_ids, context_buffer(context), action_flags::DEFAULT,
+    std::move(action_ids), std::move(pdfs), "model", timestamp());
+  BOOST_CHECK_EQUAL(moved.get_actions_ids()[0].data(), action_data);
+  BOOST_CHECK_EQUAL(moved.get_probabilities()[0].data(), pdf_data);
+  BOOST_CHECK(moved.get_actions_ids() == copied.get_actions_ids());
+  BOOST_CHECK(moved.get_probabilities() == copied.get_probabilities());
+  BOOST_CHECK(moved.get_context() == copied.get_context());
+  BOOST_CHECK_EQUAL(moved.get_event_ids().size(), 2);
+  BOOST_CHECK_EQUAL(moved.get_event_ids()[1], "slot_1");
+}
+
+BOOST_AUTO_TEST_CASE(multi_slot_decision_event_moves_actions_and_pdfs) {
+  const char* context = R"({"_multi":[{"a":1}],"_slots":[{"s":1}]})";
+  std::vector<std::vector<uint32_t>> action_ids = { { 1, 0 }, { 0 } };
+  std::vector<std::vector<float>> pdfs = { { 0.5f, 0.5f }, { 1.f } };
+  const auto* action_data = action_ids[1].data();
+
+  const auto evt = multi_slot_decision_event::request_decision("event_id", context_buffer(context), action_flags::DEFERRED,
+    std::move(action_ids), std::move(pdfs), "model", timestamp());
+  BOOST_CHECK_EQUAL(evt.get_actions_ids()[1].data(), action_data);
+  BOOST_CHECK_EQUAL(evt.get_defered_action(), true);
+  BOOST_CHECK_EQUAL(evt.get_event_id(), "event_id");
+  BOOST_CHECK_EQUAL(string(evt.get_context().begin(), evt.get_context().end()), context);
+}
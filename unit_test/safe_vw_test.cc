@@ -5,10 +5,18 @@
 
 #include <boost/test/unit_test.hpp>
 #include "vw_model/safe_vw.h"
+#include "vw_model/vw_model.h"
 #include "utility/versioned_object_pool.h"
 #include "model_mgmt.h"
+#include "configuration.h"
+#include "err_constants.h"
 #include "data.h"
 
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
 using namespace reinforcement_learning;
 using namespace reinforcement_learning::utility;
 
@@ -34,6 +42,31 @@ BOOST_AUTO_TEST_CASE(safe_vw_1)
     ranking_expected.begin(), ranking_expected.end());
 }
 
+BOOST_AUTO_TEST_CASE(safe_vw_rank_with_shared_context)
+{
+  safe_vw vw((const char*)cb_data_5_model, cb_data_5_model_len);
+  const auto json = R"({"a":{"0":1,"5":2},"_multi":[{"b":{"0":1}},{"b":{"0":2}},{"b":{"0":3}}]})";
+  const auto actions = R"({"_multi":[{"b":{"0":1}},{"b":{"0":2}},{"b":{"0":3}}]})";
+
+  model_management::shared_context shared;
+  shared.id = 1;
+  shared.features = std::make_shared<const std::string>(R"({"a":{"0":1,"5":2}})");
+
+  ranking_buffer expected;
+  vw.rank(json, expected);
+
+  // The first call parses the shared features, the second one reuses them
+  for (int i = 0; i < 2; ++i) {
+    ranking_buffer actual;
+    vw.rank(shared, actions, actual);
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(actual.action_ids(0), actual.action_ids(0) + actual.slot_size(0),
+      expected.action_ids(0), expected.action_ids(0) + expected.slot_size(0));
+    BOOST_CHECK_EQUAL_COLLECTIONS(actual.probabilities(0), actual.probabilities(0) + actual.slot_size(0),
+      expected.probabilities(0), expected.probabilities(0) + expected.slot_size(0));
+  }
+}
+
 BOOST_AUTO_TEST_CASE(factory_with_cb_model_and_ccb_arguments)
 {  
   const auto json = R"({ "GUser":{"id":"rnc", "major" : "engineering", "hobby" : "hiking", "favorite_character" : "spock"}, "_multi" : [{ "TAction":{"topic":"SkiConditions-VT"} }, { "TAction":{"topic":"HerbGarden"} }, { "TAction":{"topic":"BeyBlades"} }, { "TAction":{"topic":"NYCLiving"} }, { "TAction":{"topic":"MachineLearning"} }], "_slots" : [{ "_size":"large"}, { "_size":"medium" }, { "_size":"small" }]  })";
@@ -141,3 +174,100 @@ BOOST_AUTO_TEST_CASE(factory_with_empty_model) {
     BOOST_CHECK_EQUAL_COLLECTIONS(ranking.begin(), ranking.end(), ranking_expected.begin(), ranking_expected.end());
   }
 }
+
+namespace {
+  // Model delta in the layout read by model_delta::parse
+  std::string build_delta(const std::string& base_version, const std::string& version, const std::vector<model_management::weight_patch>& patches) {
+    std::string buffer("RLDELTA1");
+    const auto append = [&buffer](uint64_t value, size_t bytes) {
+      for (size_t i = 0; i < bytes; ++i) {
+        buffer.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+      }
+    };
+    append(base_version.size(), sizeof(uint32_t));
+    buffer.append(base_version);
+    append(version.size(), sizeof(uint32_t));
+    buffer.append(version);
+    append(patches.size(), sizeof(uint64_t));
+    for (const auto& patch : patches) {
+      uint32_t bits;
+      std::memcpy(&bits, &patch.value, sizeof(bits));
+      append(patch.index, sizeof(uint64_t));
+      append(bits, sizeof(bits));
+    }
+    return buffer;
+  }
+
+  model_management::model_data to_model_data(const std::string& data) {
+    model_management::model_data md;
+    get_model_data_from_raw(data.data(), static_cast<unsigned int>(data.size()), &md);
+    return md;
+  }
+
+  const auto DELTA_CONTEXT = R"({"a":{"0":1,"5":2},"_multi":[{"b":{"0":1}},{"b":{"0":2}},{"b":{"0":3}}]})";
+
+  std::string current_version(model_management::vw_model& model) {
+    std::vector<int> actions;
+    std::vector<float> pdf;
+    std::string version;
+    BOOST_CHECK_EQUAL(model.choose_rank(0, DELTA_CONTEXT, actions, pdf, version), error_code::success);
+    return version;
+  }
+
+  // vw_model loaded with cb_data_5_model, returns the version of that model
+  std::string load_full_model(model_management::vw_model& model) {
+    model_management::model_data full_model;
+    get_model_data_from_raw((const char*)cb_data_5_model, cb_data_5_model_len, &full_model);
+    bool ready = false;
+    BOOST_REQUIRE_EQUAL(model.update(full_model, ready), error_code::success);
+    BOOST_CHECK(ready);
+    return current_version(model);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(vw_model_applies_delta) {
+  model_management::vw_model model(nullptr, utility::configuration());
+  const auto base_version = load_full_model(model);
+
+  bool ready = false;
+  const auto delta = to_model_data(build_delta(base_version, "v2", { { 0, 0.5f }, { 1, -0.5f } }));
+  BOOST_CHECK_EQUAL(model.update(delta, ready), error_code::success);
+  BOOST_CHECK(ready);
+  BOOST_CHECK_EQUAL(current_version(model), "v2");
+
+  // Deltas chain on the version reached, and a delta already applied is ignored
+  BOOST_CHECK_EQUAL(model.update(delta, ready), error_code::success);
+  BOOST_CHECK_EQUAL(model.update(to_model_data(build_delta("v2", "v3", { { 2, 1.f } })), ready), error_code::success);
+  BOOST_CHECK_EQUAL(current_version(model), "v3");
+}
+
+BOOST_AUTO_TEST_CASE(vw_model_rejects_delta_for_another_model) {
+  model_management::vw_model model(nullptr, utility::configuration());
+  bool ready = false;
+  api_status status;
+
+  // No full model to apply it to yet
+  BOOST_CHECK_EQUAL(model.update(to_model_data(build_delta("v1", "v2", { { 0, 0.5f } })), ready, &status), error_code::model_delta_base_mismatch);
+  BOOST_CHECK(!ready);
+
+  const auto base_version = load_full_model(model);
+  BOOST_CHECK_EQUAL(model.update(to_model_data(build_delta(base_version + "other", "v2", { { 0, 0.5f } })), ready, &status), error_code::model_delta_base_mismatch);
+  BOOST_CHECK_EQUAL(current_version(model), base_version);
+}
+
+BOOST_AUTO_TEST_CASE(vw_model_rejects_delta_beyond_weights) {
+  model_management::vw_model model(nullptr, utility::configuration());
+  const auto base_version = load_full_model(model);
+
+  // The first patch is valid, but none is applied
+  bool ready = false;
+  api_status status;
+  const auto delta = to_model_data(build_delta(base_version, "v2", { { 0, 0.5f }, { 1ULL << 40, 1.f } }));
+  BOOST_CHECK_EQUAL(model.update(delta, ready, &status), error_code::model_delta_format_error);
+  BOOST_CHECK_EQUAL(current_version(model), base_version);
+
+  safe_vw vw((const char*)cb_data_5_model, cb_data_5_model_len);
+  const std::string id = vw.id();
+  BOOST_CHECK_THROW(vw.apply_weight_patches({ { 0, 0.5f }, { vw.weight_mask() + 1, 1.f } }, "v2"), std::out_of_range);
+  BOOST_CHECK_EQUAL(vw.id(), id);
+}
@@ -0,0 +1,66 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include "utility/shared_context_registry.h"
+#include "err_constants.h"
+
+#include <string>
+
+using namespace reinforcement_learning;
+using namespace reinforcement_learning::utility;
+namespace err = reinforcement_learning::error_code;
+
+BOOST_AUTO_TEST_CASE(shared_context_registry_add_get_remove) {
+  shared_context_registry registry;
+  uint64_t first = 0;
+  uint64_t second = 0;
+  BOOST_CHECK_EQUAL(registry.add(" {\"User\":{\"id\":\"a\"}}\n", first, nullptr, nullptr), err::success);
+  BOOST_CHECK_EQUAL(registry.add(R"({"User":{"id":"b"}})", second, nullptr, nullptr), err::success);
+  BOOST_CHECK(first != second);
+
+  model_management::shared_context shared;
+  BOOST_CHECK_EQUAL(registry.get(first, shared, nullptr, nullptr), err::success);
+  BOOST_CHECK_EQUAL(shared.id, first);
+  BOOST_CHECK_EQUAL(*shared.features, R"({"User":{"id":"a"}})");
+
+  // Features stay alive for requests holding them after the handle is removed
+  BOOST_CHECK_EQUAL(registry.remove(first, nullptr, nullptr), err::success);
+  BOOST_CHECK_EQUAL(*shared.features, R"({"User":{"id":"a"}})");
+  BOOST_CHECK_EQUAL(registry.get(first, shared, nullptr, nullptr), err::shared_context_not_found);
+  BOOST_CHECK_EQUAL(registry.remove(first, nullptr, nullptr), err::shared_context_not_found);
+
+  // Handles are not reused
+  uint64_t third = 0;
+  BOOST_CHECK_EQUAL(registry.add(R"({"User":{"id":"a"}})", third, nullptr, nullptr), err::success);
+  BOOST_CHECK(third != first);
+}
+
+BOOST_AUTO_TEST_CASE(shared_context_registry_rejects_invalid_features) {
+  shared_context_registry registry;
+  uint64_t handle = 0;
+  BOOST_CHECK_EQUAL(registry.add(R"({"User":)", handle, nullptr, nullptr), err::json_parse_error);
+  BOOST_CHECK_EQUAL(registry.add("[1,2]", handle, nullptr, nullptr), err::invalid_argument);
+  BOOST_CHECK_EQUAL(registry.add("{ }", handle, nullptr, nullptr), err::invalid_argument);
+  BOOST_CHECK_EQUAL(registry.add(R"({"User":{},"_multi":[{}]})", handle, nullptr, nullptr), err::invalid_argument);
+  BOOST_CHECK_EQUAL(registry.add(R"({"User":{},"_slots":[{}]})", handle, nullptr, nullptr), err::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(shared_context_registry_join) {
+  const std::string shared = R"({"User":{"id":"a"}})";
+  std::string context;
+
+  BOOST_CHECK_EQUAL(shared_context_registry::join(shared, R"({"_multi":[{},{}]})", context, nullptr, nullptr), err::success);
+  BOOST_CHECK_EQUAL(context, R"({"User":{"id":"a"},"_multi":[{},{}]})");
+
+  BOOST_CHECK_EQUAL(shared_context_registry::join(shared, "  { \"_multi\":[{}] }", context, nullptr, nullptr), err::success);
+  BOOST_CHECK_EQUAL(context, R"({"User":{"id":"a"}, "_multi":[{}] })");
+
+  BOOST_CHECK_EQUAL(shared_context_registry::join(shared, "{ }", context, nullptr, nullptr), err::success);
+  BOOST_CHECK_EQUAL(context, R"({"User":{"id":"a"} })");
+
+  BOOST_CHECK_EQUAL(shared_context_registry::join(shared, R"(["_multi"])", context, nullptr, nullptr), err::json_parse_error);
+}
@@ -0,0 +1,141 @@
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+
+#include "utility/span_tracer.h"
+#include "err_constants.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace err = reinforcement_learning::error_code;
+using namespace reinforcement_learning::utility;
+
+namespace {
+  std::string read_spans(const std::string& file) {
+    std::ifstream f(file);
+    std::stringstream content;
+    content << f.rdbuf();
+    return content.str();
+  }
+
+  size_t count_occurrences(const std::string& text, const std::string& pattern) {
+    size_t count = 0;
+    for (auto pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+      ++count;
+    }
+    return count;
+  }
+
+  // Sampling counts the requests of each thread, a new thread starts from the first one
+  template<typename TFunc>
+  void run_on_new_thread(TFunc func) {
+    std::thread thread(func);
+    thread.join();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(span_tracer_stages_outside_requests) {
+  {
+    stage_span stage("stage");
+  }
+  BOOST_CHECK(current_request_trace().tracer == nullptr);
+
+  request_span request(nullptr, "request", "event");
+  stage_span stage("stage");
+  BOOST_CHECK(current_request_trace().tracer == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(span_tracer_samples_requests) {
+  const std::string file("span_tracer_sample_test.json");
+  {
+    span_tracer tracer(4, 0, 16, file.c_str(), nullptr);
+    BOOST_CHECK_EQUAL(tracer.init(nullptr), err::success);
+
+    run_on_new_thread([&tracer] {
+      for (int i = 0; i < 8; ++i) {
+        request_span request(&tracer, "request", "event\"id");
+        stage_span outer("outer");
+        {
+          // Nested requests are recorded as part of the outer one
+          request_span nested(&tracer, "nested", "other");
+          stage_span inner("inner");
+        }
+      }
+    });
+    BOOST_CHECK_EQUAL(tracer.run_iteration(nullptr), err::success);
+  }
+
+  const auto spans = read_spans(file);
+  BOOST_CHECK_EQUAL(spans.front(), '[');
+  BOOST_CHECK_EQUAL(spans.substr(spans.size() - 3), "\n]\n");
+  BOOST_CHECK_EQUAL(count_occurrences(spans, "\"name\":\"request\""), 2);
+  BOOST_CHECK_EQUAL(count_occurrences(spans, "\"name\":\"outer\""), 2);
+  BOOST_CHECK_EQUAL(count_occurrences(spans, "\"name\":\"inner\""), 2);
+  BOOST_CHECK_EQUAL(count_occurrences(spans, "\"name\":\"nested\""), 0);
+  BOOST_CHECK_EQUAL(count_occurrences(spans, "\"args\":{\"event_id\":\"event\\\"id\"}"), 2);
+  BOOST_CHECK_EQUAL(count_occurrences(spans, "\"ph\":\"X\""), 6);
+  remove(file.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(span_tracer_keeps_slow_requests) {
+  const std::string file("span_tracer_threshold_test.json");
+  {
+    span_tracer tracer(0, 20000, 16, file.c_str(), nullptr);
+    BOOST_CHECK_EQUAL(tracer.init(nullptr), err::success);
+
+    run_on_new_thread([&tracer] {
+      for (int i = 0; i < 4; ++i) {
+        request_span request(&tracer, "fast", "event");
+        stage_span stage("stage");
+      }
+      request_span request(&tracer, "slow", "event");
+      stage_span stage("stage");
+      std::this_thread::sleep_for(std::chrono::milliseconds(25));
+    });
+  }
+
+  const auto spans = read_spans(file);
+  BOOST_CHECK_EQUAL(count_occurrences(spans, "\"name\":\"fast\""), 0);
+  BOOST_CHECK_EQUAL(count_occurrences(spans, "\"name\":\"slow\""), 1);
+  BOOST_CHECK_EQUAL(count_occurrences(spans, "\"name\":\"stage\""), 1);
+  remove(file.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(span_tracer_drops_when_full) {
+  const std::string file("span_tracer_full_test.json");
+  auto& dropped = metrics_registry::instance().counter("trace.spans.dropped_requests");
+  const auto dropped_before = dropped.value();
+  {
+    span_tracer tracer(1, 0, 2, file.c_str(), nullptr);
+    BOOST_CHECK_EQUAL(tracer.init(nullptr), err::success);
+
+    run_on_new_thread([&tracer] {
+      for (int i = 0; i < 5; ++i) {
+        request_span request(&tracer, "request", "event");
+      }
+    });
+    BOOST_CHECK_EQUAL(dropped.value() - dropped_before, 3);
+
+    // Writing makes room again
+    BOOST_CHECK_EQUAL(tracer.run_iteration(nullptr), err::success);
+    run_on_new_thread([&tracer] {
+      request_span request(&tracer, "request", "event");
+    });
+  }
+
+  BOOST_CHECK_EQUAL(count_occurrences(read_spans(file), "\"name\":\"request\""), 3);
+  remove(file.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(span_tracer_requires_file) {
+  span_tracer tracer(1, 0, 16, "", nullptr);
+  BOOST_CHECK_EQUAL(tracer.init(nullptr), err::invalid_argument);
+}
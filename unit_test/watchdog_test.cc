@@ -9,6 +9,9 @@
 #include "common_test_utils.h"
 #include <iostream>
 #include <atomic>
+#include <algorithm>
+#include <mutex>
+#include <vector>
 
 using namespace reinforcement_learning;
 
@@ -125,3 +128,74 @@ BOOST_AUTO_TEST_CASE(watchdog_multiple_threads) {
     }
   }
 }
+
+BOOST_AUTO_TEST_CASE(watchdog_check_in_through_slot) {
+  if (is_invoked_with("valgrind"))
+  {
+    // this test depends on clock timeouts, can't guarantee test success under valgrind
+    std::cout << "skipping watchdog_check_in_through_slot test when running in valgrind" << std::endl;
+    return;
+  }
+  utility::watchdog watchdog(nullptr);
+  watchdog.start(nullptr);
+
+  int task;
+  auto const slot = watchdog.register_task(&task, "Test task", timeout);
+  for (auto i = 0; i < 5; i++) {
+    watchdog.check_in(slot);
+    std::this_thread::sleep_for(std::chrono::milliseconds(safe_timeout));
+  }
+  BOOST_CHECK_EQUAL(watchdog.has_background_error_been_reported(), false);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(fail_timeout));
+  BOOST_CHECK_EQUAL(watchdog.has_background_error_been_reported(), true);
+}
+
+BOOST_AUTO_TEST_CASE(watchdog_reuses_unregistered_slots) {
+  std::vector<std::string> reported;
+  std::mutex reported_mutex;
+  auto const error_fn = [](const api_status& status, void* arg) {
+    auto const context = static_cast<std::pair<std::vector<std::string>*, std::mutex*>*>(arg);
+    std::lock_guard<std::mutex> lock(*context->second);
+    context->first->push_back(status.get_error_msg());
+  };
+  std::pair<std::vector<std::string>*, std::mutex*> context(&reported, &reported_mutex);
+  error_callback_fn err_func(error_fn, &context);
+
+  utility::watchdog watchdog(&err_func);
+  watchdog.start(nullptr);
+
+  // More tasks than a block of slots, checking in from their own threads while the watchdog scans
+  const auto num_tasks = 100;
+  std::vector<int> tasks(num_tasks);
+  std::vector<utility::watchdog::check_in_slot*> slots;
+  for (auto i = 0; i < num_tasks; i++) {
+    slots.push_back(watchdog.register_task(&tasks[i], utility::concat("Task ", i), 60 * 1000));
+  }
+  std::vector<std::thread> threads;
+  for (auto i = 0; i < 4; i++) {
+    threads.emplace_back([&, i]() {
+      for (auto j = 0; j < 1000; j++) {
+        watchdog.check_in(slots[(i + j) % num_tasks]);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  for (auto i = 0; i < num_tasks; i++) {
+    watchdog.unregister_task(&tasks[i]);
+  }
+
+  // The slot of an unregistered task is handed to the next registration
+  auto const reused = watchdog.register_task(&tasks[0], "Unresponsive task", timeout);
+  BOOST_CHECK(std::find(slots.begin(), slots.end(), reused) != slots.end());
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(fail_timeout));
+  watchdog.stop();
+  std::lock_guard<std::mutex> lock(reported_mutex);
+  BOOST_REQUIRE_GT(reported.size(), 0);
+  for (auto const& message : reported) {
+    BOOST_CHECK(message.find("Unresponsive task") != std::string::npos);
+  }
+}